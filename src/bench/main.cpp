@@ -0,0 +1,521 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/config.h>
+#include <core/Version.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/NotePool.h>
+#include <core/AudioEngine/ProcessProfiler.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Song.h>
+#include <core/CoreActionController.h>
+#include <core/EventQueue.h>
+#include <core/FX/Effects.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Hydrogen.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Sampler/Interpolation.h>
+#include <core/Sampler/Sampler.h>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+using namespace H2Core;
+
+/*
+ * Allocation counting. Replacing the global allocation functions in
+ * the executable affects the core library as well. All threads are
+ * counted, including the render workers of the Sampler.
+ */
+static std::atomic<long long> g_nAllocations( 0 );
+
+void* operator new( std::size_t nSize )
+{
+	g_nAllocations.fetch_add( 1, std::memory_order_relaxed );
+	void* p = std::malloc( nSize == 0 ? 1 : nSize );
+	if ( p == nullptr ) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[]( std::size_t nSize )
+{
+	return operator new( nSize );
+}
+
+void operator delete( void* p ) noexcept
+{
+	std::free( p );
+}
+
+void operator delete[]( void* p ) noexcept
+{
+	std::free( p );
+}
+
+void operator delete( void* p, std::size_t ) noexcept
+{
+	std::free( p );
+}
+
+void operator delete[]( void* p, std::size_t ) noexcept
+{
+	std::free( p );
+}
+
+/** A single point of the benchmark matrix.*/
+struct Scenario {
+	int nVoices;
+	Interpolation::InterpolateMode interpolation;
+	QString sInterpolation;
+	bool bResample;
+	bool bLadspa;
+	int nBufferSize;
+	bool bSongMode;
+};
+
+static const struct {
+	const char* sName;
+	Interpolation::InterpolateMode mode;
+} interpolationModes[] = {
+	{ "linear", Interpolation::InterpolateMode::Linear },
+	{ "cosine", Interpolation::InterpolateMode::Cosine },
+	{ "third", Interpolation::InterpolateMode::Third },
+	{ "cubic", Interpolation::InterpolateMode::Cubic },
+	{ "hermite", Interpolation::InterpolateMode::Hermite }
+};
+
+/** Pitch offset in semitones applied to all instruments to force
+	resampling.*/
+static const float RESAMPLE_PITCH = 0.5;
+
+/** \return Non-empty elements of the comma separated @a sList.*/
+static QStringList splitList( const QString& sList )
+{
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 14, 0 )
+	return sList.split( ',', Qt::SkipEmptyParts );
+#else
+	return sList.split( ',', QString::SkipEmptyParts );
+#endif
+}
+
+/** Parses a comma separated list of integers.
+ *
+ * \return false if any of the elements is not a positive number.*/
+static bool parseIntList( const QString& sList, std::vector<int>& values, bool bAllowZero )
+{
+	values.clear();
+	for ( const auto& sValue : splitList( sList ) ) {
+		bool bOk;
+		const int nValue = sValue.trimmed().toInt( &bOk );
+		if ( ! bOk || nValue < 0 || ( nValue == 0 && ! bAllowZero ) ) {
+			return false;
+		}
+		values.push_back( nValue );
+	}
+	return ! values.empty();
+}
+
+/** Parses a comma separated list of "off" and "on".*/
+static bool parseSwitchList( const QString& sList, std::vector<bool>& values )
+{
+	values.clear();
+	for ( const auto& sValue : splitList( sList ) ) {
+		if ( sValue.trimmed() == "on" ) {
+			values.push_back( true );
+		} else if ( sValue.trimmed() == "off" ) {
+			values.push_back( false );
+		} else {
+			return false;
+		}
+	}
+	return ! values.empty();
+}
+
+/** Drops all events pushed by the audio engine. Nobody else is
+	consuming them.*/
+static void drainEvents()
+{
+	static Event events[ MAX_EVENTS ];
+	while ( EventQueue::get_instance()->pop_events( events, MAX_EVENTS ) > 0 ) {
+	}
+}
+
+/**
+ * Starts notes until at least @a nVoices notes are playing. Only
+ * instruments without mute group are used, as starting a note in a
+ * mute group would release the other notes of the group.
+ */
+static void fillVoices( int nVoices, std::shared_ptr<Song> pSong, int& nNextInstrument )
+{
+	AudioEngine* pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	Sampler* pSampler = pAudioEngine->getSampler();
+	InstrumentList* pInstrList = pSong->getInstrumentList();
+	if ( pInstrList->size() == 0 ) {
+		return;
+	}
+
+	pAudioEngine->lock( RIGHT_HERE );
+	int nCandidates = pInstrList->size();
+	while ( pSampler->getPlayingNotesNumber() < nVoices && nCandidates > 0 ) {
+		auto pInstr = pInstrList->get( nNextInstrument );
+		nNextInstrument = ( nNextInstrument + 1 ) % pInstrList->size();
+		if ( pInstr->get_mute_group() != -1 || pInstr->is_muted() ) {
+			--nCandidates;
+			continue;
+		}
+		nCandidates = pInstrList->size();
+
+		Note* pNote = pAudioEngine->getNotePool()->acquire( pInstr, 0, 0.8, 0.0, -1, 0.0 );
+		if ( pNote == nullptr ) {
+			break;
+		}
+		pSampler->noteOn( pNote );
+	}
+	pAudioEngine->unlock();
+}
+
+/** Runs @a scenario for @a fSeconds of audio and returns its
+	results.*/
+static QJsonObject runScenario( const Scenario& scenario, float fSeconds )
+{
+	Hydrogen* pHydrogen = Hydrogen::get_instance();
+	Preferences* pPref = Preferences::get_instance();
+	std::shared_ptr<Song> pSong = pHydrogen->getSong();
+	InstrumentList* pInstrList = pSong->getInstrumentList();
+
+	// Switching the mode stops the transport. Restarting the driver
+	// applies the buffer size and lets the FakeDriver roll again.
+	pHydrogen->getCoreActionController()->activateSongMode( scenario.bSongMode, false );
+	pPref->m_nBufferSize = scenario.nBufferSize;
+	pHydrogen->restartDrivers();
+	pHydrogen->getCoreActionController()->locateToFrame( 0 );
+
+	AudioEngine* pAudioEngine = pHydrogen->getAudioEngine();
+	pAudioEngine->getSampler()->setInterpolateMode( scenario.interpolation );
+
+	std::vector<float> pitchOffsets;
+	for ( int i = 0; i < pInstrList->size(); ++i ) {
+		pitchOffsets.push_back( pInstrList->get( i )->get_pitch_offset() );
+		if ( scenario.bResample ) {
+			pInstrList->get( i )->set_pitch_offset( RESAMPLE_PITCH );
+		}
+	}
+
+#ifdef H2CORE_HAVE_LADSPA
+	std::vector<bool> fxEnabled;
+	for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+		LadspaFX* pFX = Effects::get_instance()->getLadspaFX( nFX );
+		fxEnabled.push_back( pFX != nullptr && pFX->isEnabled() );
+		if ( pFX != nullptr ) {
+			pFX->setEnabled( scenario.bLadspa );
+		}
+	}
+#endif
+
+	// Identical random humanization in all runs.
+	srand( 1 );
+
+	const int nBufferSize = pHydrogen->getAudioOutput()->getBufferSize();
+	const int nSampleRate = pHydrogen->getAudioOutput()->getSampleRate();
+	const int nCycles = std::max( 1, static_cast<int>( fSeconds * nSampleRate / nBufferSize ) );
+	const int nWarmupCycles = std::max( 1, nCycles / 10 );
+	int nNextInstrument = 0;
+
+	ProcessProfiler* pProfiler = pAudioEngine->getProfiler();
+	long long nNanoseconds = 0;
+	long long nAllocations = 0;
+	int nMeasuredCycles = 0;
+	for ( int nCycle = 0; nCycle < nWarmupCycles + nCycles; ++nCycle ) {
+		if ( nCycle == nWarmupCycles ) {
+			// Applied by the audio engine at the beginning of the
+			// next cycle.
+			pProfiler->reset();
+		}
+		fillVoices( scenario.nVoices, pSong, nNextInstrument );
+		drainEvents();
+
+		const long long nStartAllocations = g_nAllocations.load( std::memory_order_relaxed );
+		const auto start = std::chrono::steady_clock::now();
+		const int nRet = AudioEngine::audioEngine_process( nBufferSize, nullptr );
+		const auto end = std::chrono::steady_clock::now();
+		if ( nCycle >= nWarmupCycles ) {
+			nNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>( end - start ).count();
+			nAllocations += g_nAllocations.load( std::memory_order_relaxed ) - nStartAllocations;
+			++nMeasuredCycles;
+		}
+		if ( nRet == 1 ) {
+			// End of song despite of the loop mode.
+			break;
+		}
+	}
+
+	for ( int i = 0; i < pInstrList->size(); ++i ) {
+		pInstrList->get( i )->set_pitch_offset( pitchOffsets[ i ] );
+	}
+#ifdef H2CORE_HAVE_LADSPA
+	for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+		LadspaFX* pFX = Effects::get_instance()->getLadspaFX( nFX );
+		if ( pFX != nullptr ) {
+			pFX->setEnabled( fxEnabled[ nFX ] );
+		}
+	}
+#endif
+	pAudioEngine->getSampler()->stopPlayingNotes();
+
+	const long long nFrames = static_cast<long long>( nMeasuredCycles ) * nBufferSize;
+	const double fNsPerFrame = nFrames > 0 ? static_cast<double>( nNanoseconds ) / nFrames : 0;
+
+	QJsonObject stages;
+	for ( int nStage = 0; nStage < ProcessProfiler::STAGES; ++nStage ) {
+		if ( pProfiler->getCount( nStage ) == 0 ) {
+			continue;
+		}
+		QJsonObject stage;
+		stage[ "count" ] = pProfiler->getCount( nStage );
+		stage[ "mean_ms" ] = pProfiler->getMean( nStage );
+		stage[ "p50_ms" ] = pProfiler->getPercentile( nStage, 50 );
+		stage[ "p99_ms" ] = pProfiler->getPercentile( nStage, 99 );
+		stage[ "max_ms" ] = pProfiler->getMax( nStage );
+		stages[ ProcessProfiler::getStageName( nStage ) ] = stage;
+	}
+
+	QJsonObject result;
+	result[ "voices" ] = scenario.nVoices;
+	result[ "interpolation" ] = scenario.sInterpolation;
+	result[ "resample" ] = scenario.bResample;
+	result[ "ladspa" ] = scenario.bLadspa;
+	result[ "buffer_size" ] = nBufferSize;
+	result[ "mode" ] = scenario.bSongMode ? "song" : "pattern";
+	result[ "cycles" ] = nMeasuredCycles;
+	result[ "frames" ] = nFrames;
+	result[ "ns_per_frame" ] = fNsPerFrame;
+	// Share of the real-time budget used.
+	result[ "load" ] = fNsPerFrame * nSampleRate / 1e9;
+	result[ "overruns" ] = pProfiler->getOverrunCount();
+	result[ "allocations" ] = nAllocations;
+	result[ "stages" ] = stages;
+	return result;
+}
+
+int main( int argc, char** argv )
+{
+	QCoreApplication app( argc, argv );
+	QCoreApplication::setApplicationName( "h2bench" );
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(
+		"Runs the Hydrogen audio engine without real-time constraints "
+		"for a matrix of scenarios and prints the timings as JSON." );
+	parser.addHelpOption();
+	QCommandLineOption songOption( QStringList() << "s" << "song", "Song to play. Defaults to a demo song. Its drumkit has to be installed system-wide.", "file" );
+	QCommandLineOption voicesOption( "voices", "Minimum numbers of playing notes. The notes of the song count towards them.", "list", "0,32" );
+	QCommandLineOption interpolationOption( "interpolation", "Interpolation modes: linear, cosine, third, cubic, hermite.", "list", "linear,hermite" );
+	QCommandLineOption resampleOption( "resample", "Whether all instruments are pitched to force resampling: off, on.", "list", "off,on" );
+	QCommandLineOption ladspaOption( "ladspa", "Whether the LADSPA effects of the song are enabled: off, on.", "list", "off,on" );
+	QCommandLineOption bufferSizesOption( "buffer-sizes", "Buffer sizes in frames.", "list", "32,64,128,256,512,1024,2048" );
+	QCommandLineOption modesOption( "modes", "Playback modes: song, pattern.", "list", "song,pattern" );
+	QCommandLineOption secondsOption( "seconds", "Audio rendered per scenario.", "seconds", "2" );
+	QCommandLineOption threadsOption( "threads", "Number of render threads of the Sampler.", "number" );
+	QCommandLineOption outputOption( QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file" );
+	QCommandLineOption verboseOption( QStringList() << "V" << "verbose", "Level, if present, may be None, Error, Warning, Info, Debug or 0xHHHH", "Level" );
+	parser.addOption( songOption );
+	parser.addOption( voicesOption );
+	parser.addOption( interpolationOption );
+	parser.addOption( resampleOption );
+	parser.addOption( ladspaOption );
+	parser.addOption( bufferSizesOption );
+	parser.addOption( modesOption );
+	parser.addOption( secondsOption );
+	parser.addOption( threadsOption );
+	parser.addOption( outputOption );
+	parser.addOption( verboseOption );
+	parser.process( app );
+
+	std::vector<int> voices, bufferSizes;
+	std::vector<bool> resample, ladspa;
+	if ( ! parseIntList( parser.value( voicesOption ), voices, true ) ) {
+		std::cerr << "Invalid voices" << std::endl;
+		return 1;
+	}
+	if ( ! parseIntList( parser.value( bufferSizesOption ), bufferSizes, false ) ) {
+		std::cerr << "Invalid buffer sizes" << std::endl;
+		return 1;
+	}
+	for ( int nBufferSize : bufferSizes ) {
+		if ( nBufferSize > MAX_BUFFER_SIZE ) {
+			std::cerr << "Buffer sizes must not exceed " << MAX_BUFFER_SIZE << std::endl;
+			return 1;
+		}
+	}
+	if ( ! parseSwitchList( parser.value( resampleOption ), resample ) ||
+		 ! parseSwitchList( parser.value( ladspaOption ), ladspa ) ) {
+		std::cerr << "Invalid switch. Use 'off' and 'on'." << std::endl;
+		return 1;
+	}
+
+	std::vector<std::pair<QString, Interpolation::InterpolateMode>> interpolations;
+	for ( const auto& sName : splitList( parser.value( interpolationOption ) ) ) {
+		bool bFound = false;
+		for ( const auto& mode : interpolationModes ) {
+			if ( sName.trimmed() == mode.sName ) {
+				interpolations.push_back( std::make_pair( sName.trimmed(), mode.mode ) );
+				bFound = true;
+			}
+		}
+		if ( ! bFound ) {
+			std::cerr << "Unknown interpolation mode: " << sName.toLocal8Bit().data() << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<bool> modes;
+	for ( const auto& sMode : splitList( parser.value( modesOption ) ) ) {
+		if ( sMode.trimmed() == "song" ) {
+			modes.push_back( true );
+		} else if ( sMode.trimmed() == "pattern" ) {
+			modes.push_back( false );
+		} else {
+			std::cerr << "Unknown mode: " << sMode.toLocal8Bit().data() << std::endl;
+			return 1;
+		}
+	}
+
+	bool bOk;
+	const float fSeconds = parser.value( secondsOption ).toFloat( &bOk );
+	if ( ! bOk || fSeconds <= 0 ) {
+		std::cerr << "Invalid duration" << std::endl;
+		return 1;
+	}
+
+	unsigned nLogLevel = Logger::None;
+	if ( parser.isSet( verboseOption ) ) {
+		nLogLevel = Logger::parse_log_level( parser.value( verboseOption ).toLocal8Bit() );
+	}
+	Logger* pLogger = Logger::bootstrap( nLogLevel );
+	Base::bootstrap( pLogger, false );
+	// The preferences altered below are written to the config file
+	// on exit. Neither they nor the sample caches must end up in the
+	// folder of the user.
+	QTemporaryDir usrDir;
+	if ( ! usrDir.isValid() ) {
+		std::cerr << "Unable to create a temporary folder" << std::endl;
+		return 1;
+	}
+	Filesystem::bootstrap( pLogger, nullptr, usrDir.path() );
+	Preferences::create_instance();
+	Preferences* pPref = Preferences::get_instance();
+	pPref->m_sAudioDriver = "Fake";
+	pPref->m_nBufferSize = bufferSizes.front();
+	if ( parser.isSet( threadsOption ) ) {
+		pPref->m_nRenderThreads = parser.value( threadsOption ).toInt();
+	}
+
+	// Enough notes for the requested voices on top of the ones of
+	// the song. Has to be set before the note pools are created.
+	int nMaxVoices = 0;
+	for ( int nVoices : voices ) {
+		nMaxVoices = std::max( nMaxVoices, nVoices );
+	}
+	pPref->m_nMaxNotes = std::max( static_cast<int>( pPref->m_nMaxNotes ), 2 * nMaxVoices );
+
+	Hydrogen::create_instance();
+	Hydrogen* pHydrogen = Hydrogen::get_instance();
+
+	QString sSongPath = parser.value( songOption );
+	if ( sSongPath.isEmpty() ) {
+		sSongPath = Filesystem::demos_dir() + "GM_kit_demo1.h2song";
+	}
+	std::shared_ptr<Song> pSong = Song::load( sSongPath );
+	if ( pSong == nullptr ) {
+		std::cerr << "Unable to load song " << sSongPath.toLocal8Bit().data() << std::endl;
+		return 1;
+	}
+	pHydrogen->setSong( pSong );
+	pSong->setIsLoopEnabled( true );
+
+	QJsonArray results;
+	for ( bool bSongMode : modes ) {
+		for ( int nBufferSize : bufferSizes ) {
+			for ( const auto& interpolation : interpolations ) {
+				for ( bool bResample : resample ) {
+					for ( bool bLadspa : ladspa ) {
+						for ( int nVoices : voices ) {
+							Scenario scenario;
+							scenario.nVoices = nVoices;
+							scenario.sInterpolation = interpolation.first;
+							scenario.interpolation = interpolation.second;
+							scenario.bResample = bResample;
+							scenario.bLadspa = bLadspa;
+							scenario.nBufferSize = nBufferSize;
+							scenario.bSongMode = bSongMode;
+							results.append( runScenario( scenario, fSeconds ) );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	QJsonObject report;
+	report[ "version" ] = QString::fromStdString( get_version() );
+	report[ "song" ] = sSongPath;
+	report[ "sample_rate" ] = static_cast<int>( pHydrogen->getAudioOutput()->getSampleRate() );
+	report[ "render_threads" ] = static_cast<int>( pPref->m_nRenderThreads );
+	report[ "max_notes" ] = static_cast<int>( pPref->m_nMaxNotes );
+	report[ "scenarios" ] = results;
+	const QByteArray json = QJsonDocument( report ).toJson();
+
+	if ( parser.isSet( outputOption ) ) {
+		QFile file( parser.value( outputOption ) );
+		if ( ! file.open( QIODevice::WriteOnly ) ) {
+			std::cerr << "Unable to write " << parser.value( outputOption ).toLocal8Bit().data() << std::endl;
+			return 1;
+		}
+		file.write( json );
+	} else {
+		std::cout << json.constData();
+	}
+
+	delete pHydrogen;
+	delete pPref;
+	delete EventQueue::get_instance();
+	delete Logger::get_instance();
+
+	return 0;
+}
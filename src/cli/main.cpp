@@ -69,6 +69,7 @@ static struct option long_opts[] = {
 	{"help", 0, nullptr, 'h'},
 	{"install", required_argument, nullptr, 'i'},
 	{"drumkit", required_argument, nullptr, 'k'},
+	{"profile", 0, nullptr, 'P'},
 	{nullptr, 0, nullptr, 0},
 };
 
@@ -136,6 +137,7 @@ int main(int argc, char *argv[])
 		bool showVersionOpt = false;
 		const char* logLevelOpt = "Error";
 		bool showHelpOpt = false;
+		bool bShowProfile = false;
 		QString drumkitName;
 		QString drumkitToLoad;
 		short bits = 16;
@@ -182,6 +184,9 @@ int main(int argc, char *argv[])
 			case 'V':
 				logLevelOpt = (optarg) ? optarg : "Warning";
 				break;
+			case 'P':
+				bShowProfile = true;
+				break;
 #ifdef H2CORE_HAVE_JACKSESSION
 			case 'S':
 				sessionId = QString::fromLocal8Bit(optarg);
@@ -389,49 +394,53 @@ int main(int argc, char *argv[])
 		}
 
 		// Interactive mode
+		Event events[ MAX_EVENTS ];
 		while ( ! quit ) {
 			/* FIXME: Someday here will be The Real CLI ;-) */
-			Event event = pQueue->pop_event();
-			// if ( event.type > 0) std::cout << "EVENT TYPE: " << event.type << std::endl;
+			const int nEvents = pQueue->pop_events( events, MAX_EVENTS );
+			if ( nEvents == 0 ) {
+				/* Sleep if there is no more events */
+				Sleeper::msleep ( 100 );
+				continue;
+			}
 
 			/* Event handler */
-			switch ( event.type ) {
-			case EVENT_PROGRESS: /* event used only in export mode */
-				if ( ! ExportMode ) break;
+			for ( int i = 0; i < nEvents && ! quit; ++i ) {
+				const Event& event = events[ i ];
+				switch ( event.type ) {
+				case EVENT_PROGRESS: /* event used only in export mode */
+					if ( ! ExportMode ) break;
 	
-				if ( event.value < 100 ) {
-					std::cout << "\rExport Progress ... " << event.value << "%";
-				} else {
-					pHydrogen->stopExportSession();
-					std::cout << "\rExport Progress ... DONE" << std::endl;
-					quit = true;
-				}
-				break;
-			case EVENT_PLAYLIST_LOADSONG: /* Load new song on MIDI event */
-				if( pPlaylist ){
-					QString FirstSongFilename;
-					pPlaylist->getSongFilenameByNumber( event.value, FirstSongFilename );
-					pSong = Song::load( FirstSongFilename );
+					if ( event.value < 100 ) {
+						std::cout << "\rExport Progress ... " << event.value << "%";
+					} else {
+						pHydrogen->stopExportSession();
+						std::cout << "\rExport Progress ... DONE" << std::endl;
+						quit = true;
+					}
+					break;
+				case EVENT_PLAYLIST_LOADSONG: /* Load new song on MIDI event */
+					if( pPlaylist ){
+						QString FirstSongFilename;
+						pPlaylist->getSongFilenameByNumber( event.value, FirstSongFilename );
+						pSong = Song::load( FirstSongFilename );
 					
-					if( pSong ) {
-						pHydrogen->setSong( pSong );
-						preferences->setLastSongFilename( songFilename );
+						if( pSong ) {
+							pHydrogen->setSong( pSong );
+							preferences->setLastSongFilename( songFilename );
 						
-						pPlaylist->activateSong( event.value );
+							pPlaylist->activateSong( event.value );
+						}
 					}
+					break;
+				case EVENT_QUIT: // Shutdown if indicated by a
+								 // corresponding OSC message.
+					quit = true;
+					break;
+				default:
+					// EVENT_STATE, EVENT_PATTERN_CHANGED, etc are ignored
+					break;
 				}
-				break;
-			case EVENT_NONE: /* Sleep if there is no more events */
-				Sleeper::msleep ( 100 );
-				break;
-				
-			case EVENT_QUIT: // Shutdown if indicated by a
-							 // corresponding OSC message.
-				quit = true;
-				break;
-			default:
-				// EVENT_STATE, EVENT_PATTERN_CHANGED, etc are ignored
-				break;
 			}
 		}
 
@@ -439,6 +448,12 @@ int main(int argc, char *argv[])
 			pHydrogen->sequencer_stop();
 		}
 
+		if ( bShowProfile ) {
+			std::cout << std::endl
+					  << pHydrogen->getAudioEngine()->getProfiler()->getSummary().toLocal8Bit().constData()
+					  << std::endl;
+		}
+
 		//delete pSong;
 		pSong = nullptr;
 		delete pPlaylist;
@@ -511,6 +526,7 @@ void showUsage()
 	std::cout << "   --lash-no-autoresume - Tell LASH server not to assume I'm returning" << std::endl
 			  << "                          from a crash." << std::endl;
 #endif
+	std::cout << "   -P, --profile - Print the time spent in the stages of the audio processing on exit" << std::endl;
 	std::cout << "   -V[Level], --verbose[=Level] - Print a lot of debugging info" << std::endl;
 	std::cout << "                 Level, if present, may be None, Error, Warning, Info, Debug or 0xHHHH" << std::endl;
 	std::cout << "   -v, --version - Show version info" << std::endl;
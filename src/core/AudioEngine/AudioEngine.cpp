@@ -40,6 +40,7 @@
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/InstrumentLayer.h>
 #include <core/Basics/InstrumentComponent.h>
+#include <core/Sampler/BlockKernels.h>
 #include <core/Sampler/Sampler.h>
 #include <core/Helpers/Filesystem.h>
 
@@ -62,6 +63,7 @@
 
 #include <core/Hydrogen.h>	// TODO: remove this line as soon as possible
 #include <core/Preferences/Preferences.h>
+#include <algorithm>
 #include <cassert>
 
 namespace H2Core
@@ -88,18 +90,10 @@ inline float getGaussian( float z )
 }
 
 
-/** Gets the current time.
- * \return Current time obtained by gettimeofday()*/
-inline timeval currentTime2()
-{
-	struct timeval now;
-	gettimeofday( &now, nullptr );
-	return now;
-}
-
 AudioEngine::AudioEngine()
 		: TransportInfo()
 		, m_pSampler( nullptr )
+		, m_pNotePool( nullptr )
 		, m_pSynth( nullptr )
 		, m_fElapsedTime( 0 )
 		, m_pAudioDriver( nullptr )
@@ -112,16 +106,22 @@ AudioEngine::AudioEngine()
 		, m_nSongSizeInTicks( 0 )
 		, m_nRealtimeFrames( 0 )
 		, m_nAddRealtimeNoteTickPosition( 0 )
-		, m_fMasterPeak_L( 0.0f )
-		, m_fMasterPeak_R( 0.0f )
+		, m_masterMeter( true )
 		, m_nColumn( -1 )
 		, m_nMaxTimeHumanize( 2000 )
 		, m_nextState( State::Ready )
 		, m_fProcessTime( 0.0f )
 		, m_fMaxProcessTime( 0.0f )
+		, m_nCycleStartTime( 0 )
+		, m_nCycleFrames( 0 )
+		, m_nCycleSampleRate( 0 )
+		, m_songNoteQueue( 4 * Preferences::get_instance()->m_nMaxNotes )
 {
 
-	m_pSampler = new Sampler;
+	m_pNotePool = new NotePool( m_songNoteQueue.getCapacity() );
+	m_dueNotes.reserve( m_songNoteQueue.getCapacity() );
+	m_midiNoteQueue.reserve( m_songNoteQueue.getCapacity() );
+	m_pSampler = new Sampler( m_pNotePool );
 	m_pSynth = new Synth;
 	
 	m_pEventQueue = EventQueue::get_instance();
@@ -188,6 +188,7 @@ AudioEngine::~AudioEngine()
 //	delete Sequencer::get_instance();
 	delete m_pSampler;
 	delete m_pSynth;
+	delete m_pNotePool;
 }
 
 Sampler* AudioEngine::getSampler() const
@@ -196,6 +197,12 @@ Sampler* AudioEngine::getSampler() const
 	return m_pSampler;
 }
 
+NotePool* AudioEngine::getNotePool() const
+{
+	assert(m_pNotePool);
+	return m_pNotePool;
+}
+
 Synth* AudioEngine::getSynth() const
 {
 	assert(m_pSynth);
@@ -285,8 +292,7 @@ void AudioEngine::stopPlayback()
 }
 
 void AudioEngine::reset() {
-	m_fMasterPeak_L = 0.0f;
-	m_fMasterPeak_R = 0.0f;
+	m_masterMeter.reset();
 	m_nColumn = -1;
 	m_nPatternStartTick = -1;
 	m_nPatternTickPosition = 0;
@@ -681,6 +687,12 @@ void AudioEngine::stopAudioDrivers()
 	m_state = State::Initialized;
 	m_pEventQueue->push_event( EVENT_STATE, static_cast<int>(State::Initialized) );
 
+	// The MIDI worker might be waiting for the lock. It has to be
+	// stopped before acquiring it.
+	if ( m_pMidiDriver ) {
+		m_pMidiDriver->setActive( false );
+	}
+
 	this->lock( RIGHT_HERE );
 
 	// delete MIDI driver
@@ -751,9 +763,8 @@ void AudioEngine::processCheckBPMChanged(std::shared_ptr<Song> pSong)
 	// update frame position in transport class
 	setFrames( ceil(fTickNumber) * fNewTickSize );
 	
-	___WARNINGLOG( QString( "Tempo change: Recomputing ticksize and frame position. Old TS: %1, new TS: %2, new pos: %3" )
-		.arg( fOldTickSize ).arg( fNewTickSize )
-				   .arg( getFrames() ) );
+	___RT_WARNINGLOG( "Tempo change: Recomputing ticksize and frame position. Old TS: %1, new TS: %2, new pos: %3",
+					  fOldTickSize, fNewTickSize, getFrames() );
 #ifdef H2CORE_HAVE_JACK
 	if ( Hydrogen::get_instance()->haveJackTransport() ) {
 		static_cast< JackAudioDriver* >( m_pAudioDriver )->calculateFrameOffset(oldFrame);
@@ -812,108 +823,90 @@ void AudioEngine::processPlayNotes( unsigned long nframes )
 	AutomationPath *vp = pSong->getVelocityAutomationPath();
 	
 
-	// reading from m_songNoteQueue
-	while ( !m_songNoteQueue.empty() ) {
-		Note *pNote = m_songNoteQueue.top();
+	// Collect all notes in m_songNoteQueue starting within this
+	// cycle (or prior to it) in a single sweep. Negative humanize
+	// delays are taken into account so we don't miss the time
+	// slice. Positive delays are handled by the sampler.
+	m_dueNotes.clear();
+	m_songNoteQueue.popDue( static_cast<long long>( framepos ) + nframes,
+							getTickSize(), m_dueNotes );
 
+	for ( Note* pNote : m_dueNotes ) {
 		float velocity_adjustment = 1.0f;
 		if ( pSong->getMode() == Song::SONG_MODE ) {
 			float fPos = m_nColumn + (pNote->get_position()%192) / 192.f;
 			velocity_adjustment = vp->get_value(fPos);
 		}
 
-		// verifico se la nota rientra in questo ciclo
-		unsigned int noteStartInFrames =
-			(int)( pNote->get_position() * getTickSize() );
-
-		// if there is a negative Humanize delay, take into account so
-		// we don't miss the time slice.  ignore positive delay, or we
-		// might end the queue processing prematurely based on NoteQueue
-		// placement.  the sampler handles positive delay.
-		if (pNote->get_humanize_delay() < 0) {
-			noteStartInFrames += pNote->get_humanize_delay();
-		}
-
-		// m_nTotalFrames <= NotePos < m_nTotalFrames + bufferSize
-		bool isNoteStart = ( ( noteStartInFrames >= framepos )
-							 && ( noteStartInFrames < ( framepos + nframes ) ) );
-		bool isOldNote = noteStartInFrames < framepos;
-
-		if ( isNoteStart || isOldNote ) {
-			// Humanize - Velocity parameter
-			pNote->set_velocity( pNote->get_velocity() * velocity_adjustment );
-
-			/* Check if the current note has probability != 1
-			 * If yes remove call random function to dequeue or not the note
-			 */
-			float fNoteProbability = pNote->get_probability();
-			if ( fNoteProbability != 1. ) {
-				if ( fNoteProbability < (float) rand() / (float) RAND_MAX ) {
-					m_songNoteQueue.pop();
-					pNote->get_instrument()->dequeue();
-					continue;
-				}
+		// Humanize - Velocity parameter
+		pNote->set_velocity( pNote->get_velocity() * velocity_adjustment );
+
+		/* Check if the current note has probability != 1
+		 * If yes remove call random function to dequeue or not the note
+		 */
+		float fNoteProbability = pNote->get_probability();
+		if ( fNoteProbability != 1. ) {
+			if ( fNoteProbability < (float) rand() / (float) RAND_MAX ) {
+				pNote->get_instrument()->dequeue();
+				m_pNotePool->release( pNote );
+				continue;
 			}
+		}
 
-			if ( pSong->getHumanizeVelocityValue() != 0 ) {
-				float random = pSong->getHumanizeVelocityValue() * getGaussian( 0.2 );
-				pNote->set_velocity(
-							pNote->get_velocity()
-							+ ( random
-								- ( pSong->getHumanizeVelocityValue() / 2.0 ) )
-							);
-				if ( pNote->get_velocity() > 1.0 ) {
-					pNote->set_velocity( 1.0 );
-				} else if ( pNote->get_velocity() < 0.0 ) {
-					pNote->set_velocity( 0.0 );
-				}
+		if ( pSong->getHumanizeVelocityValue() != 0 ) {
+			float random = pSong->getHumanizeVelocityValue() * getGaussian( 0.2 );
+			pNote->set_velocity(
+						pNote->get_velocity()
+						+ ( random
+							- ( pSong->getHumanizeVelocityValue() / 2.0 ) )
+						);
+			if ( pNote->get_velocity() > 1.0 ) {
+				pNote->set_velocity( 1.0 );
+			} else if ( pNote->get_velocity() < 0.0 ) {
+				pNote->set_velocity( 0.0 );
 			}
+		}
 
-			// Offset + Random Pitch ;)
-			float fPitch = pNote->get_pitch() + pNote->get_instrument()->get_pitch_offset();
-			/* Check if the current instrument has random picth factor != 0.
-			 * If yes add a gaussian perturbation to the pitch
-			 */
-			float fRandomPitchFactor = pNote->get_instrument()->get_random_pitch_factor();
-			if ( fRandomPitchFactor != 0. ) {
-				fPitch += getGaussian( 0.4 ) * fRandomPitchFactor;
-			}
-			pNote->set_pitch( fPitch );
-
-
-			/*
-			 * Check if the current instrument has the property "Stop-Note" set.
-			 * If yes, a NoteOff note is generated automatically after each note.
-			 */
-			auto  noteInstrument = pNote->get_instrument();
-			if ( noteInstrument->is_stop_notes() ){
-				Note *pOffNote = new Note( noteInstrument,
-										   0.0,
-										   0.0,
-										   0.0,
-										   -1,
-										   0 );
+		// Offset + Random Pitch ;)
+		float fPitch = pNote->get_pitch() + pNote->get_instrument()->get_pitch_offset();
+		/* Check if the current instrument has random picth factor != 0.
+		 * If yes add a gaussian perturbation to the pitch
+		 */
+		float fRandomPitchFactor = pNote->get_instrument()->get_random_pitch_factor();
+		if ( fRandomPitchFactor != 0. ) {
+			fPitch += getGaussian( 0.4 ) * fRandomPitchFactor;
+		}
+		pNote->set_pitch( fPitch );
+
+
+		/*
+		 * Check if the current instrument has the property "Stop-Note" set.
+		 * If yes, a NoteOff note is generated automatically after each note.
+		 */
+		auto  noteInstrument = pNote->get_instrument();
+		if ( noteInstrument->is_stop_notes() ){
+			Note *pOffNote = m_pNotePool->acquire( noteInstrument,
+												   0.0,
+												   0.0,
+												   0.0,
+												   -1,
+												   0 );
+			if ( pOffNote != nullptr ) {
 				pOffNote->set_note_off( true );
-				pHydrogen->getAudioEngine()->getSampler()->noteOn( pOffNote );
-				delete pOffNote;
-			}
-
-			m_pSampler->noteOn( pNote );
-			m_songNoteQueue.pop(); // rimuovo la nota dalla lista di note
-			pNote->get_instrument()->dequeue();
-			// raise noteOn event
-			int nInstrument = pSong->getInstrumentList()->index( pNote->get_instrument() );
-			if( pNote->get_note_off() ){
-				delete pNote;
+				m_pSampler->noteOn( pOffNote );
+				m_pNotePool->release( pOffNote );
 			}
+		}
 
-			m_pEventQueue->push_event( EVENT_NOTEON, nInstrument );
-			
-			continue;
-		} else {
-			// this note will not be played
-			break;
+		m_pSampler->noteOn( pNote );
+		pNote->get_instrument()->dequeue();
+		// raise noteOn event
+		int nInstrument = pSong->getInstrumentList()->index( pNote->get_instrument() );
+		if( pNote->get_note_off() ){
+			m_pNotePool->release( pNote );
 		}
+
+		m_pEventQueue->push_event( EVENT_NOTEON, nInstrument );
 	}
 }
 
@@ -951,10 +944,8 @@ void AudioEngine::processTransport( unsigned nFrames )
 		/* Now we're playing. Update BPM */
 	
 		if ( pSong->getBpm() != getBpm() ) {
-			___INFOLOG( QString( "Mismatch of BPM used in AudioEngine [%1] and Song [%2]. Update the second with the first one." )
-				.arg( pSong->getBpm() )
-						.arg( getBpm() )
-			);
+			___RT_INFOLOG( "Mismatch of BPM used in AudioEngine [%1] and Song [%2]. Update the second with the first one.",
+						   pSong->getBpm(), getBpm() );
 
 			pHydrogen->setBPM( getBpm() );
 		}
@@ -980,15 +971,17 @@ void AudioEngine::processTransport( unsigned nFrames )
 void AudioEngine::clearNoteQueue()
 {
 	// delete all copied notes in the song notes queue
-	while (!m_songNoteQueue.empty()) {
-		m_songNoteQueue.top()->get_instrument()->dequeue();
-		delete m_songNoteQueue.top();
-		m_songNoteQueue.pop();
+	m_dueNotes.clear();
+	m_songNoteQueue.popAll( m_dueNotes );
+	for ( auto pNote : m_dueNotes ) {
+		pNote->get_instrument()->dequeue();
+		m_pNotePool->release( pNote );
 	}
+	m_dueNotes.clear();
 
 	// delete all copied notes in the midi notes queue
 	for ( unsigned i = 0; i < m_midiNoteQueue.size(); ++i ) {
-		delete m_midiNoteQueue[i];
+		m_pNotePool->release( m_midiNoteQueue[i].pNote );
 	}
 	m_midiNoteQueue.clear();
 }
@@ -996,7 +989,8 @@ void AudioEngine::clearNoteQueue()
 int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 {
 	AudioEngine* pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
-	timeval startTimeval = currentTime2();
+	ProcessProfiler* pProfiler = pAudioEngine->getProfiler();
+	const long long nStartTime = ProcessProfiler::now();
 
 	// Resetting all audio output buffers with zeros.
 	pAudioEngine->clearAudioBuffers( nframes );
@@ -1008,6 +1002,10 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 
 	float sampleRate = static_cast<float>(pAudioEngine->m_pAudioDriver->getSampleRate());
 	pAudioEngine->m_fMaxProcessTime = 1000.0 / ( sampleRate / nframes );
+	pAudioEngine->m_nCycleStartTime.store( nStartTime, std::memory_order_relaxed );
+	pAudioEngine->m_nCycleFrames.store( nframes, std::memory_order_relaxed );
+	pAudioEngine->m_nCycleSampleRate.store( static_cast<int>( sampleRate ),
+											std::memory_order_relaxed );
 	float fSlackTime = pAudioEngine->m_fMaxProcessTime - pAudioEngine->m_fProcessTime;
 
 	// If we expect to take longer than the available time to process,
@@ -1017,6 +1015,12 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 		fSlackTime = 0.0;
 	}
 
+	pProfiler->startCycle( static_cast<long long>( pAudioEngine->m_fMaxProcessTime * 1000000.0 ) );
+	// Cycles cut short, e.g. because the lock could not be obtained,
+	// are part of the total as well.
+	ProcessProfiler::ScopedStage totalStage( pProfiler, ProcessProfiler::Total, nStartTime );
+	long long nStageTime = ProcessProfiler::now();
+
 	/*
 	 * The "try_lock" was introduced for Bug #164 (Deadlock after during
 	 * alsa driver shutdown). The try_lock *should* only fail in rare circumstances
@@ -1025,9 +1029,12 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	 * writer driver to repeat the processing of the current data.
 	 */
 				
-	if ( !pAudioEngine->tryLockFor( std::chrono::microseconds( (int)(1000.0*fSlackTime) ),
-							  RIGHT_HERE ) ) {
-		___ERRORLOG( QString( "Failed to lock audioEngine in allowed %1 ms, missed buffer" ).arg( fSlackTime ) );
+	const bool bLocked =
+		pAudioEngine->tryLockFor( std::chrono::microseconds( (int)(1000.0*fSlackTime) ),
+								  RIGHT_HERE );
+	nStageTime = pProfiler->lap( ProcessProfiler::LockWait, nStageTime );
+	if ( ! bLocked ) {
+		___RT_ERRORLOG( "Failed to lock audioEngine in allowed %1 ms, missed buffer", fSlackTime );
 
 		if ( pAudioEngine->m_pAudioDriver->class_name() == DiskWriterDriver::_class_name() ) {
 			return 2;	// inform the caller that we could not aquire the lock
@@ -1045,6 +1052,13 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	Hydrogen* pHydrogen = Hydrogen::get_instance();
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 
+	// Notes received via MIDI are queued by the driver without
+	// waiting for the lock of the audio engine. They are triggered
+	// here.
+	if ( pAudioEngine->m_pMidiDriver != nullptr ) {
+		pAudioEngine->m_pMidiDriver->processNoteCommands();
+	}
+
 	// In case of the JackAudioDriver:
 	// Query the JACK server for the current status of the
 	// transport, start or stop the audio engine depending the
@@ -1057,13 +1071,14 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 
 	// Check whether the tick size has changed.
 	pAudioEngine->processCheckBPMChanged(pSong);
+	nStageTime = pProfiler->lap( ProcessProfiler::Transport, nStageTime );
 
 	bool bSendPatternChange = false;
 	// always update note queue.. could come from pattern or realtime input
 	// (midi, keyboard)
 	int nResNoteQueue = pAudioEngine->updateNoteQueue( nframes );
 	if ( nResNoteQueue == -1 ) {	// end of song
-		___INFOLOG( "End of song received, calling engine_stop()" );
+		___RT_INFOLOG( "End of song received, calling engine_stop()" );
 		pAudioEngine->unlock();
 		pAudioEngine->stop();
 		pAudioEngine->locate( 0 ); // locate 0, reposition from start of the song
@@ -1071,7 +1086,7 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 		if ( (pAudioEngine->m_pAudioDriver->class_name() == DiskWriterDriver::_class_name() )
 			 || ( pAudioEngine->m_pAudioDriver->class_name() == FakeDriver::_class_name() )
 			 ) {
-			___INFOLOG( "End of song." );
+			___RT_INFOLOG( "End of song." );
 			
 			return 1;	// kill the audio AudioDriver thread
 		}
@@ -1083,6 +1098,7 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 
 	// play all notes
 	pAudioEngine->processPlayNotes( nframes );
+	nStageTime = pProfiler->lap( ProcessProfiler::NoteQueue, nStageTime );
 
 	float *pBuffer_L = pAudioEngine->m_pAudioDriver->getOut_L(),
 		*pBuffer_R = pAudioEngine->m_pAudioDriver->getOut_R();
@@ -1090,24 +1106,15 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 
 	// SAMPLER
 	pAudioEngine->getSampler()->process( nframes, pSong );
-	float* out_L = pAudioEngine->getSampler()->m_pMainOut_L;
-	float* out_R = pAudioEngine->getSampler()->m_pMainOut_R;
-	for ( unsigned i = 0; i < nframes; ++i ) {
-		pBuffer_L[ i ] += out_L[ i ];
-		pBuffer_R[ i ] += out_R[ i ];
-	}
+	BlockKernels::mix( pAudioEngine->getSampler()->m_pMainOut_L, 1.0, pBuffer_L, nframes );
+	BlockKernels::mix( pAudioEngine->getSampler()->m_pMainOut_R, 1.0, pBuffer_R, nframes );
+	nStageTime = pProfiler->lap( ProcessProfiler::Sampler, nStageTime );
 
 	// SYNTH
 	pAudioEngine->getSynth()->process( nframes );
-	out_L = pAudioEngine->getSynth()->m_pOut_L;
-	out_R = pAudioEngine->getSynth()->m_pOut_R;
-	for ( unsigned i = 0; i < nframes; ++i ) {
-		pBuffer_L[ i ] += out_L[ i ];
-		pBuffer_R[ i ] += out_R[ i ];
-	}
-
-	timeval renderTime_end = currentTime2();
-	timeval ladspaTime_start = renderTime_end;
+	BlockKernels::mix( pAudioEngine->getSynth()->m_pOut_L, 1.0, pBuffer_L, nframes );
+	BlockKernels::mix( pAudioEngine->getSynth()->m_pOut_R, 1.0, pBuffer_R, nframes );
+	nStageTime = pProfiler->lap( ProcessProfiler::Synth, nStageTime );
 
 #ifdef H2CORE_HAVE_LADSPA
 	// Process LADSPA FX
@@ -1125,73 +1132,46 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 				buf_R = buf_L;
 			}
 
-			for ( unsigned i = 0; i < nframes; ++i ) {
-				pBuffer_L[ i ] += buf_L[ i ];
-				pBuffer_R[ i ] += buf_R[ i ];
-				if ( buf_L[ i ] > pAudioEngine->m_fFXPeak_L[nFX] ) {
-					pAudioEngine->m_fFXPeak_L[nFX] = buf_L[ i ];
-				}
-
-				if ( buf_R[ i ] > pAudioEngine->m_fFXPeak_R[nFX] ) {
-					pAudioEngine->m_fFXPeak_R[nFX] = buf_R[ i ];
-				}
-			}
+			BlockKernels::mix( buf_L, 1.0, pBuffer_L, nframes );
+			BlockKernels::mix( buf_R, 1.0, pBuffer_R, nframes );
+			pAudioEngine->m_fFXPeak_L[nFX] =
+				BlockKernels::peak( buf_L, nframes, pAudioEngine->m_fFXPeak_L[nFX] );
+			pAudioEngine->m_fFXPeak_R[nFX] =
+				BlockKernels::peak( buf_R, nframes, pAudioEngine->m_fFXPeak_R[nFX] );
+			nStageTime = pProfiler->lap( ProcessProfiler::Ladspa + nFX, nStageTime );
 		}
 	}
 #endif
-	timeval ladspaTime_end = currentTime2();
-
-
-	// update master peaks
-	float val_L, val_R;
-	for ( unsigned i = 0; i < nframes; ++i ) {
-		val_L = pBuffer_L[i];
-		val_R = pBuffer_R[i];
-
-		if ( val_L > pAudioEngine->m_fMasterPeak_L ) {
-			pAudioEngine->m_fMasterPeak_L = val_L;
-		}
 
-		if ( val_R > pAudioEngine->m_fMasterPeak_R ) {
-			pAudioEngine->m_fMasterPeak_R = val_R;
-		}
-
-		for (std::vector<DrumkitComponent*>::iterator it = pSong->getComponents()->begin() ; it != pSong->getComponents()->end(); ++it) {
-			DrumkitComponent* drumkit_component = *it;
 
-			float compo_val_L = drumkit_component->get_out_L(i);
-			float compo_val_R = drumkit_component->get_out_R(i);
-
-			if( compo_val_L > drumkit_component->get_peak_l() ) {
-				drumkit_component->set_peak_l( compo_val_L );
-			}
-			if( compo_val_R > drumkit_component->get_peak_r() ) {
-				drumkit_component->set_peak_r( compo_val_R );
-			}
+	// update master and component meters
+	pAudioEngine->m_masterMeter.startCycle( nframes );
+	pAudioEngine->m_masterMeter.process( pBuffer_L, pBuffer_R, nframes );
+	for ( auto& pComponent : *pSong->getComponents() ) {
+		if ( pComponent->get_outs_L() == nullptr ) {
+			continue;
 		}
+		Meter* pMeter = pComponent->getMeter();
+		pMeter->startCycle( nframes );
+		pMeter->process( pComponent->get_outs_L(), pComponent->get_outs_R(), nframes );
 	}
 
+	nStageTime = pProfiler->lap( ProcessProfiler::Metering, nStageTime );
+
 	// update total frames number
 	if ( pAudioEngine->getState() == AudioEngine::State::Playing ) {
 		pAudioEngine->setFrames( pAudioEngine->getFrames() + nframes );
 		pAudioEngine->updateElapsedTime( nframes, pAudioEngine->m_pAudioDriver->getSampleRate() );
 	}
 
-	timeval finishTimeval = currentTime2();
-	pAudioEngine->m_fProcessTime =
-			( finishTimeval.tv_sec - startTimeval.tv_sec ) * 1000.0
-			+ ( finishTimeval.tv_usec - startTimeval.tv_usec ) / 1000.0;
+	const long long nProcessTime = ProcessProfiler::now() - nStartTime;
+	pAudioEngine->m_fProcessTime = nProcessTime / 1000000.0;
 
 #ifdef CONFIG_DEBUG
-	if ( pAudioEngine->m_fProcessTime > m_fMaxProcessTime ) {
-		___WARNINGLOG( "" );
-		___WARNINGLOG( "----XRUN----" );
-		___WARNINGLOG( QString( "XRUN of %1 msec (%2 > %3)" )
-					   .arg( ( m_fProcessTime - pAudioEngine->m_fMaxProcessTime ) )
-					   .arg( m_fProcessTime ).arg( pAudioEngine->m_fMaxProcessTime ) );
-		___WARNINGLOG( QString( "Ladspa process time = %1" ).arg( fLadspaTime ) );
-		___WARNINGLOG( "------------" );
-		___WARNINGLOG( "" );
+	if ( pAudioEngine->m_fProcessTime > pAudioEngine->m_fMaxProcessTime ) {
+		___RT_WARNINGLOG( "----XRUN---- of %1 msec (%2 > %3)",
+						  pAudioEngine->m_fProcessTime - pAudioEngine->m_fMaxProcessTime,
+						  pAudioEngine->m_fProcessTime, pAudioEngine->m_fMaxProcessTime );
 		// raise xRun event
 		EventQueue::get_instance()->push_event( EVENT_XRUN, -1 );
 	}
@@ -1317,33 +1297,47 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 	// Get initial timestamp for first tick
 	gettimeofday( &m_currentTickTime, nullptr );
 
+	// Notes triggered in realtime are due right away. Without
+	// handling them here they would have to wait for the next cycle
+	// containing a tick.
+	queueMidiNotes( tickNumber_start, framepos, fTickSize, nFrames );
+
 	// A tick is the most fine-grained time scale within Hydrogen.
-	for ( int tick = tickNumber_start; tick < tickNumber_end; tick++ ) {
+	// Instead of visiting each of them only those ticks holding an
+	// event - a note, a metronome beat, or a pattern boundary - are
+	// processed. See findNextEventTick().
+	int nNextTick;
+	int nLastPlayedTick = -1;
+	for ( int tick = tickNumber_start; tick < tickNumber_end; tick = nNextTick ) {
+
+		// Number of ticks till the end of the current pattern
+		// (column). The state of transport does only change at these
+		// boundaries.
+		int nTicksToBoundary = 1;
 		
 		// MIDI events now get put into the `m_songNoteQueue` as well,
 		// based on their timestamp (which is given in terms of its
 		// transport position and not in terms of the date-time as
 		// above).
-		while ( m_midiNoteQueue.size() > 0 ) {
-			Note *pNote = m_midiNoteQueue[0];
-			if ( pNote->get_position() > tick ) break;
-
-			m_midiNoteQueue.pop_front();
-			pNote->get_instrument()->enqueue();
-			m_songNoteQueue.push( pNote );
-		}
+		queueMidiNotes( tick, framepos, fTickSize, nFrames );
 
 		if (  getState() != State::Playing ) {
 			// only keep going if we're playing
+			nNextTick = tickNumber_end;
+			if ( m_midiNoteQueue.size() > 0 ) {
+				nNextTick = std::min( nNextTick,
+									  std::max( tick + 1, m_midiNoteQueue[0].pNote->get_position() ) );
+			}
 			continue;
 		}
+		nLastPlayedTick = tick;
 		
 		//////////////////////////////////////////////////////////////
 		// SONG MODE
 		if ( pSong->getMode() == Song::SONG_MODE ) {
 			if ( pSong->getPatternGroupVector()->size() == 0 ) {
 				// there's no song!!
-				___ERRORLOG( "no patterns in song." );
+				___RT_ERRORLOG( "no patterns in song." );
 				stop();
 				return -1;
 			}
@@ -1374,7 +1368,7 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 			// function returns indicating that the end of the song is
 			// reached.
 			if ( m_nColumn == -1 ) {
-				___INFOLOG( "song pos = -1" );
+				___RT_INFOLOG( "song pos = -1" );
 				if ( pSong->getIsLoopEnabled() == true ) {
 					// TODO: This function call should be redundant
 					// since `getColumnForTick()` is deterministic
@@ -1383,7 +1377,7 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 					m_nColumn = getColumnForTick( 0, true, &m_nPatternStartTick );
 				} else {
 
-					___INFOLOG( "End of Song" );
+					___RT_INFOLOG( "End of Song" );
 
 					if( pHydrogen->getMidiOutput() != nullptr ){
 						pHydrogen->getMidiOutput()->handleQueueAllNoteOff();
@@ -1405,6 +1399,12 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 				m_pPlayingPatterns->add( pPattern );
 				pPattern->extand_with_flattened_virtual_patterns( m_pPlayingPatterns );
 			}
+
+			if ( pPatternList->size() != 0 ) {
+				nTicksToBoundary = pPatternList->longest_pattern_length() - m_nPatternTickPosition;
+			} else {
+				nTicksToBoundary = MAX_NOTES - m_nPatternTickPosition;
+			}
 		}
 		
 		//////////////////////////////////////////////////////////////
@@ -1430,7 +1430,7 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 			}
 
 			if ( nPatternSize == 0 ) {
-				___ERRORLOG( "nPatternSize == 0" );
+				___RT_ERRORLOG( "nPatternSize == 0" );
 			}
 
 			// If either the beginning of the current pattern was not
@@ -1470,6 +1470,8 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 			if ( m_nPatternTickPosition > nPatternSize && nPatternSize > 0 ) {
 				m_nPatternTickPosition = tick % nPatternSize;
 			}
+
+			nTicksToBoundary = nPatternSize - m_nPatternTickPosition;
 		}
 
 		//////////////////////////////////////////////////////////////
@@ -1498,15 +1500,20 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 				m_pMetronomeInstrument->set_volume(
 							Preferences::get_instance()->m_fMetronomeVolume
 							);
-				Note *pMetronomeNote = new Note( m_pMetronomeInstrument,
-												 tick,
-												 fVelocity,
-												 0.f, // pan
-												 -1,
-												 fPitch
-												 );
-				m_pMetronomeInstrument->enqueue();
-				m_songNoteQueue.push( pMetronomeNote );
+				Note *pMetronomeNote = m_pNotePool->acquire( m_pMetronomeInstrument,
+															 tick,
+															 fVelocity,
+															 0.f, // pan
+															 -1,
+															 fPitch
+															 );
+				if ( pMetronomeNote != nullptr ) {
+					if ( m_songNoteQueue.push( pMetronomeNote ) ) {
+						m_pMetronomeInstrument->enqueue();
+					} else {
+						m_pNotePool->release( pMetronomeNote );
+					}
+				}
 			}
 		}
 
@@ -1583,15 +1590,32 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 						// back.
 						// Why a copy? because it has the new offset (including swing and random timing) in its
 						// humanized delay, and tick position is expressed referring to start time (and not pattern).
-						Note *pCopiedNote = new Note( pNote );
+						// The copy is taken from the preallocated pool
+						// and dropped in case it is exhausted.
+						Note *pCopiedNote = m_pNotePool->acquire( pNote );
+						if ( pCopiedNote == nullptr ) {
+							continue;
+						}
 						pCopiedNote->set_position( tick );
 						pCopiedNote->set_humanize_delay( nOffset );
-						pNote->get_instrument()->enqueue();
-						m_songNoteQueue.push( pCopiedNote );
+						if ( m_songNoteQueue.push( pCopiedNote ) ) {
+							pNote->get_instrument()->enqueue();
+						} else {
+							m_pNotePool->release( pCopiedNote );
+						}
 					}
 				}
 			}
 		}
+
+		nNextTick = findNextEventTick( tick, tickNumber_end, nTicksToBoundary );
+	}
+
+	// Nothing happened in the ticks skipped at the end of the
+	// cycle. But the pattern tick position is also used for e.g.
+	// recording and has to be as if they were processed.
+	if ( nLastPlayedTick != -1 && getState() == State::Playing ) {
+		m_nPatternTickPosition += tickNumber_end - 1 - nLastPlayedTick;
 	}
 
 	// audioEngine_process() must send the pattern change event after
@@ -1602,67 +1626,71 @@ int AudioEngine::updateNoteQueue( unsigned nFrames )
 	return 0;
 }
 
-int AudioEngine::getColumnForTick( int nTick, bool bLoopMode, int* pPatternStartTick ) const
+int AudioEngine::findNextEventTick( int nTick, int nTickEnd, int nTicksToBoundary ) const
 {
-	Hydrogen* pHydrogen = Hydrogen::get_instance();
-	std::shared_ptr<Song> pSong = pHydrogen->getSong();
-	assert( pSong );
-
-	int nTotalTick = 0;
-
-	std::vector<PatternList*> *pPatternColumns = pSong->getPatternGroupVector();
-	int nColumns = pPatternColumns->size();
-
-	// Sum the lengths of all pattern columns and use the macro
-	// MAX_NOTES in case some of them are of size zero. If the
-	// supplied value nTick is bigger than this and doesn't belong to
-	// the next pattern column, we just found the pattern list we were
-	// searching for.
-	int nPatternSize;
-	for ( int i = 0; i < nColumns; ++i ) {
-		PatternList *pColumn = ( *pPatternColumns )[ i ];
-		if ( pColumn->size() != 0 ) {
-			nPatternSize = pColumn->longest_pattern_length();
-		} else {
-			nPatternSize = MAX_NOTES;
+	// The transport position does not change in between pattern
+	// boundaries. Thus, the pattern tick position increases by one
+	// each tick till the next boundary is reached.
+	int nNextTick = std::min( nTickEnd, nTick + std::max( nTicksToBoundary, 1 ) );
+
+	// Metronome beat
+	nNextTick = std::min( nNextTick, nTick + 48 - m_nPatternTickPosition % 48 );
+
+	// MIDI notes
+	if ( m_midiNoteQueue.size() > 0 ) {
+		nNextTick = std::min( nNextTick,
+							  std::max( nTick + 1, m_midiNoteQueue[0].pNote->get_position() ) );
+	}
+
+	// The notes of each pattern are stored in a map sorted by their
+	// position. The next event is thus just a lookup away.
+	for ( unsigned nPat = 0; nPat < m_pPlayingPatterns->size(); ++nPat ) {
+		const Pattern::notes_t* notes = m_pPlayingPatterns->get( nPat )->get_notes();
+		auto it = notes->upper_bound( m_nPatternTickPosition );
+		if ( it != notes->end() ) {
+			nNextTick = std::min( nNextTick, nTick + it->first - m_nPatternTickPosition );
 		}
+	}
+
+	return std::max( nNextTick, nTick + 1 );
+}
 
-		if ( ( nTick >= nTotalTick ) && ( nTick < nTotalTick + nPatternSize ) ) {
-			( *pPatternStartTick ) = nTotalTick;
-			return i;
+void AudioEngine::queueMidiNotes( int nTick, long long nFramepos, float fTickSize, unsigned nFrames )
+{
+	int nQueued = 0;
+	for ( const auto& realtimeNote : m_midiNoteQueue ) {
+		Note* pNote = realtimeNote.pNote;
+		const int nFrameOffset = realtimeNote.nFrameOffset;
+		if ( pNote->get_position() > nTick ) {
+			break;
 		}
-		nTotalTick += nPatternSize;
-	}
-
-	// If the song is played in loop mode, the tick numbers of the
-	// second turn are added on top of maximum tick number of the
-	// song. Therefore, we will introduced periodic boundary
-	// conditions and start the search again.
-	if ( bLoopMode ) {
-		int nLoopTick = 0;
-		// nTotalTicks is now the same as m_nSongSizeInTicks
-		if ( nTotalTick != 0 ) {
-			nLoopTick = nTick % nTotalTick;
+		++nQueued;
+
+		if ( nFrameOffset >= 0 && nFrames > 0 ) {
+			const long long nStart = nFramepos +
+				std::min( static_cast<long long>( nFrameOffset ),
+						  static_cast<long long>( nFrames ) - 1 );
+			pNote->set_humanize_delay(
+				static_cast<int>( nStart - static_cast<long long>( pNote->get_position() * fTickSize ) ) );
 		}
-		nTotalTick = 0;
-		for ( int i = 0; i < nColumns; ++i ) {
-			PatternList *pColumn = ( *pPatternColumns )[ i ];
-			if ( pColumn->size() != 0 ) {
-				nPatternSize = pColumn->longest_pattern_length();
-			} else {
-				nPatternSize = MAX_NOTES;
-			}
 
-			if ( ( nLoopTick >= nTotalTick )
-				 && ( nLoopTick < nTotalTick + nPatternSize ) ) {
-				( *pPatternStartTick ) = nTotalTick;
-				return i;
-			}
-			nTotalTick += nPatternSize;
+		if ( m_songNoteQueue.push( pNote ) ) {
+			pNote->get_instrument()->enqueue();
+		} else {
+			m_pNotePool->release( pNote );
 		}
 	}
 
-	return -1;
+	m_midiNoteQueue.erase( m_midiNoteQueue.begin(), m_midiNoteQueue.begin() + nQueued );
+}
+
+int AudioEngine::getColumnForTick( int nTick, bool bLoopMode, int* pPatternStartTick ) const
+{
+	Hydrogen* pHydrogen = Hydrogen::get_instance();
+	std::shared_ptr<Song> pSong = pHydrogen->getSong();
+	assert( pSong );
+
+	return pSong->getColumnForTick( nTick, bLoopMode, pPatternStartTick );
 }
 
 long AudioEngine::getTickForColumn( int nColumn ) const
@@ -1689,47 +1717,58 @@ long AudioEngine::getTickForColumn( int nColumn ) const
 		}
 	}
 
-	std::vector<PatternList*> *pColumns = pSong->getPatternGroupVector();
-	long totalTick = 0;
-	int nPatternSize;
-	Pattern *pPattern = nullptr;
-	
-	for ( int i = 0; i < nColumn; ++i ) {
-		PatternList *pColumn = ( *pColumns )[ i ];
-		
-		if( pColumn->size() > 0)
-		{
-			nPatternSize = pColumn->longest_pattern_length();
-		} else {
-			nPatternSize = MAX_NOTES;
-		}
-		totalTick += nPatternSize;
-	}
-	
-	return totalTick;
+	return pSong->getTickForColumn( std::max( nColumn, 0 ) );
 }
 
-void AudioEngine::noteOn( Note *note )
+void AudioEngine::noteOn( Note *note, int nFrameOffset )
 {
 	// check current state
 	if ( ( getState() != State::Playing ) && ( getState() != State::Ready ) ) {
 		___ERRORLOG( QString( "Error the audio engine is not in State::Ready or State::Playing but [%1]" )
 					 .arg( static_cast<int>( getState() ) ) );
-		delete note;
+		m_pNotePool->release( note );
 		return;
 	}
 
-	m_midiNoteQueue.push_back( note );
+	// Replace the note by a pooled copy. This spares the Sampler from
+	// freeing the original. Notes already taken from the pool - like
+	// the ones created by MidiInput::processNoteCommands() within
+	// the audio thread - are queued right away.
+	if ( ! m_pNotePool->contains( note ) ) {
+		Note* pPooledNote = m_pNotePool->acquire( note );
+		if ( pPooledNote != nullptr ) {
+			delete note;
+			note = pPooledNote;
+		}
+	}
+
+	// The queue was reserved in the constructor and must not grow
+	// within the audio thread.
+	if ( m_midiNoteQueue.size() == m_midiNoteQueue.capacity() ) {
+		m_pNotePool->release( note );
+		return;
+	}
+	m_midiNoteQueue.push_back( { note, nFrameOffset } );
 }
 
-bool AudioEngine::compare_pNotes::operator()(Note* pNote1, Note* pNote2)
+int AudioEngine::computeFrameOffset( long long nTime ) const
 {
-	return (pNote1->get_humanize_delay() +
-			pNote1->get_position() *
-			Hydrogen::get_instance()->getAudioEngine()->getTickSize()) >
-		   (pNote2->get_humanize_delay() +
-			pNote2->get_position() *
-			Hydrogen::get_instance()->getAudioEngine()->getTickSize());
+	return computeFrameOffset( nTime,
+							   m_nCycleStartTime.load( std::memory_order_relaxed ),
+							   m_nCycleFrames.load( std::memory_order_relaxed ),
+							   m_nCycleSampleRate.load( std::memory_order_relaxed ) );
+}
+
+int AudioEngine::computeFrameOffset( long long nTime, long long nCycleStart,
+									 int nFrames, int nSampleRate )
+{
+	if ( nFrames <= 0 || nSampleRate <= 0 ) {
+		return -1;
+	}
+
+	const long long nOffset = ( nTime - nCycleStart ) * nSampleRate / 1000000000LL;
+	return static_cast<int>( std::clamp( nOffset, 0LL,
+										 static_cast<long long>( nFrames ) - 1 ) );
 }
 
 void AudioEngine::play() {
@@ -1808,11 +1847,9 @@ long AudioEngine::getPatternLength( int nPattern ) const
 		return -1;
 	}
 
-	std::vector< PatternList* > *pColumns = pSong->getPatternGroupVector();
-
-	int nPatternGroups = pColumns->size();
+	int nPatternGroups = pSong->getPatternGroupVector()->size();
 	if ( nPattern >= nPatternGroups ) {
-		if ( pSong->getIsLoopEnabled() ) {
+		if ( pSong->getIsLoopEnabled() && nPatternGroups > 0 ) {
 			nPattern = nPattern % nPatternGroups;
 		} else {
 			return MAX_NOTES;
@@ -1823,12 +1860,7 @@ long AudioEngine::getPatternLength( int nPattern ) const
 		return MAX_NOTES;
 	}
 
-	PatternList* pPatternList = pColumns->at( nPattern - 1 );
-	if ( pPatternList->size() > 0 ) {
-		return pPatternList->longest_pattern_length();
-	} else {
-		return MAX_NOTES;
-	}
+	return pSong->getColumnLength( nPattern - 1 );
 }
 
 int AudioEngine::calculateLeadLagFactor( float fTickSize ) const {
@@ -30,6 +30,10 @@
 #include <core/Synth/Synth.h>
 #include <core/Basics/Note.h>
 #include <core/AudioEngine/TransportInfo.h>
+#include <core/AudioEngine/NotePool.h>
+#include <core/AudioEngine/NoteQueue.h>
+#include <core/AudioEngine/Meter.h>
+#include <core/AudioEngine/ProcessProfiler.h>
 #include <core/CoreActionController.h>
 
 #include <core/IO/AudioOutput.h>
@@ -37,6 +41,7 @@
 #include <core/IO/DiskWriterDriver.h>
 #include <core/IO/FakeDriver.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <cassert>
@@ -44,7 +49,6 @@
 #include <thread>
 #include <chrono>
 #include <deque>
-#include <queue>
 
 /** \def RIGHT_HERE
  * Macro intended to be used for the logging of the locking of the
@@ -213,7 +217,23 @@ public:
 	 * AudioEngine lock.
 	 */
 	void			assertLocked( );
-	void			noteOn( Note *note );
+	/** \return Whether the calling thread is the current holder of
+	 * the AudioEngine lock.*/
+	bool			isLockedByCurrentThread() const;
+	/**
+	 * Queues a note triggered in realtime, e.g. via MIDI.
+	 *
+	 * Notes taken from the NotePool are queued without allocating or
+	 * freeing memory and might be passed from within the audio
+	 * thread.
+	 *
+	 * \param note Note to play. Unless it was taken from the
+	 *   NotePool, it is replaced by a pooled copy.
+	 * \param nFrameOffset Frame within the next processing cycle at
+	 *   which the note will be started. If -1, it is started at the
+	 *   beginning of the cycle.
+	 */
+	void			noteOn( Note *note, int nFrameOffset = -1 );
 	
 	/**
 	 * Main audio processing function called by the audio drivers whenever
@@ -280,8 +300,44 @@ public:
 
 	/** \return #m_pSampler */
 	Sampler*		getSampler() const;
+	/** \return #m_pNotePool */
+	NotePool*		getNotePool() const;
 	/** \return #m_pSynth */
 	Synth*			getSynth() const;
+	/** \return #m_profiler */
+	ProcessProfiler*	getProfiler();
+	/**
+	 * Maps the time an event was received at to a frame within the
+	 * processing cycle.
+	 *
+	 * Drivers not providing timing information of their own - ALSA
+	 * and PortMidi - pass the time a MIDI message arrived at. It is
+	 * placed at the same distance from the beginning of the next
+	 * cycle as it had from the beginning of the current one. This
+	 * results in a constant latency of one buffer instead of a
+	 * jitter of up to one buffer.
+	 *
+	 * Can be called from any thread.
+	 *
+	 * \param nTime Time in nanoseconds as returned by
+	 *   ProcessProfiler::now().
+	 *
+	 * \return Frame in [0, buffer size) or -1 if the audio engine did
+	 * not process any cycle yet.
+	 */
+	int				computeFrameOffset( long long nTime ) const;
+	/**
+	 * \param nTime Time in nanoseconds.
+	 * \param nCycleStart Time in nanoseconds the processing cycle
+	 *   started at.
+	 * \param nFrames Size of the cycle.
+	 * \param nSampleRate Sample rate of the audio driver.
+	 *
+	 * \return Frame in [0, @a nFrames) corresponding to @a nTime or
+	 * -1 if @a nFrames or @a nSampleRate are not positive.
+	 */
+	static int		computeFrameOffset( long long nTime, long long nCycleStart,
+										int nFrames, int nSampleRate );
 
 	/** \return #m_fElapsedTime */
 	float			getElapsedTime() const;	
@@ -344,11 +400,8 @@ public:
 	
 	State 			getState() const;
 
-	void 			setMasterPeak_L( float value );
-	float 			getMasterPeak_L() const;
-
-	void	 		setMasterPeak_R( float value );
-	float 			getMasterPeak_R() const;
+	/** \return #m_masterMeter */
+	Meter*			getMasterMeter();
 
 	float			getProcessTime() const;
 	float			getMaxProcessTime() const;
@@ -500,12 +553,45 @@ private:
 	 * starting at the current position + the lookahead (or at 0 when at
 	 * the beginning of the Song).
 	 *
+	 * Within this range only ticks holding an event are visited. They
+	 * are determined using findNextEventTick().
+	 *
 	 * \return
 	 * - -1 if in Song::SONG_MODE and no patterns left.
 	 * - 2 if the current pattern changed with respect to the last
 	 * cycle.
 	 */
 	int				updateNoteQueue( unsigned nFrames );
+	/**
+	 * Finds the next tick after @a nTick at which updateNoteQueue()
+	 * has to do something.
+	 *
+	 * These are the positions of the next note in any of the
+	 * #m_pPlayingPatterns, of the next metronome beat, and of the next
+	 * MIDI note in #m_midiNoteQueue. Since the transport state is only
+	 * updated at the beginning of a pattern (or column in
+	 * Song::SONG_MODE), the tick @a nTicksToBoundary ticks ahead is
+	 * an event too.
+	 *
+	 * \param nTick Tick just processed. #m_nPatternTickPosition must
+	 * correspond to it.
+	 * \param nTickEnd First tick not to be processed in this cycle.
+	 * \param nTicksToBoundary Number of ticks till the end of the
+	 * current pattern.
+	 *
+	 * \return Tick in [@a nTick + 1, @a nTickEnd].
+	 */
+	int				findNextEventTick( int nTick, int nTickEnd, int nTicksToBoundary ) const;
+	/**
+	 * Moves all notes in #m_midiNoteQueue with a position not larger
+	 * than @a nTick into #m_songNoteQueue.
+	 *
+	 * Notes carrying a frame offset get their humanize delay set so
+	 * the Sampler starts them at exactly this frame of the current
+	 * cycle starting at @a nFramepos.
+	 */
+	void			queueMidiNotes( int nTick, long long nFramepos,
+									float fTickSize, unsigned nFrames );
 	
 	/** Increments #m_fElapsedTime at the end of a process cycle.
 	 *
@@ -576,6 +662,13 @@ private:
 	void			locate( unsigned long nFrame );
 	/** Local instance of the Sampler. */
 	Sampler* 			m_pSampler;
+	/**
+	 * Preallocated notes used for all notes created during
+	 * playback. It holds four times Preferences::m_nMaxNotes notes
+	 * to cover both the ones rendered by the Sampler and the ones
+	 * waiting in #m_songNoteQueue.
+	 */
+	NotePool*			m_pNotePool;
 	/** Local instance of the Synth. */
 	Synth* 				m_pSynth;
 
@@ -601,11 +694,8 @@ private:
 	float				m_fFXPeak_R[MAX_FX];
 	#endif
 
-	//Master peak (left channel)
-	float				m_fMasterPeak_L;
-
-	//Master peak (right channel)
-	float				m_fMasterPeak_R;
+	/** Level of the master output including true peaks.*/
+	Meter				m_masterMeter;
 
 	/**
 	 * Mutex for synchronizing the access to the Song object and
@@ -630,8 +720,11 @@ private:
 
 	/**
 	 * Thread ID of the current holder of the AudioEngine lock.
+	 *
+	 * It is compared against by threads not holding the lock in
+	 * isLockedByCurrentThread().
 	 */
-	std::thread::id 	m_LockingThread;
+	std::atomic<std::thread::id> 	m_LockingThread;
 
 	/**
 	 * This struct is most probably intended to be used for
@@ -678,6 +771,18 @@ private:
 	// max ms usable in process with no xrun
 	float				m_fMaxProcessTime;
 
+	/** Time spent in the individual stages of
+		audioEngine_process().*/
+	ProcessProfiler		m_profiler;
+
+	/** Start time of the most recent processing cycle in
+		nanoseconds. Used by computeFrameOffset().*/
+	std::atomic<long long>	m_nCycleStartTime;
+	/** Number of frames of the most recent processing cycle.*/
+	std::atomic<int>	m_nCycleFrames;
+	/** Sample rate used in the most recent processing cycle.*/
+	std::atomic<int>	m_nCycleSampleRate;
+
 	// updated in audioEngine_updateNoteQueue()
 	struct timeval		m_currentTickTime;
 
@@ -738,13 +843,20 @@ private:
 	audioProcessCallback m_AudioProcessCallback;
 	
 	/// Song Note FIFO
-	// overload the > operator of Note objects for priority_queue
-	struct compare_pNotes {
-		bool operator() (Note* pNote1, Note* pNote2);
+	NoteQueue			m_songNoteQueue;
+	/** Notes due within the current buffer. Filled by
+	 * processPlayNotes() from #m_songNoteQueue. Reserved in the
+	 * constructor to not allocate memory in the audio thread.*/
+	std::vector<Note*>	m_dueNotes;
+	/** Note passed to noteOn() along with the frame within the next
+		cycle it is started at.*/
+	struct RealtimeNote {
+		Note*	pNote;
+		int		nFrameOffset;
 	};
-
-	std::priority_queue<Note*, std::deque<Note*>, compare_pNotes > m_songNoteQueue;
-	std::deque<Note*>	m_midiNoteQueue;	///< Midi Note FIFO
+	/** Midi Note FIFO. Reserved in the constructor since it is
+	 * filled from within the audio thread too.*/
+	std::vector<RealtimeNote>	m_midiNoteQueue;
 	
 	/**
 	 * Pointer to the metronome.
@@ -810,24 +922,16 @@ inline float AudioEngine::getElapsedTime() const {
 
 inline void AudioEngine::assertLocked( ) {
 #ifndef NDEBUG
-	assert( m_LockingThread == std::this_thread::get_id() );
+	assert( isLockedByCurrentThread() );
 #endif
 }
 
-inline void	AudioEngine::setMasterPeak_L( float value ) {
-	m_fMasterPeak_L = value;
-}
-
-inline float AudioEngine::getMasterPeak_L() const {
-	return m_fMasterPeak_L;
+inline bool AudioEngine::isLockedByCurrentThread() const {
+	return m_LockingThread.load() == std::this_thread::get_id();
 }
 
-inline void	AudioEngine::setMasterPeak_R( float value ) {
-	m_fMasterPeak_R = value;
-}
-
-inline float AudioEngine::getMasterPeak_R() const {
-	return m_fMasterPeak_R;
+inline Meter* AudioEngine::getMasterMeter() {
+	return &m_masterMeter;
 }
 
 inline float AudioEngine::getProcessTime() const {
@@ -838,6 +942,10 @@ inline float AudioEngine::getMaxProcessTime() const {
 	return m_fMaxProcessTime;
 }
 
+inline ProcessProfiler* AudioEngine::getProfiler() {
+	return &m_profiler;
+}
+
 inline const struct timeval& AudioEngine::getCurrentTickTime() const {
 	return m_currentTickTime;
 }
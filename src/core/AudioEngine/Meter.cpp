@@ -0,0 +1,109 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/Meter.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace H2Core {
+
+Meter::Meter( bool bTruePeak )
+	: m_bTruePeak( bTruePeak )
+	, m_bResetRequested( false )
+{
+	clear();
+	std::fill( m_history_L, m_history_L + BlockKernels::TRUE_PEAK_TAPS - 1, 0.0f );
+	std::fill( m_history_R, m_history_R + BlockKernels::TRUE_PEAK_TAPS - 1, 0.0f );
+}
+
+void Meter::startCycle( int nFrames )
+{
+	if ( m_bResetRequested.exchange( false, std::memory_order_acquire ) ) {
+		clear();
+	}
+	m_nFrames.store( m_nFrames.load( std::memory_order_relaxed ) + nFrames,
+					 std::memory_order_relaxed );
+}
+
+void Meter::process( const float* pBuffer_L, const float* pBuffer_R, int nFrames )
+{
+	if ( nFrames <= 0 ) {
+		return;
+	}
+
+	raise( m_fPeak_L, BlockKernels::absPeak( pBuffer_L, nFrames, 0 ) );
+	raise( m_fPeak_R, BlockKernels::absPeak( pBuffer_R, nFrames, 0 ) );
+	add( m_fEnergy_L, BlockKernels::energy( pBuffer_L, nFrames ) );
+	add( m_fEnergy_R, BlockKernels::energy( pBuffer_R, nFrames ) );
+
+	if ( m_bTruePeak ) {
+		raise( m_fTruePeak_L,
+			   BlockKernels::truePeak( pBuffer_L, nFrames, m_history_L, 0 ) );
+		raise( m_fTruePeak_R,
+			   BlockKernels::truePeak( pBuffer_R, nFrames, m_history_R, 0 ) );
+	}
+}
+
+void Meter::reset()
+{
+	m_bResetRequested.store( true, std::memory_order_release );
+}
+
+void Meter::clear()
+{
+	m_fPeak_L.store( 0, std::memory_order_relaxed );
+	m_fPeak_R.store( 0, std::memory_order_relaxed );
+	m_fTruePeak_L.store( 0, std::memory_order_relaxed );
+	m_fTruePeak_R.store( 0, std::memory_order_relaxed );
+	m_fEnergy_L.store( 0, std::memory_order_relaxed );
+	m_fEnergy_R.store( 0, std::memory_order_relaxed );
+	m_nFrames.store( 0, std::memory_order_relaxed );
+}
+
+Meter::Snapshot Meter::getSnapshot() const
+{
+	Snapshot snapshot;
+	snapshot.fPeak_L = m_fPeak_L.load( std::memory_order_relaxed );
+	snapshot.fPeak_R = m_fPeak_R.load( std::memory_order_relaxed );
+	snapshot.fTruePeak_L = m_fTruePeak_L.load( std::memory_order_relaxed );
+	snapshot.fTruePeak_R = m_fTruePeak_R.load( std::memory_order_relaxed );
+
+	const long long nFrames = m_nFrames.load( std::memory_order_relaxed );
+	if ( nFrames > 0 ) {
+		snapshot.fRms_L = std::sqrt( m_fEnergy_L.load( std::memory_order_relaxed ) / nFrames );
+		snapshot.fRms_R = std::sqrt( m_fEnergy_R.load( std::memory_order_relaxed ) / nFrames );
+	} else {
+		snapshot.fRms_L = 0;
+		snapshot.fRms_R = 0;
+	}
+
+	// The true peak can not be smaller than the sample peak.
+	if ( m_bTruePeak ) {
+		snapshot.fTruePeak_L = std::max( snapshot.fTruePeak_L, snapshot.fPeak_L );
+		snapshot.fTruePeak_R = std::max( snapshot.fTruePeak_R, snapshot.fPeak_R );
+	}
+
+	return snapshot;
+}
+
+};
@@ -0,0 +1,143 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef METER_H
+#define METER_H
+
+#include <core/Object.h>
+#include <core/Sampler/BlockKernels.h>
+
+#include <atomic>
+
+namespace H2Core
+{
+
+/**
+ * Level meter of a stereo signal.
+ *
+ * The audio thread feeds whole blocks of frames using process(). The
+ * peak, RMS, and - if enabled - true peak values are computed using
+ * the vectorized BlockKernels and accumulated until the meter is
+ * reset. All values are stored in atomics. A snapshot can thus be
+ * retrieved by the GUI without locking the AudioEngine. Like for the
+ * ProcessProfiler, a reader might see the channels in the middle of
+ * an update but never a torn value.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class Meter : public H2Core::Object<Meter>
+{
+	H2_OBJECT(Meter)
+public:
+	/** Levels accumulated since the last reset. All values are
+		linear amplitudes.*/
+	struct Snapshot {
+		float fPeak_L;
+		float fPeak_R;
+		float fRms_L;
+		float fRms_R;
+		/** Only set if the Meter was created with true peak
+			detection enabled. Zero otherwise.*/
+		float fTruePeak_L;
+		float fTruePeak_R;
+	};
+
+	/**
+	 * \param bTruePeak Whether to estimate the inter-sample peaks
+	 *   as well. This requires four times oversampling and is
+	 *   intended for busses rather than individual voices.
+	 */
+	explicit Meter( bool bTruePeak = false );
+
+	/**
+	 * Has to be called by the audio thread at the beginning of each
+	 * cycle in which process() might be called.
+	 *
+	 * \param nFrames Size of the buffer processed in this
+	 *   cycle. Used as the duration the RMS values refer to.
+	 */
+	void startCycle( int nFrames );
+	/**
+	 * Adds a block of frames to the meter.
+	 *
+	 * Might be called several times per cycle, e.g. once for every
+	 * voice of an instrument. The energies of the individual calls
+	 * are summed up which assumes the signals to be uncorrelated.
+	 *
+	 * Meters without true peak detection can be fed concurrently
+	 * by the render workers of the Sampler. The true peak history
+	 * requires a single thread feeding consecutive blocks.
+	 */
+	void process( const float* pBuffer_L, const float* pBuffer_R, int nFrames );
+
+	/** \return Levels accumulated since the last reset.*/
+	Snapshot getSnapshot() const;
+	/** Clears all levels. The audio thread will do so at the
+		beginning of the next cycle.*/
+	void reset();
+
+	bool isTruePeak() const;
+
+private:
+	void clear();
+
+	static void raise( std::atomic<float>& value, float fValue );
+	static void add( std::atomic<double>& value, double fAmount );
+
+	const bool m_bTruePeak;
+	std::atomic<float> m_fPeak_L;
+	std::atomic<float> m_fPeak_R;
+	std::atomic<float> m_fTruePeak_L;
+	std::atomic<float> m_fTruePeak_R;
+	/** Sum of squares of all processed frames.*/
+	std::atomic<double> m_fEnergy_L;
+	std::atomic<double> m_fEnergy_R;
+	/** Number of frames #m_fEnergy_L and #m_fEnergy_R refer to.*/
+	std::atomic<long long> m_nFrames;
+	std::atomic<bool> m_bResetRequested;
+	/** Last frames of the previous block required by
+		BlockKernels::truePeak(). Accessed by the audio thread
+		only.*/
+	float m_history_L[ BlockKernels::TRUE_PEAK_TAPS - 1 ];
+	float m_history_R[ BlockKernels::TRUE_PEAK_TAPS - 1 ];
+};
+
+inline void Meter::raise( std::atomic<float>& value, float fValue ) {
+	float fCurrent = value.load( std::memory_order_relaxed );
+	while ( fValue > fCurrent &&
+			! value.compare_exchange_weak( fCurrent, fValue, std::memory_order_relaxed ) ) {
+	}
+}
+
+inline void Meter::add( std::atomic<double>& value, double fAmount ) {
+	double fCurrent = value.load( std::memory_order_relaxed );
+	while ( ! value.compare_exchange_weak( fCurrent, fCurrent + fAmount,
+										   std::memory_order_relaxed ) ) {
+	}
+}
+
+inline bool Meter::isTruePeak() const {
+	return m_bTruePeak;
+}
+
+};
+
+#endif // METER_H
@@ -0,0 +1,135 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/NotePool.h>
+
+#include <core/config.h>
+#include <core/Basics/Note.h>
+
+#include <new>
+
+namespace H2Core {
+
+NotePool::NotePool( int nSize )
+	: m_nSize( nSize > 0 ? nSize : 1 )
+	, m_head( 0 )
+	, m_nExhaustedCount( 0 )
+{
+	m_pNotes = static_cast<Note*>( ::operator new( sizeof( Note ) * m_nSize ) );
+	m_pNext = new std::atomic<uint32_t>[ m_nSize ];
+
+	for ( int ii = 0; ii < m_nSize; ++ii ) {
+		Note* pNote = new ( &m_pNotes[ ii ] ) Note( nullptr, 0, 0.0, 0.0, -1, 0 );
+		pNote->preallocate( MAX_COMPONENTS );
+		m_pNext[ ii ].store( 0, std::memory_order_relaxed );
+	}
+
+	// Push in reverse order so the notes are handed out starting at
+	// the beginning of the storage.
+	for ( int ii = m_nSize - 1; ii >= 0; --ii ) {
+		push( ii );
+	}
+
+	INFOLOG( QString( "%1 notes preallocated" ).arg( m_nSize ) );
+}
+
+NotePool::~NotePool()
+{
+	for ( int ii = 0; ii < m_nSize; ++ii ) {
+		m_pNotes[ ii ].~Note();
+	}
+	::operator delete( m_pNotes );
+	delete[] m_pNext;
+}
+
+Note* NotePool::acquire( std::shared_ptr<Instrument> pInstrument, int nPosition, float fVelocity, float fPan, int nLength, float fPitch )
+{
+	Note* pNote = pop();
+	if ( pNote != nullptr ) {
+		pNote->assign( pInstrument, nPosition, fVelocity, fPan, nLength, fPitch );
+	}
+	return pNote;
+}
+
+Note* NotePool::acquire( Note* pOther, std::shared_ptr<Instrument> pInstrument )
+{
+	Note* pNote = pop();
+	if ( pNote != nullptr ) {
+		pNote->assign( pOther, pInstrument );
+	}
+	return pNote;
+}
+
+bool NotePool::contains( const Note* pNote ) const
+{
+	return pNote >= m_pNotes && pNote < m_pNotes + m_nSize;
+}
+
+void NotePool::release( Note* pNote )
+{
+	if ( pNote == nullptr ) {
+		return;
+	}
+	if ( ! contains( pNote ) ) {
+		delete pNote;
+		return;
+	}
+
+	// Drop the reference to the instrument. Otherwise idle notes
+	// would keep instruments of already unloaded drumkits alive.
+	pNote->assign( nullptr, 0, 0.0, 0.0, -1, 0 );
+	push( static_cast<int>( pNote - m_pNotes ) );
+}
+
+Note* NotePool::pop()
+{
+	uint64_t head = m_head.load( std::memory_order_acquire );
+	while ( true ) {
+		const uint32_t nIndex = static_cast<uint32_t>( head );
+		if ( nIndex == 0 ) {
+			m_nExhaustedCount.fetch_add( 1, std::memory_order_relaxed );
+			return nullptr;
+		}
+
+		const uint64_t nNext = m_pNext[ nIndex - 1 ].load( std::memory_order_relaxed );
+		const uint64_t newHead = ( ( ( head >> 32 ) + 1 ) << 32 ) | nNext;
+		if ( m_head.compare_exchange_weak( head, newHead,
+										   std::memory_order_acq_rel,
+										   std::memory_order_acquire ) ) {
+			return &m_pNotes[ nIndex - 1 ];
+		}
+	}
+}
+
+void NotePool::push( int nIndex )
+{
+	uint64_t head = m_head.load( std::memory_order_relaxed );
+	uint64_t newHead;
+	do {
+		m_pNext[ nIndex ].store( static_cast<uint32_t>( head ), std::memory_order_relaxed );
+		newHead = ( ( ( head >> 32 ) + 1 ) << 32 ) | static_cast<uint64_t>( nIndex + 1 );
+	} while ( ! m_head.compare_exchange_weak( head, newHead,
+											  std::memory_order_release,
+											  std::memory_order_relaxed ) );
+}
+
+};
@@ -0,0 +1,134 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef NOTE_POOL_H
+#define NOTE_POOL_H
+
+#include <core/Object.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace H2Core
+{
+
+class Note;
+class Instrument;
+
+/**
+ * Fixed-size pool of preallocated notes.
+ *
+ * All notes created by the AudioEngine during playback - copies of
+ * the pattern notes, metronome clicks, and stop notes - are taken
+ * from this pool and returned to it by the Sampler once they
+ * finished rendering. This way no memory is allocated or freed
+ * within the audio thread. Each pooled note owns its ADSR envelope
+ * and layer selection storage, which are reused as well.
+ *
+ * Free notes are kept in a lock-free stack. Its head combines the
+ * index of the topmost free note with a tag incremented on every
+ * modification to protect against the ABA problem. Both acquire()
+ * and release() can therefore be called from any thread.
+ *
+ * The size of the pool is determined by Preferences::m_nMaxNotes
+ * and set in AudioEngine::AudioEngine(). Since the notes in use
+ * point into its storage, it is never resized. Larger values of
+ * Preferences::m_nMaxNotes are clamped by Sampler::getMaxNotes()
+ * until the next start of Hydrogen.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class NotePool : public H2Core::Object<NotePool>
+{
+	H2_OBJECT(NotePool)
+public:
+	/**
+	 * Allocates and constructs all @a nSize notes of the pool.
+	 */
+	NotePool( int nSize );
+	~NotePool();
+
+	/**
+	 * Takes a note from the pool and initializes it just like
+	 * Note::Note( std::shared_ptr<Instrument>, int, float, float,
+	 * int, float ) would do.
+	 *
+	 * \return Initialized note or nullptr in case the pool is
+	 * exhausted.
+	 */
+	Note* acquire( std::shared_ptr<Instrument> pInstrument, int nPosition, float fVelocity, float fPan, int nLength, float fPitch );
+	/**
+	 * Takes a note from the pool and initializes it as a copy of
+	 * @a pOther just like Note::Note( Note*,
+	 * std::shared_ptr<Instrument> ) would do.
+	 *
+	 * \return Initialized note or nullptr in case the pool is
+	 * exhausted.
+	 */
+	Note* acquire( Note* pOther, std::shared_ptr<Instrument> pInstrument = nullptr );
+
+	/**
+	 * Returns @a pNote to the pool. Notes not belonging to the pool,
+	 * like the ones created by the GUI for previewing, are deleted
+	 * instead. This allows callers to hand over any note.
+	 */
+	void release( Note* pNote );
+
+	/** \return whether @a pNote was handed out by this pool.*/
+	bool contains( const Note* pNote ) const;
+
+	int getSize() const;
+	/** \return Number of times acquire() failed since the pool was
+		created.*/
+	int getExhaustedCount() const;
+
+private:
+	/** Pops the topmost free note from the stack.
+	 *
+	 * \return nullptr if there is none.*/
+	Note* pop();
+	/** Pushes the note at @a nIndex of #m_pNotes onto the stack. */
+	void push( int nIndex );
+
+	int m_nSize;
+	/** Contiguous storage of all #m_nSize notes.*/
+	Note* m_pNotes;
+	/** One-based index of the next free note for every note in
+		#m_pNotes. 0 marks the end of the stack.*/
+	std::atomic<uint32_t>* m_pNext;
+	/** Lower 32 bits: one-based index of the topmost free note (0
+		if the pool is exhausted). Upper 32 bits: ABA tag.*/
+	std::atomic<uint64_t> m_head;
+	std::atomic<int> m_nExhaustedCount;
+};
+
+inline int NotePool::getSize() const {
+	return m_nSize;
+}
+
+inline int NotePool::getExhaustedCount() const {
+	return m_nExhaustedCount.load( std::memory_order_relaxed );
+}
+
+};
+
+#endif // NOTE_POOL_H
@@ -0,0 +1,265 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/NoteQueue.h>
+
+#include <core/Basics/Note.h>
+
+#include <algorithm>
+
+namespace H2Core {
+
+static_assert( ( NoteQueue::BUCKETS & ( NoteQueue::BUCKETS - 1 ) ) == 0,
+			   "NoteQueue::BUCKETS must be a power of two" );
+
+NoteQueue::NoteQueue( int nCapacity )
+	: m_nCapacity( nCapacity > 0 ? nCapacity : 1 )
+	, m_nSize( 0 )
+	, m_nFreeNode( 0 )
+	, m_nOverflowHead( -1 )
+	, m_nOverflowTail( -1 )
+	, m_nCursor( 0 )
+	, m_nMinDelay( 0 )
+{
+	m_pNodeNote = new Note*[ m_nCapacity ];
+	m_pNodeNext = new int[ m_nCapacity ];
+	for ( int ii = 0; ii < m_nCapacity; ++ii ) {
+		m_pNodeNote[ ii ] = nullptr;
+		m_pNodeNext[ ii ] = ii + 1 < m_nCapacity ? ii + 1 : -1;
+	}
+	for ( int ii = 0; ii < BUCKETS; ++ii ) {
+		m_bucketHead[ ii ] = -1;
+		m_bucketTail[ ii ] = -1;
+	}
+}
+
+NoteQueue::~NoteQueue()
+{
+	delete[] m_pNodeNote;
+	delete[] m_pNodeNext;
+}
+
+void NoteQueue::append( int& nHead, int& nTail, int nNode )
+{
+	m_pNodeNext[ nNode ] = -1;
+	if ( nTail == -1 ) {
+		nHead = nNode;
+	} else {
+		m_pNodeNext[ nTail ] = nNode;
+	}
+	nTail = nNode;
+}
+
+bool NoteQueue::push( Note* pNote )
+{
+	if ( m_nFreeNode == -1 ) {
+		return false;
+	}
+
+	const int nNode = m_nFreeNode;
+	m_nFreeNode = m_pNodeNext[ nNode ];
+	m_pNodeNote[ nNode ] = pNote;
+
+	long long nTick = pNote->get_position();
+	if ( m_nSize == 0 ) {
+		// Start the wheel at the first note. This way relocations
+		// of the transport position are handled transparently.
+		m_nCursor = nTick;
+		m_nMinDelay = 0;
+	}
+	else if ( nTick < m_nCursor ) {
+		nTick = m_nCursor;
+	}
+
+	if ( nTick >= m_nCursor + BUCKETS ) {
+		append( m_nOverflowHead, m_nOverflowTail, nNode );
+	} else {
+		const int nBucket = static_cast<int>( nTick & ( BUCKETS - 1 ) );
+		append( m_bucketHead[ nBucket ], m_bucketTail[ nBucket ], nNode );
+	}
+
+	m_nMinDelay = std::min( m_nMinDelay, pNote->get_humanize_delay() );
+	++m_nSize;
+
+	return true;
+}
+
+void NoteQueue::popDue( long long nFrameEnd, float fTickSize, std::vector<Note*>& dueNotes )
+{
+	const int nFirst = dueNotes.size();
+
+	while ( m_nSize > 0 ) {
+		const long long nLastTick = m_nCursor + BUCKETS;
+		long long nNewCursor = -1;
+		long long nTick = m_nCursor;
+
+		for ( ; nTick < nLastTick; ++nTick ) {
+			// The current bucket is always searched since it might
+			// hold notes with positions prior to the cursor.
+			if ( nTick > m_nCursor &&
+				 static_cast<long long>( nTick * fTickSize ) + m_nMinDelay >= nFrameEnd ) {
+				break;
+			}
+			popDueFromBucket( static_cast<int>( nTick & ( BUCKETS - 1 ) ),
+							  nFrameEnd, fTickSize, dueNotes );
+			if ( nNewCursor == -1 && m_bucketHead[ nTick & ( BUCKETS - 1 ) ] != -1 ) {
+				nNewCursor = nTick;
+			}
+		}
+
+		m_nCursor = nNewCursor != -1 ? nNewCursor : nTick;
+		if ( m_nOverflowHead != -1 ) {
+			rebucketOverflow();
+		}
+
+		// Only in case the whole wheel was passed - e.g. after a
+		// large tempo change - the notes moved from the overflow
+		// list might be due as well.
+		if ( nTick < nLastTick || nNewCursor != -1 ) {
+			break;
+		}
+	}
+
+	if ( m_nSize == 0 ) {
+		m_nMinDelay = 0;
+	}
+
+	sortDue( fTickSize, dueNotes, nFirst );
+}
+
+void NoteQueue::popDueFromBucket( int nBucket, long long nFrameEnd, float fTickSize, std::vector<Note*>& dueNotes )
+{
+	int nPrev = -1;
+	int nNode = m_bucketHead[ nBucket ];
+	while ( nNode != -1 ) {
+		const int nNext = m_pNodeNext[ nNode ];
+		Note* pNote = m_pNodeNote[ nNode ];
+
+		// Ignore positive humanize delays. They are handled by the
+		// Sampler.
+		long long nNoteStart = static_cast<long long>( pNote->get_position() * fTickSize );
+		if ( pNote->get_humanize_delay() < 0 ) {
+			nNoteStart += pNote->get_humanize_delay();
+		}
+
+		if ( nNoteStart < nFrameEnd ) {
+			dueNotes.push_back( pNote );
+
+			// Unlink the node and return it to the free list.
+			if ( nPrev == -1 ) {
+				m_bucketHead[ nBucket ] = nNext;
+			} else {
+				m_pNodeNext[ nPrev ] = nNext;
+			}
+			if ( m_bucketTail[ nBucket ] == nNode ) {
+				m_bucketTail[ nBucket ] = nPrev;
+			}
+			m_pNodeNote[ nNode ] = nullptr;
+			m_pNodeNext[ nNode ] = m_nFreeNode;
+			m_nFreeNode = nNode;
+			--m_nSize;
+		} else {
+			nPrev = nNode;
+		}
+		nNode = nNext;
+	}
+}
+
+void NoteQueue::rebucketOverflow()
+{
+	if ( m_nOverflowHead == m_nOverflowTail && m_nOverflowHead != -1 &&
+		 m_nSize == 1 ) {
+		// The only note left. Skip the empty part of the wheel.
+		m_nCursor = std::max<long long>( m_pNodeNote[ m_nOverflowHead ]->get_position(), m_nCursor );
+	}
+
+	int nPrev = -1;
+	int nNode = m_nOverflowHead;
+	while ( nNode != -1 ) {
+		const int nNext = m_pNodeNext[ nNode ];
+		const long long nTick = std::max<long long>( m_pNodeNote[ nNode ]->get_position(), m_nCursor );
+
+		if ( nTick < m_nCursor + BUCKETS ) {
+			if ( nPrev == -1 ) {
+				m_nOverflowHead = nNext;
+			} else {
+				m_pNodeNext[ nPrev ] = nNext;
+			}
+			if ( m_nOverflowTail == nNode ) {
+				m_nOverflowTail = nPrev;
+			}
+			const int nBucket = static_cast<int>( nTick & ( BUCKETS - 1 ) );
+			append( m_bucketHead[ nBucket ], m_bucketTail[ nBucket ], nNode );
+		} else {
+			nPrev = nNode;
+		}
+		nNode = nNext;
+	}
+}
+
+void NoteQueue::sortDue( float fTickSize, std::vector<Note*>& dueNotes, int nFirst ) const
+{
+	// Buckets are visited in ascending order and the notes of a
+	// bucket only differ by their humanize delay. The due notes are
+	// thus mostly sorted already and an insertion sort is cheap. In
+	// contrast to std::stable_sort() it does not allocate.
+	const int nSize = dueNotes.size();
+	for ( int ii = nFirst + 1; ii < nSize; ++ii ) {
+		Note* pNote = dueNotes[ ii ];
+		const float fOnset = pNote->get_humanize_delay() + pNote->get_position() * fTickSize;
+		int jj = ii - 1;
+		while ( jj >= nFirst &&
+				dueNotes[ jj ]->get_humanize_delay() +
+				dueNotes[ jj ]->get_position() * fTickSize > fOnset ) {
+			dueNotes[ jj + 1 ] = dueNotes[ jj ];
+			--jj;
+		}
+		dueNotes[ jj + 1 ] = pNote;
+	}
+}
+
+void NoteQueue::popAll( std::vector<Note*>& notes )
+{
+	for ( int ii = 0; ii < BUCKETS; ++ii ) {
+		for ( int nNode = m_bucketHead[ ii ]; nNode != -1; nNode = m_pNodeNext[ nNode ] ) {
+			notes.push_back( m_pNodeNote[ nNode ] );
+		}
+		m_bucketHead[ ii ] = -1;
+		m_bucketTail[ ii ] = -1;
+	}
+	for ( int nNode = m_nOverflowHead; nNode != -1; nNode = m_pNodeNext[ nNode ] ) {
+		notes.push_back( m_pNodeNote[ nNode ] );
+	}
+	m_nOverflowHead = -1;
+	m_nOverflowTail = -1;
+
+	for ( int ii = 0; ii < m_nCapacity; ++ii ) {
+		m_pNodeNote[ ii ] = nullptr;
+		m_pNodeNext[ ii ] = ii + 1 < m_nCapacity ? ii + 1 : -1;
+	}
+	m_nFreeNode = 0;
+	m_nSize = 0;
+	m_nCursor = 0;
+	m_nMinDelay = 0;
+}
+
+};
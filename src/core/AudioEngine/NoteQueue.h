@@ -0,0 +1,152 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef NOTE_QUEUE_H
+#define NOTE_QUEUE_H
+
+#include <core/Object.h>
+
+#include <vector>
+
+namespace H2Core
+{
+
+class Note;
+
+/**
+ * Timing wheel holding the notes scheduled for playback.
+ *
+ * Notes are sorted into one bucket per tick according to their
+ * position. Since the tick size is only applied when the queue is
+ * drained, the buckets stay valid across tempo changes. The wheel
+ * covers #BUCKETS ticks starting at #m_nCursor, which is way more than
+ * the lookahead used in AudioEngine::updateNoteQueue(). Notes beyond
+ * that range are kept in a separate overflow list and moved into the
+ * wheel once it advanced far enough. Notes with a position prior to
+ * #m_nCursor are put into the current bucket.
+ *
+ * All nodes are allocated in the constructor. Both push() and
+ * popDue() are O(1) per note and do not allocate memory. The class is
+ * not thread-safe and has to be accessed with the AudioEngine locked.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class NoteQueue : public H2Core::Object<NoteQueue>
+{
+	H2_OBJECT(NoteQueue)
+public:
+	/** Number of ticks covered by the wheel. Must be a power of two. */
+	static constexpr int BUCKETS = 2048;
+
+	/**
+	 * \param nCapacity Maximum number of notes held at once.
+	 */
+	NoteQueue( int nCapacity );
+	~NoteQueue();
+
+	/**
+	 * Schedules @a pNote according to its position.
+	 *
+	 * \return false if the queue is full. The note is not added in
+	 * this case.
+	 */
+	bool push( Note* pNote );
+
+	/**
+	 * Removes all notes starting before @a nFrameEnd and appends
+	 * them to @a dueNotes.
+	 *
+	 * A note starts at Note::get_position() * @a fTickSize shifted by
+	 * its negative humanize delay. Positive delays are handled by the
+	 * Sampler instead. Just like in the former priority queue the
+	 * appended notes are ordered by their position plus their full
+	 * humanize delay. Notes of equal onset keep the order they were
+	 * pushed in.
+	 *
+	 * \param nFrameEnd First frame past the current buffer.
+	 * \param fTickSize Number of frames per tick.
+	 * \param dueNotes Vector the notes will be appended to. Its
+	 *   capacity should be at least the capacity of the queue.
+	 */
+	void popDue( long long nFrameEnd, float fTickSize, std::vector<Note*>& dueNotes );
+
+	/**
+	 * Removes all notes and appends them to @a notes in no
+	 * particular order.
+	 */
+	void popAll( std::vector<Note*>& notes );
+
+	bool empty() const;
+	int size() const;
+	int getCapacity() const;
+
+private:
+	/** Links node @a nNode to the end of the list starting at @a
+		nHead and ending at @a nTail.*/
+	void append( int& nHead, int& nTail, int nNode );
+	/** Sorts the notes appended to @a dueNotes starting at @a
+		nFirst by their onset.*/
+	void sortDue( float fTickSize, std::vector<Note*>& dueNotes, int nFirst ) const;
+	/** Moves all notes of bucket @a nBucket starting before @a
+		nFrameEnd to @a dueNotes.*/
+	void popDueFromBucket( int nBucket, long long nFrameEnd, float fTickSize, std::vector<Note*>& dueNotes );
+	/** Moves notes from the overflow list into the wheel once their
+		tick got in range.*/
+	void rebucketOverflow();
+
+	int m_nCapacity;
+	int m_nSize;
+	/** Note stored in each node. */
+	Note** m_pNodeNote;
+	/** Index of the next node in the list the node is part of. -1
+		marks the end of a list.*/
+	int* m_pNodeNext;
+	/** First node of the list of unused nodes. */
+	int m_nFreeNode;
+	/** First and last node of every bucket. */
+	int m_bucketHead[ BUCKETS ];
+	int m_bucketTail[ BUCKETS ];
+	/** Notes scheduled at or beyond #m_nCursor + #BUCKETS. */
+	int m_nOverflowHead;
+	int m_nOverflowTail;
+	/** Smallest tick which might still hold notes. */
+	long long m_nCursor;
+	/** Smallest (negative) humanize delay of all notes in the queue.
+		Used to determine up to which tick buckets have to be
+		searched for due notes.*/
+	int m_nMinDelay;
+};
+
+inline bool NoteQueue::empty() const {
+	return m_nSize == 0;
+}
+
+inline int NoteQueue::size() const {
+	return m_nSize;
+}
+
+inline int NoteQueue::getCapacity() const {
+	return m_nCapacity;
+}
+
+};
+
+#endif // NOTE_QUEUE_H
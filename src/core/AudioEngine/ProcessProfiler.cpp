@@ -0,0 +1,195 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/AudioEngine/ProcessProfiler.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace H2Core {
+
+ProcessProfiler::ProcessProfiler()
+	: m_nOverruns( 0 )
+	, m_nBudget( 0 )
+	, m_bResetRequested( false )
+{
+	clear();
+}
+
+long long ProcessProfiler::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void ProcessProfiler::startCycle( long long nBudget )
+{
+	if ( m_bResetRequested.exchange( false, std::memory_order_acquire ) ) {
+		clear();
+	}
+	m_nBudget.store( nBudget, std::memory_order_relaxed );
+}
+
+void ProcessProfiler::record( int nStage, long long nNanoseconds )
+{
+	if ( nStage < 0 || nStage >= STAGES ) {
+		return;
+	}
+	if ( nNanoseconds < 0 ) {
+		nNanoseconds = 0;
+	}
+
+	StageData& stage = m_stages[ nStage ];
+	increment( stage.count, 1 );
+	increment( stage.sum, nNanoseconds );
+	if ( nNanoseconds > stage.max.load( std::memory_order_relaxed ) ) {
+		stage.max.store( nNanoseconds, std::memory_order_relaxed );
+	}
+
+	int nBin = 0;
+	for ( long long nMicroseconds = nNanoseconds / 1000;
+		  nMicroseconds > 0 && nBin < BINS - 1; nMicroseconds >>= 1 ) {
+		++nBin;
+	}
+	increment( stage.bins[ nBin ], 1 );
+
+	if ( nStage == Total &&
+		 nNanoseconds > m_nBudget.load( std::memory_order_relaxed ) ) {
+		increment( m_nOverruns, 1 );
+	}
+}
+
+void ProcessProfiler::reset()
+{
+	m_bResetRequested.store( true, std::memory_order_release );
+}
+
+void ProcessProfiler::clear()
+{
+	for ( auto& stage : m_stages ) {
+		stage.count.store( 0, std::memory_order_relaxed );
+		stage.sum.store( 0, std::memory_order_relaxed );
+		stage.max.store( 0, std::memory_order_relaxed );
+		for ( auto& bin : stage.bins ) {
+			bin.store( 0, std::memory_order_relaxed );
+		}
+	}
+	m_nOverruns.store( 0, std::memory_order_relaxed );
+}
+
+float ProcessProfiler::getMean( int nStage ) const
+{
+	const long long nCount = getCount( nStage );
+	if ( nCount == 0 ) {
+		return 0;
+	}
+	return m_stages[ nStage ].sum.load( std::memory_order_relaxed ) /
+		static_cast<double>( nCount ) / 1000000.0;
+}
+
+float ProcessProfiler::getMax( int nStage ) const
+{
+	return m_stages[ nStage ].max.load( std::memory_order_relaxed ) / 1000000.0;
+}
+
+float ProcessProfiler::getBinUpperEdge( int nBin )
+{
+	// In microseconds: 1, 2, 4, 8, ...
+	return static_cast<float>( 1LL << nBin ) / 1000.0;
+}
+
+float ProcessProfiler::getPercentile( int nStage, float fPercentile ) const
+{
+	long long nTotal = 0;
+	for ( int nBin = 0; nBin < BINS; ++nBin ) {
+		nTotal += getBinCount( nStage, nBin );
+	}
+	if ( nTotal == 0 ) {
+		return 0;
+	}
+
+	const double fThreshold = nTotal * fPercentile / 100.0;
+	long long nSum = 0;
+	for ( int nBin = 0; nBin < BINS - 1; ++nBin ) {
+		nSum += getBinCount( nStage, nBin );
+		if ( nSum >= fThreshold ) {
+			return std::min( getBinUpperEdge( nBin ), getMax( nStage ) );
+		}
+	}
+	return getMax( nStage );
+}
+
+QString ProcessProfiler::getStageName( int nStage )
+{
+	if ( nStage >= Ladspa && nStage < Ladspa + MAX_FX ) {
+		return QString( "LADSPA %1" ).arg( nStage - Ladspa + 1 );
+	}
+
+	switch ( nStage ) {
+	case LockWait:
+		return "Lock wait";
+	case Transport:
+		return "Transport";
+	case NoteQueue:
+		return "Note queue";
+	case Sampler:
+		return "Sampler";
+	case Synth:
+		return "Synth";
+	case Metering:
+		return "Metering";
+	case Total:
+		return "Total";
+	default:
+		return "Unknown";
+	}
+}
+
+QString ProcessProfiler::getSummary() const
+{
+	QString sSummary = QString( "%1 %2 %3 %4 %5\n" )
+		.arg( "Stage", -12 )
+		.arg( "Count", 10 )
+		.arg( "Mean [ms]", 10 )
+		.arg( "p99 [ms]", 10 )
+		.arg( "Max [ms]", 10 );
+
+	for ( int nStage = 0; nStage < STAGES; ++nStage ) {
+		if ( getCount( nStage ) == 0 ) {
+			continue;
+		}
+		sSummary.append( QString( "%1 %2 %3 %4 %5\n" )
+						 .arg( getStageName( nStage ), -12 )
+						 .arg( getCount( nStage ), 10 )
+						 .arg( getMean( nStage ), 10, 'f', 4 )
+						 .arg( getPercentile( nStage, 99 ), 10, 'f', 4 )
+						 .arg( getMax( nStage ), 10, 'f', 4 ) );
+	}
+
+	sSummary.append( QString( "Budget: %1 ms, overruns: %2" )
+					 .arg( getBudget(), 0, 'f', 4 )
+					 .arg( getOverrunCount() ) );
+
+	return sSummary;
+}
+
+};
@@ -0,0 +1,205 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef PROCESS_PROFILER_H
+#define PROCESS_PROFILER_H
+
+#include <core/config.h>
+#include <core/Object.h>
+
+#include <atomic>
+
+namespace H2Core
+{
+
+/**
+ * Collects the time spent in the individual stages of
+ * AudioEngine::audioEngine_process().
+ *
+ * For each Stage the number of measurements, their sum, their
+ * maximum, and a histogram with logarithmically spaced bins are
+ * stored. All values are atomics written by the audio thread only
+ * using relaxed stores. They can thus be read from any other thread
+ * - like the AudioEngineInfoForm, the OscServer, or h2cli - without
+ * locking the AudioEngine. A reader might see the values of
+ * different stages in the middle of an update but never a torn
+ * value.
+ *
+ * \ingroup docCore docAudioEngine docDebugging
+ */
+class ProcessProfiler : public H2Core::Object<ProcessProfiler>
+{
+	H2_OBJECT(ProcessProfiler)
+public:
+	/** Stages of a single processing cycle.*/
+	enum Stage {
+		/** Waiting for the lock of the AudioEngine.*/
+		LockWait = 0,
+		/** AudioEngine::processTransport() and the check for tempo
+			changes.*/
+		Transport,
+		/** AudioEngine::updateNoteQueue() and
+			AudioEngine::processPlayNotes().*/
+		NoteQueue,
+		Sampler,
+		Synth,
+		/** First of the #MAX_FX LADSPA slots. Only enabled effects
+			are measured.*/
+		Ladspa,
+		/** Update of the master and component peaks.*/
+		Metering = Ladspa + MAX_FX,
+		/** Whole processing cycle.*/
+		Total,
+		STAGES
+	};
+	/** Number of histogram bins. Bin 0 holds all measurements below
+		one microsecond, bin n > 0 the ones in [2^(n-1), 2^n)
+		microseconds. The last bin is open ended.*/
+	static constexpr int BINS = 20;
+
+	ProcessProfiler();
+
+	/** \return Current time of a monotonic clock in nanoseconds.*/
+	static long long now();
+
+	/**
+	 * Has to be called by the audio thread at the beginning of
+	 * each cycle.
+	 *
+	 * \param nBudget Time available to process a single buffer in
+	 *   nanoseconds. Cycles taking longer are counted as overruns.
+	 */
+	void startCycle( long long nBudget );
+	/**
+	 * Records the time passed since @a nStart for stage @a
+	 * nStage.
+	 *
+	 * \return Current time. This way it can be passed as @a nStart
+	 * of the following stage.
+	 */
+	long long lap( int nStage, long long nStart );
+	/** Adds a single measurement of @a nNanoseconds to stage @a
+		nStage.*/
+	void record( int nStage, long long nNanoseconds );
+
+	/**
+	 * Records the time passed between @a nStart and its destruction
+	 * for stage @a nStage. This way a stage spanning a function is
+	 * measured on all of its return paths.
+	 */
+	class ScopedStage {
+	public:
+		ScopedStage( ProcessProfiler* pProfiler, int nStage, long long nStart )
+			: m_pProfiler( pProfiler ), m_nStage( nStage ), m_nStart( nStart ) {}
+		~ScopedStage() {
+			m_pProfiler->record( m_nStage, ProcessProfiler::now() - m_nStart );
+		}
+		ScopedStage( const ScopedStage& ) = delete;
+		ScopedStage& operator=( const ScopedStage& ) = delete;
+	private:
+		ProcessProfiler* m_pProfiler;
+		int m_nStage;
+		long long m_nStart;
+	};
+
+	/** Clears all measurements. The audio thread will do so at the
+		beginning of the next cycle.*/
+	void reset();
+
+	/** \return Number of measurements of @a nStage.*/
+	long long getCount( int nStage ) const;
+	/** \return Average duration of @a nStage in milliseconds.*/
+	float getMean( int nStage ) const;
+	/** \return Longest duration of @a nStage in milliseconds.*/
+	float getMax( int nStage ) const;
+	/**
+	 * \param nStage Stage of interest.
+	 * \param fPercentile Number between 0 and 100.
+	 *
+	 * \return Upper edge of the histogram bin holding the requested
+	 * percentile of @a nStage in milliseconds.
+	 */
+	float getPercentile( int nStage, float fPercentile ) const;
+	/** \return Number of measurements of @a nStage in @a nBin.*/
+	long long getBinCount( int nStage, int nBin ) const;
+	/** \return Upper edge of bin @a nBin in milliseconds.*/
+	static float getBinUpperEdge( int nBin );
+	/** \return Number of cycles exceeding the budget passed to
+		startCycle().*/
+	long long getOverrunCount() const;
+	/** \return Budget of the most recent cycle in milliseconds.*/
+	float getBudget() const;
+
+	/** \return Human readable name of @a nStage.*/
+	static QString getStageName( int nStage );
+	/** \return Table containing count, mean, 99th percentile, and
+		maximum of all stages measured so far.*/
+	QString getSummary() const;
+
+private:
+	struct StageData {
+		std::atomic<long long> count;
+		std::atomic<long long> sum;
+		std::atomic<long long> max;
+		std::atomic<long long> bins[ BINS ];
+	};
+
+	/** Increments @a value. Only the audio thread writes the
+		statistics and a plain store avoids a locked instruction.*/
+	static void increment( std::atomic<long long>& value, long long nAmount );
+	void clear();
+
+	StageData m_stages[ STAGES ];
+	std::atomic<long long> m_nOverruns;
+	std::atomic<long long> m_nBudget;
+	std::atomic<bool> m_bResetRequested;
+};
+
+inline void ProcessProfiler::increment( std::atomic<long long>& value, long long nAmount ) {
+	value.store( value.load( std::memory_order_relaxed ) + nAmount,
+				 std::memory_order_relaxed );
+}
+
+inline long long ProcessProfiler::lap( int nStage, long long nStart ) {
+	const long long nNow = now();
+	record( nStage, nNow - nStart );
+	return nNow;
+}
+
+inline long long ProcessProfiler::getCount( int nStage ) const {
+	return m_stages[ nStage ].count.load( std::memory_order_relaxed );
+}
+
+inline long long ProcessProfiler::getBinCount( int nStage, int nBin ) const {
+	return m_stages[ nStage ].bins[ nBin ].load( std::memory_order_relaxed );
+}
+
+inline long long ProcessProfiler::getOverrunCount() const {
+	return m_nOverruns.load( std::memory_order_relaxed );
+}
+
+inline float ProcessProfiler::getBudget() const {
+	return m_nBudget.load( std::memory_order_relaxed ) / 1000000.0;
+}
+
+};
+
+#endif // PROCESS_PROFILER_H
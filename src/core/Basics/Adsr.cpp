@@ -46,8 +46,8 @@ void ADSR::normalise()
 	if (__sustain < 0.0) {
 		__sustain = 0.0;
 	}
-	if (__release < 256) {
-		__release = 256;
+	if (__release < FAST_RELEASE) {
+		__release = FAST_RELEASE;
 	}
 	if (__attack > 100000) {
 		__attack = 100000;
@@ -91,6 +91,19 @@ ADSR::ADSR( const std::shared_ptr<ADSR> other ) :
 
 ADSR::~ADSR() { }
 
+void ADSR::assign( const std::shared_ptr<ADSR> other )
+{
+	__attack = other->__attack;
+	__decay = other->__decay;
+	__sustain = other->__sustain;
+	__release = other->__release;
+	__state = other->__state;
+	__ticks = other->__ticks;
+	__value = other->__value;
+	__release_value = other->__release_value;
+	normalise();
+}
+
 //#define convex_exponant
 //#define concave_exponant
 
@@ -128,8 +141,8 @@ float ADSR::get_value( float step )
 		break;
 
 	case RELEASE:
-		if ( __release < 256 ) {
-			__release = 256;
+		if ( __release < FAST_RELEASE ) {
+			__release = FAST_RELEASE;
 		}
 		__value = concave_exponant( linear_interpolation( 1.0, 0.0, ( __ticks * 1.0 / __release ) ) ) * __release_value;
 		__ticks += step;
@@ -163,6 +176,18 @@ float ADSR::release()
 	return __release_value;
 }
 
+float ADSR::fast_release()
+{
+	if ( __state == IDLE ) return 0;
+	// Continue from the current value even if the envelope was
+	// already released.
+	__release_value = __value;
+	__release = FAST_RELEASE;
+	__state = RELEASE;
+	__ticks = 0;
+	return __release_value;
+}
+
 QString ADSR::toQString( const QString& sPrefix, bool bShort ) const {
 	QString s = Base::sPrintIndention;
 	QString sOutput;
@@ -51,6 +51,14 @@ class ADSR : public Object<ADSR>
 		/** copy constructor */
 		ADSR( const std::shared_ptr<ADSR> other );
 
+		/**
+		 * Copies all parameters and the current state of @a other
+		 * into this envelope without allocating a new one.
+		 *
+		 * \param other envelope to copy from
+		 */
+		void assign( const std::shared_ptr<ADSR> other );
+
 		/** destructor */
 		~ADSR();
 
@@ -99,6 +107,23 @@ class ADSR : public Object<ADSR>
 		 * set state to RELEASE, save __release_value and return it.
 		 * */
 		float release();
+		/**
+		 * Like release() but the envelope fades out within the
+		 * shortest release supported, #FAST_RELEASE ticks,
+		 * regardless of #__release. Used to stop notes without a
+		 * click.
+		 *
+		 * \return value the fade starts at.
+		 */
+		float fast_release();
+		/** \return value computed by the last call of get_value().*/
+		float get_current_value() const;
+		/** \return whether the envelope has been released and faded
+			out completely.*/
+		bool is_idle() const;
+
+		/** Shortest release in ticks.*/
+		static constexpr unsigned int FAST_RELEASE = 256;
 
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
@@ -171,6 +196,16 @@ inline unsigned int ADSR::get_release()
 	return __release;
 }
 
+inline float ADSR::get_current_value() const
+{
+	return __value;
+}
+
+inline bool ADSR::is_idle() const
+{
+	return __state == IDLE;
+}
+
 };
 
 #endif // H2C_ADRS_H
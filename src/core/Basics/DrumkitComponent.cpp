@@ -48,13 +48,10 @@ DrumkitComponent::DrumkitComponent( const int id, const QString& name )
 	, __volume( 1.0 )
 	, __muted( false )
 	, __soloed( false )
+	, m_meter( true )
 	, __out_L( nullptr )
 	, __out_R( nullptr )
-	, __peak_l( 0.0 )
-	, __peak_r( 0.0 )
 {
-	__out_L = new float[ MAX_BUFFER_SIZE ];
-	__out_R = new float[ MAX_BUFFER_SIZE ];
 }
 
 DrumkitComponent::DrumkitComponent( DrumkitComponent* other )
@@ -63,41 +60,14 @@ DrumkitComponent::DrumkitComponent( DrumkitComponent* other )
 	, __volume( other->__volume )
 	, __muted( other->__muted )
 	, __soloed( other->__soloed )
+	, m_meter( true )
 	, __out_L( nullptr )
 	, __out_R( nullptr )
-	, __peak_l( 0.0 )
-	, __peak_r( 0.0 )
 {
-	__out_L = new float[ MAX_BUFFER_SIZE ];
-	__out_R = new float[ MAX_BUFFER_SIZE ];
 }
 
 DrumkitComponent::~DrumkitComponent()
 {
-	delete[] __out_L;
-	delete[] __out_R;
-}
-
-void DrumkitComponent::reset_outs( uint32_t nFrames )
-{
-	memset( __out_L, 0, nFrames * sizeof( float ) );
-	memset( __out_R, 0, nFrames * sizeof( float ) );
-}
-
-void DrumkitComponent::set_outs( int nBufferPos, float valL, float valR )
-{
-	__out_L[nBufferPos] += valL;
-	__out_R[nBufferPos] += valR;
-}
-
-float DrumkitComponent::get_out_L( int nBufferPos )
-{
-	return __out_L[nBufferPos];
-}
-
-float DrumkitComponent::get_out_R( int nBufferPos )
-{
-	return __out_R[nBufferPos];
 }
 
 void DrumkitComponent::load_from( DrumkitComponent* component, bool is_live )
@@ -149,8 +119,8 @@ QString DrumkitComponent::toQString( const QString& sPrefix, bool bShort ) const
 			.append( QString( "%1%2volume: %3\n" ).arg( sPrefix ).arg( s ).arg( __volume ) )
 			.append( QString( "%1%2muted: %3\n" ).arg( sPrefix ).arg( s ).arg( __muted ) )
 			.append( QString( "%1%2soloed: %3\n" ).arg( sPrefix ).arg( s ).arg( __soloed ) )
-			.append( QString( "%1%2peak_l: %3\n" ).arg( sPrefix ).arg( s ).arg( __peak_l ) )
-			.append( QString( "%1%2peak_r: %3\n" ).arg( sPrefix ).arg( s ).arg( __peak_r ) );
+			.append( QString( "%1%2peak_l: %3\n" ).arg( sPrefix ).arg( s ).arg( m_meter.getSnapshot().fPeak_L ) )
+			.append( QString( "%1%2peak_r: %3\n" ).arg( sPrefix ).arg( s ).arg( m_meter.getSnapshot().fPeak_R ) );
 	} else {
 
 		sOutput = QString( "[DrumkitComponent]" )
@@ -159,8 +129,8 @@ QString DrumkitComponent::toQString( const QString& sPrefix, bool bShort ) const
 			.append( QString( ", volume: %1" ).arg( __volume ) )
 			.append( QString( ", muted: %1" ).arg( __muted ) )
 			.append( QString( ", soloed: %1" ).arg( __soloed ) )
-			.append( QString( ", peak_l: %1" ).arg( __peak_l ) )
-			.append( QString( ", peak_r: %1" ).arg( __peak_r ) );
+			.append( QString( ", peak_l: %1" ).arg( m_meter.getSnapshot().fPeak_L ) )
+			.append( QString( ", peak_r: %1" ).arg( m_meter.getSnapshot().fPeak_R ) );
 	}
 	return sOutput;
 }
@@ -26,6 +26,7 @@
 #include <cassert>
 #include <inttypes.h>
 #include <core/Object.h>
+#include <core/AudioEngine/Meter.h>
 
 namespace H2Core
 {
@@ -64,15 +65,24 @@ class DrumkitComponent : public H2Core::Object<DrumkitComponent>
 		void						set_soloed( bool soloed );
 		bool						is_soloed() const;
 
-		void						set_peak_l( float val );
-		float						get_peak_l() const;
-		void						set_peak_r( float val );
-		float						get_peak_r() const;
-
-		void						reset_outs( uint32_t nFrames );
-		void						set_outs( int nBufferPos, float valL, float valR );
-		float						get_out_L( int nBufferPos );
-		float						get_out_R( int nBufferPos );
+		/** \return #m_meter */
+		Meter*						getMeter();
+
+		/**
+		 * Assigns the bus the component is rendered to. The
+		 * buffers are owned by the Sampler, which assigns one of
+		 * its component busses to every component of the current
+		 * song at the beginning of each processing cycle.
+		 */
+		void						set_out_buffers( float* pOut_L, float* pOut_R );
+		/** \return Output buffer of the left channel holding
+			MAX_BUFFER_SIZE frames or nullptr if no bus was
+			assigned.*/
+		float*						get_outs_L() const;
+		/** \return Output buffer of the right channel holding
+			MAX_BUFFER_SIZE frames or nullptr if no bus was
+			assigned.*/
+		float*						get_outs_R() const;
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
 		 * every new line
@@ -91,9 +101,12 @@ class DrumkitComponent : public H2Core::Object<DrumkitComponent>
 		bool		__muted;
 		bool		__soloed;
 
-		float		__peak_l;
-		float		__peak_r;
+		/** Level of the component including true peaks. Fed by
+			the AudioEngine and read by the Mixer.*/
+		Meter		m_meter;
 
+		/** Bus of the Sampler the component is rendered to. Not
+			owned by the component.*/
 		float *		__out_L;
 		float *		__out_R;
 };
@@ -152,24 +165,25 @@ inline bool DrumkitComponent::is_soloed() const
 	return __soloed;
 }
 
-inline void DrumkitComponent::set_peak_l( float val )
+inline Meter* DrumkitComponent::getMeter()
 {
-	__peak_l = val;
+	return &m_meter;
 }
 
-inline float DrumkitComponent::get_peak_l() const
+inline void DrumkitComponent::set_out_buffers( float* pOut_L, float* pOut_R )
 {
-	return __peak_l;
+	__out_L = pOut_L;
+	__out_R = pOut_R;
 }
 
-inline void DrumkitComponent::set_peak_r( float val )
+inline float* DrumkitComponent::get_outs_L() const
 {
-	__peak_r = val;
+	return __out_L;
 }
 
-inline float DrumkitComponent::get_peak_r() const
+inline float* DrumkitComponent::get_outs_R() const
 {
-	return __peak_r;
+	return __out_R;
 }
 
 };
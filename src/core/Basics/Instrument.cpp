@@ -36,6 +36,7 @@
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/InstrumentComponent.h>
 #include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/SampleLoader.h>
 #include <core/Sampler/Sampler.h>
 
 namespace H2Core
@@ -47,8 +48,6 @@ Instrument::Instrument( const int id, const QString& name, std::shared_ptr<ADSR>
 	, __gain( 1.0 )
 	, __volume( 1.0 )
 	, m_fPan( 0.f )
-	, __peak_l( 0.0 )
-	, __peak_r( 0.0 )
 	, __adsr( adsr )
 	, __filter_active( false )
 	, __filter_cutoff( 1.0 )
@@ -73,6 +72,7 @@ Instrument::Instrument( const int id, const QString& name, std::shared_ptr<ADSR>
 	, __apply_velocity( true )
 	, __current_instr_for_export(false)
 	, m_bHasMissingSamples( false )
+	, m_nVoicePriority( 0 )
 {
 	if ( __adsr == nullptr ) {
 		__adsr = std::make_shared<ADSR>();
@@ -98,8 +98,6 @@ Instrument::Instrument( std::shared_ptr<Instrument> other )
 	, __gain( other->__gain )
 	, __volume( other->get_volume() )
 	, m_fPan( other->getPan() )
-	, __peak_l( other->get_peak_l() )
-	, __peak_r( other->get_peak_r() )
 	, __adsr( std::make_shared<ADSR>( *( other->get_adsr() ) ) )
 	, __filter_active( other->is_filter_active() )
 	, __filter_cutoff( other->get_filter_cutoff() )
@@ -123,6 +121,7 @@ Instrument::Instrument( std::shared_ptr<Instrument> other )
 	, __is_metronome_instrument(false)
 	, __apply_velocity( other->get_apply_velocity() )
 	, __current_instr_for_export(false)
+	, m_nVoicePriority( other->getVoicePriority() )
 {
 	for ( int i=0; i<MAX_FX; i++ ) {
 		__fx_level[i] = other->get_fx_level( i );
@@ -139,78 +138,73 @@ Instrument::~Instrument()
 	delete __components;
 }
 
-std::shared_ptr<Instrument> Instrument::load_instrument( const QString& drumkit_name, const QString& instrument_name, Filesystem::Lookup lookup )
+std::shared_ptr<Instrument> Instrument::load_instrument( const QString& drumkit_name, const QString& instrument_name, Filesystem::Lookup lookup, bool bUseCache )
 {
 	auto pInstrument = std::make_shared<Instrument>();
-	pInstrument->load_from( drumkit_name, instrument_name, false, lookup );
+	pInstrument->load_from( drumkit_name, instrument_name, false, lookup, bUseCache );
 	return pInstrument;
 }
 
-void Instrument::load_from( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInstrument, bool is_live )
+void Instrument::load_from( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInstrument, bool is_live, bool bUseCache )
 {
-	AudioEngine* pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	auto pComponents = copy_components( pDrumkit, pInstrument );
+	SampleLoader::loadComponents( *pComponents, bUseCache );
 
+	AudioEngine* pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
 	if ( is_live ) {
 		pAudioEngine->lock( RIGHT_HERE );
 	}
-	
-	this->get_components()->clear();
+
+	set_from( pDrumkit, pInstrument, pComponents );
 	
 	if ( is_live ) {
 		pAudioEngine->unlock();
 	}
 
-	set_missing_samples( false );
+	// The previous samples are freed without holding the lock.
+	delete pComponents;
+}
+
+std::vector<std::shared_ptr<InstrumentComponent>>* Instrument::copy_components( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInstrument )
+{
+	auto pComponents = new std::vector<std::shared_ptr<InstrumentComponent>>;
 
 	for ( const auto& pSrcComponent : *pInstrument->get_components() ) {
 		auto pMyComponent = std::make_shared<InstrumentComponent>( pSrcComponent->get_drumkit_componentID() );
 		pMyComponent->set_gain( pSrcComponent->get_gain() );
 
-		this->get_components()->push_back( pMyComponent );
-
 		for ( int i = 0; i < InstrumentComponent::getMaxLayers(); i++ ) {
 			auto src_layer = pSrcComponent->get_layer( i );
-			auto my_layer = pMyComponent->get_layer( i );
-
-			if( src_layer == nullptr ) {
-				if ( is_live ) {
-					pAudioEngine->lock( RIGHT_HERE );
-				}
-				pMyComponent->set_layer( nullptr, i );
-				if ( is_live ) {
-					pAudioEngine->unlock();
-				}
-			} else {
+			if ( src_layer != nullptr && src_layer->get_sample() != nullptr ) {
 				QString sample_path =  pDrumkit->get_path() + "/" + src_layer->get_sample()->get_filename();
-				auto pSample = Sample::load( sample_path );
-				if ( pSample == nullptr ) {
-					_ERRORLOG( QString( "Error loading sample %1. Creating a new empty layer." ).arg( sample_path ) );
-					set_missing_samples( true );
-					if ( is_live ) {
-						pAudioEngine->lock( RIGHT_HERE );
-					}
-					pMyComponent->set_layer( nullptr, i );
-					
-					if ( is_live ) {
-						pAudioEngine->unlock();
-					}
-				} else {
-					if ( is_live ) {
-						pAudioEngine->lock( RIGHT_HERE );
-					}
-					pMyComponent->set_layer( std::make_shared<InstrumentLayer>( src_layer, pSample ), i );
-					if ( is_live ) {
-						pAudioEngine->unlock();
-					}
-				}
+				pMyComponent->set_layer( std::make_shared<InstrumentLayer>( src_layer, std::make_shared<Sample>( sample_path ) ), i );
 			}
-			my_layer = nullptr;
 		}
+
+		pComponents->push_back( pMyComponent );
 	}
-	if ( is_live ) {
-		pAudioEngine->lock( RIGHT_HERE );
+
+	return pComponents;
+}
+
+void Instrument::set_from( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInstrument,
+						   std::vector<std::shared_ptr<InstrumentComponent>>* pComponents )
+{
+	set_missing_samples( false );
+	for ( const auto& pComponent : *pComponents ) {
+		for ( int i = 0; i < InstrumentComponent::getMaxLayers(); i++ ) {
+			auto pLayer = pComponent->get_layer( i );
+			if ( pLayer != nullptr && pLayer->get_sample()->is_empty() ) {
+				_ERRORLOG( QString( "Error loading sample %1. Creating a new empty layer." )
+						   .arg( pLayer->get_sample()->get_filepath() ) );
+				set_missing_samples( true );
+				pComponent->set_layer( nullptr, i );
+			}
+		}
 	}
 
+	this->get_components()->swap( *pComponents );
+
 	this->set_id( pInstrument->get_id() );
 	this->set_name( pInstrument->get_name() );
 	this->set_drumkit_name( pDrumkit->get_name() );
@@ -232,14 +226,11 @@ void Instrument::load_from( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInst
 	this->set_hihat_grp( pInstrument->get_hihat_grp() );
 	this->set_lower_cc( pInstrument->get_lower_cc() );
 	this->set_higher_cc( pInstrument->get_higher_cc() );
+	this->setVoicePriority( pInstrument->getVoicePriority() );
 	this->set_apply_velocity ( pInstrument->get_apply_velocity() );
-	
-	if ( is_live ) {
-		pAudioEngine->unlock();
-	}
 }
 
-void Instrument::load_from( const QString& dk_name, const QString& instrument_name, bool is_live, Filesystem::Lookup lookup )
+void Instrument::load_from( const QString& dk_name, const QString& instrument_name, bool is_live, Filesystem::Lookup lookup, bool bUseCache )
 {
 	Drumkit* pDrumkit = Drumkit::load_by_name( dk_name, false, lookup );
 	if ( !pDrumkit ) {
@@ -250,7 +241,7 @@ void Instrument::load_from( const QString& dk_name, const QString& instrument_na
 
 	auto pInstrument = pDrumkit->get_instruments()->find( instrument_name );
 	if ( pInstrument!=nullptr ) {
-		load_from( pDrumkit, pInstrument, is_live );
+		load_from( pDrumkit, pInstrument, is_live, bUseCache );
 	}
 	
 	delete pDrumkit;
@@ -311,6 +302,7 @@ std::shared_ptr<Instrument> Instrument::load_from( XMLNode* node, const QString&
 	pInstrument->set_hihat_grp( node->read_int( "isHihat", -1, true ) );
 	pInstrument->set_lower_cc( node->read_int( "lower_cc", 0, true ) );
 	pInstrument->set_higher_cc( node->read_int( "higher_cc", 127, true ) );
+	pInstrument->setVoicePriority( node->read_int( "voicePriority", 0, true, false ) );
 
 	for ( int i=0; i<MAX_FX; i++ ) {
 		pInstrument->set_fx_level( node->read_float( QString( "FX%1Level" ).arg( i+1 ), 0.0 ), i );
@@ -326,14 +318,7 @@ std::shared_ptr<Instrument> Instrument::load_from( XMLNode* node, const QString&
 
 void Instrument::load_samples()
 {
-	for ( auto& pComponent : *get_components() ) {
-		for ( int i = 0; i < InstrumentComponent::getMaxLayers(); i++ ) {
-			auto pLayer = pComponent->get_layer( i );
-			if( pLayer ) {
-				pLayer->load_sample();
-			}
-		}
-	}
+	SampleLoader::loadComponents( *get_components() );
 }
 
 void Instrument::unload_samples()
@@ -388,6 +373,7 @@ void Instrument::save_to( XMLNode* node, int component_id )
 	InstrumentNode.write_int( "isHihat", __hihat_grp );
 	InstrumentNode.write_int( "lower_cc", __lower_cc );
 	InstrumentNode.write_int( "higher_cc", __higher_cc );
+	InstrumentNode.write_int( "voicePriority", m_nVoicePriority );
 
 	for ( int i=0; i<MAX_FX; i++ ) {
 		InstrumentNode.write_float( QString( "FX%1Level" ).arg( i+1 ), __fx_level[i] );
@@ -426,8 +412,8 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( "%1%2gain: %3\n" ).arg( sPrefix ).arg( s ).arg( __gain ) )
 			.append( QString( "%1%2volume: %3\n" ).arg( sPrefix ).arg( s ).arg( __volume ) )
 			.append( QString( "%1%2pan: %3\n" ).arg( sPrefix ).arg( s ).arg( m_fPan ) )
-			.append( QString( "%1%2peak_l: %3\n" ).arg( sPrefix ).arg( s ).arg( __peak_l ) )
-			.append( QString( "%1%2peak_r: %3\n" ).arg( sPrefix ).arg( s ).arg( __peak_r ) )
+			.append( QString( "%1%2peak_l: %3\n" ).arg( sPrefix ).arg( s ).arg( m_meter.getSnapshot().fPeak_L ) )
+			.append( QString( "%1%2peak_r: %3\n" ).arg( sPrefix ).arg( s ).arg( m_meter.getSnapshot().fPeak_R ) )
 			.append( QString( "%1" ).arg( __adsr->toQString( sPrefix + s, bShort ) ) )
 			.append( QString( "%1%2filter_active: %3\n" ).arg( sPrefix ).arg( s ).arg( __filter_active ) )
 			.append( QString( "%1%2filter_cutoff: %3\n" ).arg( sPrefix ).arg( s ).arg( __filter_cutoff ) )
@@ -456,6 +442,7 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( "%1%2apply_velocity: %3\n" ).arg( sPrefix ).arg( s ).arg( __apply_velocity ) )
 			.append( QString( "%1%2current_instr_for_export: %3\n" ).arg( sPrefix ).arg( s ).arg( __current_instr_for_export ) )
 			.append( QString( "%1%2m_bHasMissingSamples: %3\n" ).arg( sPrefix ).arg( s ).arg( m_bHasMissingSamples ) )
+			.append( QString( "%1%2m_nVoicePriority: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nVoicePriority ) )
 			.append( QString( "%1%2components:\n" ).arg( sPrefix ).arg( s ) );
 		for ( auto cc : *__components ) {
 			if ( cc != nullptr ) {
@@ -471,8 +458,8 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", gain: %1" ).arg( __gain ) )
 			.append( QString( ", volume: %1" ).arg( __volume ) )
 			.append( QString( ", pan: %1" ).arg( m_fPan ) )
-			.append( QString( ", peak_l: %1" ).arg( __peak_l ) )
-			.append( QString( ", peak_r: %1" ).arg( __peak_r ) )
+			.append( QString( ", peak_l: %1" ).arg( m_meter.getSnapshot().fPeak_L ) )
+			.append( QString( ", peak_r: %1" ).arg( m_meter.getSnapshot().fPeak_R ) )
 			.append( QString( ", [%1" ).arg( __adsr->toQString( sPrefix + s, bShort ).replace( "\n", "]" ) ) )
 			.append( QString( ", filter_active: %1" ).arg( __filter_active ) )
 			.append( QString( ", filter_cutoff: %1" ).arg( __filter_cutoff ) )
@@ -501,6 +488,7 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", apply_velocity: %1" ).arg( __apply_velocity ) )
 			.append( QString( ", current_instr_for_export: %1" ).arg( __current_instr_for_export ) )
 			.append( QString( ", m_bHasMissingSamples: %1" ).arg( m_bHasMissingSamples ) )
+			.append( QString( ", m_nVoicePriority: %1" ).arg( m_nVoicePriority ) )
 			.append( QString( ", components: [" ) );
 		for ( auto cc : *__components ) {
 			if ( cc != nullptr ) {
@@ -27,6 +27,7 @@
 #include <memory>
 
 #include <core/Object.h>
+#include <core/AudioEngine/Meter.h>
 #include <core/Basics/Adsr.h>
 #include <core/Helpers/Filesystem.h>
 
@@ -78,9 +79,11 @@ class Instrument : public H2Core::Object<Instrument>
 		 * \param instrument_name the instrument within the drumkit to load samples from
 		 * \param lookup Where to search (system/user folder or both)
 		 * for the drumkit.
+		 * \param bUseCache Whether the SampleCache is used. Should be
+		 * false for previews.
 		 * \return a new Instrument instance
 		 */
-		static std::shared_ptr<Instrument> load_instrument( const QString& drumkit_name, const QString& instrument_name, Filesystem::Lookup lookup = Filesystem::Lookup::stacked );
+		static std::shared_ptr<Instrument> load_instrument( const QString& drumkit_name, const QString& instrument_name, Filesystem::Lookup lookup = Filesystem::Lookup::stacked, bool bUseCache = true );
 
 		/**
 		 * loads instrument from a given instrument within a given drumkit into a `live` Instrument object.
@@ -89,21 +92,58 @@ class Instrument : public H2Core::Object<Instrument>
 		 * \param is_live is it performed while playing
 		 * \param lookup Where to search (system/user folder or both)
 		 * for the drumkit.
+		 * \param bUseCache Whether the SampleCache is used.
 		 */
-		void load_from( const QString& drumkit_name, const QString& instrument_name, bool is_live = true, Filesystem::Lookup lookup = Filesystem::Lookup::stacked );
+		void load_from( const QString& drumkit_name, const QString& instrument_name, bool is_live = true, Filesystem::Lookup lookup = Filesystem::Lookup::stacked, bool bUseCache = true );
 
 		/**
 		 * loads instrument from a given instrument into a `live` Instrument object.
+		 *
+		 * The samples are decoded concurrently before the
+		 * AudioEngine is locked once to swap them in.
+		 *
 		 * \param drumkit the drumkit the instrument belongs to
 		 * \param instrument to load samples and members from
 		 * \param is_live is it performed while playing
+		 * \param bUseCache Whether the SampleCache is used.
+		 */
+		void load_from( Drumkit* drumkit, std::shared_ptr<Instrument> instrument, bool is_live = true, bool bUseCache = true );
+		/**
+		 * Creates copies of the components of @a pInstrument. Their
+		 * layers hold new samples pointing to the files in @a
+		 * pDrumkit which are not loaded yet.
+		 *
+		 * Together with SampleLoader::loadComponents() and
+		 * set_from() this allows to load the samples of a whole
+		 * drumkit without touching the instruments used by the
+		 * AudioEngine.
+		 *
+		 * \return New component list owned by the caller.
+		 */
+		static std::vector<std::shared_ptr<InstrumentComponent>>* copy_components( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInstrument );
+		/**
+		 * Replaces the components of this instrument by the ones in
+		 * @a pComponents and copies all other members of @a
+		 * pInstrument.
+		 *
+		 * Layers holding empty samples are removed and the
+		 * instrument is marked as having missing samples. The
+		 * AudioEngine is not locked.
+		 *
+		 * \param pDrumkit the drumkit @a pInstrument belongs to
+		 * \param pInstrument instrument to copy the members from
+		 * \param pComponents Loaded components created by
+		 * copy_components(). On return it holds the previous
+		 * components of this instrument. Those should be released
+		 * after unlocking the AudioEngine.
 		 */
-		void load_from( Drumkit* drumkit, std::shared_ptr<Instrument> instrument, bool is_live = true );
+		void set_from( Drumkit* pDrumkit, std::shared_ptr<Instrument> pInstrument,
+					   std::vector<std::shared_ptr<InstrumentComponent>>* pComponents );
 
 		/**
-		 * Calls the InstrumentLayer::load_sample() member
-		 * function of all layers of each component of the
-		 * Instrument.
+		 * Loads the samples of all layers of each component of
+		 * the Instrument concurrently using
+		 * SampleLoader::loadComponents().
 		 */
 		void load_samples();
 		/**
@@ -204,14 +244,8 @@ class Instrument : public H2Core::Object<Instrument>
 		/** get the filter cutoff of the instrument */
 		float get_filter_cutoff() const;
 
-		/** set the left peak of the instrument */
-		void set_peak_l( float val );
-		/** get the left peak of the instrument */
-		float get_peak_l() const;
-		/** set the right peak of the instrument */
-		void set_peak_r( float val );
-		/** get the right peak of the instrument */
-		float get_peak_r() const;
+		/** \return #m_meter */
+		Meter* getMeter();
 
 		/** set the fx level of the instrument */
 		void set_fx_level( float level, int index );
@@ -262,6 +296,11 @@ class Instrument : public H2Core::Object<Instrument>
 		void set_higher_cc( int message );
 		int get_higher_cc() const;
 
+		/** Sets #m_nVoicePriority.*/
+		void setVoicePriority( int nPriority );
+		/** \return #m_nVoicePriority.*/
+		int getVoicePriority() const;
+
 		///< set the name of the related drumkit
 		void set_drumkit_name( const QString& name );
 		///< get the name of the related drumkits
@@ -308,8 +347,9 @@ class Instrument : public H2Core::Object<Instrument>
 		float					__gain;					///< gain of the instrument
 		float					__volume;				///< volume of the instrument
 		float					m_fPan;	///< pan of the instrument, [-1;1] from left to right, as requested by Sampler PanLaws
-		float					__peak_l;				///< left current peak value
-		float					__peak_r;				///< right current peak value
+		/** Level of all voices of the instrument. It is fed by
+			the Sampler and read by the Mixer.*/
+		Meter					m_meter;
 		std::shared_ptr<ADSR>					__adsr;					///< attack delay sustain release instance
 		bool					__filter_active;		///< is filter active?
 		float					__filter_cutoff;		///< filter cutoff (0..1)
@@ -324,7 +364,7 @@ class Instrument : public H2Core::Object<Instrument>
 		bool					__soloed;				///< is the instrument in solo mode?
 		bool					__muted;				///< is the instrument muted?
 		int						__mute_group;			///< mute group of the instrument
-		int						__queued;				///< count the number of notes queued within Sampler::__playing_notes_queue or std::priority_queue m_songNoteQueue
+		int						__queued;				///< count the number of notes queued within Sampler::__playing_notes_queue or AudioEngine::m_songNoteQueue
 		float					__fx_level[MAX_FX];		///< Ladspa FX level array
 		int						__hihat_grp;			///< the instrument is part of a hihat
 		int						__lower_cc;				///< lower cc level
@@ -335,6 +375,11 @@ class Instrument : public H2Core::Object<Instrument>
 		bool					__apply_velocity;				///< change the sample gain based on velocity
 		bool					__current_instr_for_export;		///< is the instrument currently being exported?
 		bool 					m_bHasMissingSamples;	///< does the instrument have missing sample files?
+		/** Importance of the notes of this instrument. Once the
+			Sampler runs out of voices and uses
+			Sampler::VoiceStealing::LowestPriority, notes of the
+			instrument with the lowest value are stopped first.*/
+		int						m_nVoicePriority;
 };
 
 // DEFINITIONS
@@ -487,24 +532,9 @@ inline float Instrument::get_filter_cutoff() const
 	return __filter_cutoff;
 }
 
-inline void Instrument::set_peak_l( float val )
-{
-	__peak_l = val;
-}
-
-inline float Instrument::get_peak_l() const
-{
-	return __peak_l;
-}
-
-inline void Instrument::set_peak_r( float val )
-{
-	__peak_r = val;
-}
-
-inline float Instrument::get_peak_r() const
+inline Meter* Instrument::getMeter()
 {
-	return __peak_r;
+	return &m_meter;
 }
 
 inline void Instrument::set_fx_level( float level, int index )
@@ -623,6 +653,16 @@ inline int Instrument::get_higher_cc() const
 	return __higher_cc;
 }
 
+inline void Instrument::setVoicePriority( int nPriority )
+{
+	m_nVoicePriority = nPriority;
+}
+
+inline int Instrument::getVoicePriority() const
+{
+	return m_nVoicePriority;
+}
+
 inline void Instrument::set_drumkit_name( const QString& name )
 {
 	__drumkit_name = name;
@@ -24,6 +24,7 @@
 
 #include <core/Helpers/Xml.h>
 #include <core/Basics/Sample.h>
+#include <core/Preferences/Preferences.h>
 
 namespace H2Core
 {
@@ -42,7 +43,8 @@ InstrumentLayer::InstrumentLayer( std::shared_ptr<InstrumentLayer> other ) : Obj
 	__end_velocity( other->get_end_velocity() ),
 	__pitch( other->get_pitch() ),
 	__gain( other->get_gain() ),
-	__sample( other->get_sample() )
+	__sample( other->get_sample() ),
+	__converted_sample( other->get_converted_sample() )
 {
 }
 
@@ -62,17 +64,33 @@ InstrumentLayer::~InstrumentLayer()
 void InstrumentLayer::set_sample( std::shared_ptr<Sample> sample )
 {
 	__sample = sample;
+	__converted_sample = nullptr;
 }
 
-void InstrumentLayer::load_sample()
+bool InstrumentLayer::load_sample( bool bUseCache )
 {
+	// The content of the sample is replaced.
+	__converted_sample = nullptr;
 	if( __sample ) {
-		__sample->load();
+		Preferences* pPref = Preferences::get_instance();
+		bool bLoaded;
+		if ( pPref->m_bStreamSamples ) {
+			bLoaded = __sample->load_streamed( pPref->m_nStreamPreloadMs );
+		} else {
+			bLoaded = __sample->load( bUseCache );
+		}
+		// Streamed samples are left untouched.
+		if ( bLoaded && pPref->m_bCompactSamples ) {
+			__sample->compact();
+		}
+		return bLoaded;
 	}
+	return false;
 }
 
 void InstrumentLayer::unload_sample()
 {
+	__converted_sample = nullptr;
 	if( __sample ) {
 		__sample->unload();
 	}
@@ -78,16 +78,29 @@ namespace H2Core
 		void set_end_velocity( float end );
 		/** get the end velocity of the layer */
 		float get_end_velocity() const;
-		/** set the sample of the layer */
+		/** set the sample of the layer and drop #__converted_sample */
 		void set_sample( std::shared_ptr<Sample> sample );
 		/** get the sample of the layer */
 		std::shared_ptr<Sample> get_sample() const;
+		/** set #__converted_sample */
+		void set_converted_sample( std::shared_ptr<Sample> sample );
+		/** \return #__converted_sample */
+		std::shared_ptr<Sample> get_converted_sample() const;
 
 		/**
 		 * Calls the #H2Core::Sample::load()
-		 * member function of #__sample.
+		 * member function of #__sample or -
+		 * if Preferences::m_bStreamSamples is set -
+		 * #H2Core::Sample::load_streamed(). If
+		 * Preferences::m_bCompactSamples is set, the
+		 * sample is compacted afterwards, see
+		 * #H2Core::Sample::compact().
+		 *
+		 * \param bUseCache Passed to #H2Core::Sample::load().
+		 *
+		 * \return Whether the sample could be loaded.
 		 */
-		void load_sample();
+		bool load_sample( bool bUseCache = true );
 		/*
 		 * unload sample and replace it with an empty one
 		 */
@@ -121,6 +134,12 @@ namespace H2Core
 		float __start_velocity;     ///< the start velocity of the sample, 0.0 by default
 		float __end_velocity;       ///< the end velocity of the sample, 1.0 by default
 		std::shared_ptr<Sample> __sample;           ///< the underlaying sample
+		/**
+		 * #__sample converted to the sample rate of the audio driver
+		 * by the ResampleCache or nullptr. Used by the Sampler to
+		 * render unpitched notes without interpolation.
+		 */
+		std::shared_ptr<Sample> __converted_sample;
 	};
 
 	// DEFINITIONS
@@ -170,6 +189,16 @@ namespace H2Core
 		return __sample;
 	}
 
+	inline void InstrumentLayer::set_converted_sample( std::shared_ptr<Sample> sample )
+	{
+		__converted_sample = sample;
+	}
+
+	inline std::shared_ptr<Sample> InstrumentLayer::get_converted_sample() const
+	{
+		return __converted_sample;
+	}
+
 };
 
 #endif // H2C_INSTRUMENT_LAYER_H
@@ -24,6 +24,8 @@
 
 #include <core/Helpers/Xml.h>
 #include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/SampleLoader.h>
 
 #include <set>
 
@@ -49,9 +51,14 @@ InstrumentList::~InstrumentList()
 
 void InstrumentList::load_samples()
 {
+	// The samples of all instruments are decoded at once.
+	std::vector<std::shared_ptr<InstrumentComponent>> components;
 	for( int i=0; i<__instruments.size(); i++ ) {
-		__instruments[i]->load_samples();
+		for ( const auto& pComponent : *__instruments[i]->get_components() ) {
+			components.push_back( pComponent );
+		}
 	}
+	SampleLoader::loadComponents( components );
 }
 
 void InstrumentList::unload_samples()
@@ -134,8 +134,9 @@ class InstrumentList : public H2Core::Object<InstrumentList>
 		 */
 		void move( int idx_a, int idx_b );
 
-		/** Calls the Instrument::load_samples() member
-		 * function of all Instruments in #__instruments.
+		/** Loads the samples of all layers of all Instruments in
+		 * #__instruments concurrently using
+		 * SampleLoader::loadComponents().
 		 */
 		void load_samples();
 		/** Calls the Instrument::unload_samples() member
@@ -63,17 +63,7 @@ Note::Note( std::shared_ptr<Instrument> instrument, int position, float velocity
 	  __probability( 1.0f )
 {
 	if ( __instrument != nullptr ) {
-		__adsr = __instrument->copy_adsr();
-		__instrument_id = __instrument->get_id();
-
-		for ( const auto& pCompo : *__instrument->get_components() ) {
-
-			SelectedLayerInfo *sampleInfo = new SelectedLayerInfo;
-			sampleInfo->SelectedLayer = -1;
-			sampleInfo->SamplePosition = 0;
-
-			__layers_selected[ pCompo->get_drumkit_componentID() ] = sampleInfo;
-		}
+		init_instrument_data();
 	}
 
 	setPan( pan ); // this checks the boundaries
@@ -108,21 +98,112 @@ Note::Note( Note* other, std::shared_ptr<Instrument> instrument )
 {
 	if ( instrument != nullptr ) __instrument = instrument;
 	if ( __instrument != nullptr ) {
-		__adsr = __instrument->copy_adsr();
-		__instrument_id = __instrument->get_id();
+		init_instrument_data();
+	}
+}
 
-		for ( const auto& pCompo : *__instrument->get_components() ) {
-			SelectedLayerInfo *sampleInfo = new SelectedLayerInfo;
-			sampleInfo->SelectedLayer = -1;
-			sampleInfo->SamplePosition = 0;
+Note::~Note()
+{
+}
+
+void Note::init_instrument_data()
+{
+	if ( __adsr == nullptr ) {
+		__adsr = __instrument->copy_adsr();
+	} else {
+		__adsr->assign( __instrument->get_adsr() );
+	}
+	__instrument_id = __instrument->get_id();
 
-			__layers_selected[ pCompo->get_drumkit_componentID() ] = sampleInfo;
+	// clear() keeps the capacity of the vector.
+	__layers_selected.clear();
+	for ( const auto& pCompo : *__instrument->get_components() ) {
+		SelectedLayerInfo* pSelectedLayer = get_layer_selected( pCompo->get_drumkit_componentID() );
+		if ( pSelectedLayer == nullptr ) {
+			__layers_selected.push_back( std::make_pair( pCompo->get_drumkit_componentID(),
+														 SelectedLayerInfo{ -1, 0, -1, false } ) );
+		} else {
+			pSelectedLayer->SelectedLayer = -1;
+			pSelectedLayer->SamplePosition = 0;
+			pSelectedLayer->Stream = -1;
+			pSelectedLayer->Converted = false;
 		}
 	}
 }
 
-Note::~Note()
+void Note::preallocate( int nComponents )
 {
+	if ( __adsr == nullptr ) {
+		__adsr = std::make_shared<ADSR>();
+	}
+	__layers_selected.reserve( nComponents );
+}
+
+void Note::assign( std::shared_ptr<Instrument> instrument, int position, float velocity, float pan, int length, float pitch )
+{
+	__instrument = instrument;
+	__instrument_id = 0;
+	__specific_compo_id = -1;
+	__position = position;
+	__velocity = velocity;
+	__length = length;
+	__pitch = pitch;
+	__key = C;
+	__octave = P8;
+	__lead_lag = 0.0;
+	__cut_off = 1.0;
+	__resonance = 0.0;
+	__humanize_delay = 0;
+	__bpfb_l = 0.0;
+	__bpfb_r = 0.0;
+	__lpfb_l = 0.0;
+	__lpfb_r = 0.0;
+	__pattern_idx = 0;
+	__midi_msg = -1;
+	__note_off = false;
+	__just_recorded = false;
+	__probability = 1.0f;
+
+	if ( __instrument != nullptr ) {
+		init_instrument_data();
+	} else {
+		__layers_selected.clear();
+	}
+
+	setPan( pan ); // this checks the boundaries
+}
+
+void Note::assign( Note* other, std::shared_ptr<Instrument> instrument )
+{
+	__instrument = instrument != nullptr ? instrument : other->get_instrument();
+	__instrument_id = 0;
+	__specific_compo_id = -1;
+	__position = other->get_position();
+	__velocity = other->get_velocity();
+	m_fPan = other->getPan();
+	__length = other->get_length();
+	__pitch = other->get_pitch();
+	__key = other->get_key();
+	__octave = other->get_octave();
+	__lead_lag = other->get_lead_lag();
+	__cut_off = other->get_cut_off();
+	__resonance = other->get_resonance();
+	__humanize_delay = other->get_humanize_delay();
+	__bpfb_l = other->get_bpfb_l();
+	__bpfb_r = other->get_bpfb_r();
+	__lpfb_l = other->get_lpfb_l();
+	__lpfb_r = other->get_lpfb_r();
+	__pattern_idx = other->get_pattern_idx();
+	__midi_msg = other->get_midi_msg();
+	__note_off = other->get_note_off();
+	__just_recorded = other->get_just_recorded();
+	__probability = other->get_probability();
+
+	if ( __instrument != nullptr ) {
+		init_instrument_data();
+	} else {
+		__layers_selected.clear();
+	}
 }
 
 static inline float check_boundary( float v, float min, float max )
@@ -275,8 +356,8 @@ QString Note::toQString( const QString& sPrefix, bool bShort ) const {
 			sOutput.append( QString( "%1%2%3 : selected layer: %4, sample position: %5\n" )
 							.arg( sPrefix ).arg( s + s )
 							.arg( ll.first )
-							.arg( ll.second->SelectedLayer )
-							.arg( ll.second->SamplePosition ) );
+							.arg( ll.second.SelectedLayer )
+							.arg( ll.second.SamplePosition ) );
 		}
 	} else {
 
@@ -310,8 +391,8 @@ QString Note::toQString( const QString& sPrefix, bool bShort ) const {
 		for ( auto ll : __layers_selected ) {
 			sOutput.append( QString( "%1 : selected layer: %2, sample position: %3" )
 							.arg( ll.first )
-							.arg( ll.second->SelectedLayer )
-							.arg( ll.second->SamplePosition ) );
+							.arg( ll.second.SelectedLayer )
+							.arg( ll.second.SamplePosition ) );
 		}
 	}
 	return sOutput;
@@ -24,6 +24,7 @@
 #define H2C_NOTE_H
 
 #include <memory>
+#include <vector>
 
 #include <core/Object.h>
 #include <core/Basics/Instrument.h>
@@ -60,6 +61,8 @@ class InstrumentList;
 struct SelectedLayerInfo {
 	int SelectedLayer;		///< selected layer during layer selection
 	float SamplePosition;	///< place marker for overlapping process() cycles
+	int Stream;				///< SampleStreamer stream of a streamed sample or -1
+	bool Converted;			///< whether the copy converted by the ResampleCache is played
 };
 
 /**
@@ -95,6 +98,32 @@ class Note : public H2Core::Object<Note>
 		/** destructor */
 		~Note();
 
+		/**
+		 * Reinitializes the note the same way the constructor does
+		 * but reuses the already allocated envelope and layer
+		 * selection storage.
+		 *
+		 * Used by the #NotePool to recycle notes within the audio
+		 * thread.
+		 */
+		void assign( std::shared_ptr<Instrument> instrument, int position, float velocity, float pan, int length, float pitch );
+		/**
+		 * Reinitializes the note the same way the copy constructor
+		 * does but reuses the already allocated envelope and layer
+		 * selection storage.
+		 *
+		 * \param other note to copy from
+		 * \param instrument if set will be used as note instrument
+		 */
+		void assign( Note* other, std::shared_ptr<Instrument> instrument=nullptr );
+		/**
+		 * Allocates the envelope and reserves layer selection
+		 * storage for @a nComponents components up front so
+		 * subsequent calls of assign() do not allocate memory as
+		 * long as the instrument does not exceed that number.
+		 */
+		void preallocate( int nComponents );
+
 		/*
 		 * save the note within the given XMLNode
 		 * \param node the XMLNode to feed
@@ -211,6 +240,8 @@ class Note : public H2Core::Object<Note>
 		 * selected sample
 		 * */
 		SelectedLayerInfo* get_layer_selected( int CompoID );
+		/** \return #__layers_selected of all components*/
+		std::vector< std::pair< int, SelectedLayerInfo > >* get_layers_selected();
 
 
 		void set_probability( float value );
@@ -327,7 +358,10 @@ class Note : public H2Core::Object<Note>
 		float			__cut_off;            ///< filter cutoff [0;1]
 		float			__resonance;          ///< filter resonant frequency [0;1]
 		int				__humanize_delay;       ///< used in "humanize" function
-		std::map< int, SelectedLayerInfo* > __layers_selected;
+		/** Layer selection per drumkit component ID. Stored by
+			value in a flat vector to avoid allocations when notes
+			are recycled.*/
+		std::vector< std::pair< int, SelectedLayerInfo > > __layers_selected;
 		float			__bpfb_l;             ///< left band pass filter buffer
 		float			__bpfb_r;             ///< right band pass filter buffer
 		float			__lpfb_l;             ///< left low pass filter buffer
@@ -338,6 +372,9 @@ class Note : public H2Core::Object<Note>
 		bool			__just_recorded;       ///< used in record+delete
 		float			__probability;        ///< note probability
 		static const char* __key_str[]; ///< used to build QString from #__key an #__octave
+		/** Sets up #__adsr, #__instrument_id, and
+			#__layers_selected according to #__instrument.*/
+		void init_instrument_data();
 };
 
 // DEFINITIONS
@@ -469,7 +506,17 @@ inline void Note::set_probability( float value )
 
 inline SelectedLayerInfo* Note::get_layer_selected( int CompoID )
 {
-	return __layers_selected[ CompoID ];
+	for ( auto& ll : __layers_selected ) {
+		if ( ll.first == CompoID ) {
+			return &ll.second;
+		}
+	}
+	return nullptr;
+}
+
+inline std::vector< std::pair< int, SelectedLayerInfo > >* Note::get_layers_selected()
+{
+	return &__layers_selected;
 }
 
 inline void Note::set_humanize_delay( int value )
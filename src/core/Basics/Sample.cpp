@@ -22,13 +22,17 @@
 
 
 
+#include <cmath>
 #include <limits>
 #include <memory>
 
+#include <QTemporaryDir>
+
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Basics/Sample.h>
+#include <core/Basics/SampleCache.h>
 
 #if defined(H2CORE_HAVE_RUBBERBAND) || _DOXYGEN_
 #include <rubberband/RubberBandStretcher.h>
@@ -65,9 +69,12 @@ EnvelopePoint::EnvelopePoint( const EnvelopePoint& other ) : Object(other), fram
 Sample::Sample( const QString& filepath,  int frames, int sample_rate, float* data_l, float* data_r ) 
   : __filepath( filepath ),
 	__frames( frames ),
+	__preloaded_frames( 0 ),
 	__sample_rate( sample_rate ),
 	__data_l( data_l ),
 	__data_r( data_r ),
+	__data_16_l( nullptr ),
+	__data_16_r( nullptr ),
 	__is_modified( false )
 {
 	assert( filepath.lastIndexOf( "/" ) >0 );
@@ -76,23 +83,49 @@ Sample::Sample( const QString& filepath,  int frames, int sample_rate, float* da
 Sample::Sample( std::shared_ptr<Sample> pOther ): Object( *pOther ),
 	__filepath( pOther->get_filepath() ),
 	__frames( pOther->get_frames() ),
+	__preloaded_frames( pOther->__preloaded_frames ),
 	__sample_rate( pOther->get_sample_rate() ),
 	__data_l( nullptr ),
 	__data_r( nullptr ),
+	__data_16_l( nullptr ),
+	__data_16_r( nullptr ),
 	__is_modified( pOther->get_is_modified() ),
 	__loops( pOther->__loops ),
 	__rubberband( pOther->__rubberband )
 {
-
-	__data_l = new float[__frames];
-	__data_r = new float[__frames];
+	if ( pOther->is_mapped() ) {
+		// Mapped data is never altered and can be shared. It is
+		// copied as soon as one of the samples gets modified.
+		__mapped_file = pOther->__mapped_file;
+		__data_l = pOther->__data_l;
+		__data_r = pOther->__data_r;
+	} else if ( pOther->is_compact() ) {
+		__data_16_l = new int16_t[ __frames ];
+		memcpy( __data_16_l, pOther->__data_16_l, __frames * sizeof( int16_t ) );
+		if ( pOther->is_mono() ) {
+			__data_16_r = __data_16_l;
+		} else {
+			__data_16_r = new int16_t[ __frames ];
+			memcpy( __data_16_r, pOther->__data_16_r, __frames * sizeof( int16_t ) );
+		}
+	} else {
+		// Of streamed samples only the preloaded part is copied. The
+		// copy will be streamed from the same file.
+		const int nFrames = get_preloaded_frames();
+		__data_l = new float[nFrames];
 	
-	// Since the third argument of memcpy takes the number of bytes,
-	// which are about to be copied, and the data is given in float,
-	// which are  four bytes each, the number of copied frames
-	// `__frames` has to be multiplied by four.
-	memcpy( __data_l, pOther->get_data_l(), __frames * 4 );
-	memcpy( __data_r, pOther->get_data_r(), __frames * 4 );
+		// Since the third argument of memcpy takes the number of bytes,
+		// which are about to be copied, and the data is given in float,
+		// which are  four bytes each, the number of copied frames
+		// `nFrames` has to be multiplied by four.
+		memcpy( __data_l, pOther->get_data_l(), nFrames * 4 );
+		if ( pOther->is_mono() ) {
+			__data_r = __data_l;
+		} else {
+			__data_r = new float[nFrames];
+			memcpy( __data_r, pOther->get_data_r(), nFrames * 4 );
+		}
+	}
 	
 	PanEnvelope* pPan = pOther->get_pan_envelope();
 	for( int i=0; i<pPan->size(); i++ ) {
@@ -107,12 +140,103 @@ Sample::Sample( std::shared_ptr<Sample> pOther ): Object( *pOther ),
 
 Sample::~Sample()
 {
-	if ( __data_l != nullptr ) {
-		delete[] __data_l;
+	free_data();
+}
+
+void Sample::detach_data()
+{
+	if ( __mapped_file == nullptr && ! is_compact() && ! is_mono() ) {
+		return;
+	}
+
+	const int nFrames = get_preloaded_frames();
+	float* pData_L = new float[ nFrames ];
+	float* pData_R = new float[ nFrames ];
+	if ( is_compact() ) {
+		for ( int i = 0; i < nFrames; ++i ) {
+			pData_L[ i ] = __data_16_l[ i ] * INT16_SCALE;
+			pData_R[ i ] = __data_16_r[ i ] * INT16_SCALE;
+		}
+	} else {
+		memcpy( pData_L, __data_l, nFrames * sizeof( float ) );
+		memcpy( pData_R, __data_r, nFrames * sizeof( float ) );
+	}
+
+	free_data();
+	__data_l = pData_L;
+	__data_r = pData_R;
+}
+
+/** \return Whether all @a nFrames values in @a pData can be stored
+	as 16 bit integers without loss.*/
+static bool is_int16_representable( const float* pData, int nFrames )
+{
+	for ( int i = 0; i < nFrames; ++i ) {
+		const float fValue = pData[ i ] * 32768.0f;
+		if ( fValue < -32768.0f || fValue > 32767.0f ||
+			 fValue != std::floor( fValue ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Sample::compact()
+{
+	if ( is_compact() ) {
+		return true;
+	}
+	if ( is_streamed() || __frames <= 0 ||
+		 __data_l == nullptr || __data_r == nullptr ) {
+		return false;
+	}
+
+	const bool bMono = is_mono();
+	if ( ! is_int16_representable( __data_l, __frames ) ||
+		 ( ! bMono && ! is_int16_representable( __data_r, __frames ) ) ) {
+		return false;
+	}
+
+	int16_t* pData_L = new int16_t[ __frames ];
+	for ( int i = 0; i < __frames; ++i ) {
+		pData_L[ i ] = static_cast<int16_t>( __data_l[ i ] * 32768.0f );
+	}
+	int16_t* pData_R = pData_L;
+	if ( ! bMono ) {
+		pData_R = new int16_t[ __frames ];
+		for ( int i = 0; i < __frames; ++i ) {
+			pData_R[ i ] = static_cast<int16_t>( __data_r[ i ] * 32768.0f );
+		}
+	}
+
+	free_data();
+	__data_16_l = pData_L;
+	__data_16_r = pData_R;
+
+	return true;
+}
+
+void Sample::expand()
+{
+	if ( ! is_compact() ) {
+		return;
+	}
+
+	float* pData_L = new float[ __frames ];
+	for ( int i = 0; i < __frames; ++i ) {
+		pData_L[ i ] = __data_16_l[ i ] * INT16_SCALE;
 	}
-	if ( __data_r != nullptr ) {
-		delete[] __data_r;
+	float* pData_R = pData_L;
+	if ( ! is_mono() ) {
+		pData_R = new float[ __frames ];
+		for ( int i = 0; i < __frames; ++i ) {
+			pData_R[ i ] = __data_16_r[ i ] * INT16_SCALE;
+		}
 	}
+
+	free_data();
+	__data_l = pData_L;
+	__data_r = pData_R;
 }
 
 void Sample::set_filename( const QString& filename )
@@ -123,7 +247,7 @@ void Sample::set_filename( const QString& filename )
 }
 
 
-std::shared_ptr<Sample> Sample::load( const QString& sFilepath )
+std::shared_ptr<Sample> Sample::load( const QString& sFilepath, bool bUseCache )
 {
 	std::shared_ptr<Sample> pSample;
 	
@@ -134,7 +258,7 @@ std::shared_ptr<Sample> Sample::load( const QString& sFilepath )
 
 	pSample = std::make_shared<Sample>( sFilepath );
 		
-	if( !pSample->load() ) {
+	if( !pSample->load( bUseCache ) ) {
 		pSample.reset();
 		return pSample;
 	}
@@ -144,29 +268,106 @@ std::shared_ptr<Sample> Sample::load( const QString& sFilepath )
 
 std::shared_ptr<Sample> Sample::load( const QString& filepath, const Loops& loops, const Rubberband& rubber, const VelocityEnvelope& velocity, const PanEnvelope& pan )
 {
+	const QString sProcessing = SampleCache::getProcessingKey( loops, rubber, velocity, pan,
+															   Hydrogen::get_instance()->getNewBpmJTM() );
+	if ( sProcessing.isEmpty() ) {
+		return Sample::load( filepath );
+	}
+
+	// The transformations, especially Rubber Band, are way more
+	// expensive than the decoding itself. Look up their result
+	// first.
+	const QString sCachePath = SampleCache::getCachePath( filepath, sProcessing );
+	if ( ! sCachePath.isEmpty() ) {
+		auto pCached = std::make_shared<Sample>( filepath );
+		if ( SampleCache::map( pCached.get(), sCachePath ) ) {
+			pCached->__loops = loops;
+			if ( rubber.use ) {
+				pCached->__rubberband = rubber;
+			}
+			pCached->__velocity_envelope = velocity;
+			pCached->__pan_envelope = pan;
+			pCached->__is_modified = true;
+			return pCached;
+		}
+	}
+
 	auto pSample = Sample::load( filepath );
 	
 	if( pSample ){
 		pSample->apply( loops, rubber, velocity, pan );
+
+		// Failed transformations are not stored in order to not
+		// report them as successful when loading the cached result.
+		if ( ! sCachePath.isEmpty() && pSample->__loops == loops &&
+			 ( ! rubber.use || pSample->__rubberband == rubber ) ) {
+			SampleCache::store( pSample.get(), sCachePath );
+		}
 	}
 
 	return pSample;
 }
 
+std::shared_ptr<Sample> Sample::stretch( std::shared_ptr<Sample> pSource, const Rubberband& rubber, float fBpm )
+{
+	if ( pSource == nullptr || pSource->is_streamed() ||
+		 pSource->__rubberband.use || ! rubber.use || fBpm <= 0 ) {
+		return nullptr;
+	}
+
+	const QString sCachePath =
+		SampleCache::getCachePath( pSource->__filepath,
+								   SampleCache::getProcessingKey( pSource->__loops, rubber,
+																  pSource->__velocity_envelope,
+																  pSource->__pan_envelope, fBpm ) );
+	if ( ! sCachePath.isEmpty() ) {
+		auto pCached = std::make_shared<Sample>( pSource->__filepath );
+		if ( SampleCache::map( pCached.get(), sCachePath ) ) {
+			pCached->__loops = pSource->__loops;
+			pCached->__rubberband = rubber;
+			pCached->__velocity_envelope = pSource->__velocity_envelope;
+			pCached->__pan_envelope = pSource->__pan_envelope;
+			pCached->__is_modified = true;
+			return pCached;
+		}
+	}
+
+	auto pStretched = std::make_shared<Sample>( pSource );
+#ifdef H2CORE_HAVE_RUBBERBAND
+	pStretched->apply_rubberband( rubber, fBpm );
+#else
+	pStretched->exec_rubberband_cli( rubber, fBpm );
+#endif
+	if ( ! ( pStretched->__rubberband == rubber ) ) {
+		return nullptr;
+	}
+
+	if ( ! sCachePath.isEmpty() ) {
+		SampleCache::store( pStretched.get(), sCachePath );
+	}
+
+	return pStretched;
+}
+
 void Sample::apply( const Loops& loops, const Rubberband& rubber, const VelocityEnvelope& velocity, const PanEnvelope& pan )
 {
 	apply_loops( loops );
 	apply_velocity( velocity );
 	apply_pan( pan );
 #ifdef H2CORE_HAVE_RUBBERBAND
-	apply_rubberband( rubber );
+	apply_rubberband( rubber, Hydrogen::get_instance()->getNewBpmJTM() );
 #else
-	exec_rubberband_cli( rubber );
+	exec_rubberband_cli( rubber, Hydrogen::get_instance()->getNewBpmJTM() );
 #endif
 }
 
-bool Sample::load()
+bool Sample::load( bool bUseCache )
 {
+	const QString sCachePath = bUseCache ? SampleCache::getCachePath( __filepath ) : QString();
+	if ( ! sCachePath.isEmpty() && SampleCache::map( this, sCachePath ) ) {
+		return true;
+	}
+
 	// Will contain a bunch of metadata about the loaded sample.
 	SF_INFO sound_info = {0};
 
@@ -219,13 +420,14 @@ bool Sample::load()
 
 	// Split the loaded frames into left and right channel. 
 	// If only one channels was present in the underlying data,
-	// duplicate its content.
-	__data_l = new float[ sound_info.frames ];
-	__data_r = new float[ sound_info.frames ];
+	// both channels share the same buffer.
 	if ( sound_info.channels == 1 ) {
-		memcpy( __data_l, buffer, __frames * sizeof( float ) );
-		memcpy( __data_r, buffer, __frames * sizeof( float ) );
+		__data_l = buffer;
+		__data_r = buffer;
+		buffer = nullptr;
 	} else if ( sound_info.channels == SAMPLE_CHANNELS ) {
+		__data_l = new float[ sound_info.frames ];
+		__data_r = new float[ sound_info.frames ];
 		for ( int i = 0; i < __frames; i++ ) {
 			__data_l[i] = buffer[i * SAMPLE_CHANNELS ];
 			__data_r[i] = buffer[i * SAMPLE_CHANNELS + 1 ];
@@ -233,6 +435,65 @@ bool Sample::load()
 	}
 	delete[] buffer;
 
+	if ( ! sCachePath.isEmpty() ) {
+		SampleCache::store( this, sCachePath );
+	}
+
+	return true;
+}
+
+bool Sample::load_streamed( int nPreloadMs )
+{
+	SF_INFO sound_info = {0};
+	SNDFILE* file = sf_open( __filepath.toLocal8Bit(), SFM_READ, &sound_info );
+	if ( !file ) {
+		ERRORLOG( QString( "Error loading file %1" ).arg( __filepath ) );
+		return false;
+	}
+
+	const sf_count_t nPreloadFrames =
+		static_cast<sf_count_t>( nPreloadMs ) * sound_info.samplerate / 1000;
+
+	// Streaming short samples would save only little memory while
+	// occupying a stream during playback.
+	if ( nPreloadFrames <= 0 || sound_info.frames <= 2 * nPreloadFrames ||
+		 sound_info.frames > std::numeric_limits<int>::max() ||
+		 sound_info.channels > SAMPLE_CHANNELS ) {
+		sf_close( file );
+		return load();
+	}
+
+	float* buffer = new float[ nPreloadFrames * sound_info.channels ];
+	sf_count_t count = sf_readf_float( file, buffer, nPreloadFrames );
+	if ( sf_close( file ) != 0 ){
+		WARNINGLOG( QString( "Unable to close sample file %1" ).arg( __filepath ) );
+	}
+	if ( count != nPreloadFrames ) {
+		WARNINGLOG( QString( "Unable to preload %1. Loading it completely." ).arg( __filepath ) );
+		delete[] buffer;
+		return load();
+	}
+
+	unload();
+
+	__frames = sound_info.frames;
+	__preloaded_frames = nPreloadFrames;
+	__sample_rate = sound_info.samplerate;
+
+	if ( sound_info.channels == 1 ) {
+		__data_l = buffer;
+		__data_r = buffer;
+		buffer = nullptr;
+	} else {
+		__data_l = new float[ __preloaded_frames ];
+		__data_r = new float[ __preloaded_frames ];
+		for ( int i = 0; i < __preloaded_frames; i++ ) {
+			__data_l[i] = buffer[i * SAMPLE_CHANNELS ];
+			__data_r[i] = buffer[i * SAMPLE_CHANNELS + 1 ];
+		}
+	}
+	delete[] buffer;
+
 	return true;
 }
 
@@ -263,6 +524,8 @@ bool Sample::apply_loops( const Loops& lo )
 	}
 	//if( lo == __loops ) return true;
 
+	expand();
+
 	bool full_loop = lo.start_frame==lo.loop_frame;
 	int full_length =  lo.end_frame - lo.start_frame;
 	int loop_length =  lo.end_frame - lo.loop_frame;
@@ -326,8 +589,7 @@ bool Sample::apply_loops( const Loops& lo )
 		assert( x==new_length );
 	}
 	__loops = lo;
-	delete[] __data_l;
-	delete[] __data_r;
+	free_data();
 	__data_l = new_data_l;
 	__data_r = new_data_r;
 	__frames = new_length;
@@ -348,6 +610,7 @@ void Sample::apply_velocity( const VelocityEnvelope& v )
 	
 	__velocity_envelope.clear();
 	if ( v.size() > 0 ) {
+		detach_data();
 		float inv_resolution = __frames / 841.0F;
 		for ( int i = 1; i < v.size(); i++ ) {
 			float y = ( 91 - v[i - 1].value ) / 91.0F;
@@ -383,6 +646,7 @@ void Sample::apply_pan( const PanEnvelope& p )
 	
 	__pan_envelope.clear();
 	if ( p.size() > 0 ) {
+		detach_data();
 		float inv_resolution = __frames / 841.0F;
 		for ( int i = 1; i < p.size(); i++ ) {
 			float y = ( 45 - p[i - 1].value ) / 45.0F;
@@ -419,15 +683,16 @@ void Sample::apply_pan( const PanEnvelope& p )
 	__is_modified = true;
 }
 
-void Sample::apply_rubberband( const Rubberband& rb )
+void Sample::apply_rubberband( const Rubberband& rb, float fBpm )
 {
 	// TODO see Rubberband declaration in sample.h
 #ifdef H2CORE_HAVE_RUBBERBAND
-	if( !rb.use ){
+	if( !rb.use || fBpm <= 0 ){
 		return;
 	}
+	expand();
 	// compute rubberband options
-	double output_duration = 60.0 / Hydrogen::get_instance()->getNewBpmJTM() * rb.divider;
+	double output_duration = 60.0 / fBpm * rb.divider;
 	double time_ratio = output_duration / get_sample_duration();
 	RubberBand::RubberBandStretcher::Options options = compute_rubberband_options( rb );
 	double pitch_scale = compute_pitch_scale( rb );
@@ -570,8 +835,7 @@ void Sample::apply_rubberband( const Rubberband& rb )
 		retrieved += n;
 	}
 	
-	delete [] __data_l;
-	delete [] __data_r;
+	free_data();
 	__data_l = new float[ retrieved ];
 	__data_r = new float[ retrieved ];
 	memcpy( __data_l, out_data_l, retrieved*sizeof( float ) );
@@ -586,7 +850,7 @@ void Sample::apply_rubberband( const Rubberband& rb )
 #endif
 }
 
-bool Sample::exec_rubberband_cli( const Rubberband& rb )
+bool Sample::exec_rubberband_cli( const Rubberband& rb, float fBpm )
 {
 	//set the path to rubberband-cli
 	QString program = Preferences::get_instance()->m_rubberBandCLIexecutable;
@@ -596,8 +860,14 @@ bool Sample::exec_rubberband_cli( const Rubberband& rb )
 		return false;
 	}
 
-	if( rb.use ) {
-		QString outfilePath =  QDir::tempPath() + "/tmp_rb_outfile.wav";
+	if( rb.use && fBpm > 0 ) {
+		// Several samples might be stretched in parallel.
+		QTemporaryDir tmpDir;
+		if ( ! tmpDir.isValid() ) {
+			ERRORLOG( "unable to create temporary folder" );
+			return false;
+		}
+		QString outfilePath = tmpDir.filePath( "tmp_rb_outfile.wav" );
 		if( !write( outfilePath ) ) {
 			ERRORLOG( "unable to write sample" );
 			return false;
@@ -605,7 +875,7 @@ bool Sample::exec_rubberband_cli( const Rubberband& rb )
 
 		unsigned rubberoutframes = 0;
 		double ratio = 1.0;
-		double durationtime = 60.0 / Hydrogen::get_instance()->getNewBpmJTM() * rb.divider/*beats*/;
+		double durationtime = 60.0 / fBpm * rb.divider/*beats*/;
 		double induration = get_sample_duration();
 		if ( induration != 0.0 ) {
 			ratio = durationtime / induration;
@@ -621,7 +891,7 @@ bool Sample::exec_rubberband_cli( const Rubberband& rb )
 		QString rCs = QString( " %1" ).arg( rb.c_settings );
 		float pitch = pow( 1.0594630943593, ( double )rb.pitch );
 		QString rPs = QString( " %1" ).arg( pitch );
-		QString rubberResultPath = QDir::tempPath() + "/tmp_rb_result_file.wav";
+		QString rubberResultPath = tmpDir.filePath( "tmp_rb_result_file.wav" );
 
 		arguments << "-D" << QString( " %1" ).arg( durationtime ) 	//stretch or squash to make output file X seconds long
 		          << "--threads"					//assume multi-CPU even if only one CPU is identified
@@ -655,6 +925,8 @@ bool Sample::exec_rubberband_cli( const Rubberband& rb )
 
 		__frames = p_Rubberbanded->get_frames();
 
+		p_Rubberbanded->detach_data();
+		free_data();
 		__data_l = p_Rubberbanded->get_data_l();
 		__data_r = p_Rubberbanded->get_data_r();
 		p_Rubberbanded->__data_l = nullptr;
@@ -681,10 +953,25 @@ Sample::Loops::LoopMode Sample::parse_loop_mode( const QString& sMode )
 
 bool Sample::write( const QString& path, int format )
 {
+	if ( is_streamed() ) {
+		// Only the beginning of the sample is held in memory.
+		auto pFullSample = Sample::load( __filepath );
+		if ( pFullSample == nullptr ) {
+			return false;
+		}
+		return pFullSample->write( path, format );
+	}
+
 	float* obuf = new float[ SAMPLE_CHANNELS * __frames ];
 	for ( int i = 0; i < __frames; ++i ) {
-		float value_l = __data_l[i];
-		float value_r = __data_r[i];
+		float value_l, value_r;
+		if ( is_compact() ) {
+			value_l = __data_16_l[i] * INT16_SCALE;
+			value_r = __data_16_r[i] * INT16_SCALE;
+		} else {
+			value_l = __data_l[i];
+			value_r = __data_r[i];
+		}
 		
 		if ( value_l > 1.f ) {
 			value_l = 1.f;
@@ -23,12 +23,15 @@
 #ifndef H2C_SAMPLE_H
 #define H2C_SAMPLE_H
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <sndfile.h>
 
 #include <core/Object.h>
 
+class QFile;
+
 namespace H2Core
 {
 
@@ -68,6 +71,10 @@ class Sample : public H2Core::Object<Sample>
 		H2_OBJECT(Sample)
 	public:
 
+		/** Factor converting the values of compact samples into
+		 * floating point values in [-1, 1). */
+		static constexpr float INT16_SCALE = 1.0f / 32768.0f;
+
 		/** define the type used to store pan envelope points */
 		using PanEnvelope = std::vector<EnvelopePoint>;
 		/** define the type used to store velocity envelope points */
@@ -158,14 +165,16 @@ class Sample : public H2Core::Object<Sample>
 		 * load() member on it.
 		 *
 		 * \param filepath the file to load audio data from
+		 * \param bUseCache Whether the SampleCache is used. Should
+		 *   be false for one-off loads, like previews.
 		 *
 		 * \return Pointer to the newly initialized Sample. If
 		 * the provided @a filepath is not readable, a nullptr
 		 * is returned instead.
 		 *
-		 * \fn load(const QString& filepath)
+		 * \fn load(const QString& filepath, bool bUseCache)
 		 */
-		static std::shared_ptr<Sample> load( const QString& filepath);
+		static std::shared_ptr<Sample> load( const QString& filepath, bool bUseCache = true );
 	
 		/**
 		 * Load a sample from a file and apply the
@@ -174,7 +183,8 @@ class Sample : public H2Core::Object<Sample>
 		 * Wrapper around #load(const QString& filepath),
 		 * which calls apply() with @a loops, @a rubber, @a
 		 * velocity, and @a pan as arguments after
-		 * successfully loading the sample.
+		 * successfully loading the sample. The processed
+		 * sample is stored in the SampleCache as well.
 		 *
 		 * \param filepath the file to load audio data from
 		 * \param loops transformation parameters
@@ -189,6 +199,24 @@ class Sample : public H2Core::Object<Sample>
 		 * \overload load(const QString& filepath, const Loops& loops, const Rubberband& rubber, const VelocityEnvelope& velocity, const PanEnvelope& pan)
 		 */
 		static std::shared_ptr<Sample> load( const QString& filepath, const Loops& loops, const Rubberband& rubber, const VelocityEnvelope& velocity, const PanEnvelope& pan );
+		/**
+		 * Creates a copy of @a pSource stretched by Rubber Band to
+		 * the length @a rubber specifies at tempo @a fBpm.
+		 *
+		 * Just like load() the result is looked up in and stored to
+		 * the SampleCache. Since neither @a pSource nor any global
+		 * state is altered, several samples can be stretched in
+		 * parallel.
+		 *
+		 * \param pSource Sample with loops and envelopes applied
+		 * but not stretched yet.
+		 * \param rubber Rubber Band parameters. Has to be enabled.
+		 * \param fBpm Tempo the length of the result is based on.
+		 *
+		 * \return Stretched sample or nullptr if @a pSource is
+		 * streamed or already stretched or Rubber Band failed.
+		 */
+		static std::shared_ptr<Sample> stretch( std::shared_ptr<Sample> pSource, const Rubberband& rubber, float fBpm );
 
 		/**
 		 * Load the sample stored in #__filepath into
@@ -204,16 +232,37 @@ class Sample : public H2Core::Object<Sample>
 		 * content but simply extract the first two channels
 		 * and display a warning message. For mono file the
 		 * same content will be assigned to both the left
-		 * (#__data_l) and right channel (#__data_r).
+		 * (#__data_l) and right channel (#__data_r). Both
+		 * point to the same buffer, see is_mono().
 		 *
 		 * If the total number of frames in the file is larger
 		 * than the maximum value of an `int', the content is
 		 * truncated and a warning log message will be
 		 * displayed.
 		 *
-		 * \fn load()
+		 * Unless @a bUseCache is false, the decoded content is
+		 * stored in the SampleCache. Subsequent loads of the
+		 * unchanged file map the cached data instead of decoding it
+		 * again.
+		 *
+		 * \fn load(bool bUseCache)
+		 */
+		bool load( bool bUseCache = true );
+		/**
+		 * Load only the beginning of the sample stored in
+		 * #__filepath into #__data_l and #__data_r.
+		 *
+		 * #__frames is set to the length of the whole file
+		 * while only the first #__preloaded_frames frames are
+		 * held in memory. The remainder has to be read by the
+		 * SampleStreamer during playback. Samples not
+		 * considerably longer than @a nPreloadMs are loaded
+		 * completely using load().
+		 *
+		 * \param nPreloadMs Length of the part kept in memory
+		 *   in milliseconds.
 		 */
-		bool load();
+		bool load_streamed( int nPreloadMs );
 		/**
 		 * Flush the current content of the left and right
 		 * channel and the current metadata.
@@ -258,16 +307,53 @@ class Sample : public H2Core::Object<Sample>
 		/**
 		 * apply rubberband transformation to the sample
 		 * \param rb rubberband parameters
+		 * \param fBpm tempo the length of the result is based on
 		 */
-		void apply_rubberband( const Rubberband& rb );
+		void apply_rubberband( const Rubberband& rb, float fBpm );
 		/**
 		 * call rubberband cli to modify the sample
 		 * \param rb rubberband parameters
+		 * \param fBpm tempo the length of the result is based on
+		 */
+		bool exec_rubberband_cli( const Rubberband& rb, float fBpm );
+
+		/**
+		 * Converts the sample data into 16 bit integers held in
+		 * #__data_16_l and #__data_16_r, which halves the memory
+		 * required.
+		 *
+		 * The conversion is only done if it is lossless. This is
+		 * the case for all samples loaded from 16 bit files and
+		 * not altered afterwards. Streamed samples are not
+		 * converted.
+		 *
+		 * Compact samples do not provide #__data_l and #__data_r.
+		 * Use get_data_16_l() and get_data_16_r() or call expand()
+		 * on a copy instead.
+		 *
+		 * \return true if the sample is compact afterwards.
 		 */
-		bool exec_rubberband_cli( const Rubberband& rb );
+		bool compact();
+		/** Converts the data of a compact sample back into
+		 * #__data_l and #__data_r. Must not be called on a sample
+		 * currently rendered by the Sampler. */
+		void expand();
 
-		/** \return true if both data channels are null pointers */
+		/** \return true if neither float nor compact data is held */
 		bool is_empty() const;
+		/** \return true if the data is stored as 16 bit integers,
+		 * see compact(). */
+		bool is_compact() const;
+		/** \return true if the left and right channel share the
+		 * same buffer. This is the case for samples loaded from
+		 * mono files. */
+		bool is_mono() const;
+		/** \return true if only the beginning of the sample is held
+		 * in memory, see load_streamed(). */
+		bool is_streamed() const;
+		/** \return number of frames held in #__data_l and
+		 * #__data_r. */
+		int get_preloaded_frames() const;
 		/** \return #__filepath */
 		const QString get_filepath() const;
 		/** \return Filename part of #__filepath */
@@ -294,10 +380,23 @@ class Sample : public H2Core::Object<Sample>
 		 * #__frames time sizeof( float ) * 2 
 		 */
 		int get_size() const;
-		/** \return #__data_l*/
+		/** \return #__data_l. Read-only if the sample is backed by
+		 * the SampleCache, see is_mapped(), or if it is mono, see
+		 * is_mono(). nullptr for compact samples.*/
 		float* get_data_l() const;
-		/** \return #__data_r*/
+		/** \return #__data_r. Read-only if the sample is backed by
+		 * the SampleCache, see is_mapped(), or if it is mono, see
+		 * is_mono(). nullptr for compact samples.*/
 		float* get_data_r() const;
+		/** \return #__data_16_l. Values have to be scaled by
+		 * #INT16_SCALE. nullptr unless the sample is compact.*/
+		const int16_t* get_data_16_l() const;
+		/** \return #__data_16_r. Values have to be scaled by
+		 * #INT16_SCALE. nullptr unless the sample is compact.*/
+		const int16_t* get_data_16_r() const;
+		/** \return true if #__data_l and #__data_r point into a
+		 * memory-mapped file of the SampleCache. */
+		bool is_mapped() const;
 		/**
 		 * #__is_modified setter
 		 * \param value the new value for #__is_modified
@@ -330,11 +429,25 @@ class Sample : public H2Core::Object<Sample>
 		 * \return String presentation of current object.*/
 		QString toQString( const QString& sPrefix, bool bShort = true ) const override;
 	private:
+		friend class SampleCache;
+
+		/** Frees #__data_l and #__data_r, #__data_16_l and
+		 * #__data_16_r, or releases the mapping backing them.*/
+		void free_data();
+		/** Copies mapped, mono, or compact data into two separate
+		 * float buffers owned by the sample. Has to be called
+		 * before altering #__data_l or #__data_r.*/
+		void detach_data();
+
 		QString				__filepath;          ///< filepath of the sample
 		int					__frames;            ///< number of frames in this sample
+		int					__preloaded_frames;  ///< number of frames held in memory if streamed, 0 otherwise
 		int					__sample_rate;       ///< samplerate for this sample
 		float*				__data_l;            ///< left channel data
 		float*				__data_r;            ///< right channel data
+		int16_t*			__data_16_l;         ///< left channel data of compact samples
+		int16_t*			__data_16_r;         ///< right channel data of compact samples
+		std::shared_ptr<QFile>	__mapped_file;   ///< cache file backing the data, see SampleCache
 		bool				__is_modified;       ///< true if sample is modified
 		PanEnvelope			__pan_envelope;      ///< pan envelope vector
 		VelocityEnvelope	__velocity_envelope; ///< velocity envelope vector
@@ -346,25 +459,68 @@ class Sample : public H2Core::Object<Sample>
 
 // DEFINITIONS
 
-inline void Sample::unload()
+inline void Sample::free_data()
 {
-	if ( __data_l != nullptr ) {
-		delete [] __data_l;
-	}
-	
-	if ( __data_r != nullptr ) {
-		delete [] __data_r;
+	if ( __mapped_file != nullptr ) {
+		// The mapping is released along with the last sample
+		// referencing it.
+		__mapped_file = nullptr;
+	} else {
+		// Mono samples share a single buffer.
+		if ( __data_r != nullptr && __data_r != __data_l ) {
+			delete [] __data_r;
+		}
+		if ( __data_l != nullptr ) {
+			delete [] __data_l;
+		}
+		if ( __data_16_r != nullptr && __data_16_r != __data_16_l ) {
+			delete [] __data_16_r;
+		}
+		if ( __data_16_l != nullptr ) {
+			delete [] __data_16_l;
+		}
 	}
-	__frames = __sample_rate = 0;
+	__data_l = __data_r = nullptr;
+	__data_16_l = __data_16_r = nullptr;
+}
+
+inline void Sample::unload()
+{
+	free_data();
+	__frames = __sample_rate = __preloaded_frames = 0;
 	/** #__is_modified = false; leave this unchanged as pan,
 	    velocity, loop and rubberband are kept unchanged */
-
-	__data_l = __data_r = nullptr;
 }
 
 inline bool Sample::is_empty() const
 {
-	return ( __data_l == 0 && __data_r == 0 );
+	return ( __data_l == 0 && __data_r == 0 && __data_16_l == 0 );
+}
+
+inline bool Sample::is_compact() const
+{
+	return __data_16_l != nullptr;
+}
+
+inline bool Sample::is_mono() const
+{
+	return is_compact() ? __data_16_l == __data_16_r :
+		( __data_l != nullptr && __data_l == __data_r );
+}
+
+inline bool Sample::is_mapped() const
+{
+	return __mapped_file != nullptr;
+}
+
+inline bool Sample::is_streamed() const
+{
+	return __preloaded_frames > 0;
+}
+
+inline int Sample::get_preloaded_frames() const
+{
+	return is_streamed() ? __preloaded_frames : __frames;
 }
 
 inline const QString Sample::get_filepath() const
@@ -417,6 +573,16 @@ inline float* Sample::get_data_r() const
 	return __data_r;
 }
 
+inline const int16_t* Sample::get_data_16_l() const
+{
+	return __data_16_l;
+}
+
+inline const int16_t* Sample::get_data_16_r() const
+{
+	return __data_16_r;
+}
+
 inline void Sample::set_is_modified( bool is_modified )
 {
 	__is_modified = is_modified;
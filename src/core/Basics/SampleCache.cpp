@@ -0,0 +1,286 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Basics/SampleCache.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Preferences/Preferences.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace H2Core
+{
+
+static const char* CACHE_MAGIC = "H2SC";
+
+static_assert( sizeof( SampleCache::Header ) == 64, "Sample data has to stay aligned" );
+
+std::mutex SampleCache::s_mutex;
+qint64 SampleCache::s_nSize = -1;
+
+/** \return Folder holding the cache files.*/
+static QString getCacheDir()
+{
+	return QDir( Filesystem::cache_dir() ).filePath( "samples" );
+}
+
+QString SampleCache::getCachePath( const QString& sFilepath, const QString& sProcessing )
+{
+	if ( ! Preferences::get_instance()->m_bUseSampleCache ) {
+		return "";
+	}
+
+	QFileInfo info( sFilepath );
+	if ( ! info.exists() ) {
+		return "";
+	}
+
+	// Neither temporary files, like the ones exchanged with the
+	// Rubber Band CLI, nor files of the cache itself are worth
+	// caching.
+	const QString sAbsolutePath = info.absoluteFilePath();
+	if ( sAbsolutePath.startsWith( QDir( QDir::tempPath() ).absolutePath() + "/" ) ||
+		 sAbsolutePath.startsWith( QDir( Filesystem::cache_dir() ).absolutePath() + "/" ) ) {
+		return "";
+	}
+
+	const QString sKey = QString( "%1|%2|%3|%4|%5" )
+		.arg( sAbsolutePath )
+		.arg( info.size() )
+		.arg( info.lastModified().toMSecsSinceEpoch() )
+		.arg( VERSION )
+		.arg( sProcessing );
+	const QString sHash = QCryptographicHash::hash( sKey.toUtf8(),
+													QCryptographicHash::Sha1 ).toHex();
+
+	return QDir( getCacheDir() ).filePath( QString( "%1.h2s" ).arg( sHash ) );
+}
+
+QString SampleCache::getProcessingKey( const Sample::Loops& loops,
+									   const Sample::Rubberband& rubber,
+									   const Sample::VelocityEnvelope& velocity,
+									   const Sample::PanEnvelope& pan,
+									   float fBpm )
+{
+	QStringList processing;
+
+	if ( ! ( loops == Sample::Loops() ) ) {
+		processing << QString( "loops:%1,%2,%3,%4,%5" )
+			.arg( loops.start_frame ).arg( loops.loop_frame )
+			.arg( loops.end_frame ).arg( loops.count )
+			.arg( static_cast<int>( loops.mode ) );
+	}
+
+	if ( ! velocity.empty() ) {
+		QString sVelocity( "velocity:" );
+		for ( const auto& point : velocity ) {
+			sVelocity.append( QString( "%1,%2;" ).arg( point.frame ).arg( point.value ) );
+		}
+		processing << sVelocity;
+	}
+
+	if ( ! pan.empty() ) {
+		QString sPan( "pan:" );
+		for ( const auto& point : pan ) {
+			sPan.append( QString( "%1,%2;" ).arg( point.frame ).arg( point.value ) );
+		}
+		processing << sPan;
+	}
+
+	if ( rubber.use ) {
+		// The length of the stretched sample depends on the current
+		// tempo.
+		processing << QString( "rubberband:%1,%2,%3,%4" )
+			.arg( rubber.divider, 0, 'g', 9 )
+			.arg( rubber.pitch, 0, 'g', 9 )
+			.arg( rubber.c_settings )
+			.arg( fBpm, 0, 'g', 9 );
+#ifdef H2CORE_HAVE_RUBBERBAND
+		processing << QString( "library:%1" )
+			.arg( Preferences::get_instance()->getRubberBandBatchMode() );
+#else
+		processing << "cli";
+#endif
+	}
+
+	return processing.join( "|" );
+}
+
+bool SampleCache::map( Sample* pSample, const QString& sCachePath )
+{
+	auto pFile = std::make_shared<QFile>( sCachePath );
+	if ( ! pFile->exists() || ! pFile->open( QIODevice::ReadOnly ) ) {
+		return false;
+	}
+
+	const qint64 nSize = pFile->size();
+	if ( nSize < static_cast<qint64>( sizeof( Header ) ) ) {
+		WARNINGLOG( QString( "Invalid cache file [%1]" ).arg( sCachePath ) );
+		return false;
+	}
+
+	uchar* pData = pFile->map( 0, nSize );
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 10, 0 )
+	// Used by prune() to find the least recently used files.
+	pFile->setFileTime( QDateTime::currentDateTime(), QFileDevice::FileModificationTime );
+#endif
+	// The mapping stays valid after closing the file. Keeping one
+	// file descriptor open per sample would exceed the limit of the
+	// system for large drumkits.
+	pFile->close();
+	if ( pData == nullptr ) {
+		WARNINGLOG( QString( "Unable to map [%1]: %2" )
+					.arg( sCachePath ).arg( pFile->errorString() ) );
+		return false;
+	}
+
+	Header header;
+	memcpy( &header, pData, sizeof( Header ) );
+	if ( memcmp( header.magic, CACHE_MAGIC, sizeof( header.magic ) ) != 0 ||
+		 header.version != VERSION || header.frames <= 0 ||
+		 header.sample_rate <= 0 ||
+		 ( header.channels != 1 && header.channels != 2 ) ||
+		 nSize != static_cast<qint64>( sizeof( Header ) ) +
+		 header.channels * static_cast<qint64>( header.frames ) * sizeof( float ) ) {
+		WARNINGLOG( QString( "Invalid cache file [%1]" ).arg( sCachePath ) );
+		return false;
+	}
+
+	// Touch all pages right away. Otherwise the audio thread would
+	// fault them in during playback.
+	volatile uchar nSum = 0;
+	for ( qint64 nn = 0; nn < nSize; nn += 4096 ) {
+		nSum += pData[ nn ];
+	}
+
+	pSample->unload();
+	pSample->__frames = header.frames;
+	pSample->__sample_rate = header.sample_rate;
+	pSample->__data_l = reinterpret_cast<float*>( pData + sizeof( Header ) );
+	pSample->__data_r = header.channels == 1 ? pSample->__data_l :
+		pSample->__data_l + header.frames;
+	pSample->__mapped_file = pFile;
+
+	return true;
+}
+
+bool SampleCache::store( const Sample* pSample, const QString& sCachePath )
+{
+	if ( pSample == nullptr || pSample->is_streamed() ||
+		 pSample->is_compact() ||
+		 pSample->__frames <= 0 || pSample->__data_l == nullptr ||
+		 pSample->__data_r == nullptr ) {
+		return false;
+	}
+
+	QDir().mkpath( QFileInfo( sCachePath ).absolutePath() );
+
+	// QSaveFile writes to a temporary file and renames it on
+	// commit. Other instances mapping a previous version of the
+	// file will never see a truncated one.
+	QSaveFile file( sCachePath );
+	if ( ! file.open( QIODevice::WriteOnly ) ) {
+		WARNINGLOG( QString( "Unable to write [%1]: %2" )
+					.arg( sCachePath ).arg( file.errorString() ) );
+		return false;
+	}
+
+	Header header;
+	memset( &header, 0, sizeof( Header ) );
+	memcpy( header.magic, CACHE_MAGIC, sizeof( header.magic ) );
+	header.version = VERSION;
+	header.frames = pSample->__frames;
+	header.sample_rate = pSample->__sample_rate;
+	header.channels = pSample->is_mono() ? 1 : 2;
+
+	const qint64 nBytes = static_cast<qint64>( pSample->__frames ) * sizeof( float );
+	if ( file.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) ) != sizeof( Header ) ||
+		 file.write( reinterpret_cast<const char*>( pSample->__data_l ), nBytes ) != nBytes ||
+		 ( header.channels == 2 &&
+		   file.write( reinterpret_cast<const char*>( pSample->__data_r ), nBytes ) != nBytes ) ||
+		 ! file.commit() ) {
+		WARNINGLOG( QString( "Unable to store [%1]: %2" )
+					.arg( sCachePath ).arg( file.errorString() ) );
+		return false;
+	}
+
+	const qint64 nMaxBytes =
+		static_cast<qint64>( Preferences::get_instance()->m_nSampleCacheSize ) * 1024 * 1024;
+	bool bPrune;
+	{
+		std::lock_guard<std::mutex> lock( s_mutex );
+		if ( s_nSize >= 0 ) {
+			s_nSize += sizeof( Header ) + header.channels * nBytes;
+		}
+		bPrune = s_nSize < 0 || s_nSize > nMaxBytes;
+	}
+	if ( bPrune ) {
+		prune( nMaxBytes );
+	}
+
+	return true;
+}
+
+qint64 SampleCache::prune( qint64 nMaxBytes )
+{
+	std::lock_guard<std::mutex> lock( s_mutex );
+
+	// Most recently used files first.
+	const QFileInfoList files = QDir( getCacheDir() ).entryInfoList(
+		QStringList( "*.h2s" ), QDir::Files, QDir::Time );
+
+	qint64 nSize = 0;
+	for ( const auto& info : files ) {
+		nSize += info.size();
+	}
+
+	if ( nSize > nMaxBytes ) {
+		const qint64 nTarget = nMaxBytes / 10 * 9;
+		nSize = 0;
+		int nRemoved = 0;
+		bool bFull = false;
+		for ( const auto& info : files ) {
+			bFull = bFull || nSize + info.size() > nTarget;
+			if ( ! bFull ) {
+				nSize += info.size();
+			} else if ( QFile::remove( info.absoluteFilePath() ) ) {
+				++nRemoved;
+			} else {
+				// Might still be opened by another process.
+				nSize += info.size();
+			}
+		}
+		INFOLOG( QString( "Removed %1 files from the sample cache. %2 MB remaining" )
+				 .arg( nRemoved ).arg( nSize / 1024 / 1024 ) );
+	}
+
+	s_nSize = nSize;
+	return nSize;
+}
+
+};
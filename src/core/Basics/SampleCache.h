@@ -0,0 +1,143 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef H2C_SAMPLE_CACHE_H
+#define H2C_SAMPLE_CACHE_H
+
+#include <core/Object.h>
+#include <core/Basics/Sample.h>
+
+#include <mutex>
+
+namespace H2Core
+{
+
+/**
+ * On-disk cache of decoded samples.
+ *
+ * Decoding a sample file with libsndfile, splitting its channels,
+ * and applying loops, envelopes, or Rubber Band takes a considerable
+ * amount of time for large drumkits. The result of these steps is
+ * stored in a subfolder of Filesystem::cache_dir() as plain,
+ * de-interleaved 32 bit floats preceded by a small #Header. Mono
+ * samples are stored as a single channel. Further
+ * loads map the file read-only into memory and let the #Sample point
+ * directly into the mapping instead of decoding it again. Since the
+ * mapping is shared, several instances of Hydrogen using the same
+ * sample share the same pages of the operating system's cache.
+ *
+ * The name of a cache file is derived from the path, size, and
+ * modification time of the original file as well as all parameters
+ * of its processing. Modifying the original file thus results in a
+ * new entry. Files are written to a temporary location first and
+ * moved into place afterwards. Existing entries are never altered
+ * and can safely be mapped by other processes.
+ *
+ * The cache can be disabled using Preferences::m_bUseSampleCache.
+ * Once it exceeds Preferences::m_nSampleCacheSize megabytes, the
+ * least recently used files are removed. This also takes care of
+ * entries whose original file was changed or removed.
+ *
+ * \ingroup docCore
+ */
+class SampleCache : public H2Core::Object<SampleCache>
+{
+	H2_OBJECT(SampleCache)
+public:
+	/** Version of the file format. Increment it whenever the layout
+		of the files or the processing of the samples changes.*/
+	static constexpr int VERSION = 2;
+
+	/** Leading part of each cache file.*/
+	struct Header {
+		char magic[ 4 ];
+		qint32 version;
+		qint32 frames;
+		qint32 sample_rate;
+		/** 1 for samples sharing a single buffer for both
+			channels (see Sample::is_mono()), 2 otherwise.*/
+		qint32 channels;
+		/** Pads the header to 64 bytes to align the sample data.*/
+		char reserved[ 44 ];
+	};
+
+	/**
+	 * \param sFilepath Sample file.
+	 * \param sProcessing Key returned by getProcessingKey(). Empty
+	 *   for the unprocessed content of the file.
+	 *
+	 * \return Absolute path of the cache file corresponding to @a
+	 * sFilepath. An empty string is returned for files which do not
+	 * exist or are temporary, for files located in the cache itself,
+	 * and if the cache is disabled.
+	 */
+	static QString getCachePath( const QString& sFilepath, const QString& sProcessing = "" );
+	/**
+	 * \param fBpm Tempo the length of a stretched sample is based
+	 *   on. Only used if @a rubber is enabled.
+	 *
+	 * \return String uniquely describing the transformations
+	 * Sample::apply() performs for the provided parameters. Empty if
+	 * none of them alters the sample.
+	 */
+	static QString getProcessingKey( const Sample::Loops& loops,
+									 const Sample::Rubberband& rubber,
+									 const Sample::VelocityEnvelope& velocity,
+									 const Sample::PanEnvelope& pan,
+									 float fBpm );
+
+	/**
+	 * Maps the cache file @a sCachePath into memory and assigns its
+	 * content to @a pSample. The modification time of the file is
+	 * updated to mark it as recently used.
+	 *
+	 * \return Whether the file exists and is valid. On failure @a
+	 * pSample is left unchanged.
+	 */
+	static bool map( Sample* pSample, const QString& sCachePath );
+	/**
+	 * Writes the content of @a pSample to @a sCachePath and calls
+	 * prune() in case the cache grew too large.
+	 *
+	 * \return Whether the file could be written. Compact samples
+	 * (see Sample::compact()) are not stored.
+	 */
+	static bool store( const Sample* pSample, const QString& sCachePath );
+	/**
+	 * Removes the least recently used files in case the cache
+	 * exceeds @a nMaxBytes until it fills less than 90 percent of
+	 * it.
+	 *
+	 * \return Size of the remaining files in bytes.
+	 */
+	static qint64 prune( qint64 nMaxBytes );
+
+private:
+	/** Guards #s_nSize and prune().*/
+	static std::mutex s_mutex;
+	/** Total size of all files in the cache in bytes. -1 until the
+		cache folder was scanned by prune().*/
+	static qint64 s_nSize;
+};
+
+};
+
+#endif // H2C_SAMPLE_CACHE_H
@@ -0,0 +1,105 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Basics/SampleLoader.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/Sample.h>
+#include <core/EventQueue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace H2Core
+{
+
+bool SampleLoader::loadComponents( const std::vector<std::shared_ptr<InstrumentComponent>>& components,
+								   bool bUseCache )
+{
+	std::vector<std::shared_ptr<InstrumentLayer>> layers;
+	for ( const auto& pComponent : components ) {
+		for ( int nLayer = 0; nLayer < InstrumentComponent::getMaxLayers(); ++nLayer ) {
+			auto pLayer = pComponent->get_layer( nLayer );
+			if ( pLayer != nullptr ) {
+				layers.push_back( pLayer );
+			}
+		}
+	}
+
+	std::atomic<bool> bSuccess( true );
+	run( layers.size(), [&]( int nLayer ) {
+		auto pLayer = layers[ nLayer ];
+		if ( pLayer->get_sample() == nullptr ) {
+			return;
+		}
+		if ( ! pLayer->load_sample( bUseCache ) ) {
+			bSuccess = false;
+		}
+	} );
+
+	return bSuccess;
+}
+
+void SampleLoader::run( int nJobs, const std::function<void(int)>& job )
+{
+	if ( nJobs <= 0 ) {
+		return;
+	}
+
+	EventQueue::get_instance()->push_event( EVENT_LOAD_PROGRESS, 0 );
+
+	std::atomic<int> nNextJob( 0 );
+	std::atomic<int> nDoneJobs( 0 );
+	std::atomic<int> nProgress( 0 );
+	auto work = [&]() {
+		int nJob;
+		while ( ( nJob = nNextJob.fetch_add( 1 ) ) < nJobs ) {
+			job( nJob );
+
+			const int nPercent = 100 * ( nDoneJobs.fetch_add( 1 ) + 1 ) / nJobs;
+			int nOldPercent = nProgress.load();
+			// Only report each step once regardless of the order the
+			// threads finish their jobs in.
+			while ( nPercent > nOldPercent ) {
+				if ( nProgress.compare_exchange_weak( nOldPercent, nPercent ) ) {
+					EventQueue::get_instance()->push_event( EVENT_LOAD_PROGRESS, nPercent );
+					break;
+				}
+			}
+		}
+	};
+
+	const int nThreads = std::min( std::max( static_cast<int>( std::thread::hardware_concurrency() ), 1 ),
+								   nJobs );
+	std::vector<std::thread> threads;
+	// The calling thread takes part in loading as well.
+	for ( int nThread = 1; nThread < nThreads; ++nThread ) {
+		threads.push_back( std::thread( work ) );
+	}
+	work();
+	for ( auto& thread : threads ) {
+		thread.join();
+	}
+}
+
+};
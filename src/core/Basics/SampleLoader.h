@@ -0,0 +1,80 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef H2C_SAMPLE_LOADER_H
+#define H2C_SAMPLE_LOADER_H
+
+#include <core/Object.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace H2Core
+{
+
+class InstrumentComponent;
+
+/**
+ * Decodes samples concurrently.
+ *
+ * Reading and decoding a sample file is independent of all other
+ * samples. Instead of loading the layers of a drumkit or song one
+ * after another, the jobs are distributed across one thread per
+ * CPU core. Progress is reported via #EVENT_LOAD_PROGRESS in
+ * percent.
+ *
+ * Neither function locks the AudioEngine. Callers loading samples
+ * of a live drumkit are supposed to decode them into new objects
+ * and swap those into the engine afterwards.
+ *
+ * \ingroup docCore
+ */
+class SampleLoader : public H2Core::Object<SampleLoader>
+{
+	H2_OBJECT(SampleLoader)
+public:
+	/**
+	 * Calls InstrumentLayer::load_sample() of all layers of
+	 * @a components concurrently.
+	 *
+	 * \param bUseCache Passed to InstrumentLayer::load_sample().
+	 *
+	 * \return Whether all samples could be loaded. Layers whose
+	 * sample failed to load hold an empty Sample (see
+	 * Sample::is_empty()).
+	 */
+	static bool loadComponents( const std::vector<std::shared_ptr<InstrumentComponent>>& components,
+								bool bUseCache = true );
+
+	/**
+	 * Calls @a job for all indices in [0, @a nJobs) concurrently
+	 * and returns once all of them are done.
+	 *
+	 * The jobs are handed out one by one. This way a couple of long
+	 * samples do not leave the other threads idle.
+	 */
+	static void run( int nJobs, const std::function<void(int)>& job );
+};
+
+};
+
+#endif // H2C_SAMPLE_LOADER_H
@@ -22,6 +22,7 @@
 
 #include "Version.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
@@ -38,11 +39,13 @@
 #include <core/Basics/InstrumentComponent.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/SampleLoader.h>
 #include <core/Basics/Pattern.h>
 #include <core/Basics/PatternList.h>
 #include <core/Basics/Note.h>
 #include <core/Basics/AutomationPath.h>
 #include <core/AutomationPathSerializer.h>
+#include <core/AudioEngine/AudioEngine.h>
 #include <core/Helpers/Xml.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Hydrogen.h>
@@ -73,6 +76,8 @@ Song::Song( const QString& sName, const QString& sAuthor, float fBpm, float fVol
 	, m_sNotes( "" )
 	, m_pPatternList( nullptr )
 	, m_pPatternGroupSequence( nullptr )
+	, m_pColumnStartTicks( new std::vector<long>( 1, 0 ) )
+	, m_nColumnIndexReaders( 0 )
 	, m_pInstrumentList( nullptr )
 	, m_pComponents( nullptr )
 	, m_sFilename( "" )
@@ -120,6 +125,11 @@ Song::~Song()
 		delete m_pPatternGroupSequence;
 	}
 
+	delete m_pColumnStartTicks.load();
+	for ( auto pColumnStartTicks : m_retiredColumnStartTicks ) {
+		delete pColumnStartTicks;
+	}
+
 	delete m_pInstrumentList;
 
 	delete m_pVelocityAutomationPath;
@@ -161,19 +171,117 @@ void Song::setActionMode( Song::ActionMode actionMode ) {
 }
 
 int Song::lengthInTicks() const {
-	int nSongLength = 0;
-	int nColumns = m_pPatternGroupSequence->size();
+	++m_nColumnIndexReaders;
+	const int nLength = m_pColumnStartTicks.load()->back();
+	--m_nColumnIndexReaders;
+	return nLength;
+}
+
+void Song::updateColumnIndex() {
+	AudioEngine* pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	const bool bLock = ! pAudioEngine->isLockedByCurrentThread();
+	if ( bLock ) {
+		pAudioEngine->lock( RIGHT_HERE );
+	}
+
+	buildColumnIndex();
+
+	if ( bLock ) {
+		pAudioEngine->unlock();
+	}
+}
+
+void Song::buildColumnIndex() {
+	const int nColumns = m_pPatternGroupSequence != nullptr ?
+		m_pPatternGroupSequence->size() : 0;
+	auto pColumnStartTicks = new std::vector<long>( nColumns + 1 );
+	auto& columnStartTicks = *pColumnStartTicks;
+	columnStartTicks[ 0 ] = 0;
+
 	// Sum the lengths of all pattern columns and use the macro
 	// MAX_NOTES in case some of them are of size zero.
 	for ( int i = 0; i < nColumns; i++ ) {
 		PatternList *pColumn = ( *m_pPatternGroupSequence )[ i ];
+		long nPatternSize;
 		if ( pColumn->size() != 0 ) {
-			nSongLength += pColumn->longest_pattern_length();
+			nPatternSize = pColumn->longest_pattern_length();
 		} else {
-			nSongLength += MAX_NOTES;
+			nPatternSize = MAX_NOTES;
 		}
+		columnStartTicks[ i + 1 ] = columnStartTicks[ i ] + nPatternSize;
 	}
-    return nSongLength;
+
+	const std::vector<long>* pOldColumnStartTicks =
+		m_pColumnStartTicks.exchange( pColumnStartTicks );
+	if ( pOldColumnStartTicks != nullptr ) {
+		m_retiredColumnStartTicks.push_back( pOldColumnStartTicks );
+	}
+
+	// A reader entering after the exchange above does only see the
+	// new snapshot.
+	if ( m_nColumnIndexReaders.load() == 0 ) {
+		for ( auto pRetiredColumnStartTicks : m_retiredColumnStartTicks ) {
+			delete pRetiredColumnStartTicks;
+		}
+		m_retiredColumnStartTicks.clear();
+	}
+}
+
+int Song::getColumnForTick( int nTick, bool bLoopMode, int* pPatternStartTick ) const {
+	++m_nColumnIndexReaders;
+	const auto& columnStartTicks = *m_pColumnStartTicks.load();
+
+	const long nSongSize = columnStartTicks.back();
+	if ( nSongSize == 0 || nTick < 0 ||
+		 ( nTick >= nSongSize && ! bLoopMode ) ) {
+		--m_nColumnIndexReaders;
+		return -1;
+	}
+
+	// If the song is played in loop mode, the tick numbers of the
+	// second turn are added on top of maximum tick number of the
+	// song. Therefore, we introduce periodic boundary conditions.
+	if ( nTick >= nSongSize ) {
+		nTick = nTick % nSongSize;
+	}
+
+	// First column starting after nTick. Since the start ticks are
+	// sorted and the first one is 0, the column nTick is located in
+	// is the one right before it.
+	auto it = std::upper_bound( columnStartTicks.begin(),
+								columnStartTicks.end(), nTick );
+	--it;
+	( *pPatternStartTick ) = *it;
+	const int nColumn = it - columnStartTicks.begin();
+
+	--m_nColumnIndexReaders;
+	return nColumn;
+}
+
+long Song::getTickForColumn( int nColumn ) const {
+	++m_nColumnIndexReaders;
+	const auto& columnStartTicks = *m_pColumnStartTicks.load();
+
+	long nTick = -1;
+	if ( nColumn >= 0 && nColumn < columnStartTicks.size() ) {
+		nTick = columnStartTicks[ nColumn ];
+	}
+
+	--m_nColumnIndexReaders;
+	return nTick;
+}
+
+int Song::getColumnLength( int nColumn ) const {
+	++m_nColumnIndexReaders;
+	const auto& columnStartTicks = *m_pColumnStartTicks.load();
+
+	int nLength = -1;
+	if ( nColumn >= 0 && nColumn + 1 < columnStartTicks.size() ) {
+		nLength = columnStartTicks[ nColumn + 1 ] - columnStartTicks[ nColumn ];
+	}
+
+	--m_nColumnIndexReaders;
+	return nLength;
 }
 
 bool Song::isPatternActive( int nColumn, int nRow ) const {
@@ -429,6 +537,7 @@ void Song::readTempPatternList( const QString& sFilename )
 	} else {
 		WARNINGLOG( "no sequence node not found" );
 	}
+	updateColumnIndex();
 }
 
 bool Song::writeTempPatternList( const QString& sFilename )
@@ -939,6 +1048,20 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 	//  Instrument List
 	InstrumentList* pInstrList = new InstrumentList();
 
+	// Samples are decoded concurrently once all instruments were
+	// read.
+	struct SampleJob {
+		std::shared_ptr<Instrument> pInstrument;
+		std::shared_ptr<InstrumentLayer> pLayer;
+		QString sFilename;
+		bool bIsModified;
+		Sample::Loops loops;
+		Sample::Rubberband rubberband;
+		Sample::VelocityEnvelope velocity;
+		Sample::PanEnvelope pan;
+	};
+	std::vector<SampleJob> sampleJobs;
+
 	QDomNode instrumentListNode = songNode.firstChildElement( "instrumentList" );
 	if ( ( ! instrumentListNode.isNull()  ) ) {
 		// INSTRUMENT NODE
@@ -1023,6 +1146,7 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 			int iIsHiHat = LocalFileMng::readXmlInt( instrumentNode, "isHihat", -1, true );
 			int iLowerCC = LocalFileMng::readXmlInt( instrumentNode, "lower_cc", 0, true );
 			int iHigherCC = LocalFileMng::readXmlInt( instrumentNode, "higher_cc", 127, true );
+			int nVoicePriority = LocalFileMng::readXmlInt( instrumentNode, "voicePriority", 0, true, false );
 
 			// create a new instrument
 			auto pInstrument = std::make_shared<Instrument>( id, sName, std::make_shared<ADSR>( fAttack, fDecay, fSustain, fRelease ) );
@@ -1047,6 +1171,7 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 			pInstrument->set_hihat_grp( iIsHiHat );
 			pInstrument->set_lower_cc( iLowerCC );
 			pInstrument->set_higher_cc( iHigherCC );
+			pInstrument->setVoicePriority( nVoicePriority );
 			if ( sRead_sample_select_algo.compare("VELOCITY") == 0 ) {
 				pInstrument->set_sample_selection_alg( Instrument::VELOCITY );
 			} else if ( sRead_sample_select_algo.compare("ROUND_ROBIN") == 0 ) {
@@ -1141,14 +1266,12 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 							ro.use = false;
 						}
 
-						std::shared_ptr<Sample> pSample;
-						if ( !sIsModified ) {
-							pSample = Sample::load( sFilename );
-						} else {
+						Sample::VelocityEnvelope velocity;
+						Sample::VelocityEnvelope pan;
+						if ( sIsModified ) {
 							// FIXME, kill EnvelopePoint, create Envelope class
 							EnvelopePoint pt;
 
-							Sample::VelocityEnvelope velocity;
 							QDomNode volumeNode = layerNode.firstChildElement( "volume" );
 							while (  ! volumeNode.isNull()  ) {
 								pt.frame = LocalFileMng::readXmlInt( volumeNode, "volume-position", 0 );
@@ -1158,7 +1281,6 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 								//ERRORLOG( QString("volume-posi %1").arg(LocalFileMng::readXmlInt( volumeNode, "volume-position", 0)) );
 							}
 
-							Sample::VelocityEnvelope pan;
 							QDomNode  panNode = layerNode.firstChildElement( "pan" );
 							while (  ! panNode.isNull()  ) {
 								pt.frame = LocalFileMng::readXmlInt( panNode, "pan-position", 0 );
@@ -1166,15 +1288,11 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 								pan.push_back( pt );
 								panNode = panNode.nextSiblingElement( "pan" );
 							}
-
-							pSample = Sample::load( sFilename, lo, ro, velocity, pan );
-						}
-						if ( pSample == nullptr ) {
-							ERRORLOG( "Error loading sample: " + sFilename + " not found" );
-							pInstrument->set_muted( true );
-							pInstrument->set_missing_samples( true );
 						}
-						auto pLayer = std::make_shared<InstrumentLayer>( pSample );
+						// The sample is loaded once the whole song was parsed.
+						auto pLayer = std::make_shared<InstrumentLayer>( nullptr );
+						sampleJobs.push_back( { pInstrument, pLayer, sFilename, sIsModified,
+												   lo, ro, velocity, pan } );
 						pLayer->set_start_velocity( fMin );
 						pLayer->set_end_velocity( fMax );
 						pLayer->set_gain( fGain );
@@ -1229,13 +1347,11 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 							ro.use = false;
 						}
 
-						std::shared_ptr<Sample> pSample = nullptr;
-						if ( !sIsModified ) {
-							pSample = Sample::load( sFilename );
-						} else {
+						Sample::VelocityEnvelope velocity;
+						Sample::VelocityEnvelope pan;
+						if ( sIsModified ) {
 							EnvelopePoint pt;
 
-							Sample::VelocityEnvelope velocity;
 							QDomNode volumeNode = layerNode.firstChildElement( "volume" );
 							while (  ! volumeNode.isNull()  ) {
 								pt.frame = LocalFileMng::readXmlInt( volumeNode, "volume-position", 0 );
@@ -1245,7 +1361,6 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 								//ERRORLOG( QString("volume-posi %1").arg(LocalFileMng::readXmlInt( volumeNode, "volume-position", 0)) );
 							}
 
-							Sample::VelocityEnvelope pan;
 							QDomNode  panNode = layerNode.firstChildElement( "pan" );
 							while (  ! panNode.isNull()  ) {
 								pt.frame = LocalFileMng::readXmlInt( panNode, "pan-position", 0 );
@@ -1253,15 +1368,11 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 								pan.push_back( pt );
 								panNode = panNode.nextSiblingElement( "pan" );
 							}
-
-							pSample = Sample::load( sFilename, lo, ro, velocity, pan );
 						}
-						if ( pSample == nullptr ) {
-							ERRORLOG( "Error loading sample: " + sFilename + " not found" );
-							pInstrument->set_muted( true );
-							pInstrument->set_missing_samples( true );
-						}
-						auto pLayer = std::make_shared<InstrumentLayer>( pSample );
+						// The sample is loaded once the whole song was parsed.
+						auto pLayer = std::make_shared<InstrumentLayer>( nullptr );
+						sampleJobs.push_back( { pInstrument, pLayer, sFilename, sIsModified,
+												   lo, ro, velocity, pan } );
 						pLayer->set_start_velocity( fMin );
 						pLayer->set_end_velocity( fMax );
 						pLayer->set_gain( fGain );
@@ -1278,6 +1389,30 @@ std::shared_ptr<Song> SongReader::readSong( const QString& sFileName )
 			instrumentNode = ( QDomNode ) instrumentNode.nextSiblingElement( "instrument" );
 		}
 
+		std::vector<std::shared_ptr<Sample>> samples( sampleJobs.size() );
+		SampleLoader::run( sampleJobs.size(), [&]( int nJob ) {
+			const SampleJob& job = sampleJobs[ nJob ];
+			if ( job.bIsModified ) {
+				samples[ nJob ] = Sample::load( job.sFilename, job.loops, job.rubberband,
+												job.velocity, job.pan );
+			} else {
+				samples[ nJob ] = Sample::load( job.sFilename );
+			}
+			if ( samples[ nJob ] != nullptr &&
+				 Preferences::get_instance()->m_bCompactSamples ) {
+				samples[ nJob ]->compact();
+			}
+		} );
+		for ( int nJob = 0; nJob < sampleJobs.size(); ++nJob ) {
+			if ( samples[ nJob ] == nullptr ) {
+				ERRORLOG( "Error loading sample: " + sampleJobs[ nJob ].sFilename + " not found" );
+				sampleJobs[ nJob ].pInstrument->set_muted( true );
+				sampleJobs[ nJob ].pInstrument->set_missing_samples( true );
+			} else {
+				sampleJobs[ nJob ].pLayer->set_sample( samples[ nJob ] );
+			}
+		}
+
 		if ( instrumentList_count == 0 ) {
 			WARNINGLOG( "0 instruments?" );
 		}
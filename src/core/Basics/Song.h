@@ -29,6 +29,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <atomic>
 
 #include <core/Object.h>
 
@@ -107,6 +108,51 @@ class Song : public H2Core::Object<Song>, public std::enable_shared_from_this<So
 		/** get the length of the song, in tick units */
 		int lengthInTicks() const;
 
+		/**
+		 * Find the pattern group / column @a nTick is located in.
+		 *
+		 * The lookup is done using a binary search in the cached
+		 * start ticks of all columns (see #m_pColumnStartTicks).
+		 *
+		 * \param nTick Position in ticks.
+		 * \param bLoopMode Whether positions beyond the end of the
+		 *   song are mapped back into it.
+		 * \param pPatternStartTick Set to the tick the found column
+		 *   starts at (without the loop offset).
+		 * \return Index of the column or -1 if @a nTick could not be
+		 *   mapped to one.
+		 */
+		int getColumnForTick( int nTick, bool bLoopMode, int* pPatternStartTick ) const;
+		/**
+		 * \param nColumn Index of the column in the range between 0
+		 *   and the number of columns (inclusive).
+		 * \return Tick @a nColumn starts at or -1 if it is out of
+		 *   range. Passing the number of columns yields
+		 *   lengthInTicks().
+		 */
+		long getTickForColumn( int nColumn ) const;
+		/**
+		 * \return Length in ticks of the column at @a nColumn (the
+		 * longest pattern contained or #MAX_NOTES for an empty one)
+		 * or -1 if it is out of range.
+		 */
+		int getColumnLength( int nColumn ) const;
+		/**
+		 * Rebuilds the start ticks of all columns and publishes them
+		 * as a new snapshot (see #m_pColumnStartTicks).
+		 *
+		 * It has to be called whenever a column is added or removed,
+		 * a pattern is added to or removed from a column, or the
+		 * length of a pattern changes. setPatternGroupVector() and
+		 * readTempPatternList() do so on their own.
+		 *
+		 * The AudioEngine is locked while the pattern group vector
+		 * is read unless the calling thread already holds the lock.
+		 * Since this allocates memory, it must not be called from
+		 * within the audio thread.
+		 */
+		void updateColumnIndex();
+
 		static std::shared_ptr<Song> 	load( const QString& sFilename );
 		bool 			save( const QString& sFilename );
 
@@ -249,6 +295,29 @@ class Song : public H2Core::Object<Song>, public std::enable_shared_from_this<So
 		PatternList*	m_pPatternList;
 		///< Sequence of pattern groups
 		std::vector<PatternList*>* m_pPatternGroupSequence;
+		/** Tick each column of #m_pPatternGroupSequence starts at
+		 * followed by the length of the whole song.
+		 *
+		 * Since it is queried by the AudioEngine during every
+		 * processing cycle the prefix sum is cached instead of
+		 * summing the lengths of all columns every time.
+		 *
+		 * It is queried by the audio thread, the JACK driver, the
+		 * MIDI handlers, and the GUI. Therefore, a snapshot is never
+		 * altered. buildColumnIndex() publishes a new one and keeps
+		 * the previous one in #m_retiredColumnStartTicks until no
+		 * reader is active anymore (see #m_nColumnIndexReaders).
+		 * Readers neither lock a mutex nor free memory.*/
+		std::atomic<const std::vector<long>*> m_pColumnStartTicks;
+		/** Snapshots replaced while a reader was active. Freed by
+		 * the next call to buildColumnIndex() without one.*/
+		std::vector<const std::vector<long>*> m_retiredColumnStartTicks;
+		/** Number of threads currently reading from
+		 * #m_pColumnStartTicks.*/
+		mutable std::atomic<int> m_nColumnIndexReaders;
+		/** Builds and publishes #m_pColumnStartTicks without locking
+		 * the AudioEngine.*/
+		void buildColumnIndex();
 		///< Instrument list
 		InstrumentList*	       	m_pInstrumentList;
 		///< list of drumkit component
@@ -394,6 +463,9 @@ inline const std::vector<PatternList*>* Song::getPatternGroupVector() const
 inline void Song::setPatternGroupVector( std::vector<PatternList*>* pGroupVector )
 {
 	m_pPatternGroupSequence = pGroupVector;
+	// The vector is either part of a song not handed to Hydrogen
+	// yet or the caller holds the AudioEngine lock.
+	buildColumnIndex();
 }
 
 inline void Song::setNotes( const QString& sNotes )
@@ -849,6 +849,7 @@ bool CoreActionController::toggleGridCell( int nColumn, int nRow ){
 				delete pColumn;
 			}
 		}
+		pSong->updateColumnIndex();
 	} else if ( nColumn >= pColumns->size() ) {
 		// We need to add some new columns..
 		PatternList *pColumn;
@@ -858,6 +859,7 @@ bool CoreActionController::toggleGridCell( int nColumn, int nRow ){
 			pColumns->push_back( pColumn );
 		}
 		pColumn->add( pNewPattern );
+		pSong->updateColumnIndex();
 	} else {
 		// nColumn < 0
 		ERRORLOG( QString( "Provided column [%1] is out of bound [0,%2]" )
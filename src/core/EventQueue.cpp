@@ -38,12 +38,18 @@ void EventQueue::create_instance()
 EventQueue::EventQueue()
 		: __read_index( 0 )
 		, __write_index( 0 )
+		, __dropped_events( 0 )
+		, __reported_dropped_events( 0 )
 {
+	static_assert( ( MAX_EVENTS & ( MAX_EVENTS - 1 ) ) == 0,
+				   "MAX_EVENTS must be a power of two" );
+
 	__instance = this;
 
 	for ( int i = 0; i < MAX_EVENTS; ++i ) {
-		__events_buffer[ i ].type = EVENT_NONE;
-		__events_buffer[ i ].value = 0;
+		__events_buffer[ i ].sequence.store( i, std::memory_order_relaxed );
+		__events_buffer[ i ].event.type = EVENT_NONE;
+		__events_buffer[ i ].event.value = 0;
 	}
 }
 
@@ -54,30 +60,115 @@ EventQueue::~EventQueue()
 }
 
 
+bool EventQueue::is_critical( const EventType type )
+{
+	switch ( type ) {
+	case EVENT_STATE:
+	case EVENT_PROGRESS:
+	case EVENT_ERROR:
+	case EVENT_QUIT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
 void EventQueue::push_event( const EventType type, const int nValue )
 {
-	unsigned int nIndex = ++__write_index;
-	nIndex = nIndex % MAX_EVENTS;
-	Event ev;
-	ev.type = type;
-	ev.value = nValue;
-//	INFOLOG( QString( "[pushEvent] %1 : %2 %3" ).arg( nIndex ).arg( ev.type ).arg( ev.value ) );
-	__events_buffer[ nIndex ] = ev;
+	const bool bCritical = is_critical( type );
+	unsigned int nIndex = __write_index.load( std::memory_order_relaxed );
+	while ( true ) {
+		// An outdated read index only overestimates the number of
+		// occupied slots.
+		if ( ! bCritical &&
+			 nIndex - __read_index.load( std::memory_order_relaxed ) >=
+			 MAX_EVENTS - RESERVED_EVENTS ) {
+			__dropped_events.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+
+		EventSlot* pSlot = &__events_buffer[ nIndex % MAX_EVENTS ];
+		const unsigned int nSequence = pSlot->sequence.load( std::memory_order_acquire );
+		const int nDiff = static_cast<int>( nSequence - nIndex );
+
+		if ( nDiff == 0 ) {
+			// The slot is free. Try to reserve it.
+			if ( __write_index.compare_exchange_weak( nIndex, nIndex + 1,
+													  std::memory_order_relaxed ) ) {
+				pSlot->event.type = type;
+				pSlot->event.value = nValue;
+//				INFOLOG( QString( "[pushEvent] %1 : %2 %3" ).arg( nIndex ).arg( type ).arg( nValue ) );
+				pSlot->sequence.store( nIndex + 1, std::memory_order_release );
+				return;
+			}
+		}
+		else if ( nDiff < 0 ) {
+			// The slot still holds an event of the previous lap
+			// which was not read yet.
+			__dropped_events.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+		else {
+			// Another thread reserved the slot in the meantime.
+			nIndex = __write_index.load( std::memory_order_relaxed );
+		}
+	}
+}
+
+
+bool EventQueue::pop_event_into( Event* pEvent )
+{
+	const unsigned int nReadIndex = __read_index.load( std::memory_order_relaxed );
+	EventSlot* pSlot = &__events_buffer[ nReadIndex % MAX_EVENTS ];
+	const unsigned int nSequence = pSlot->sequence.load( std::memory_order_acquire );
+	if ( static_cast<int>( nSequence - ( nReadIndex + 1 ) ) < 0 ) {
+		return false;
+	}
+
+	*pEvent = pSlot->event;
+//	INFOLOG( QString( "[popEvent] %1 : %2 %3" ).arg( nReadIndex ).arg( pEvent->type ).arg( pEvent->value ) );
+
+	// Hand the slot over to the producers of the next lap.
+	pSlot->sequence.store( nReadIndex + MAX_EVENTS, std::memory_order_release );
+	__read_index.store( nReadIndex + 1, std::memory_order_relaxed );
+	return true;
 }
 
 
 Event EventQueue::pop_event()
 {
-	if ( __read_index == __write_index ) {
-		Event ev;
+	report_dropped_events();
+
+	Event ev;
+	if ( ! pop_event_into( &ev ) ) {
 		ev.type = EVENT_NONE;
 		ev.value = 0;
-		return ev;
 	}
-	unsigned int nIndex = ++__read_index;
-	nIndex = nIndex % MAX_EVENTS;
-//	INFOLOG( QString( "[popEvent] %1 : %2 %3" ).arg( nIndex ).arg( __events_buffer[ nIndex ].type ).arg( __events_buffer[ nIndex ].value ) );
-	return __events_buffer[ nIndex ];
+	return ev;
+}
+
+
+int EventQueue::pop_events( Event* pEvents, int nMaxEvents )
+{
+	report_dropped_events();
+
+	int nEvents = 0;
+	while ( nEvents < nMaxEvents && pop_event_into( &pEvents[ nEvents ] ) ) {
+		++nEvents;
+	}
+	return nEvents;
+}
+
+
+void EventQueue::report_dropped_events()
+{
+	const unsigned int nDropped = get_dropped_event_count();
+	if ( nDropped != __reported_dropped_events ) {
+		WARNINGLOG( QString( "EventQueue full. [%1] events were dropped" )
+					.arg( nDropped - __reported_dropped_events ) );
+		__reported_dropped_events = nDropped;
+	}
 }
 
 };
@@ -25,11 +25,16 @@
 
 #include <core/Object.h>
 #include <core/Basics/Note.h>
+#include <atomic>
 #include <cassert>
 
 /** Maximum number of events to be stored in the
-    H2Core::EventQueue::__events_buffer.*/
+    H2Core::EventQueue::__events_buffer. Must be a power of two.*/
 #define MAX_EVENTS 1024
+/** Number of slots of the H2Core::EventQueue only critical events,
+    like #H2Core::EVENT_PROGRESS or #H2Core::EVENT_STATE, are
+    allowed to occupy. See H2Core::EventQueue::is_critical().*/
+#define RESERVED_EVENTS 64
 
 namespace H2Core
 {
@@ -153,7 +158,12 @@ enum EventType {
 	/** Switches between select mode (0) and draw mode (1) in the *SongEditor.*/
 	EVENT_ACTION_MODE_CHANGE,
 	/** Triggers an udpate of the entire SongEditor*/
-	EVENT_UPDATE_SONG_EDITOR
+	EVENT_UPDATE_SONG_EDITOR,
+	/** Progress of decoding the samples of a drumkit or Song in
+		percent, see SampleLoader::run(). Kept apart from
+		#EVENT_PROGRESS, which consumers take as the end of an audio
+		export once it reaches 100.*/
+	EVENT_LOAD_PROGRESS
 };
 
 /** Basic building block for the communication between the core of
@@ -183,7 +193,19 @@ public:
  * is encountered, the corresponding function in the EventListener
  * will be invoked to respond to the condition of the engine. For
  * details about the mapping of EventTypes to functions please see the
- * documentation of HydrogenApp::onEventQueueTimer().*/
+ * documentation of HydrogenApp::onEventQueueTimer().
+ *
+ * Events are pushed by the audio thread, the MIDI and OSC handlers,
+ * and the GUI itself but are only read by a single consumer. The
+ * queue is a bounded ring buffer in which every slot carries a
+ * sequence number telling whether it is ready to be written or to be
+ * read. Neither push_event() nor pop_event() does lock or allocate
+ * and both can be safely called from within the audio thread. In
+ * case the consumer does not keep up, new events are dropped
+ * instead of overwriting unread ones and counted in
+ * #__dropped_events. The last #RESERVED_EVENTS slots are kept for
+ * critical events, see is_critical(). This way e.g. the end of an
+ * export is never lost in a flood of #EVENT_NOTEON.*/
 /** \ingroup docCore docEvent */
 class EventQueue : public H2Core::Object<EventQueue>
 {
@@ -207,15 +229,14 @@ public:/**
 	 *
 	 * The event itself will be constructed inside the function
 	 * and will be two properties: an EventType @a type and a
-	 * value @a nValue. Since the event written to the queue most
-	 * recently is indexed with #__write_index, this variable is
-	 * incremented once and its modulo with respect to #MAX_EVENTS
-	 * is calculated to determine the position of insertion into
-	 * #__events_buffer.
+	 * value @a nValue. A slot is reserved by advancing
+	 * #__write_index and published by updating its sequence number
+	 * once the event was written.
 	 *
-	 * The modulo operation is necessary because #__write_index
-	 * will be only incremented and does not respect the actual
-	 * length of #__events_buffer itself.
+	 * If all #MAX_EVENTS slots hold unread events, the new one is
+	 * discarded and #__dropped_events is incremented. Events not
+	 * considered critical are already discarded if less than
+	 * #RESERVED_EVENTS slots are free.
 	 *
 	 * \param type Type of the event, which will be queued.
 	 * \param nValue Value specifying the content of the new event.
@@ -224,18 +245,33 @@ public:/**
 	/**
 	 * Reads out the next event of the EventQueue.
 	 *
-	 * Since the event read out most recently is indexed with
-	 * #__read_index, this variable is incremented once and its
-	 * modulo with respect to #MAX_EVENTS is calculated to
-	 * determine the event returned from #__events_buffer. 
-	 *
-	 * The modulo operation is necessary because #__read_index
-	 * will be only incremented and does not respect the actual
-	 * length of #__events_buffer itself.
+	 * Must only be called by a single thread at a time.
 	 *
-	 * \return Next event in line.
+	 * \return Next event in line or an event of type
+	 * #H2Core::EVENT_NONE if the queue is empty.
 	 */
 	Event pop_event();
+	/**
+	 * Reads out up to @a nMaxEvents events at once.
+	 *
+	 * Must only be called by a single thread at a time.
+	 *
+	 * \param pEvents Array the events will be written to.
+	 * \param nMaxEvents Size of @a pEvents. Passing #MAX_EVENTS
+	 *   drains the whole queue.
+	 * \return Number of events written to @a pEvents.
+	 */
+	int pop_events( Event* pEvents, int nMaxEvents );
+
+	/** \return Number of events dropped since the EventQueue was
+		created.*/
+	unsigned int get_dropped_event_count() const;
+	/** \return Whether events of @a type may occupy the slots
+		reserved by #RESERVED_EVENTS. These are the ones whose loss
+		would leave the consumer in an inconsistent state, like
+		#EVENT_STATE, #EVENT_PROGRESS, #EVENT_ERROR, and
+		#EVENT_QUIT.*/
+	static bool is_critical( const EventType type );
 
 	struct AddMidiNoteVector {
 		int m_column;       //position
@@ -269,28 +305,56 @@ private:
 	static EventQueue *__instance;
 
 	/**
-	 * Continuously growing number indexing the event, which has
-	 * been read from the EventQueue most recently.
+	 * Reads the event at #__read_index into @a pEvent.
 	 *
-	 * It is incremented with each call to pop_event(). 
+	 * \return false if there is no published event in the slot.
 	 */
-	unsigned int __read_index;
+	bool pop_event_into( Event* pEvent );
+	/** Logs a warning in case further events were dropped since the
+		last call. Only called by the consumer thread.*/
+	void report_dropped_events();
+
+	/** Single slot of the #__events_buffer. */
+	struct EventSlot {
+		/** Equals the writing position of the slot if it is free
+		 * and the position plus one once the event was written.*/
+		std::atomic<unsigned int> sequence;
+		Event event;
+	};
+
 	/**
-	 * Continuously growing number indexing the event, which has
-	 * been written to the EventQueue most recently.
+	 * Continuously growing number indexing the next event to be
+	 * read from the EventQueue.
 	 *
-	 * It is incremented with each call to push_event(). 
+	 * It is only written by the consumer. Producers read it to
+	 * determine the number of free slots.
 	 */
-	unsigned int __write_index;
+	std::atomic<unsigned int> __read_index;
+	/**
+	 * Continuously growing number indexing the next slot to be
+	 * written to.
+	 *
+	 * It is incremented with each successful call to push_event().
+	 */
+	std::atomic<unsigned int> __write_index;
+	/** Number of events dropped because the queue was full. */
+	std::atomic<unsigned int> __dropped_events;
+	/** Value of #__dropped_events at the time of the last warning
+		in report_dropped_events().*/
+	unsigned int __reported_dropped_events;
 	/**
 	 * Array of all events contained in the EventQueue.
 	 *
 	 * Its length is set to #MAX_EVENTS and it gets initialized
 	 * with #H2Core::EVENT_NONE in EventQueue().
 	 */
-	Event __events_buffer[ MAX_EVENTS ];
+	EventSlot __events_buffer[ MAX_EVENTS ];
 };
 
+inline unsigned int EventQueue::get_dropped_event_count() const {
+	return __dropped_events.load( std::memory_order_relaxed );
+}
+
 };
 
 #endif
@@ -113,7 +113,7 @@ QStringList Filesystem::__ladspa_paths;
 QString Filesystem::m_sPreferencesOverwritePath = "";
 
 /* TODO QCoreApplication is not instantiated */
-bool Filesystem::bootstrap( Logger* logger, const QString& sys_path )
+bool Filesystem::bootstrap( Logger* logger, const QString& sys_path, const QString& usr_path )
 {
 	if( __logger==nullptr && logger!=nullptr ) {
 		__logger = logger;
@@ -140,6 +140,10 @@ bool Filesystem::bootstrap( Logger* logger, const QString& sys_path )
 	__usr_cfg_path = QDir::homePath().append( "/" H2_USR_PATH "/" USR_CONFIG );
 #endif
 	if( sys_path!=nullptr ) __sys_data_path = sys_path;
+	if( usr_path!=nullptr ) {
+		__usr_data_path = QDir( usr_path ).filePath( "data/" );
+		__usr_cfg_path = QDir( usr_path ).filePath( USR_CONFIG );
+	}
 
 	if( !dir_readable( __sys_data_path ) ) {
 		__sys_data_path = QCoreApplication::applicationDirPath().append( "/" LOCAL_DATA_PATH );
@@ -81,8 +81,11 @@ namespace H2Core
 		 * check user and system filesystem usability
 		 * \param logger is a pointer to the logger instance which will be used
 		 * \param sys_path an alternate system data path
+		 * \param usr_path an alternate folder holding the user
+		 *   data and the user config file
 		 */
-		static bool bootstrap( Logger* logger, const QString& sys_path=nullptr );
+		static bool bootstrap( Logger* logger, const QString& sys_path=nullptr,
+							   const QString& usr_path=nullptr );
 
 		/** returns system data path */
 		static QString sys_data_path();
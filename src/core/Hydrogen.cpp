@@ -56,6 +56,7 @@
 #include <core/Basics/InstrumentLayer.h>
 #include <core/Basics/Playlist.h>
 #include <core/Basics/Sample.h>
+#include <core/Basics/SampleLoader.h>
 #include <core/Basics/AutomationPath.h>
 #include <core/Hydrogen.h>
 #include <core/Basics/Pattern.h>
@@ -66,6 +67,8 @@
 #include <core/FX/Effects.h>
 
 #include <core/Preferences/Preferences.h>
+#include <core/Sampler/ResampleCache.h>
+#include <core/Sampler/StretchCache.h>
 #include <core/Sampler/Sampler.h>
 #include "MidiMap.h"
 #include <core/Timeline.h>
@@ -124,6 +127,8 @@ Hydrogen::Hydrogen() : m_nSelectedInstrumentNumber( 0 )
 	InstrumentComponent::setMaxLayers( Preferences::get_instance()->getMaxLayers() );
 	
 	m_pAudioEngine = new AudioEngine();
+	m_pResampleCache = new ResampleCache( m_pAudioEngine );
+	m_pStretchCache = new StretchCache( m_pAudioEngine );
 	Playlist::create_instance();
 
 	EventQueue::get_instance()->push_event( EVENT_STATE, static_cast<int>(AudioEngine::State::Initialized) );
@@ -157,6 +162,11 @@ Hydrogen::~Hydrogen()
 		delete pOscServer;
 	}
 #endif
+
+	// Stop the conversion before the samples get removed. The
+	// stretching triggers the conversion and is stopped first.
+	delete m_pStretchCache;
+	delete m_pResampleCache;
 	
 	removeSong();
 	
@@ -290,6 +300,9 @@ void Hydrogen::setSong( std::shared_ptr<Song> pSong )
 	// load new playback track information
 	m_pAudioEngine->getSampler()->reinitializePlaybackTrack();
 
+	m_pStretchCache->clear();
+	updateResampleCache();
+
 	// Push current state of Hydrogen to attached control interfaces,
 	// like OSC clients.
 	m_pCoreActionController->initExternalControlInterfaces();
@@ -321,7 +334,8 @@ void Hydrogen::addRealtimeNote(	int		instrument,
 								float	pitch,
 								bool	noteOff,
 								bool	forcePlay,
-								int		msg1 )
+								int		msg1,
+								bool	bPlay )
 {
 	UNUSED( pitch );
 	
@@ -331,7 +345,7 @@ void Hydrogen::addRealtimeNote(	int		instrument,
 	unsigned res = pPreferences->getPatternEditorGridResolution();
 	int nBase = pPreferences->isPatternEditorUsingTriplets() ? 3 : 4;
 	int scalar = ( 4 * MAX_NOTES ) / ( res * nBase );
-	bool hearnote = forcePlay;
+	bool hearnote = forcePlay && bPlay;
 	int currentPatternNumber;
 
 	m_pAudioEngine->lock( RIGHT_HERE );
@@ -487,11 +501,11 @@ void Hydrogen::addRealtimeNote(	int		instrument,
 
 			// hear note if its not in the future
 			if ( pPreferences->getHearNewNotes() && position <= pAudioEngine->getPatternTickPosition() ) {
-				hearnote = true;
+				hearnote = bPlay;
 			}
 		}/* if doRecord */
 	} else if ( pPreferences->getHearNewNotes() ) {
-			hearnote = true;
+			hearnote = bPlay;
 	} /* if .. AudioEngine::State::Playing */
 
 	if ( !pPreferences->__playselectedinstrument ) {
@@ -582,6 +596,9 @@ void Hydrogen::sequencer_setOnlyNextPattern( int pos )
 void Hydrogen::restartDrivers()
 {
 	m_pAudioEngine->restartAudioDrivers();
+
+	// The new driver might use a different sample rate.
+	updateResampleCache();
 }
 
 void Hydrogen::startExportSession(int sampleRate, int sampleDepth )
@@ -713,12 +730,6 @@ int Hydrogen::loadDrumkit( Drumkit *pDrumkitInfo, bool conditional )
 	AudioEngine* pAudioEngine = m_pAudioEngine;
 	assert ( pDrumkitInfo );
 
-	AudioEngine::State oldAudioEngineState = pAudioEngine->getState();
-	if( pAudioEngine->getState() == AudioEngine::State::Ready ||
-		pAudioEngine->getState() == AudioEngine::State::Playing ) {
-		pAudioEngine->setState( AudioEngine::State::Prepared );
-	}
-
 	INFOLOG( pDrumkitInfo->get_name() );
 	m_sCurrentDrumkitName = pDrumkitInfo->get_name();
 	if ( pDrumkitInfo->isUserDrumkit() ) {
@@ -729,13 +740,40 @@ int Hydrogen::loadDrumkit( Drumkit *pDrumkitInfo, bool conditional )
 
 	std::vector<DrumkitComponent*>* pSongCompoList= getSong()->getComponents();
 	std::vector<DrumkitComponent*>* pDrumkitCompoList = pDrumkitInfo->get_components();
+
+	//current instrument list
+	InstrumentList *pSongInstrList = getSong()->getInstrumentList();
 	
-	pAudioEngine->lock( RIGHT_HERE );	
-	for( auto &pComponent : *pSongCompoList ){
-		delete pComponent;
+	//new instrument list
+	InstrumentList *pDrumkitInstrList = pDrumkitInfo->get_instruments();
+
+	// Decode the samples of all instruments concurrently without
+	// touching the song. The AudioEngine is locked only once
+	// afterwards to publish the new drumkit.
+	std::vector<std::vector<std::shared_ptr<InstrumentComponent>>*> newComponents;
+	std::vector<std::shared_ptr<InstrumentComponent>> allComponents;
+	for ( unsigned nInstr = 0; nInstr < pDrumkitInstrList->size(); ++nInstr ) {
+		auto pNewInstr = pDrumkitInstrList->get( nInstr );
+		assert( pNewInstr );
+		newComponents.push_back( Instrument::copy_components( pDrumkitInfo, pNewInstr ) );
+		allComponents.insert( allComponents.end(), newComponents.back()->begin(),
+							  newComponents.back()->end() );
 	}
-	pSongCompoList->clear();
-	pAudioEngine->unlock();
+	INFOLOG( QString( "Loading samples of %1 instruments" ).arg( pDrumkitInstrList->size() ) );
+	SampleLoader::loadComponents( allComponents );
+	allComponents.clear();
+
+	// Playback only stops while the new drumkit is swapped in.
+	AudioEngine::State oldAudioEngineState = pAudioEngine->getState();
+	if( pAudioEngine->getState() == AudioEngine::State::Ready ||
+		pAudioEngine->getState() == AudioEngine::State::Playing ) {
+		pAudioEngine->setState( AudioEngine::State::Prepared );
+	}
+
+	std::vector<DrumkitComponent*> oldCompoList;
+	
+	pAudioEngine->lock( RIGHT_HERE );
+	oldCompoList.swap( *pSongCompoList );
 	
 	for (std::vector<DrumkitComponent*>::iterator it = pDrumkitCompoList->begin() ; it != pDrumkitCompoList->end(); ++it) {
 		DrumkitComponent* pSrcComponent = *it;
@@ -744,12 +782,6 @@ int Hydrogen::loadDrumkit( Drumkit *pDrumkitInfo, bool conditional )
 
 		pSongCompoList->push_back( pNewComponent );
 	}
-
-	//current instrument list
-	InstrumentList *pSongInstrList = getSong()->getInstrumentList();
-	
-	//new instrument list
-	InstrumentList *pDrumkitInstrList = pDrumkitInfo->get_instruments();
 	
 	/*
 	 * If the old drumkit is bigger then the new drumkit,
@@ -784,19 +816,10 @@ int Hydrogen::loadDrumkit( Drumkit *pDrumkitInfo, bool conditional )
 			assert( pInstr );
 		} else {
 			pInstr = std::make_shared<Instrument>();
-			// The instrument isn't playing yet; no need for locking
-			// :-) - Jakob Lund.  m_pAudioEngine->lock(
-			// "Hydrogen::loadDrumkit" );
 			pSongInstrList->add( pInstr );
-			// m_pAudioEngine->unlock();
 		}
 
 		auto pNewInstr = pDrumkitInstrList->get( nInstr );
-		assert( pNewInstr );
-		INFOLOG( QString( "Loading instrument (%1 of %2) [%3]" )
-				 .arg( nInstr + 1 )
-				 .arg( pDrumkitInstrList->size() )
-				 .arg( pNewInstr->get_name() ) );
 
 		// Preserve instrument IDs. Where the new drumkit has more instruments than the song does, new
 		// instruments need new ids.
@@ -806,10 +829,19 @@ int Hydrogen::loadDrumkit( Drumkit *pDrumkitInfo, bool conditional )
 		}
 		nMaxID = std::max( nID, nMaxID );
 
-		// Moved code from here right into the Instrument class - Jakob Lund.
-		pInstr->load_from( pDrumkitInfo, pNewInstr );
+		pInstr->set_from( pDrumkitInfo, pNewInstr, newComponents[ nInstr ] );
 		pInstr->set_id( nID );
 	}
+	pAudioEngine->unlock();
+
+	// The previous samples and components are freed without
+	// holding the lock.
+	for ( auto& pComponents : newComponents ) {
+		delete pComponents;
+	}
+	for ( auto& pComponent : oldCompoList ) {
+		delete pComponent;
+	}
 
 	//wolke: new delete function
 	if ( instrumentDiff >= 0 ) {
@@ -828,6 +860,8 @@ int Hydrogen::loadDrumkit( Drumkit *pDrumkitInfo, bool conditional )
 #endif
 
 	pAudioEngine->setState( oldAudioEngineState );
+
+	updateResampleCache();
 	
 	m_pCoreActionController->initExternalControlInterfaces();
 	
@@ -1286,6 +1320,37 @@ void Hydrogen::setNewBpmJTM( float bpmJTM )
 	m_fNewBpmJTM = bpmJTM;
 }
 
+void Hydrogen::recalculateRubberband( float fBpm )
+{
+	std::shared_ptr<Song> pSong = getSong();
+	if ( pSong == nullptr ) {
+		return;
+	}
+
+	setNewBpmJTM( fBpm );
+
+	// The playing patterns are altered by the audio thread.
+	m_pAudioEngine->lock( RIGHT_HERE );
+	int nColumn = -1;
+	if ( pSong->getMode() == Song::SONG_MODE ) {
+		nColumn = std::max( m_pAudioEngine->getColumn(), 0 );
+	}
+	m_pStretchCache->update( pSong, fBpm, nColumn, m_pAudioEngine->getPlayingPatterns() );
+	m_pAudioEngine->unlock();
+}
+
+void Hydrogen::updateResampleCache()
+{
+	std::shared_ptr<Song> pSong = getSong();
+	AudioOutput* pAudioDriver = getAudioOutput();
+	if ( pSong == nullptr || pAudioDriver == nullptr ) {
+		return;
+	}
+
+	m_pResampleCache->update( pSong->getInstrumentList(),
+							  pAudioDriver->getSampleRate() );
+}
+
 void Hydrogen::togglePlaysSelected()
 {
 	AudioEngine* pAudioEngine = m_pAudioEngine;	
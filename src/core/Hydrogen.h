@@ -45,6 +45,8 @@ namespace H2Core
 {
 	class CoreActionController;
 	class AudioEngine;
+	class ResampleCache;
+	class StretchCache;
 ///
 /// Hydrogen Audio Engine.
 ///
@@ -89,6 +91,8 @@ public:
 	 * return central instance of the audio engine
 	 */
 	AudioEngine*		getAudioEngine() const;
+	/** \return #m_pStretchCache */
+	StretchCache*		getStretchCache() const;
 
 	/**
 	 * Destructor taking care of most of the clean up.
@@ -189,13 +193,22 @@ public:
 
 		void			removeSong();
 
+		/**
+		 * Records and plays a note triggered in realtime.
+		 *
+		 * \param bPlay Whether to play the note. Notes received
+		 *   via MIDI are played by the audio thread itself (see
+		 *   MidiInput::processNoteCommands()) and only recorded
+		 *   here.
+		 */
 		void			addRealtimeNote ( int instrument,
 							  float velocity,
 							  float fPan = 0.0f,
 							  float pitch=0.0,
 							  bool noteoff=false,
 							  bool forcePlay=false,
-							  int msg1=0 );
+							  int msg1=0,
+							  bool bPlay=true );
 
 		void			restartDrivers();
 
@@ -375,6 +388,28 @@ void			previewSample( Sample *pSample );
 	/** Set the fallback speed #m_fNewBpmJTM.
 	 * \param bpmJTM New default tempo. */ 
 	void			setNewBpmJTM( float bpmJTM);
+	/**
+	 * Stretches all samples of the current Song using Rubber Band
+	 * to the speed @a fBpm.
+	 *
+	 * Sets #m_fNewBpmJTM to @a fBpm and schedules the stretching
+	 * in #m_pStretchCache. Layers of instruments used next in the
+	 * song are handled first. The function returns immediately and
+	 * the layers keep their current samples until the stretched
+	 * ones are ready. Use StretchCache::wait() to block until they
+	 * are.
+	 *
+	 * \param fBpm Speed to stretch the samples to.
+	 */
+	void			recalculateRubberband( float fBpm );
+	/**
+	 * Schedules the conversion of all samples of the current Song
+	 * to the sample rate of the audio driver.
+	 *
+	 * The conversion is done by #m_pResampleCache in the background
+	 * and the function returns immediately.
+	 */
+	void			updateResampleCache();
 
 	void			__panic();
 	/**
@@ -602,6 +637,16 @@ private:
 	 * Central instance of the audio engine. 
 	 */
 	AudioEngine*	m_pAudioEngine;
+	/**
+	 * Converts the samples of the current Song to the sample rate
+	 * of the audio driver.
+	 */
+	ResampleCache*	m_pResampleCache;
+	/**
+	 * Stretches the samples of the current Song to the current
+	 * tempo using Rubber Band.
+	 */
+	StretchCache*	m_pStretchCache;
 
 	/** 
 	 * Constructor, entry point, and initialization of the
@@ -662,6 +707,10 @@ inline AudioEngine* Hydrogen::getAudioEngine() const {
 	return m_pAudioEngine;
 }
 
+inline StretchCache* Hydrogen::getStretchCache() const {
+	return m_pStretchCache;
+}
+
 inline bool Hydrogen::getPlaybackTrackState() const
 {
 	std::shared_ptr<Song> pSong = getSong();
@@ -254,10 +254,13 @@ void AlsaMidiDriver::midi_action( snd_seq_t *seq_handle )
 			break;
 		}
 		snd_seq_event_input( seq_handle, &ev );
+		const long long nArrivalTime = ProcessProfiler::now();
 
 		if ( m_bActive && ev != nullptr ) {
 
 			MidiMessage msg;
+			msg.m_nFrameOffset = Hydrogen::get_instance()->getAudioEngine()->
+				computeFrameOffset( nArrivalTime );
 
 			switch ( ev->type ) {
 			case SND_SEQ_EVENT_NOTEON:
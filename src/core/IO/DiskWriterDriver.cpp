@@ -31,21 +31,14 @@
 #include <core/Basics/Pattern.h>
 #include <core/Basics/PatternList.h>
 #include <core/IO/DiskWriterDriver.h>
+#include <core/Sampler/StretchCache.h>
 
 #include <pthread.h>
 #include <cassert>
-
-#if defined(WIN32) || _DOXYGEN_
-#include <windows.h>
-/*
- * In Windows the unistd function sleep( seconds ) is not available.
- * Treat sleep( SECONDS ) as a macro that uses SleepEx.
- * Convert seconds to milliseconds for the first argument of SleepEx.
- * Use false for the second argument of SleepEx.
- * This way SleepEx always returns 0, after the specified time has passed.
- */
-#define sleep( SECONDS ) SleepEx( SECONDS * 1000, false )
-#endif
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace H2Core
 {
@@ -150,14 +143,55 @@ void* diskWriterDriver_thread( void* param )
 
 	SNDFILE* m_file = sf_open( pDriver->m_sFilename.toLocal8Bit(), SFM_WRITE, &soundInfo );
 
-	float *pData = new float[ pDriver->m_nBufferSize * 2 ];	// always stereo
-
 	float *pData_L = pDriver->m_pOut_L;
 	float *pData_R = pDriver->m_pOut_R;
 
+	// Encoding the audio - especially into FLAC and Ogg/Vorbis - is
+	// done in a separate thread while the engine is already rendering
+	// the following buffers. The blocks are handed over in order via
+	// a ring and written back to back.
+	const int nBlocks = 16;
+	std::vector<float*> blocks( nBlocks );
+	std::vector<int> blockFrames( nBlocks, 0 );
+	for ( auto& pBlock : blocks ) {
+		pBlock = new float[ pDriver->m_nBufferSize * 2 ];	// always stereo
+	}
+	std::mutex blockMutex;
+	std::condition_variable blockCondition;
+	int nFilledBlocks = 0;
+	int nNextBlockToFill = 0;
+	bool bRenderingDone = false;
+
+	std::thread writerThread( [&]() {
+		int nNextBlockToWrite = 0;
+		while ( true ) {
+			{
+				std::unique_lock<std::mutex> lock( blockMutex );
+				blockCondition.wait( lock, [&]{ return nFilledBlocks > 0 || bRenderingDone; } );
+				if ( nFilledBlocks == 0 ) {
+					return;
+				}
+			}
+
+			int res = sf_writef_float( m_file, blocks[ nNextBlockToWrite ], blockFrames[ nNextBlockToWrite ] );
+			if ( res != blockFrames[ nNextBlockToWrite ] ) {
+				__ERRORLOG( "Error during sf_write_float" );
+			}
+			nNextBlockToWrite = ( nNextBlockToWrite + 1 ) % nBlocks;
+
+			{
+				std::lock_guard<std::mutex> lock( blockMutex );
+				--nFilledBlocks;
+			}
+			blockCondition.notify_all();
+		}
+	} );
+
 
 	Hydrogen* pHydrogen = Hydrogen::get_instance();
 	auto pSong = pHydrogen->getSong();
+	const float fOldBpmJTM = pHydrogen->getNewBpmJTM();
+	bool bRubberbandRecalculated = false;
 
 	std::vector<PatternList*> *pPatternColumns = pSong->getPatternGroupVector();
 	int nColumns = pPatternColumns->size();
@@ -193,11 +227,15 @@ void* diskWriterDriver_thread( void* param )
 			pDriver->audioEngine_process_checkBPMChanged();
 			pHydrogen->getCoreActionController()->locateToColumn( patternPosition );
 			
-			// delay needed time to calculate all rubberband samples
+			// Stretch all rubberband samples before rendering. The
+			// distances used by the StretchCache are relative to
+			// the current column and instruments first used in one
+			// of the following ones must not be rendered with a
+			// sample stretched for a previous tempo either.
 			if( Preferences::get_instance()->getRubberBandBatchMode() && validBpm != oldBPM ){
-				EventQueue::get_instance()->push_event( EVENT_RECALCULATERUBBERBAND, -1);
-				int sleepTime = Preferences::get_instance()->getRubberBandCalcTime()+1;
-				while ((sleepTime = sleep(sleepTime)) > 0);
+				pHydrogen->recalculateRubberband( validBpm );
+				pHydrogen->getStretchCache()->wait( StretchCache::UNUSED );
+				bRubberbandRecalculated = true;
 			}
 			oldBPM = validBpm;
 			
@@ -235,6 +273,13 @@ void* diskWriterDriver_thread( void* param )
 			while( ret != 0) {
 				ret = pDriver->m_processCallback( usedBuffer, nullptr );
 			}
+
+			// Wait for the writer in case it fell behind.
+			{
+				std::unique_lock<std::mutex> lock( blockMutex );
+				blockCondition.wait( lock, [&]{ return nFilledBlocks < nBlocks; } );
+			}
+			float* pData = blocks[ nNextBlockToFill ];
 			
 			for ( unsigned i = 0; i < usedBuffer; i++ ) {
 				if(pData_L[i] > 1){
@@ -257,21 +302,44 @@ void* diskWriterDriver_thread( void* param )
 					pData[i * 2 + 1] = pData_R[i];
 				}
 			}
-			int res = sf_writef_float( m_file, pData, usedBuffer );
-			if ( res != ( int )usedBuffer ) {
-				__ERRORLOG( "Error during sf_write_float" );
+			blockFrames[ nNextBlockToFill ] = usedBuffer;
+			nNextBlockToFill = ( nNextBlockToFill + 1 ) % nBlocks;
+			{
+				std::lock_guard<std::mutex> lock( blockMutex );
+				++nFilledBlocks;
 			}
+			blockCondition.notify_all();
 		}
 		
 		// this progress bar method is not exact but ok enough to give users a usable visible progress feedback
-		float fPercent = ( float )(patternPosition +1) / ( float )nColumns * 100.0;
-		EventQueue::get_instance()->push_event( EVENT_PROGRESS, ( int )fPercent );
+		// The export is only reported as finished once all blocks are written.
+		if ( patternPosition < nColumns - 1 ) {
+			float fPercent = ( float )(patternPosition +1) / ( float )nColumns * 100.0;
+			EventQueue::get_instance()->push_event( EVENT_PROGRESS, ( int )fPercent );
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( blockMutex );
+		bRenderingDone = true;
+	}
+	blockCondition.notify_all();
+	writerThread.join();
+
+	for ( auto pBlock : blocks ) {
+		delete[] pBlock;
 	}
-	delete[] pData;
-	pData = nullptr;
 
 	sf_close( m_file );
 
+	if ( bRubberbandRecalculated ) {
+		// Back to the samples of the previous tempo. They are most
+		// probably still cached.
+		pHydrogen->recalculateRubberband( fOldBpmJTM );
+	}
+
+	EventQueue::get_instance()->push_event( EVENT_PROGRESS, 100 );
+
 	__INFOLOG( "DiskWriterDriver thread end" );
 
 	pthread_exit( nullptr );
@@ -104,6 +104,15 @@ JackMidiDriver::JackMidiWrite(jack_nframes_t nframes)
 		memset(buffer, 0, sizeof(buffer));
 		memcpy(buffer, event.buffer, error);
 
+		// The MIDI client has its own process callback, which JACK
+		// might run before or after the one of the audio client. The
+		// events are thus handled in the current or in the next
+		// cycle of the audio engine, depending on the order of the
+		// clients in the graph. Using event.time as offset within
+		// that cycle delays all events by a constant latency for a
+		// given graph order.
+		msg.m_nFrameOffset = event.time;
+
 		switch (buffer[0] >> 4) {
 		case 0x8:	 /* note off */
 			msg.m_type = MidiMessage::NOTE_OFF;
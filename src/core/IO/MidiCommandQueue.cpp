@@ -0,0 +1,90 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/IO/MidiCommandQueue.h>
+
+#include <algorithm>
+
+namespace H2Core
+{
+
+MidiCommand MidiCommand::fromMessage( const MidiMessage& msg )
+{
+	MidiCommand command;
+	command.type = msg.m_type;
+	command.nChannel = msg.m_nChannel;
+	command.nData1 = msg.m_nData1;
+	command.nData2 = msg.m_nData2;
+	command.nFrameOffset = msg.m_nFrameOffset;
+	command.nSysexSize = static_cast<int>( msg.m_sysexData.size() );
+	std::fill( command.sysexData, command.sysexData + MAX_SYSEX, 0 );
+	std::copy( msg.m_sysexData.begin(),
+			   msg.m_sysexData.begin() + std::min( command.nSysexSize, MAX_SYSEX ),
+			   command.sysexData );
+	return command;
+}
+
+MidiMessage MidiCommand::toMessage() const
+{
+	MidiMessage msg;
+	msg.m_type = type;
+	msg.m_nChannel = nChannel;
+	msg.m_nData1 = nData1;
+	msg.m_nData2 = nData2;
+	msg.m_nFrameOffset = nFrameOffset;
+	msg.m_sysexData.assign( sysexData, sysexData + std::min( nSysexSize, MAX_SYSEX ) );
+	return msg;
+}
+
+MidiCommandQueue::MidiCommandQueue()
+	: m_nWritten( 0 )
+	, m_nRead( 0 )
+	, m_nDropped( 0 )
+{
+}
+
+bool MidiCommandQueue::push( const MidiCommand& command )
+{
+	const unsigned nWritten = m_nWritten.load( std::memory_order_relaxed );
+	if ( nWritten - m_nRead.load( std::memory_order_acquire ) >= SIZE ) {
+		m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+		return false;
+	}
+
+	m_commands[ nWritten & ( SIZE - 1 ) ] = command;
+	m_nWritten.store( nWritten + 1, std::memory_order_release );
+	return true;
+}
+
+bool MidiCommandQueue::pop( MidiCommand& command )
+{
+	const unsigned nRead = m_nRead.load( std::memory_order_relaxed );
+	if ( nRead == m_nWritten.load( std::memory_order_acquire ) ) {
+		return false;
+	}
+
+	command = m_commands[ nRead & ( SIZE - 1 ) ];
+	m_nRead.store( nRead + 1, std::memory_order_release );
+	return true;
+}
+
+};
@@ -0,0 +1,128 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef H2_MIDI_COMMAND_QUEUE_H
+#define H2_MIDI_COMMAND_QUEUE_H
+
+#include <core/Object.h>
+#include <core/IO/MidiCommon.h>
+
+#include <atomic>
+#include <type_traits>
+
+namespace H2Core
+{
+
+/**
+ * Trivially copyable version of a MidiMessage.
+ *
+ * In contrast to MidiMessage::m_sysexData, the SysEx data is stored
+ * in a fixed-size array. Longer messages are truncated but keep
+ * their original size in #nSysexSize.
+ *
+ * \ingroup docCore docMIDI
+ */
+struct MidiCommand {
+	/** Number of SysEx bytes stored. Sufficient for all MMC
+		messages.*/
+	static constexpr int MAX_SYSEX = 16;
+
+	MidiMessage::MidiMessageType type;
+	int nChannel;
+	int nData1;
+	int nData2;
+	/** See MidiMessage::m_nFrameOffset.*/
+	int nFrameOffset;
+	/** Size of the SysEx message the command was created from.*/
+	int nSysexSize;
+	unsigned char sysexData[ MAX_SYSEX ];
+
+	static MidiCommand fromMessage( const MidiMessage& msg );
+	/** Allocates memory and must not be called from within the
+		audio thread.*/
+	MidiMessage toMessage() const;
+};
+
+static_assert( std::is_trivially_copyable<MidiCommand>::value,
+			   "MidiCommand must be trivially copyable" );
+
+/**
+ * Bounded FIFO of MidiCommand between a single producer and a single
+ * consumer.
+ *
+ * Both push() and pop() neither lock nor allocate and finish in a
+ * bounded number of steps. This allows the MIDI drivers to hand over
+ * incoming messages from within their own realtime threads - like
+ * the process callback of the JackMidiDriver - without ever waiting
+ * for the AudioEngine. In case the consumer does not keep up, new
+ * commands are dropped and counted.
+ *
+ * \ingroup docCore docMIDI
+ */
+class MidiCommandQueue : public H2Core::Object<MidiCommandQueue>
+{
+	H2_OBJECT(MidiCommandQueue)
+public:
+	/** Number of slots. Must be a power of two.*/
+	static constexpr unsigned SIZE = 512;
+
+	MidiCommandQueue();
+
+	/** Appends @a command. Must only be called by the producer.
+	 *
+	 * \return false if the queue is full and @a command was
+	 * dropped.*/
+	bool push( const MidiCommand& command );
+	/** Removes the oldest command and stores it in @a command. Must
+	 * only be called by the consumer.
+	 *
+	 * \return false if the queue is empty.*/
+	bool pop( MidiCommand& command );
+
+	bool isEmpty() const;
+	/** \return Number of commands dropped by push() so far.*/
+	int getDroppedCount() const;
+
+private:
+	static_assert( ( SIZE & ( SIZE - 1 ) ) == 0, "SIZE must be a power of two" );
+
+	MidiCommand m_commands[ SIZE ];
+	/** Number of commands pushed so far. Only written by the
+		producer.*/
+	std::atomic<unsigned> m_nWritten;
+	/** Number of commands popped so far. Only written by the
+		consumer.*/
+	std::atomic<unsigned> m_nRead;
+	std::atomic<int> m_nDropped;
+};
+
+inline bool MidiCommandQueue::isEmpty() const {
+	return m_nRead.load( std::memory_order_acquire ) ==
+		m_nWritten.load( std::memory_order_acquire );
+}
+
+inline int MidiCommandQueue::getDroppedCount() const {
+	return m_nDropped.load( std::memory_order_relaxed );
+}
+
+};
+
+#endif // H2_MIDI_COMMAND_QUEUE_H
@@ -58,12 +58,18 @@ public:
 	int m_nData2;
 	int m_nChannel;
 	std::vector<unsigned char> m_sysexData;
+	/** Frame within the processing cycle of the AudioEngine at which
+		the message should take effect. -1 if the driver does not
+		provide any timing information. In this case the message is
+		handled at the beginning of the next cycle.*/
+	int m_nFrameOffset;
 
 	MidiMessage()
 			: m_type( UNKNOWN )
 			, m_nData1( -1 )
 			, m_nData2( -1 )
-			, m_nChannel( -1 ) {}
+			, m_nChannel( -1 )
+			, m_nFrameOffset( -1 ) {}
 };
 
 
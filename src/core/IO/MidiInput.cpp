@@ -40,6 +40,7 @@ MidiInput::MidiInput()
 		, __hihat_cc_openess ( 127 )
 		, __noteOffTick( 0 )
 		, __noteOnTick( 0 )
+		, m_bWorkerRunning( false )
 {
 	//INFOLOG( "INIT" );
 
@@ -49,17 +50,30 @@ MidiInput::MidiInput()
 MidiInput::~MidiInput()
 {
 	//INFOLOG( "DESTROY" );
+	setActive( false );
+}
+
+void MidiInput::setActive( bool isActive )
+{
+	m_bActive = isActive;
+
+	if ( isActive && ! m_worker.joinable() ) {
+		m_bWorkerRunning = true;
+		m_worker = std::thread( &MidiInput::processDeferredCommands, this );
+	} else if ( ! isActive && m_worker.joinable() ) {
+		{
+			std::lock_guard<std::mutex> lock( m_workerMutex );
+			m_bWorkerRunning = false;
+		}
+		m_workerCondition.notify_one();
+		m_worker.join();
+	}
 }
 
 void MidiInput::handleMidiMessage( const MidiMessage& msg )
 {
 		EventQueue::get_instance()->push_event( EVENT_MIDI_ACTIVITY, -1 );
 
-		INFOLOG( "[start of handleMidiMessage]" );
-		INFOLOG( QString("[handleMidiMessage] channel: %1").arg(msg.m_nChannel) );
-		INFOLOG( QString("[handleMidiMessage] val1: %1").arg( msg.m_nData1 ) );
-		INFOLOG( QString("[handleMidiMessage] val2: %1").arg( msg.m_nData2 ) );
-
 		// midi channel filter for all messages
 		bool bIsChannelValid = true;
 		Preferences* pPref = Preferences::get_instance();
@@ -86,6 +100,87 @@ void MidiInput::handleMidiMessage( const MidiMessage& msg )
 			return;
 		}
 
+		const MidiCommand command = MidiCommand::fromMessage( msg );
+
+		// Everything required to play or stop notes - including the
+		// hihat openness - is handled by the audio thread.
+		if (  MidiMessage::NOTE_ON == type
+		   || MidiMessage::NOTE_OFF == type
+		   || MidiMessage::POLYPHONIC_KEY_PRESSURE == type
+		   || ( MidiMessage::CONTROL_CHANGE == type && msg.m_nData1 == 4 )
+		) {
+			m_noteCommands.push( command );
+		}
+
+		// The worker is not notified since signalling a condition
+		// variable might enter the kernel and take a lock within
+		// the realtime thread of the driver. It polls the queue
+		// instead.
+		m_deferredCommands.push( command );
+}
+
+void MidiInput::processNoteCommands()
+{
+	MidiCommand command;
+	if ( Hydrogen::get_instance()->getSong() == nullptr ) {
+		while ( m_noteCommands.pop( command ) ) {}
+		return;
+	}
+
+	while ( m_noteCommands.pop( command ) ) {
+		switch ( command.type ) {
+		case MidiMessage::NOTE_ON:
+			if ( command.nData2 == 0 ) {
+				playNoteOff( command, false );
+			} else {
+				playNoteOn( command );
+			}
+			break;
+
+		case MidiMessage::NOTE_OFF:
+			playNoteOff( command, false );
+			break;
+
+		case MidiMessage::POLYPHONIC_KEY_PRESSURE:
+			if ( command.nData2 == 127 ) {
+				playNoteOff( command, true );
+			}
+			break;
+
+		case MidiMessage::CONTROL_CHANGE:
+			__hihat_cc_openess = command.nData2;
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void MidiInput::processDeferredCommands()
+{
+	MidiCommand command;
+	while ( m_bWorkerRunning ) {
+		while ( m_deferredCommands.pop( command ) ) {
+			handleDeferredMessage( command.toMessage() );
+		}
+
+		// Messages are picked up within the timeout. Only
+		// setActive() wakes the worker early in order to stop it.
+		std::unique_lock<std::mutex> lock( m_workerMutex );
+		m_workerCondition.wait_for( lock, std::chrono::milliseconds( 10 ), [&]() {
+			return ! m_bWorkerRunning || ! m_deferredCommands.isEmpty();
+		} );
+	}
+}
+
+void MidiInput::handleDeferredMessage( const MidiMessage& msg )
+{
+		INFOLOG( "[start of handleMidiMessage]" );
+		INFOLOG( QString("[handleMidiMessage] channel: %1").arg(msg.m_nChannel) );
+		INFOLOG( QString("[handleMidiMessage] val1: %1").arg( msg.m_nData1 ) );
+		INFOLOG( QString("[handleMidiMessage] val2: %1").arg( msg.m_nData2 ) );
+
 		Hydrogen* pHydrogen = Hydrogen::get_instance();
 		auto pAudioEngine = pHydrogen->getAudioEngine();
 		if ( ! pHydrogen->getSong() ) {
@@ -93,7 +188,7 @@ void MidiInput::handleMidiMessage( const MidiMessage& msg )
 			return;
 		}
 
-		switch ( type ) {
+		switch ( msg.m_type ) {
 		case MidiMessage::SYSEX:
 				handleSysexMessage( msg );
 				break;
@@ -187,13 +282,10 @@ void MidiInput::handleControlChangeMessage( const MidiMessage& msg )
 	MidiActionManager *pMidiActionManager = MidiActionManager::get_instance();
 	MidiMap *pMidiMap = MidiMap::get_instance();
 
-	std::shared_ptr<Action> pAction = pMidiMap->getCCAction( msg.m_nData1 );
-	pAction->setValue( QString::number( msg.m_nData2 ) );
-
-	pMidiActionManager->handleAction( pAction );
-
-	if(msg.m_nData1 == 04){
-		__hihat_cc_openess = msg.m_nData2;
+	std::shared_ptr<Action> pAction = pMidiMap->findCCAction( msg.m_nData1 );
+	if ( pAction != nullptr ) {
+		pAction->setValue( msg.m_nData2 );
+		pMidiActionManager->handleAction( pAction );
 	}
 
 	pHydrogen->lastMidiEvent = "CC";
@@ -206,15 +298,137 @@ void MidiInput::handleProgramChangeMessage( const MidiMessage& msg )
 	MidiActionManager *pMidiActionManager = MidiActionManager::get_instance();
 	MidiMap *pMidiMap = MidiMap::get_instance();
 
-	std::shared_ptr<Action> pAction = pMidiMap->getPCAction();
-	pAction->setValue( QString::number( msg.m_nData1 ) );
-
-	pMidiActionManager->handleAction( pAction );
+	std::shared_ptr<Action> pAction = pMidiMap->findPCAction();
+	if ( pAction != nullptr ) {
+		pAction->setValue( msg.m_nData1 );
+		pMidiActionManager->handleAction( pAction );
+	}
 
 	pHydrogen->lastMidiEvent = "PROGRAM_CHANGE";
 	pHydrogen->lastMidiEventParameter = 0;
 }
 
+std::shared_ptr<Instrument> MidiInput::findInstrument( int nNote, int* pInstrumentNumber,
+													   bool bHihatOpenness ) const
+{
+	Hydrogen *pHydrogen = Hydrogen::get_instance();
+	Preferences* pPref = Preferences::get_instance();
+	InstrumentList *pInstrList = pHydrogen->getSong()->getInstrumentList();
+	std::shared_ptr<Instrument> pInstr = nullptr;
+	int nInstrument = nNote - 36;
+
+	if ( pPref->__playselectedinstrument ) {
+		nInstrument = pHydrogen->getSelectedInstrumentNumber();
+		if ( nInstrument >= 0 && nInstrument < pInstrList->size() ) {
+			pInstr = pInstrList->get( nInstrument );
+		}
+	} else if ( pPref->m_bMidiFixedMapping ) {
+		pInstr = pInstrList->findMidiNote( nNote );
+		if ( pInstr != nullptr ) {
+			nInstrument = pInstrList->index( pInstr );
+		}
+	} else if ( nInstrument >= 0 && nInstrument < pInstrList->size() ) {
+		// Everything < 36 is dropped.
+		pInstr = pInstrList->get( static_cast<uint>(nInstrument) );
+	}
+
+	/*
+	Only look to change instrument if the
+	current note is actually of hihat and
+	hihat openness is outside the instrument selected
+	*/
+	const int nOpenness = __hihat_cc_openess;
+	if ( bHihatOpenness &&
+		 pInstr != nullptr &&
+		 pInstr->get_hihat_grp() >= 0 &&
+		 ( nOpenness < pInstr->get_lower_cc() || nOpenness > pInstr->get_higher_cc() ) )
+	{
+		for ( int i = 0; i < pInstrList->size(); i++ ) {
+			auto instr_contestant = pInstrList->get( i );
+			if ( instr_contestant != nullptr &&
+				 pInstr->get_hihat_grp() == instr_contestant->get_hihat_grp() &&
+				 nOpenness >= instr_contestant->get_lower_cc() &&
+				 nOpenness <= instr_contestant->get_higher_cc() )
+			{
+				nInstrument = i;
+				pInstr = instr_contestant;
+				break;
+			}
+		}
+	}
+
+	*pInstrumentNumber = nInstrument;
+	return pInstr;
+}
+
+void MidiInput::playNoteOn( const MidiCommand& command )
+{
+	Hydrogen *pHydrogen = Hydrogen::get_instance();
+	AudioEngine* pAudioEngine = pHydrogen->getAudioEngine();
+	Preferences* pPref = Preferences::get_instance();
+	const int nNote = command.nData1;
+
+	if ( pPref->m_bMidiDiscardNoteAfterAction &&
+		 MidiMap::get_instance()->isNoteMapped( nNote ) ) {
+		return;
+	}
+
+	int nInstrument;
+	std::shared_ptr<Instrument> pInstr = findInstrument( nNote, &nInstrument, true );
+	if ( pInstr == nullptr ) {
+		return;
+	}
+	if ( ! pPref->__playselectedinstrument ) {
+		pInstr = pHydrogen->getSong()->getInstrumentList()->
+			get( pHydrogen->m_nInstrumentLookupTable[ nInstrument ] );
+		if ( pInstr == nullptr ) {
+			return;
+		}
+	}
+
+	Note* pNote = pAudioEngine->getNotePool()->
+		acquire( pInstr, 0, command.nData2 / 127.0, 0.f, -1, 0 );
+	if ( pNote == nullptr ) {
+		return;
+	}
+
+	if ( pPref->__playselectedinstrument ) {
+		int divider = nNote / 12;
+		Note::Octave octave = (Note::Octave)(divider -3);
+		Note::Key notehigh = (Note::Key)(nNote - (12 * divider));
+		pNote->set_midi_info( notehigh, octave, nNote );
+	}
+
+	pAudioEngine->noteOn( pNote, command.nFrameOffset );
+}
+
+void MidiInput::playNoteOff( const MidiCommand& command, bool bCymbalChoke )
+{
+	if ( !bCymbalChoke && Preferences::get_instance()->m_bMidiNoteOffIgnore ) {
+		return;
+	}
+
+	AudioEngine* pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	Sampler* pSampler = pAudioEngine->getSampler();
+
+	int nInstrument;
+	std::shared_ptr<Instrument> pInstr = findInstrument( command.nData1, &nInstrument, false );
+	if ( pInstr == nullptr || ! pSampler->isInstrumentPlaying( pInstr ) ) {
+		return;
+	}
+
+	if ( Preferences::get_instance()->__playselectedinstrument ) {
+		pSampler->midiKeyboardNoteOff( command.nData1 );
+	} else {
+		Note *pOffNote = pAudioEngine->getNotePool()->acquire( pInstr, 0, 0.0, 0.0, -1, 0 );
+		if ( pOffNote != nullptr ) {
+			pOffNote->set_note_off( true );
+			pSampler->noteOn( pOffNote );
+			pAudioEngine->getNotePool()->release( pOffNote );
+		}
+	}
+}
+
 void MidiInput::handleNoteOnMessage( const MidiMessage& msg )
 {
 //	INFOLOG( "handleNoteOnMessage" );
@@ -235,80 +449,25 @@ void MidiInput::handleNoteOnMessage( const MidiMessage& msg )
 	pHydrogen->lastMidiEvent = "NOTE";
 	pHydrogen->lastMidiEventParameter = msg.m_nData1;
 
-	bool bActionSuccess = pMidiActionManager->handleAction( pMidiMap->getNoteAction( msg.m_nData1 ) );
+	pMidiActionManager->handleAction( pMidiMap->findNoteAction( msg.m_nData1 ) );
 
-	if ( bActionSuccess && Preferences::get_instance()->m_bMidiDiscardNoteAfterAction)
-	{
+	// The note itself was already played by the audio thread in
+	// playNoteOn(). What is left is recording it.
+	if ( pMidiMap->isNoteMapped( nNote ) &&
+		 Preferences::get_instance()->m_bMidiDiscardNoteAfterAction ) {
 		return;
 	}
 
-	bool bPatternSelect = false;
-
-	if ( bPatternSelect ) {
-		int patternNumber = nNote - 36;
-		//INFOLOG( QString( "next pattern = %1" ).arg( patternNumber ) );
-		pHydrogen->sequencer_setNextPattern( patternNumber );
+	static const float fPan = 0.f;
 
-	} else {
-		static const float fPan = 0.f;
-
-		int nInstrument = nNote - 36;
-		InstrumentList *pInstrList = pHydrogen->getSong()->getInstrumentList();
-		std::shared_ptr<Instrument> pInstr = nullptr;
-		
-		if ( Preferences::get_instance()->__playselectedinstrument ){
-			nInstrument = pHydrogen->getSelectedInstrumentNumber();
-			pInstr= pInstrList->get( pHydrogen->getSelectedInstrumentNumber());
-		}
-		else if(Preferences::get_instance()->m_bMidiFixedMapping ){
-			pInstr = pInstrList->findMidiNote( nNote );
-			
-			if(pInstr == nullptr) {
-				WARNINGLOG( QString( "Can't find corresponding Instrument for note %1" ).arg( nNote ));
-				return;
-			}
-			
-			nInstrument = pInstrList->index( pInstr );
-		} else {
-			if(nInstrument < 0) {
-				//Drop everything < 36
-				return;
-			}
-			
-			if( nInstrument >= pInstrList->size()) {
-				WARNINGLOG( QString( "Can't find corresponding Instrument for note %1" ).arg( nNote ));
-				return;
-			}
-			
-			pInstr = pInstrList->get( static_cast<uint>(nInstrument) );
-		}
-
-		/*
-		Only look to change instrument if the
-		current note is actually of hihat and
-		hihat openness is outside the instrument selected
-		*/
-		if ( pInstr != nullptr &&
-			 pInstr->get_hihat_grp() >= 0 &&
-			 ( __hihat_cc_openess < pInstr->get_lower_cc() || __hihat_cc_openess > pInstr->get_higher_cc() ) )
-		{
-			for(int i=0 ; i<=pInstrList->size() ; i++)
-			{
-				auto instr_contestant = pInstrList->get( i );
-				if( instr_contestant != nullptr &&
-						pInstr->get_hihat_grp() == instr_contestant->get_hihat_grp() &&
-						__hihat_cc_openess >= instr_contestant->get_lower_cc() &&
-						__hihat_cc_openess <= instr_contestant->get_higher_cc() )
-				{
-					nInstrument = i;
-					break;
-				}
-			}
-		}
-
-		pHydrogen->addRealtimeNote( nInstrument, fVelocity, fPan, 0.0, false, true, nNote );
+	int nInstrument;
+	if ( findInstrument( nNote, &nInstrument, true ) == nullptr ) {
+		WARNINGLOG( QString( "Can't find corresponding Instrument for note %1" ).arg( nNote ));
+		return;
 	}
 
+	pHydrogen->addRealtimeNote( nInstrument, fVelocity, fPan, 0.0, false, true, nNote, false );
+
 	__noteOnTick = pAudioEngine->getAddRealtimeNoteTickPosition();
 }
 
@@ -330,42 +489,24 @@ void MidiInput::handleNoteOffMessage( const MidiMessage& msg, bool CymbalChoke )
 	if ( !CymbalChoke && Preferences::get_instance()->m_bMidiNoteOffIgnore ) {
 		return;
 	}
+	// The note was already stopped by the audio thread in
+	// playNoteOff(). What is left is recording its length.
+	if ( ! Preferences::get_instance()->getRecordEvents() ) {
+		return;
+	}
 
 	Hydrogen *pHydrogen = Hydrogen::get_instance();
-	InstrumentList* pInstrList = pHydrogen->getSong()->getInstrumentList();
 
 	__noteOffTick = pHydrogen->getAudioEngine()->getPatternTickPosition();
 	unsigned long notelength = computeDeltaNoteOnOfftime();
 
 	int nNote = msg.m_nData1;
 	//float fVelocity = msg.m_nData2 / 127.0; //we need this in future to control release velocity
-	int nInstrument = nNote - 36;
-	std::shared_ptr<Instrument> pInstr = nullptr;
-
-	if ( Preferences::get_instance()->__playselectedinstrument ){
-		nInstrument = pHydrogen->getSelectedInstrumentNumber();
-		pInstr = pInstrList->get( pHydrogen->getSelectedInstrumentNumber());
-	} else if( Preferences::get_instance()->m_bMidiFixedMapping ) {
-		pInstr = pInstrList->findMidiNote( nNote );
-
-		if( pInstr == nullptr ) {
-			WARNINGLOG( QString( "Can't find corresponding Instrument for note %1" ).arg( nNote ));
-			return;
-		}
-		nInstrument = pInstrList->index(pInstr);
-	}
-	else {
-		if( nInstrument < 0 ) {
-			//Drop everything < 36
-			return;
-		}
-		
-		if( nInstrument >= pInstrList->size()) {
-			WARNINGLOG( QString( "Can't find corresponding Instrument for note %1" ).arg( nNote ));
-			return;
-		}
-		
-		pInstr =  pInstrList->get(nInstrument);
+	int nInstrument;
+	std::shared_ptr<Instrument> pInstr = findInstrument( nNote, &nInstrument, false );
+	if ( pInstr == nullptr ) {
+		WARNINGLOG( QString( "Can't find corresponding Instrument for note %1" ).arg( nNote ));
+		return;
 	}
 
 	float fStep = pow( 1.0594630943593, (nNote) );
@@ -373,32 +514,7 @@ void MidiInput::handleNoteOffMessage( const MidiMessage& msg, bool CymbalChoke )
 		fStep = 1;
 	}
 
-	bool use_note_off = Hydrogen::get_instance()->getAudioEngine()->getSampler()->isInstrumentPlaying( pInstr );
-	if(use_note_off){
-		if ( Preferences::get_instance()->__playselectedinstrument ){
-			Hydrogen::get_instance()->getAudioEngine()->getSampler()->midiKeyboardNoteOff( msg.m_nData1 );
-		}
-		else
-		{
-			if ( pInstrList->size() < nInstrument +1 ) {
-				return;
-			}
-			
-			Note *pOffNote = new Note( pInstr,
-										0.0,
-										0.0,
-										0.0,
-										-1,
-										0 );
-			pOffNote->set_note_off( true );
-			Hydrogen::get_instance()->getAudioEngine()->getSampler()->noteOn( pOffNote );
-			delete pOffNote;
-		}
-		
-		if(Preferences::get_instance()->getRecordEvents()) {
-			Hydrogen::get_instance()->getAudioEngine()->getSampler()->setPlayingNotelength( pInstr, notelength * fStep, __noteOnTick );
-		}
-	}
+	pHydrogen->getAudioEngine()->getSampler()->setPlayingNotelength( pInstr, notelength * fStep, __noteOnTick );
 }
 
 
@@ -24,15 +24,32 @@
 #define H2_MIDI_INPUT_H
 
 #include <core/Object.h>
+#include <core/IO/MidiCommandQueue.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include "MidiCommon.h"
 
 namespace H2Core
 {
 
+class Instrument;
+
 /**
  * MIDI input base class
+ *
+ * Incoming messages are split into two parts. Everything affecting
+ * the playback of notes is turned into MidiCommand and handed over
+ * to the audio thread via a wait-free queue. It is processed by
+ * processNoteCommands() at the beginning of each cycle of the
+ * AudioEngine. All remaining work - dispatching of MIDI actions,
+ * recording of notes into patterns, and transport control - is done
+ * by a worker thread. This way the driver threads never have to wait
+ * for the lock of the AudioEngine, which might be held by the GUI.
  */
 /** \ingroup docCore docMIDI */
 class MidiInput : public virtual Object<MidiInput>
@@ -46,10 +63,25 @@ public:
 	virtual void close() = 0;
 	virtual std::vector<QString> getOutputPortList() = 0;
 
-	void setActive( bool isActive ) {
-		m_bActive = isActive;
-	}
+	/** Starts or stops the worker thread handling the non-realtime
+	 * parts of incoming messages.
+	 *
+	 * Deactivation waits for the worker to finish. It must thus not
+	 * be called while holding the lock of the AudioEngine.*/
+	void setActive( bool isActive );
+	/** Entry point for all incoming messages.
+	 *
+	 * Neither locks, waits, nor signals other threads and can be
+	 * called from within the realtime thread of a driver. The worker
+	 * polls for new messages every 10 ms instead. There must be at
+	 * most one thread calling it at a time.*/
 	void handleMidiMessage( const MidiMessage& msg );
+	/** Triggers and stops the notes of all messages received since
+	 * the last call.
+	 *
+	 * Called by AudioEngine::audioEngine_process() while holding the
+	 * lock of the AudioEngine.*/
+	void processNoteCommands();
 	void handleSysexMessage( const MidiMessage& msg );
 	void handleControlChangeMessage( const MidiMessage& msg );
 	void handleProgramChangeMessage( const MidiMessage& msg );
@@ -67,7 +99,37 @@ private:
 	unsigned long  __noteOffTick;
 	unsigned long computeDeltaNoteOnOfftime();
 
-	int __hihat_cc_openess;
+	/** Looks up the instrument triggered by @a nNote.
+	 *
+	 * \param nNote MIDI note.
+	 * \param pInstrumentNumber Index of the instrument. Used by
+	 *   Hydrogen::addRealtimeNote().
+	 * \param bHihatOpenness Whether to pick the instrument of the
+	 *   hihat group matching the current openness.
+	 *
+	 * \return nullptr if no instrument corresponds to @a nNote.*/
+	std::shared_ptr<Instrument> findInstrument( int nNote, int* pInstrumentNumber,
+												bool bHihatOpenness ) const;
+	/** Realtime part of handleNoteOnMessage().*/
+	void playNoteOn( const MidiCommand& command );
+	/** Realtime part of handleNoteOffMessage().*/
+	void playNoteOff( const MidiCommand& command, bool bCymbalChoke );
+	/** Main loop of #m_worker.*/
+	void processDeferredCommands();
+	/** Non-realtime handling of @a msg within #m_worker.*/
+	void handleDeferredMessage( const MidiMessage& msg );
+
+	/** Consumed by the audio thread in processNoteCommands().*/
+	MidiCommandQueue m_noteCommands;
+	/** Consumed by #m_worker.*/
+	MidiCommandQueue m_deferredCommands;
+	std::thread m_worker;
+	std::mutex m_workerMutex;
+	std::condition_variable m_workerCondition;
+	std::atomic<bool> m_bWorkerRunning;
+
+	/** Updated by the audio thread and read by the worker.*/
+	std::atomic<int> __hihat_cc_openess;
 };
 
 };
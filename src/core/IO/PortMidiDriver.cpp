@@ -27,8 +27,10 @@
 #include <core/Basics/Instrument.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Hydrogen.h>
+#include <core/AudioEngine/AudioEngine.h>
 #include <core/Globals.h>
 
+#include <algorithm>
 
 #ifdef WIN32
 #include <windows.h>
@@ -63,6 +65,13 @@ void* PortMidiDriver_thread( void* param )
 			if ( length > 0 ) {
 				MidiMessage msg;
 
+				// PortMidi stamps the events with the millisecond
+				// clock started in open(). Use it to compensate for
+				// the time the event spent in the buffer.
+				const long long nDelay = std::max( 0, Pt_Time() - buffer[0].timestamp );
+				msg.m_nFrameOffset = Hydrogen::get_instance()->getAudioEngine()->
+					computeFrameOffset( ProcessProfiler::now() - nDelay * 1000000LL );
+
 				int nEventType = Pm_MessageStatus( buffer[0].message );
 				if ( ( nEventType >= 128 ) && ( nEventType < 144 ) ) {	// note off
 					msg.m_nChannel = nEventType - 128;
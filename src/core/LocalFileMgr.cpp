@@ -549,6 +549,7 @@ int SongWriter::writeSong( std::shared_ptr<Song> pSong, const QString& filename
 		LocalFileMng::writeXmlString( instrumentNode, "isHihat", QString("%1").arg( pInstr->get_hihat_grp() ) );
 		LocalFileMng::writeXmlString( instrumentNode, "lower_cc", QString("%1").arg( pInstr->get_lower_cc() ) );
 		LocalFileMng::writeXmlString( instrumentNode, "higher_cc", QString("%1").arg( pInstr->get_higher_cc() ) );
+		LocalFileMng::writeXmlString( instrumentNode, "voicePriority", QString("%1").arg( pInstr->getVoicePriority() ) );
 
 		for ( const auto& pComponent : *pInstr->get_components() ) {
 
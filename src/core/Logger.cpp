@@ -23,6 +23,7 @@
 #include "core/Logger.h"
 #include "core/Helpers/Filesystem.h"
 
+#include <chrono>
 #include <cstdio>
 #include <QtCore/QDir>
 #include <QtCore/QString>
@@ -65,8 +66,18 @@ void* loggerThread_func( void* param ) {
 	Logger::queue_t::iterator it, last;
 
 	while ( logger->__running ) {
-		pthread_cond_wait( &logger->__messages_available, &logger->__mutex );
+		// Messages written by log_rt() do not signal the condition
+		// variable. Wake up regularly to check for them.
+		const long long nTimeout = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			( std::chrono::system_clock::now() +
+			  std::chrono::milliseconds( Logger::RT_POLL_INTERVAL ) ).time_since_epoch() ).count();
+		struct timespec timeout;
+		timeout.tv_sec = nTimeout / 1000000000;
+		timeout.tv_nsec = nTimeout % 1000000000;
+		pthread_mutex_lock( &logger->__mutex );
+		pthread_cond_timedwait( &logger->__messages_available, &logger->__mutex, &timeout );
 		pthread_mutex_unlock( &logger->__mutex );
+		logger->flush_rt();
 		if( !queue->empty() ) {
 			for( it = last = queue->begin() ; it != queue->end() ; ++it ) {
 				last = it;
@@ -106,8 +117,16 @@ Logger* Logger::create_instance() {
 	return __instance;
 }
 
-Logger::Logger() : __use_file( true ), __running( true ) {
+Logger::Logger() : __use_file( true ),
+				   __running( true ),
+				   __rt_write_index( 0 ),
+				   __rt_read_index( 0 ),
+				   __rt_dropped( 0 ),
+				   __rt_dropped_reported( 0 ) {
 	__instance = this;
+	for ( unsigned i = 0; i < RT_QUEUE_SIZE; ++i ) {
+		__rt_queue[ i ].sequence.store( i, std::memory_order_relaxed );
+	}
 	pthread_attr_t attr;
 	pthread_attr_init( &attr );
 	pthread_mutex_init( &__mutex, nullptr );
@@ -168,6 +187,79 @@ void Logger::log( unsigned level, const QString& class_name, const char* func_na
 	pthread_cond_broadcast( &__messages_available );
 }
 
+void Logger::push_rt( unsigned level, const char* class_name, const char* func_name,
+					  const char* format, int nargs, const RtArg* args ) {
+	unsigned nIndex = __rt_write_index.load( std::memory_order_relaxed );
+	while ( true ) {
+		RtRecord* pRecord = &__rt_queue[ nIndex % RT_QUEUE_SIZE ];
+		const unsigned nSequence = pRecord->sequence.load( std::memory_order_acquire );
+		const int nDiff = static_cast<int>( nSequence - nIndex );
+
+		if ( nDiff == 0 ) {
+			if ( __rt_write_index.compare_exchange_weak( nIndex, nIndex + 1,
+														 std::memory_order_relaxed ) ) {
+				pRecord->level = level;
+				pRecord->class_name = class_name;
+				pRecord->func_name = func_name;
+				pRecord->format = format;
+				pRecord->nargs = nargs;
+				for ( int i = 0; i < nargs; ++i ) {
+					pRecord->args[ i ] = args[ i ];
+				}
+				pRecord->sequence.store( nIndex + 1, std::memory_order_release );
+				return;
+			}
+		}
+		else if ( nDiff < 0 ) {
+			// The logger thread did not catch up yet.
+			__rt_dropped.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+		else {
+			nIndex = __rt_write_index.load( std::memory_order_relaxed );
+		}
+	}
+}
+
+QString Logger::format_rt( const char* format, int nargs, const RtArg* args ) {
+	QString sMsg( format );
+	for ( int i = 0; i < nargs; ++i ) {
+		if ( args[ i ].bIntegral ) {
+			sMsg = sMsg.arg( static_cast<qlonglong>( args[ i ].nValue ) );
+		} else {
+			sMsg = sMsg.arg( args[ i ].fValue );
+		}
+	}
+	return sMsg;
+}
+
+void Logger::flush_rt() {
+	while ( true ) {
+		RtRecord* pRecord = &__rt_queue[ __rt_read_index % RT_QUEUE_SIZE ];
+		if ( pRecord->sequence.load( std::memory_order_acquire ) != __rt_read_index + 1 ) {
+			break;
+		}
+
+		const QString sMsg = format_rt( pRecord->format, pRecord->nargs, pRecord->args );
+		const unsigned level = pRecord->level;
+		const char* class_name = pRecord->class_name;
+		const char* func_name = pRecord->func_name;
+
+		// Hand the slot back to the writers.
+		pRecord->sequence.store( __rt_read_index + RT_QUEUE_SIZE, std::memory_order_release );
+		++__rt_read_index;
+
+		log( level, class_name, func_name, sMsg );
+	}
+
+	const unsigned nDropped = __rt_dropped.load( std::memory_order_relaxed );
+	if ( nDropped != __rt_dropped_reported ) {
+		log( Warning, "Logger", "flush_rt", QString( "%1 real-time messages dropped" )
+			 .arg( nDropped - __rt_dropped_reported ) );
+		__rt_dropped_reported = nDropped;
+	}
+}
+
 unsigned Logger::parse_log_level( const char* level ) {
 	unsigned log_level = Logger::None;
 	if( 0 == strncasecmp( level, __levels[0], strlen( __levels[0] ) ) ) {
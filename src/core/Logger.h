@@ -23,10 +23,12 @@
 #ifndef H2C_LOGGER_H
 #define H2C_LOGGER_H
 
+#include <atomic>
 #include <cassert>
 #include <list>
 #include <pthread.h>
 #include <memory>
+#include <type_traits>
 
 #include <core/config.h>
 
@@ -113,6 +115,81 @@ class Logger {
 		 * \param msg the message to log
 		 */
 		void log( unsigned level, const QString& class_name, const char* func_name, const QString& msg );
+		/**
+		 * Real-time safe variant of log() to be used within the
+		 * audio thread.
+		 *
+		 * Instead of formatting the message right away a record
+		 * holding pointers to the strings and the numerical
+		 * arguments is written into the lock-free ring
+		 * #__rt_queue. Neither memory is allocated nor a mutex is
+		 * locked. The logger thread does format the messages and
+		 * passes them to log() at most #RT_POLL_INTERVAL
+		 * milliseconds later.
+		 *
+		 * If the ring is full, the record is dropped and counted in
+		 * #__rt_dropped.
+		 *
+		 * \param level used to output the corresponding level string
+		 * \param class_name the name of the calling class. Has to
+		 *   have static storage duration.
+		 * \param func_name the name of the calling function/method.
+		 *   Has to have static storage duration.
+		 * \param format message containing the placeholders %1 to
+		 *   %4 like a QString. Has to be a string literal.
+		 * \param args up to #RT_MAX_ARGS numerical values the
+		 *   placeholders are replaced by.
+		 */
+		template <typename... Args>
+		void log_rt( unsigned level, const char* class_name, const char* func_name,
+					 const char* format, Args... args );
+		/** \return Number of records of log_rt() dropped since the
+			ring was full.*/
+		unsigned get_rt_dropped_count() const {
+			return __rt_dropped.load( std::memory_order_relaxed );
+		}
+
+		/** Numerical argument of log_rt(). Integral values are
+			stored and formatted exactly, floating point ones like
+			QString::arg( double ) does.*/
+		struct RtArg {
+			RtArg() : bIntegral( true ), nValue( 0 ) {}
+			template <typename T>
+			RtArg( T value ) {
+				set( value, std::integral_constant<bool, std::is_integral<T>::value ||
+							 std::is_enum<T>::value>() );
+			}
+
+			bool bIntegral;
+			union {
+				long long nValue;
+				double fValue;
+			};
+
+		private:
+			template <typename T>
+			void set( T value, std::true_type ) {
+				bIntegral = true;
+				nValue = static_cast<long long>( value );
+			}
+			template <typename T>
+			void set( T value, std::false_type ) {
+				bIntegral = false;
+				fValue = static_cast<double>( value );
+			}
+		};
+		/** Replaces the placeholders %1 to %4 of \a format by the
+			first \a nargs elements of \a args. Used by the logger
+			thread to format the records of log_rt().*/
+		static QString format_rt( const char* format, int nargs, const RtArg* args );
+
+		/** Number of records the ring of log_rt() can hold.*/
+		static constexpr unsigned RT_QUEUE_SIZE = 512;
+		/** Maximum number of arguments of a single log_rt() call.*/
+		static constexpr int RT_MAX_ARGS = 4;
+		/** Time in milliseconds between two checks of the ring of
+			log_rt() by the logger thread.*/
+		static constexpr int RT_POLL_INTERVAL = 50;
 		/**
 		 * needed for being able to access logger internal
 		 * \param param is a pointer to the logger instance
@@ -120,6 +197,28 @@ class Logger {
 		friend void* loggerThread_func( void* param );
 
 	private:
+		/** Unformatted message written by log_rt().*/
+		struct RtRecord {
+			/** Used to hand the record from the writers to the
+				logger thread. Equals the index of the next write if
+				the slot is free and the index plus one if it holds
+				a record not read yet.*/
+			std::atomic<unsigned> sequence;
+			unsigned level;
+			const char* class_name;
+			const char* func_name;
+			const char* format;
+			int nargs;
+			RtArg args[ RT_MAX_ARGS ];
+		};
+
+		/** Writes a record into #__rt_queue. Called by log_rt().*/
+		void push_rt( unsigned level, const char* class_name, const char* func_name,
+					  const char* format, int nargs, const RtArg* args );
+		/** Formats all records in #__rt_queue and passes them to
+			log(). Called by the logger thread.*/
+		void flush_rt();
+
 		/**
 		 * Object holding the current H2Core::Logger
 		 * singleton. It is initialized with NULL, set with
@@ -134,6 +233,15 @@ class Logger {
 		static unsigned __bit_msk;      ///< the bitmask of log_level_t
 		static const char* __levels[];  ///< levels strings
 		pthread_cond_t __messages_available;
+		/** Ring of records written by log_rt().*/
+		RtRecord __rt_queue[ RT_QUEUE_SIZE ];
+		std::atomic<unsigned> __rt_write_index;
+		/** Only accessed by the logger thread.*/
+		unsigned __rt_read_index;
+		std::atomic<unsigned> __rt_dropped;
+		/** Value of #__rt_dropped at the time of the last report.
+			Only accessed by the logger thread.*/
+		unsigned __rt_dropped_reported;
 
 		/** constructor */
 		Logger();
@@ -149,6 +257,15 @@ class Logger {
 #endif // HAVE_SSCANF
 };
 
+template <typename... Args>
+inline void Logger::log_rt( unsigned level, const char* class_name, const char* func_name,
+							const char* format, Args... args ) {
+	static_assert( sizeof...( Args ) <= RT_MAX_ARGS, "Too many arguments for Logger::log_rt()" );
+	// The leading element allows for calls without arguments.
+	const RtArg values[] = { RtArg(), args... };
+	push_rt( level, class_name, func_name, format, sizeof...( Args ), values + 1 );
+}
+
 };
 
 #endif // H2C_LOGGER_H
@@ -69,10 +69,14 @@ using namespace H2Core;
 
 Action::Action( QString sType ) {
 	m_sType = sType;
+	m_nId = MidiActionManager::getActionId( sType );
 	m_sParameter1 = "0";
 	m_sParameter2 = "0";
 	m_sParameter3 = "0";
-	m_sValue = "0";
+	m_nParameter1 = 0;
+	m_nParameter2 = 0;
+	m_nParameter3 = 0;
+	m_nValue = 0;
 }
 
 QString Action::toQString( const QString& sPrefix, bool bShort ) const {
@@ -81,14 +85,16 @@ QString Action::toQString( const QString& sPrefix, bool bShort ) const {
 	if ( ! bShort ) {
 		sOutput = QString( "%1[Action]\n" ).arg( sPrefix )
 			.append( QString( "%1%2m_sType: %3\n" ).arg( sPrefix ).arg( s ).arg( m_sType ) )
-			.append( QString( "%1%2m_sValue: %3\n" ).arg( sPrefix ).arg( s ).arg( m_sValue ) )
+			.append( QString( "%1%2m_nId: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nId ) )
+			.append( QString( "%1%2m_nValue: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nValue ) )
 			.append( QString( "%1%2m_sParameter1: %3\n" ).arg( sPrefix ).arg( s ).arg( m_sParameter1 ) )
 			.append( QString( "%1%2m_sParameter2: %3\n" ).arg( sPrefix ).arg( s ).arg( m_sParameter2 ) )
 			.append( QString( "%1%2m_sParameter3: %3\n" ).arg( sPrefix ).arg( s ).arg( m_sParameter3 ) );
 	} else {
 		sOutput = QString( "[Action]" )
 			.append( QString( "m_sType: %1\n" ).arg( m_sType ) )
-			.append( QString( "m_sValue: %1\n" ).arg( m_sValue ) )
+			.append( QString( "m_nId: %1\n" ).arg( m_nId ) )
+			.append( QString( "m_nValue: %1\n" ).arg( m_nValue ) )
 			.append( QString( "m_sParameter1: %1\n" ).arg( m_sParameter1 ) )
 			.append( QString( "m_sParameter2: %1\n" ).arg( m_sParameter2 ) )
 			.append( QString( "m_sParameter3: %1\n" ).arg( m_sParameter3 ) );
@@ -112,66 +118,69 @@ QString Action::toQString( const QString& sPrefix, bool bShort ) const {
 */
 MidiActionManager* MidiActionManager::__instance = nullptr;
 
+const MidiActionManager::ActionInfo MidiActionManager::s_actionTable[] = {
+	{ "PLAY", &MidiActionManager::play, 0 },
+	{ "PLAY/STOP_TOGGLE", &MidiActionManager::play_stop_pause_toggle, 0 },
+	{ "PLAY/PAUSE_TOGGLE", &MidiActionManager::play_stop_pause_toggle, 0 },
+	{ "STOP", &MidiActionManager::stop, 0 },
+	{ "PAUSE", &MidiActionManager::pause, 0 },
+	{ "RECORD_READY", &MidiActionManager::record_ready, 0 },
+	{ "RECORD/STROBE_TOGGLE", &MidiActionManager::record_strobe_toggle, 0 },
+	{ "RECORD_STROBE", &MidiActionManager::record_strobe, 0 },
+	{ "RECORD_EXIT", &MidiActionManager::record_exit, 0 },
+	{ "MUTE", &MidiActionManager::mute, 0 },
+	{ "UNMUTE", &MidiActionManager::unmute, 0 },
+	{ "MUTE_TOGGLE", &MidiActionManager::mute_toggle, 0 },
+	{ "STRIP_MUTE_TOGGLE", &MidiActionManager::strip_mute_toggle, 1 },
+	{ "STRIP_SOLO_TOGGLE", &MidiActionManager::strip_solo_toggle, 1 },
+	{ "_NEXT_BAR", &MidiActionManager::next_bar, 0 },
+	{ "<<_PREVIOUS_BAR", &MidiActionManager::previous_bar, 0 },
+	{ "BPM_INCR", &MidiActionManager::bpm_increase, 1 },
+	{ "BPM_DECR", &MidiActionManager::bpm_decrease, 1 },
+	{ "BPM_CC_RELATIVE", &MidiActionManager::bpm_cc_relative, 1 },
+	{ "BPM_FINE_CC_RELATIVE", &MidiActionManager::bpm_fine_cc_relative, 1 },
+	{ "MASTER_VOLUME_RELATIVE", &MidiActionManager::master_volume_relative, 0 },
+	{ "MASTER_VOLUME_ABSOLUTE", &MidiActionManager::master_volume_absolute, 0 },
+	{ "STRIP_VOLUME_RELATIVE", &MidiActionManager::strip_volume_relative, 1 },
+	{ "STRIP_VOLUME_ABSOLUTE", &MidiActionManager::strip_volume_absolute, 1 },
+	{ "EFFECT_LEVEL_ABSOLUTE", &MidiActionManager::effect_level_absolute, 2 },
+	{ "EFFECT_LEVEL_RELATIVE", &MidiActionManager::effect_level_relative, 2 },
+	{ "GAIN_LEVEL_ABSOLUTE", &MidiActionManager::gain_level_absolute, 3 },
+	{ "PITCH_LEVEL_ABSOLUTE", &MidiActionManager::pitch_level_absolute, 3 },
+	{ "SELECT_NEXT_PATTERN", &MidiActionManager::select_next_pattern, 1 },
+	{ "SELECT_ONLY_NEXT_PATTERN", &MidiActionManager::select_only_next_pattern, 1 },
+	{ "SELECT_NEXT_PATTERN_CC_ABSOLUTE", &MidiActionManager::select_next_pattern_cc_absolute, 0 },
+	{ "SELECT_NEXT_PATTERN_RELATIVE", &MidiActionManager::select_next_pattern_relative, 1 },
+	{ "SELECT_AND_PLAY_PATTERN", &MidiActionManager::select_and_play_pattern, 1 },
+	{ "PAN_RELATIVE", &MidiActionManager::pan_relative, 1 },
+	{ "PAN_ABSOLUTE", &MidiActionManager::pan_absolute, 1 },
+	{ "FILTER_CUTOFF_LEVEL_ABSOLUTE", &MidiActionManager::filter_cutoff_level_absolute, 1 },
+	{ "BEATCOUNTER", &MidiActionManager::beatcounter, 0 },
+	{ "TAP_TEMPO", &MidiActionManager::tap_tempo, 0 },
+	{ "PLAYLIST_SONG", &MidiActionManager::playlist_song, 1 },
+	{ "PLAYLIST_NEXT_SONG", &MidiActionManager::playlist_next_song, 0 },
+	{ "PLAYLIST_PREV_SONG", &MidiActionManager::playlist_previous_song, 0 },
+	{ "TOGGLE_METRONOME", &MidiActionManager::toggle_metronome, 0 },
+	{ "SELECT_INSTRUMENT", &MidiActionManager::select_instrument, 0 },
+	{ "UNDO_ACTION", &MidiActionManager::undo_action, 0 },
+	{ "REDO_ACTION", &MidiActionManager::redo_action, 0 },
+};
+
+const int MidiActionManager::s_nActions =
+	sizeof( MidiActionManager::s_actionTable ) / sizeof( MidiActionManager::ActionInfo );
+
 MidiActionManager::MidiActionManager() {
 	__instance = this;
 
 	m_nLastBpmChangeCCParameter = -1;
-	/*
-		the m_actionMap holds all Action identifiers which hydrogen is able to interpret.
-		it holds pointer to member function
-	*/
-	m_actionMap.insert(std::make_pair("PLAY", std::make_pair( &MidiActionManager::play, 0 ) ));
-	m_actionMap.insert(std::make_pair("PLAY/STOP_TOGGLE", std::make_pair( &MidiActionManager::play_stop_pause_toggle, 0 ) ));
-	m_actionMap.insert(std::make_pair("PLAY/PAUSE_TOGGLE", std::make_pair( &MidiActionManager::play_stop_pause_toggle, 0 ) ));
-	m_actionMap.insert(std::make_pair("STOP", std::make_pair( &MidiActionManager::stop, 0 ) ));
-	m_actionMap.insert(std::make_pair("PAUSE", std::make_pair( &MidiActionManager::pause, 0 ) ));
-	m_actionMap.insert(std::make_pair("RECORD_READY", std::make_pair( &MidiActionManager::record_ready, 0 ) ));
-	m_actionMap.insert(std::make_pair("RECORD/STROBE_TOGGLE", std::make_pair( &MidiActionManager::record_strobe_toggle, 0 ) ));
-	m_actionMap.insert(std::make_pair("RECORD_STROBE", std::make_pair( &MidiActionManager::record_strobe, 0 ) ));
-	m_actionMap.insert(std::make_pair("RECORD_EXIT", std::make_pair( &MidiActionManager::record_exit, 0 ) ));
-	m_actionMap.insert(std::make_pair("MUTE", std::make_pair( &MidiActionManager::mute, 0 ) ));
-	m_actionMap.insert(std::make_pair("UNMUTE", std::make_pair( &MidiActionManager::unmute, 0 ) ));
-	m_actionMap.insert(std::make_pair("MUTE_TOGGLE", std::make_pair( &MidiActionManager::mute_toggle, 0 ) ));
-	m_actionMap.insert(std::make_pair("STRIP_MUTE_TOGGLE", std::make_pair( &MidiActionManager::strip_mute_toggle, 1 ) ));
-	m_actionMap.insert(std::make_pair("STRIP_SOLO_TOGGLE", std::make_pair( &MidiActionManager::strip_solo_toggle, 1 ) ));	
-	m_actionMap.insert(std::make_pair("_NEXT_BAR", std::make_pair( &MidiActionManager::next_bar, 0 ) ));
-	m_actionMap.insert(std::make_pair("<<_PREVIOUS_BAR", std::make_pair( &MidiActionManager::previous_bar, 0 ) ));
-	m_actionMap.insert(std::make_pair("BPM_INCR", std::make_pair( &MidiActionManager::bpm_increase, 1 ) ));
-	m_actionMap.insert(std::make_pair("BPM_DECR", std::make_pair( &MidiActionManager::bpm_decrease, 1 ) ));
-	m_actionMap.insert(std::make_pair("BPM_CC_RELATIVE", std::make_pair( &MidiActionManager::bpm_cc_relative, 1 ) ));
-	m_actionMap.insert(std::make_pair("BPM_FINE_CC_RELATIVE", std::make_pair( &MidiActionManager::bpm_fine_cc_relative, 1 ) ));
-	m_actionMap.insert(std::make_pair("MASTER_VOLUME_RELATIVE", std::make_pair( &MidiActionManager::master_volume_relative, 0 ) ));
-	m_actionMap.insert(std::make_pair("MASTER_VOLUME_ABSOLUTE", std::make_pair( &MidiActionManager::master_volume_absolute, 0 ) ));
-	m_actionMap.insert(std::make_pair("STRIP_VOLUME_RELATIVE", std::make_pair( &MidiActionManager::strip_volume_relative, 1 ) ));
-	m_actionMap.insert(std::make_pair("STRIP_VOLUME_ABSOLUTE", std::make_pair( &MidiActionManager::strip_volume_absolute, 1 ) ));
-	m_actionMap.insert(std::make_pair("EFFECT_LEVEL_ABSOLUTE", std::make_pair( &MidiActionManager::effect_level_absolute, 2 ) ));
-	m_actionMap.insert(std::make_pair("EFFECT_LEVEL_RELATIVE", std::make_pair( &MidiActionManager::effect_level_relative, 2 ) ));
-	m_actionMap.insert(std::make_pair("GAIN_LEVEL_ABSOLUTE", std::make_pair( &MidiActionManager::gain_level_absolute, 3 ) ));
-	m_actionMap.insert(std::make_pair("PITCH_LEVEL_ABSOLUTE", std::make_pair( &MidiActionManager::pitch_level_absolute, 3 ) ));
-	m_actionMap.insert(std::make_pair("SELECT_NEXT_PATTERN", std::make_pair( &MidiActionManager::select_next_pattern, 1 ) ));
-	m_actionMap.insert(std::make_pair("SELECT_ONLY_NEXT_PATTERN", std::make_pair( &MidiActionManager::select_only_next_pattern, 1 ) ));
-	m_actionMap.insert(std::make_pair("SELECT_NEXT_PATTERN_CC_ABSOLUTE", std::make_pair( &MidiActionManager::select_next_pattern_cc_absolute, 0 ) ));
-	m_actionMap.insert(std::make_pair("SELECT_NEXT_PATTERN_RELATIVE", std::make_pair( &MidiActionManager::select_next_pattern_relative, 1 ) ));
-	m_actionMap.insert(std::make_pair("SELECT_AND_PLAY_PATTERN", std::make_pair( &MidiActionManager::select_and_play_pattern, 1 ) ));
-	m_actionMap.insert(std::make_pair("PAN_RELATIVE", std::make_pair( &MidiActionManager::pan_relative, 1 ) ));
-	m_actionMap.insert(std::make_pair("PAN_ABSOLUTE", std::make_pair( &MidiActionManager::pan_absolute, 1 ) ));
-	m_actionMap.insert(std::make_pair("FILTER_CUTOFF_LEVEL_ABSOLUTE", std::make_pair( &MidiActionManager::filter_cutoff_level_absolute, 1 ) ));
-	m_actionMap.insert(std::make_pair("BEATCOUNTER", std::make_pair( &MidiActionManager::beatcounter, 0 ) ));
-	m_actionMap.insert(std::make_pair("TAP_TEMPO", std::make_pair( &MidiActionManager::tap_tempo, 0 ) ));
-	m_actionMap.insert(std::make_pair("PLAYLIST_SONG", std::make_pair( &MidiActionManager::playlist_song, 1 ) ));
-	m_actionMap.insert(std::make_pair("PLAYLIST_NEXT_SONG", std::make_pair( &MidiActionManager::playlist_next_song, 0 ) ));
-	m_actionMap.insert(std::make_pair("PLAYLIST_PREV_SONG", std::make_pair( &MidiActionManager::playlist_previous_song, 0 ) ));
-	m_actionMap.insert(std::make_pair("TOGGLE_METRONOME", std::make_pair( &MidiActionManager::toggle_metronome, 0 ) ));
-	m_actionMap.insert(std::make_pair("SELECT_INSTRUMENT", std::make_pair( &MidiActionManager::select_instrument, 0 ) ));
-	m_actionMap.insert(std::make_pair("UNDO_ACTION", std::make_pair( &MidiActionManager::undo_action, 0 ) ));
-	m_actionMap.insert(std::make_pair("REDO_ACTION", std::make_pair( &MidiActionManager::redo_action, 0 ) ));
 	/*
 	  the m_actionList holds all Action identfiers which hydrogen is able to interpret.
 	*/
-	m_actionList <<"";
-	for ( const auto& ppAction : m_actionMap ) {
-		m_actionList << ppAction.first;
+	for ( int ii = 0; ii < s_nActions; ++ii ) {
+		m_actionList << s_actionTable[ ii ].sType;
 	}
+	m_actionList.sort();
+	m_actionList.prepend( "" );
 
 	m_eventList << ""
 			  << "MMC_PLAY"
@@ -219,7 +228,7 @@ bool MidiActionManager::stop( std::shared_ptr<Action> , Hydrogen* pHydrogen ) {
 }
 
 bool MidiActionManager::play_stop_pause_toggle( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	QString sActionString = pAction->getType();
+	static const int nStopToggleId = getActionId( "PLAY/STOP_TOGGLE" );
 	switch ( pHydrogen->getAudioEngine()->getState() )
 	{
 	case AudioEngine::State::Ready:
@@ -227,7 +236,7 @@ bool MidiActionManager::play_stop_pause_toggle( std::shared_ptr<Action> pAction,
 		break;
 
 	case AudioEngine::State::Playing:
-		if( sActionString == "PLAY/STOP_TOGGLE" ) {
+		if( pAction->getId() == nStopToggleId ) {
 			pHydrogen->getCoreActionController()->locateToColumn( 0 );
 		}
 		pHydrogen->sequencer_stop();
@@ -259,10 +268,9 @@ bool MidiActionManager::mute_toggle( std::shared_ptr<Action> , Hydrogen* pHydrog
 
 bool MidiActionManager::strip_mute_toggle( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 	
-	bool ok;
 	bool bSucccess = true;
 	
-	int nLine = pAction->getParameter1().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -284,10 +292,9 @@ bool MidiActionManager::strip_mute_toggle( std::shared_ptr<Action> pAction, Hydr
 
 bool MidiActionManager::strip_solo_toggle( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 	
-	bool ok;
 	bool bSucccess = true;
 	
-	int nLine = pAction->getParameter1().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -318,8 +325,7 @@ bool MidiActionManager::tap_tempo( std::shared_ptr<Action> , Hydrogen* pHydrogen
 }
 
 bool MidiActionManager::select_next_pattern( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int row = pAction->getParameter1().toInt(&ok,10);
+	int row = pAction->getParameter1AsInt();
 	if( row > pHydrogen->getSong()->getPatternList()->size() - 1 ||
 		row < 0 ) {
 		ERRORLOG( QString( "Provided value [%1] out of bound [0,%2]" ).arg( row )
@@ -336,8 +342,7 @@ bool MidiActionManager::select_next_pattern( std::shared_ptr<Action> pAction, Hy
 }
 
 bool MidiActionManager::select_only_next_pattern( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int row = pAction->getParameter1().toInt(&ok,10);
+	int row = pAction->getParameter1AsInt();
 	if( row > pHydrogen->getSong()->getPatternList()->size() -1 ||
 		row < 0 ) {
 		ERRORLOG( QString( "Provided value [%1] out of bound [0,%2]" ).arg( row )
@@ -354,11 +359,10 @@ bool MidiActionManager::select_only_next_pattern( std::shared_ptr<Action> pActio
 }
 
 bool MidiActionManager::select_next_pattern_relative( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
 	if(!Preferences::get_instance()->patternModePlaysSelected()) {
 		return true;
 	}
-	int row = pHydrogen->getSelectedPatternNumber() + pAction->getParameter1().toInt(&ok,10);
+	int row = pHydrogen->getSelectedPatternNumber() + pAction->getParameter1AsInt();
 	if( row > pHydrogen->getSong()->getPatternList()->size() - 1 ||
 		row < 0 ) {
 		ERRORLOG( QString( "Provided value [%1] out of bound [0,%2]" ).arg( row )
@@ -371,8 +375,7 @@ bool MidiActionManager::select_next_pattern_relative( std::shared_ptr<Action> pA
 }
 
 bool MidiActionManager::select_next_pattern_cc_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int row = pAction->getValue().toInt(&ok,10);
+	int row = pAction->getValue();
 	
 	if( row > pHydrogen->getSong()->getPatternList()->size() - 1 ||
 		row < 0 ) {
@@ -404,8 +407,7 @@ bool MidiActionManager::select_and_play_pattern( std::shared_ptr<Action> pAction
 }
 
 bool MidiActionManager::select_instrument( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int  nInstrumentNumber = pAction->getValue().toInt(&ok,10) ;
+	int  nInstrumentNumber = pAction->getValue() ;
 	
 
 	if ( pHydrogen->getSong()->getInstrumentList()->size() < nInstrumentNumber ) {
@@ -419,10 +421,9 @@ bool MidiActionManager::select_instrument( std::shared_ptr<Action> pAction, Hydr
 }
 
 bool MidiActionManager::effect_level_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen) {
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int fx_param = pAction->getValue().toInt(&ok,10);
-	int fx_id = pAction->getParameter2().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int fx_param = pAction->getValue();
+	int fx_id = pAction->getParameter2AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -451,10 +452,9 @@ bool MidiActionManager::effect_level_absolute( std::shared_ptr<Action> pAction,
 }
 
 bool MidiActionManager::effect_level_relative( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int fx_param = pAction->getValue().toInt(&ok,10);
-	int fx_id = pAction->getParameter2().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int fx_param = pAction->getValue();
+	int fx_id = pAction->getParameter2AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -486,8 +486,7 @@ bool MidiActionManager::effect_level_relative( std::shared_ptr<Action> pAction,
 //sets the volume of a master output to a given level (percentage)
 bool MidiActionManager::master_volume_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 
-	bool ok;
-	int vol_param = pAction->getValue().toInt(&ok,10);
+	int vol_param = pAction->getValue();
 
 	std::shared_ptr<Song> song = pHydrogen->getSong();
 
@@ -503,8 +502,7 @@ bool MidiActionManager::master_volume_absolute( std::shared_ptr<Action> pAction,
 //increments/decrements the volume of the whole song
 bool MidiActionManager::master_volume_relative( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 
-	bool ok;
-	int vol_param = pAction->getValue().toInt(&ok,10);
+	int vol_param = pAction->getValue();
 
 	std::shared_ptr<Song> song = pHydrogen->getSong();
 
@@ -526,9 +524,8 @@ bool MidiActionManager::master_volume_relative( std::shared_ptr<Action> pAction,
 //sets the volume of a mixer strip to a given level (percentage)
 bool MidiActionManager::strip_volume_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int vol_param = pAction->getValue().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int vol_param = pAction->getValue();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -558,9 +555,8 @@ bool MidiActionManager::strip_volume_absolute( std::shared_ptr<Action> pAction,
 //increments/decrements the volume of one mixer strip
 bool MidiActionManager::strip_volume_relative( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int vol_param = pAction->getValue().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int vol_param = pAction->getValue();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -596,9 +592,8 @@ bool MidiActionManager::strip_volume_relative( std::shared_ptr<Action> pAction,
 // sets the absolute panning of a given mixer channel
 bool MidiActionManager::pan_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int pan_param = pAction->getValue().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int pan_param = pAction->getValue();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -627,9 +622,8 @@ bool MidiActionManager::pan_absolute( std::shared_ptr<Action> pAction, Hydrogen*
 // this is useful if the panning is set by a rotary control knob
 bool MidiActionManager::pan_relative( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int pan_param = pAction->getValue().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int pan_param = pAction->getValue();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -661,11 +655,10 @@ bool MidiActionManager::pan_relative( std::shared_ptr<Action> pAction, Hydrogen*
 }
 
 bool MidiActionManager::gain_level_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int gain_param = pAction->getValue().toInt(&ok,10);
-	int component_id = pAction->getParameter2().toInt(&ok,10);
-	int layer_id = pAction->getParameter3().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int gain_param = pAction->getValue();
+	int component_id = pAction->getParameter2AsInt();
+	int layer_id = pAction->getParameter3AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -707,11 +700,10 @@ bool MidiActionManager::gain_level_absolute( std::shared_ptr<Action> pAction, Hy
 }
 
 bool MidiActionManager::pitch_level_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int pitch_param = pAction->getValue().toInt(&ok,10);
-	int component_id = pAction->getParameter2().toInt(&ok,10);
-	int layer_id = pAction->getParameter3().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int pitch_param = pAction->getValue();
+	int component_id = pAction->getParameter2AsInt();
+	int layer_id = pAction->getParameter3AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -752,9 +744,8 @@ bool MidiActionManager::pitch_level_absolute( std::shared_ptr<Action> pAction, H
 }
 
 bool MidiActionManager::filter_cutoff_level_absolute( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int nLine = pAction->getParameter1().toInt(&ok,10);
-	int filter_cutoff_param = pAction->getValue().toInt(&ok,10);
+	int nLine = pAction->getParameter1AsInt();
+	int filter_cutoff_param = pAction->getValue();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	InstrumentList *pInstrList = pSong->getInstrumentList();
@@ -794,10 +785,9 @@ bool MidiActionManager::bpm_cc_relative( std::shared_ptr<Action> pAction, Hydrog
 
 	//this Action should be triggered only by CC commands
 
-	bool ok;
-	int mult = pAction->getParameter1().toInt(&ok,10);
+	int mult = pAction->getParameter1AsInt();
 	//this value should be 1 to decrement and something other then 1 to increment the bpm
-	int cc_param = pAction->getValue().toInt(&ok,10);
+	int cc_param = pAction->getValue();
 
 	if( m_nLastBpmChangeCCParameter == -1) {
 		m_nLastBpmChangeCCParameter = cc_param;
@@ -829,10 +819,9 @@ bool MidiActionManager::bpm_fine_cc_relative( std::shared_ptr<Action> pAction, H
 	pHydrogen->getAudioEngine()->lock( RIGHT_HERE );
 
 	//this Action should be triggered only by CC commands
-	bool ok;
-	int mult = pAction->getParameter1().toInt(&ok,10);
+	int mult = pAction->getParameter1AsInt();
 	//this value should be 1 to decrement and something other then 1 to increment the bpm
-	int cc_param = pAction->getValue().toInt(&ok,10);
+	int cc_param = pAction->getValue();
 
 	if( m_nLastBpmChangeCCParameter == -1) {
 		m_nLastBpmChangeCCParameter = cc_param;
@@ -858,8 +847,7 @@ bool MidiActionManager::bpm_fine_cc_relative( std::shared_ptr<Action> pAction, H
 bool MidiActionManager::bpm_increase( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 	pHydrogen->getAudioEngine()->lock( RIGHT_HERE );
 
-	bool ok;
-	int mult = pAction->getParameter1().toInt(&ok,10);
+	int mult = pAction->getParameter1AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	pHydrogen->setBPM( pSong->getBpm() + 1*mult );
@@ -874,8 +862,7 @@ bool MidiActionManager::bpm_increase( std::shared_ptr<Action> pAction, Hydrogen*
 bool MidiActionManager::bpm_decrease( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
 	pHydrogen->getAudioEngine()->lock( RIGHT_HERE );
 
-	bool ok;
-	int mult = pAction->getParameter1().toInt(&ok,10);
+	int mult = pAction->getParameter1AsInt();
 
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 	pHydrogen->setBPM( pSong->getBpm() - 1*mult );
@@ -913,8 +900,7 @@ bool setSong( int nSongNumber, Hydrogen * pHydrogen ) {
 }
 
 bool MidiActionManager::playlist_song( std::shared_ptr<Action> pAction, Hydrogen* pHydrogen ) {
-	bool ok;
-	int songnumber = pAction->getParameter1().toInt(&ok,10);
+	int songnumber = pAction->getParameter1AsInt();
 	return setSong( songnumber, pHydrogen );
 }
 
@@ -979,10 +965,19 @@ bool MidiActionManager::redo_action( std::shared_ptr<Action> , Hydrogen* ) {
 	return true;
 }
 
+int MidiActionManager::getActionId( const QString& sActionType ) {
+	for ( int ii = 0; ii < s_nActions; ++ii ) {
+		if ( sActionType == s_actionTable[ ii ].sType ) {
+			return ii;
+		}
+	}
+	return -1;
+}
+
 int MidiActionManager::getParameterNumber( const QString& sActionType ) const {
-	auto foundActionPair = m_actionMap.find( sActionType );
-	if ( foundActionPair != m_actionMap.end() ) {
-		return foundActionPair->second.second;
+	const int nId = getActionId( sActionType );
+	if ( nId >= 0 ) {
+		return s_actionTable[ nId ].nParameters;
 	} else {
 		ERRORLOG( QString( "MIDI Action type [%1] couldn't be found" ).arg( sActionType ) );
 	}
@@ -1001,14 +996,12 @@ bool MidiActionManager::handleAction(  std::shared_ptr<Action> pAction ) {
 		return false;
 	}
 
-	QString sActionString = pAction->getType();
-
-	auto foundActionPair = m_actionMap.find( sActionString );
-	if( foundActionPair != m_actionMap.end() ) {
-		action_f action = foundActionPair->second.first;
+	const int nId = pAction->getId();
+	if( nId >= 0 && nId < s_nActions ) {
+		action_f action = s_actionTable[ nId ].function;
 		return (this->*action)(pAction, pHydrogen);
 	} else {
-		ERRORLOG( QString( "MIDI Action type [%1] couldn't be found" ).arg( sActionString ) );
+		ERRORLOG( QString( "MIDI Action type [%1] couldn't be found" ).arg( pAction->getType() ) );
 	}
 
 	return false;
@@ -35,18 +35,27 @@ class Action : public H2Core::Object<Action> {
 
 		void setParameter1( QString text ){
 			m_sParameter1 = text;
+			m_nParameter1 = text.toInt();
 		}
 
 		void setParameter2( QString text ){
 			m_sParameter2 = text;
+			m_nParameter2 = text.toInt();
 		}
 
 		void setParameter3( QString text ){
 			m_sParameter3 = text;
+			m_nParameter3 = text.toInt();
 		}
 
 		void setValue( QString text ){
-			m_sValue = text;
+			m_nValue = text.toInt();
+		}
+
+		/** Sets the value without any string conversion. Used when
+			dispatching incoming MIDI messages.*/
+		void setValue( int nValue ){
+			m_nValue = nValue;
 		}
 
 		QString getParameter1() const {
@@ -61,14 +70,35 @@ class Action : public H2Core::Object<Action> {
 			return m_sParameter3;
 		}
 
-		QString getValue() const {
-			return m_sValue;
+		/** Integer representation of #m_sParameter1 parsed when
+			setting it.*/
+		int getParameter1AsInt() const {
+			return m_nParameter1;
+		}
+
+		int getParameter2AsInt() const {
+			return m_nParameter2;
+		}
+
+		int getParameter3AsInt() const {
+			return m_nParameter3;
+		}
+
+		int getValue() const {
+			return m_nValue;
 		}
 
 		QString getType() const {
 			return m_sType;
 		}
 
+		/** \return Index of #m_sType in the dispatch table of the
+		 * MidiActionManager or -1 in case the type is unknown (like
+		 * "NOTHING").*/
+		int getId() const {
+			return m_nId;
+		}
+
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
 		 * every new line
@@ -84,7 +114,13 @@ class Action : public H2Core::Object<Action> {
 		QString m_sParameter1;
 		QString m_sParameter2;
 		QString m_sParameter3;
-		QString m_sValue;
+		/** Resolved once on construction so handling the action
+			does not require any string comparison.*/
+		int m_nId;
+		int m_nParameter1;
+		int m_nParameter2;
+		int m_nParameter3;
+		int m_nValue;
 };
 
 namespace H2Core
@@ -112,15 +148,20 @@ class MidiActionManager : public H2Core::Object<MidiActionManager>
 	QStringList m_actionList;
 
 		typedef bool (MidiActionManager::*action_f)(std::shared_ptr<Action> , H2Core::Hydrogen * );
+		struct ActionInfo {
+			const char* sType;
+			/** Member function performing the desired action.*/
+			action_f function;
+			/** Number of additional Action parameters required.*/
+			int nParameters;
+		};
 		/**
 		 * Holds all Action identifiers which Hydrogen is able to
-		 * interpret.  
-		 *
-		 * It holds a pair consisting of a pointer to member function
-		 * performing the desired action and an integer specifying how
-		 * many additional Action parameters are required to do so.
+		 * interpret. The position within the table is used as
+		 * Action::getId().
 		 */
-	std::map<QString, std::pair<action_f,int>> m_actionMap;
+		static const ActionInfo s_actionTable[];
+		static const int s_nActions;
 		bool play(std::shared_ptr<Action> , H2Core::Hydrogen * );
 		bool play_stop_pause_toggle(std::shared_ptr<Action> , H2Core::Hydrogen * );
 		bool stop(std::shared_ptr<Action> , H2Core::Hydrogen * );
@@ -203,6 +244,11 @@ class MidiActionManager : public H2Core::Object<MidiActionManager>
 	 * \return -1 in case the @a couldn't be found.
 	 */
 	int getParameterNumber( const QString& sActionType ) const;
+		/**
+		 * \return Id of @a sActionType used to dispatch the Action
+		 * or -1 in case it is not supported.
+		 */
+		static int getActionId( const QString& sActionType );
 
 		MidiActionManager();
 		~MidiActionManager();
@@ -44,6 +44,8 @@
 MidiMap * MidiMap::__instance = nullptr;
 
 MidiMap::MidiMap()
+	: m_pDispatchTable( nullptr )
+	, m_nReaders( 0 )
 {
 	__instance = this;
 	QMutexLocker mx(&__mutex);
@@ -57,12 +59,19 @@ MidiMap::MidiMap()
 		m_ccVector[ note ] = std::make_shared<Action>("NOTHING");
 	}
 	m_pPcAction = std::make_shared<Action>("NOTHING");
+
+	compile();
 }
 
 MidiMap::~MidiMap()
 {
 	QMutexLocker mx(&__mutex);
 
+	delete m_pDispatchTable.load();
+	for ( auto pTable : m_retiredTables ) {
+		delete pTable;
+	}
+
 	__instance = nullptr;
 }
 
@@ -100,6 +109,38 @@ void MidiMap::reset()
 	}
 
 	m_pPcAction = std::make_shared<Action>("NOTHING");
+
+	compile();
+}
+
+void MidiMap::compile()
+{
+	DispatchTable* pTable = new DispatchTable;
+	for ( int ii = 0; ii < 128; ++ii ) {
+		if ( m_noteVector[ ii ] != nullptr && m_noteVector[ ii ]->getId() >= 0 ) {
+			pTable->note[ ii ] = m_noteVector[ ii ];
+		}
+		if ( m_ccVector[ ii ] != nullptr && m_ccVector[ ii ]->getId() >= 0 ) {
+			pTable->cc[ ii ] = m_ccVector[ ii ];
+		}
+	}
+	if ( m_pPcAction != nullptr && m_pPcAction->getId() >= 0 ) {
+		pTable->pc = m_pPcAction;
+	}
+
+	DispatchTable* pOldTable = m_pDispatchTable.exchange( pTable );
+	if ( pOldTable != nullptr ) {
+		m_retiredTables.push_back( pOldTable );
+	}
+
+	// A reader entering after the exchange above does only see the
+	// new table.
+	if ( m_nReaders.load() == 0 ) {
+		for ( auto pRetiredTable : m_retiredTables ) {
+			delete pRetiredTable;
+		}
+		m_retiredTables.clear();
+	}
 }
 
 
@@ -127,6 +168,7 @@ void MidiMap::registerNoteEvent( int note, std::shared_ptr<Action> pAction )
 	QMutexLocker mx(&__mutex);
 	if( note >= 0 && note < 128 ) {
 		m_noteVector[ note ] = pAction;
+		compile();
 	} else {
 		ERRORLOG( QString( "Unable to register MIDI action [%1]: Provided note [%2] out of bound [0,128)" )
 				  .arg( pAction->getType() ).arg( note ) );
@@ -141,6 +183,7 @@ void MidiMap::registerCCEvent( int parameter, std::shared_ptr<Action> pAction ){
 	QMutexLocker mx(&__mutex);
 	if( parameter >= 0 && parameter < 128 ) {
 		m_ccVector[ parameter ] = pAction;
+		compile();
 	} else {
 		ERRORLOG( QString( "Unable to register MIDI action [%1]: Provided parameter [%2] out of bound [0,128)" )
 				  .arg( pAction->getType() ).arg( parameter ) );
@@ -186,6 +229,7 @@ int MidiMap::findCCValueByActionType( QString actionType ) const
 void MidiMap::registerPCEvent( std::shared_ptr<Action> pAction ){
 	QMutexLocker mx(&__mutex);
 	m_pPcAction = pAction;
+	compile();
 }
 
 /**
@@ -211,6 +255,53 @@ std::shared_ptr<Action> MidiMap::getNoteAction( int note )
 	return m_noteVector[ note ];
 }
 
+bool MidiMap::isNoteMapped( int note ) const
+{
+	if ( note < 0 || note >= 128 ) {
+		return false;
+	}
+	// The shared pointer is not copied to never release an action
+	// within the audio thread.
+	++m_nReaders;
+	const bool bMapped = m_pDispatchTable.load()->note[ note ] != nullptr;
+	--m_nReaders;
+
+	return bMapped;
+}
+
+std::shared_ptr<Action> MidiMap::findNoteAction( int note ) const
+{
+	if ( note < 0 || note >= 128 ) {
+		return nullptr;
+	}
+	++m_nReaders;
+	std::shared_ptr<Action> pAction = m_pDispatchTable.load()->note[ note ];
+	--m_nReaders;
+
+	return pAction;
+}
+
+std::shared_ptr<Action> MidiMap::findCCAction( int parameter ) const
+{
+	if ( parameter < 0 || parameter >= 128 ) {
+		return nullptr;
+	}
+	++m_nReaders;
+	std::shared_ptr<Action> pAction = m_pDispatchTable.load()->cc[ parameter ];
+	--m_nReaders;
+
+	return pAction;
+}
+
+std::shared_ptr<Action> MidiMap::findPCAction() const
+{
+	++m_nReaders;
+	std::shared_ptr<Action> pAction = m_pDispatchTable.load()->pc;
+	--m_nReaders;
+
+	return pAction;
+}
+
 /**
  * Returns the cc action which was linked to the given event.
  */
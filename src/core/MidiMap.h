@@ -22,6 +22,7 @@
 #ifndef MIDIMAP_H
 #define MIDIMAP_H
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <map>
@@ -77,6 +78,23 @@ class MidiMap : public H2Core::Object<MidiMap>
 		std::shared_ptr<Action> getNoteAction( int note );
 		std::shared_ptr<Action> getCCAction( int parameter );
 		std::shared_ptr<Action> getPCAction();
+		/** \return Whether an action is registered for @a note.
+		 *
+		 * Does not lock and can be called from within the audio
+		 * thread.*/
+		bool isNoteMapped( int note ) const;
+
+		/**
+		 * Lock-free counterparts of getNoteAction(), getCCAction(),
+		 * and getPCAction() used to dispatch incoming MIDI messages.
+		 *
+		 * \return Action registered for the event or nullptr in case
+		 * none or one not known to the MidiActionManager was
+		 * registered.
+		 */
+		std::shared_ptr<Action> findNoteAction( int note ) const;
+		std::shared_ptr<Action> findCCAction( int parameter ) const;
+		std::shared_ptr<Action> findPCAction() const;
 		
 		int findCCValueByActionParam1( QString actionType, QString param1 ) const;
 		int findCCValueByActionType( QString actionType ) const;
@@ -85,11 +103,36 @@ class MidiMap : public H2Core::Object<MidiMap>
 	private:
 		MidiMap();
 
+		/** Flat lookup tables compiled from #m_noteVector,
+			#m_ccVector, and #m_pPcAction holding only those actions
+			which can be dispatched.*/
+		struct DispatchTable {
+			std::shared_ptr<Action> note[ 128 ];
+			std::shared_ptr<Action> cc[ 128 ];
+			std::shared_ptr<Action> pc;
+		};
+
+		/**
+		 * Compiles and publishes a new #m_pDispatchTable. Has to be
+		 * called with #__mutex locked.
+		 *
+		 * Tables replaced while a reader is active are kept in
+		 * #m_retiredTables and freed by the next call without
+		 * one.
+		 */
+		void compile();
+
 	std::vector<std::shared_ptr<Action>> m_noteVector;
 	std::vector<std::shared_ptr<Action>> m_ccVector;
 		std::shared_ptr<Action> m_pPcAction;
 
 		map_t mmcMap;
 		QMutex __mutex;
+
+		std::atomic<DispatchTable*> m_pDispatchTable;
+		std::vector<DispatchTable*> m_retiredTables;
+		/** Number of threads currently reading from
+			#m_pDispatchTable.*/
+		mutable std::atomic<int> m_nReaders;
 };
 #endif
@@ -244,6 +244,19 @@ template<typename T> atomic_obj_cpt_t Object<T>::counters;
 #define ___WARNINGLOG(x) __LOG_STATIC(H2Core::Logger::Warning,  (x) );
 #define ___ERRORLOG(x)  __LOG_STATIC( H2Core::Logger::Error,    (x) );
 
+// real-time safe logging macros for the audio thread, see Logger::log_rt().
+// The first argument has to be a string literal followed by up to four numbers.
+#define __LOG_RT_METHOD( lvl, ... ) if( H2Core::Logger::get_instance()->should_log( (lvl) ) ) { H2Core::Logger::get_instance()->log_rt( (lvl), _class_name(), __FUNCTION__, __VA_ARGS__ ); }
+#define __LOG_RT_STATIC( lvl, ... ) if( H2Core::Logger::get_instance()->should_log( (lvl) ) ) { H2Core::Logger::get_instance()->log_rt( (lvl), nullptr, __FUNCTION__, __VA_ARGS__ ); }
+
+#define RT_INFOLOG(...)       __LOG_RT_METHOD( H2Core::Logger::Info,    __VA_ARGS__ );
+#define RT_WARNINGLOG(...)    __LOG_RT_METHOD( H2Core::Logger::Warning, __VA_ARGS__ );
+#define RT_ERRORLOG(...)      __LOG_RT_METHOD( H2Core::Logger::Error,   __VA_ARGS__ );
+
+#define ___RT_INFOLOG(...)    __LOG_RT_STATIC( H2Core::Logger::Info,    __VA_ARGS__ );
+#define ___RT_WARNINGLOG(...) __LOG_RT_STATIC( H2Core::Logger::Warning, __VA_ARGS__ );
+#define ___RT_ERRORLOG(...)   __LOG_RT_STATIC( H2Core::Logger::Error,   __VA_ARGS__ );
+
 };
 
 #endif // H2C_OBJECT_H
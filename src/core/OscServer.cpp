@@ -38,6 +38,7 @@
 #include "core/CoreActionController.h"
 #include "core/EventQueue.h"
 #include "core/Hydrogen.h"
+#include "core/AudioEngine/AudioEngine.h"
 #include "core/Basics/Song.h"
 #include "core/MidiAction.h"
 
@@ -756,6 +757,36 @@ void OscServer::SONG_EDITOR_TOGGLE_GRID_CELL_Handler(lo_arg **argv, int argc) {
 								 static_cast<int>(std::round( argv[1]->f )) );
 }
 
+void OscServer::PROFILE_Handler(lo_arg **argv, int argc) {
+
+	H2Core::ProcessProfiler* pProfiler =
+		H2Core::Hydrogen::get_instance()->getAudioEngine()->getProfiler();
+
+	for ( int nStage = 0; nStage < H2Core::ProcessProfiler::STAGES; ++nStage ) {
+		if ( pProfiler->getCount( nStage ) == 0 ) {
+			continue;
+		}
+		lo_message reply = lo_message_new();
+		lo_message_add_string( reply, H2Core::ProcessProfiler::getStageName( nStage ).toLocal8Bit().data() );
+		lo_message_add_int32( reply, static_cast<int32_t>( pProfiler->getCount( nStage ) ) );
+		lo_message_add_float( reply, pProfiler->getMean( nStage ) );
+		lo_message_add_float( reply, pProfiler->getPercentile( nStage, 99 ) );
+		lo_message_add_float( reply, pProfiler->getMax( nStage ) );
+
+		get_instance()->broadcastMessage( "/Hydrogen/PROFILE", reply );
+
+		lo_message_free( reply );
+	}
+
+	lo_message reply = lo_message_new();
+	lo_message_add_float( reply, pProfiler->getBudget() );
+	lo_message_add_int32( reply, static_cast<int32_t>( pProfiler->getOverrunCount() ) );
+
+	get_instance()->broadcastMessage( "/Hydrogen/PROFILE_OVERRUNS", reply );
+
+	lo_message_free( reply );
+}
+
 // -------------------------------------------------------------------
 // Helper functions
 
@@ -1037,6 +1068,8 @@ bool OscServer::init()
 	m_pServerThread->add_method("/Hydrogen/OPEN_PATTERN", "s", OPEN_PATTERN_Handler);
 	m_pServerThread->add_method("/Hydrogen/REMOVE_PATTERN", "f", REMOVE_PATTERN_Handler);
 	m_pServerThread->add_method("/Hydrogen/SONG_EDITOR_TOGGLE_GRID_CELL", "ff", SONG_EDITOR_TOGGLE_GRID_CELL_Handler);
+	m_pServerThread->add_method("/Hydrogen/PROFILE", "", PROFILE_Handler);
+	m_pServerThread->add_method("/Hydrogen/PROFILE", "f", PROFILE_Handler);
 
 	m_bInitialized = true;
 	
@@ -757,6 +757,24 @@ class OscServer : public H2Core::Object<OscServer>
 		 * \param argc Number of arguments passed by the OSC message.
 		 */
 		static void SONG_EDITOR_TOGGLE_GRID_CELL_Handler(lo_arg **argv, int argc);
+		/**
+		 * Sends the timings collected by the
+		 * H2Core::ProcessProfiler to all registered clients.
+		 *
+		 * For each stage measured so far a message is sent to \e
+		 * /Hydrogen/PROFILE containing its name ("s"), the number of
+		 * measurements ("i"), as well as the mean, the 99th
+		 * percentile, and the maximum duration in milliseconds
+		 * ("fff"). Afterwards, the budget of a single buffer in
+		 * milliseconds ("f") and the number of cycles exceeding it
+		 * ("i") are sent to \e /Hydrogen/PROFILE_OVERRUNS.
+		 *
+		 * \param argv Unused pointer to a vector of arguments passed
+		 * by the OSC message.
+		 * \param argc Unused number of arguments passed by the OSC
+		 * message.
+		 */
+		static void PROFILE_Handler(lo_arg **argv, int argc);
 		/** 
 		 * Catches any incoming messages and display them. 
 		 *
@@ -143,6 +143,13 @@ Preferences::Preferences()
 	m_bUseMetronome = false;
 	m_fMetronomeVolume = 0.5;
 	m_nMaxNotes = 256;
+	m_nVoiceStealing = 0;
+	m_nRenderThreads = 1;
+	m_bStreamSamples = false;
+	m_nStreamPreloadMs = 250;
+	m_bCompactSamples = false;
+	m_bUseSampleCache = true;
+	m_nSampleCacheSize = 1024;
 	m_nBufferSize = 1024;
 	m_nSampleRate = 44100;
 
@@ -407,6 +414,13 @@ void Preferences::loadPreferences( bool bGlobal )
 				m_bUseMetronome = LocalFileMng::readXmlBool( audioEngineNode, "use_metronome", m_bUseMetronome );
 				m_fMetronomeVolume = LocalFileMng::readXmlFloat( audioEngineNode, "metronome_volume", 0.5f );
 				m_nMaxNotes = LocalFileMng::readXmlInt( audioEngineNode, "maxNotes", m_nMaxNotes );
+				m_nVoiceStealing = LocalFileMng::readXmlInt( audioEngineNode, "voiceStealing", m_nVoiceStealing );
+				m_nRenderThreads = LocalFileMng::readXmlInt( audioEngineNode, "renderThreads", m_nRenderThreads );
+				m_bStreamSamples = LocalFileMng::readXmlBool( audioEngineNode, "streamSamples", m_bStreamSamples );
+				m_nStreamPreloadMs = LocalFileMng::readXmlInt( audioEngineNode, "streamPreloadMs", m_nStreamPreloadMs );
+				m_bCompactSamples = LocalFileMng::readXmlBool( audioEngineNode, "compactSamples", m_bCompactSamples );
+				m_bUseSampleCache = LocalFileMng::readXmlBool( audioEngineNode, "useSampleCache", m_bUseSampleCache );
+				m_nSampleCacheSize = LocalFileMng::readXmlInt( audioEngineNode, "sampleCacheSize", m_nSampleCacheSize );
 				m_nBufferSize = LocalFileMng::readXmlInt( audioEngineNode, "buffer_size", m_nBufferSize );
 				m_nSampleRate = LocalFileMng::readXmlInt( audioEngineNode, "samplerate", m_nSampleRate );
 
@@ -906,6 +920,13 @@ void Preferences::savePreferences()
 		LocalFileMng::writeXmlString( audioEngineNode, "use_metronome", m_bUseMetronome ? "true": "false" );
 		LocalFileMng::writeXmlString( audioEngineNode, "metronome_volume", QString("%1").arg( m_fMetronomeVolume ) );
 		LocalFileMng::writeXmlString( audioEngineNode, "maxNotes", QString("%1").arg( m_nMaxNotes ) );
+		LocalFileMng::writeXmlString( audioEngineNode, "voiceStealing", QString("%1").arg( m_nVoiceStealing ) );
+		LocalFileMng::writeXmlString( audioEngineNode, "renderThreads", QString("%1").arg( m_nRenderThreads ) );
+		LocalFileMng::writeXmlString( audioEngineNode, "streamSamples", m_bStreamSamples ? "true": "false" );
+		LocalFileMng::writeXmlString( audioEngineNode, "streamPreloadMs", QString("%1").arg( m_nStreamPreloadMs ) );
+		LocalFileMng::writeXmlString( audioEngineNode, "compactSamples", m_bCompactSamples ? "true": "false" );
+		LocalFileMng::writeXmlString( audioEngineNode, "useSampleCache", m_bUseSampleCache ? "true": "false" );
+		LocalFileMng::writeXmlString( audioEngineNode, "sampleCacheSize", QString("%1").arg( m_nSampleCacheSize ) );
 		LocalFileMng::writeXmlString( audioEngineNode, "buffer_size", QString("%1").arg( m_nBufferSize ) );
 		LocalFileMng::writeXmlString( audioEngineNode, "samplerate", QString("%1").arg( m_nSampleRate ) );
 
@@ -185,6 +185,31 @@ public:
 	float				m_fMetronomeVolume;
 	/// max notes
 	unsigned			m_nMaxNotes;
+	/** Which notes the Sampler stops once more than #m_nMaxNotes
+	 * are playing. Holds a Sampler::VoiceStealing.*/
+	int					m_nVoiceStealing;
+	/** Number of threads rendering the notes played by the
+	 * Sampler, including the audio thread. Values smaller than two
+	 * disable parallel rendering. See Sampler::setRenderThreads().*/
+	int					m_nRenderThreads;
+	/** Whether long samples of drumkits loaded from now on are only
+	 * partially kept in memory and streamed from disk during
+	 * playback. See SampleStreamer.*/
+	bool				m_bStreamSamples;
+	/** Length of the beginning of a streamed sample kept in memory
+	 * in milliseconds. It has to cover the time it takes to fetch
+	 * the remainder from disk.*/
+	int					m_nStreamPreloadMs;
+	/** Whether samples of drumkits and songs loaded from now on
+	 * are stored as 16 bit integers if this is possible without
+	 * loss. See Sample::compact().*/
+	bool				m_bCompactSamples;
+	/** Whether decoded samples are stored in and mapped from the
+	 * SampleCache.*/
+	bool				m_bUseSampleCache;
+	/** Size in megabytes the SampleCache is allowed to occupy on
+	 * disk before the least recently used files are removed.*/
+	int					m_nSampleCacheSize;
 	/** 
 	 * Buffer size of the audio.
 	 *
@@ -0,0 +1,422 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/BlockKernels.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Runtime dispatch. The compiler emits one clone of each kernel per
+// listed target and an ifunc resolver picking the best one for the
+// host CPU when the library is loaded. This requires GNU ifunc
+// support, which is why it is restricted to x86_64 glibc systems.
+#if defined( __x86_64__ ) && defined( __linux__ ) && defined( __GLIBC__ ) && defined( __has_attribute )
+#if __has_attribute( target_clones )
+#define H2_KERNEL __attribute__(( target_clones( "avx2", "avx", "sse4.1", "default" ) ))
+#endif
+#endif
+#ifndef H2_KERNEL
+#define H2_KERNEL
+#endif
+
+// Helpers have to be inlined into the dispatched kernels in order to
+// be compiled for the selected target as well.
+#if defined( __GNUC__ )
+#define H2_KERNEL_INLINE inline __attribute__(( always_inline ))
+#else
+#define H2_KERNEL_INLINE inline
+#endif
+
+namespace H2Core
+{
+
+namespace BlockKernels
+{
+
+/** Factor converting 16 bit integers into floating point values.
+	Matches Sample::INT16_SCALE.*/
+static constexpr float INT16_SCALE = 1.0f / 32768.0f;
+
+/** Factor applied to interpolated values of type @a T.*/
+template <typename T>
+constexpr float inputScale();
+
+template <>
+constexpr float inputScale<float>() {
+	return 1.0f;
+}
+
+template <>
+constexpr float inputScale<int16_t>() {
+	return INT16_SCALE;
+}
+
+/** Interpolates between @a pData[nPos] and @a pData[nPos + 1].*/
+template <Interpolation::InterpolateMode mode, typename T>
+H2_KERNEL_INLINE float interpolate( const T* pData, int nPos, float fMu ) {
+	if constexpr ( mode == Interpolation::InterpolateMode::Linear ) {
+		return Interpolation::linear_Interpolate( pData[ nPos ], pData[ nPos + 1 ], fMu );
+	}
+	else if constexpr ( mode == Interpolation::InterpolateMode::Cosine ) {
+		return Interpolation::cosine_Interpolate( pData[ nPos ], pData[ nPos + 1 ], fMu );
+	}
+	else if constexpr ( mode == Interpolation::InterpolateMode::Third ) {
+		return Interpolation::third_Interpolate( pData[ nPos - 1 ], pData[ nPos ], pData[ nPos + 1 ], pData[ nPos + 2 ], fMu );
+	}
+	else if constexpr ( mode == Interpolation::InterpolateMode::Cubic ) {
+		return Interpolation::cubic_Interpolate( pData[ nPos - 1 ], pData[ nPos ], pData[ nPos + 1 ], pData[ nPos + 2 ], fMu );
+	}
+	else {
+		return Interpolation::hermite_Interpolate( pData[ nPos - 1 ], pData[ nPos ], pData[ nPos + 1 ], pData[ nPos + 2 ], fMu );
+	}
+}
+
+/** Bounds checked version of interpolate() used at the edges of
+	the input.*/
+template <Interpolation::InterpolateMode mode, typename T>
+H2_KERNEL_INLINE float interpolateChecked( const T* pData, int nInFrames, int nPos, float fMu ) {
+	if ( nPos + 1 >= nInFrames ) {
+		// We reached the last frame of the input.
+		return 0.0;
+	}
+	const float support[ 4 ] = { nPos > 0 ? static_cast<float>( pData[ nPos - 1 ] ) : 0.0f,
+								 static_cast<float>( pData[ nPos ] ),
+								 static_cast<float>( pData[ nPos + 1 ] ),
+								 nPos + 2 < nInFrames ? static_cast<float>( pData[ nPos + 2 ] ) : 0.0f };
+	return interpolate<mode>( support, 1, fMu );
+}
+
+/** Resamples the input of type @a T. If @a bStereo is false, only
+	@a pIn_L is read and the result is written to both outputs.*/
+template <Interpolation::InterpolateMode mode, typename T, bool bStereo>
+H2_KERNEL_INLINE void resampleBlock( const T* __restrict pIn_L, const T* __restrict pIn_R, int nInFrames,
+						   double fSamplePos, double fStep,
+						   float* __restrict pOut_L, float* __restrict pOut_R, int nFrames )
+{
+	constexpr float fScale = inputScale<T>();
+
+	// Output frames within [nBegin, nEnd) have all their support
+	// points inside the input and are rendered without any bounds
+	// checks. The range is kept one input frame smaller on both
+	// ends to absorb rounding errors.
+	int nBegin = 0;
+	if ( fSamplePos < 2.0 ) {
+		nBegin = static_cast<int>( std::min<double>( std::ceil( ( 2.0 - fSamplePos ) / fStep ), nFrames ) );
+	}
+	int nEnd = static_cast<int>( std::max<double>(
+		std::min<double>( std::floor( ( nInFrames - 3 - fSamplePos ) / fStep ), nFrames ), 0.0 ) );
+	nEnd = std::max( nEnd, nBegin );
+
+	for ( int i = 0; i < nBegin; ++i ) {
+		const double fPos = fSamplePos + i * fStep;
+		const int nPos = static_cast<int>( fPos );
+		const float fMu = static_cast<float>( fPos - nPos );
+		pOut_L[ i ] = interpolateChecked<mode>( pIn_L, nInFrames, nPos, fMu ) * fScale;
+		pOut_R[ i ] = bStereo ? interpolateChecked<mode>( pIn_R, nInFrames, nPos, fMu ) * fScale : pOut_L[ i ];
+	}
+
+	for ( int i = nBegin; i < nEnd; ++i ) {
+		const double fPos = fSamplePos + i * fStep;
+		const int nPos = static_cast<int>( fPos );
+		const float fMu = static_cast<float>( fPos - nPos );
+		pOut_L[ i ] = interpolate<mode>( pIn_L, nPos, fMu ) * fScale;
+		pOut_R[ i ] = bStereo ? interpolate<mode>( pIn_R, nPos, fMu ) * fScale : pOut_L[ i ];
+	}
+
+	for ( int i = nEnd; i < nFrames; ++i ) {
+		const double fPos = fSamplePos + i * fStep;
+		const int nPos = static_cast<int>( fPos );
+		const float fMu = static_cast<float>( fPos - nPos );
+		pOut_L[ i ] = interpolateChecked<mode>( pIn_L, nInFrames, nPos, fMu ) * fScale;
+		pOut_R[ i ] = bStereo ? interpolateChecked<mode>( pIn_R, nInFrames, nPos, fMu ) * fScale : pOut_L[ i ];
+	}
+}
+
+/** Picks the mono or stereo variant of resampleBlock(). */
+template <Interpolation::InterpolateMode mode, typename T>
+H2_KERNEL_INLINE void resampleChannels( const T* pIn_L, const T* pIn_R, int nInFrames,
+										double fSamplePos, double fStep,
+										float* pOut_L, float* pOut_R, int nFrames )
+{
+	if ( pIn_L == pIn_R ) {
+		resampleBlock<mode, T, false>( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+	} else {
+		resampleBlock<mode, T, true>( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+	}
+}
+
+// One dispatched entry point per interpolation mode and input type.
+H2_KERNEL void resampleLinear( const float* pIn_L, const float* pIn_R, int nInFrames,
+							   double fSamplePos, double fStep,
+							   float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Linear>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleLinear( const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+							   double fSamplePos, double fStep,
+							   float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Linear>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleCosine( const float* pIn_L, const float* pIn_R, int nInFrames,
+							   double fSamplePos, double fStep,
+							   float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Cosine>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleCosine( const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+							   double fSamplePos, double fStep,
+							   float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Cosine>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleThird( const float* pIn_L, const float* pIn_R, int nInFrames,
+							  double fSamplePos, double fStep,
+							  float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Third>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleThird( const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+							  double fSamplePos, double fStep,
+							  float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Third>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleCubic( const float* pIn_L, const float* pIn_R, int nInFrames,
+							  double fSamplePos, double fStep,
+							  float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Cubic>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleCubic( const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+							  double fSamplePos, double fStep,
+							  float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Cubic>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleHermite( const float* pIn_L, const float* pIn_R, int nInFrames,
+								double fSamplePos, double fStep,
+								float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Hermite>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void resampleHermite( const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+								double fSamplePos, double fStep,
+								float* pOut_L, float* pOut_R, int nFrames ) {
+	resampleChannels<Interpolation::InterpolateMode::Hermite>(
+		pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+template <typename T>
+static void resampleInput( Interpolation::InterpolateMode mode,
+						   const T* pIn_L, const T* pIn_R, int nInFrames,
+						   double fSamplePos, double fStep,
+						   float* pOut_L, float* pOut_R, int nFrames )
+{
+	switch ( mode ) {
+	case Interpolation::InterpolateMode::Linear:
+		resampleLinear( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+		break;
+	case Interpolation::InterpolateMode::Cosine:
+		resampleCosine( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+		break;
+	case Interpolation::InterpolateMode::Third:
+		resampleThird( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+		break;
+	case Interpolation::InterpolateMode::Cubic:
+		resampleCubic( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+		break;
+	case Interpolation::InterpolateMode::Hermite:
+		resampleHermite( pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+		break;
+	}
+}
+
+void resample( Interpolation::InterpolateMode mode,
+			   const float* pIn_L, const float* pIn_R, int nInFrames,
+			   double fSamplePos, double fStep,
+			   float* pOut_L, float* pOut_R, int nFrames )
+{
+	resampleInput( mode, pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+void resample( Interpolation::InterpolateMode mode,
+			   const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+			   double fSamplePos, double fStep,
+			   float* pOut_L, float* pOut_R, int nFrames )
+{
+	resampleInput( mode, pIn_L, pIn_R, nInFrames, fSamplePos, fStep, pOut_L, pOut_R, nFrames );
+}
+
+H2_KERNEL void convert( const int16_t* __restrict pIn, float* __restrict pOut, int nFrames )
+{
+	for ( int i = 0; i < nFrames; ++i ) {
+		pOut[ i ] = pIn[ i ] * INT16_SCALE;
+	}
+}
+
+H2_KERNEL void scale( float* pBuffer, float fGain, int nFrames )
+{
+	for ( int i = 0; i < nFrames; ++i ) {
+		pBuffer[ i ] *= fGain;
+	}
+}
+
+H2_KERNEL void mix( const float* __restrict pIn, float fGain, float* __restrict pOut, int nFrames )
+{
+	for ( int i = 0; i < nFrames; ++i ) {
+		pOut[ i ] += pIn[ i ] * fGain;
+	}
+}
+
+H2_KERNEL float peak( const float* pBuffer, int nFrames, float fPeak )
+{
+	// Independent partial maxima to allow vectorization without
+	// relaxing the floating point semantics.
+	float partial[ 8 ] = { fPeak, fPeak, fPeak, fPeak, fPeak, fPeak, fPeak, fPeak };
+	int i = 0;
+	for ( ; i + 8 <= nFrames; i += 8 ) {
+		for ( int j = 0; j < 8; ++j ) {
+			partial[ j ] = std::max( partial[ j ], pBuffer[ i + j ] );
+		}
+	}
+	for ( ; i < nFrames; ++i ) {
+		partial[ 0 ] = std::max( partial[ 0 ], pBuffer[ i ] );
+	}
+	for ( int j = 1; j < 8; ++j ) {
+		partial[ 0 ] = std::max( partial[ 0 ], partial[ j ] );
+	}
+	return partial[ 0 ];
+}
+
+H2_KERNEL float absPeak( const float* pBuffer, int nFrames, float fPeak )
+{
+	float partial[ 8 ] = { fPeak, fPeak, fPeak, fPeak, fPeak, fPeak, fPeak, fPeak };
+	int i = 0;
+	for ( ; i + 8 <= nFrames; i += 8 ) {
+		for ( int j = 0; j < 8; ++j ) {
+			partial[ j ] = std::max( partial[ j ], std::fabs( pBuffer[ i + j ] ) );
+		}
+	}
+	for ( ; i < nFrames; ++i ) {
+		partial[ 0 ] = std::max( partial[ 0 ], std::fabs( pBuffer[ i ] ) );
+	}
+	for ( int j = 1; j < 8; ++j ) {
+		partial[ 0 ] = std::max( partial[ 0 ], partial[ j ] );
+	}
+	return partial[ 0 ];
+}
+
+H2_KERNEL float energy( const float* pBuffer, int nFrames )
+{
+	// Independent partial sums for the same reason as in peak().
+	float partial[ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	int i = 0;
+	for ( ; i + 8 <= nFrames; i += 8 ) {
+		for ( int j = 0; j < 8; ++j ) {
+			partial[ j ] += pBuffer[ i + j ] * pBuffer[ i + j ];
+		}
+	}
+	for ( ; i < nFrames; ++i ) {
+		partial[ 0 ] += pBuffer[ i ] * pBuffer[ i ];
+	}
+	float fSum = 0;
+	for ( int j = 0; j < 8; ++j ) {
+		fSum += partial[ j ];
+	}
+	return fSum;
+}
+
+/** Polyphase filter upsampling by a factor of four as given in ITU-R
+	BS.1770-4 Annex 2. Row n yields the value n/4 frames after the
+	current one.*/
+static const float truePeakFilter[ 4 ][ TRUE_PEAK_TAPS ] = {
+	{ 0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f,
+	  -0.0594482421875f, 0.1373291015625f, 0.9721679687500f, -0.1022949218750f,
+	  0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f },
+	{ -0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f,
+	  -0.1665039062500f, 0.4650878906250f, 0.7797851562500f, -0.2003173828125f,
+	  0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f },
+	{ -0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f,
+	  -0.2003173828125f, 0.7797851562500f, 0.4650878906250f, -0.1665039062500f,
+	  0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f },
+	{ -0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f,
+	  -0.1022949218750f, 0.9721679687500f, 0.1373291015625f, -0.0594482421875f,
+	  0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f }
+};
+
+/** \return Largest absolute value of the four upsampled values
+	computed from the #TRUE_PEAK_TAPS frames ending at @a
+	pNewest.*/
+H2_KERNEL_INLINE float upsampledPeak( const float* pNewest ) {
+	float fPeak = 0;
+	for ( int nPhase = 0; nPhase < 4; ++nPhase ) {
+		float fValue = 0;
+		for ( int k = 0; k < TRUE_PEAK_TAPS; ++k ) {
+			fValue += truePeakFilter[ nPhase ][ k ] * pNewest[ -k ];
+		}
+		fPeak = std::max( fPeak, std::fabs( fValue ) );
+	}
+	return fPeak;
+}
+
+H2_KERNEL float truePeak( const float* pBuffer, int nFrames, float* pHistory, float fPeak )
+{
+	constexpr int nHistory = TRUE_PEAK_TAPS - 1;
+	if ( nFrames <= 0 ) {
+		return fPeak;
+	}
+
+	// The first frames require support points of the previous
+	// block. They are processed using a small window holding both.
+	float window[ 2 * nHistory ];
+	const int nHead = std::min( nFrames, nHistory );
+	std::copy( pHistory, pHistory + nHistory, window );
+	std::copy( pBuffer, pBuffer + nHead, window + nHistory );
+	for ( int i = 0; i < nHead; ++i ) {
+		fPeak = std::max( fPeak, upsampledPeak( window + nHistory + i ) );
+	}
+	for ( int i = nHead; i < nFrames; ++i ) {
+		fPeak = std::max( fPeak, upsampledPeak( pBuffer + i ) );
+	}
+
+	if ( nFrames >= nHistory ) {
+		std::copy( pBuffer + nFrames - nHistory, pBuffer + nFrames, pHistory );
+	} else {
+		std::copy( window + nFrames, window + nFrames + nHistory, pHistory );
+	}
+
+	return fPeak;
+}
+
+};
+
+};
@@ -0,0 +1,139 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef BLOCK_KERNELS_H
+#define BLOCK_KERNELS_H
+
+#include <core/Sampler/Interpolation.h>
+
+#include <cstdint>
+
+namespace H2Core
+{
+
+/**
+ * Block-based DSP kernels used by the Sampler.
+ *
+ * All kernels operate on whole blocks of frames and do not contain
+ * any branching depending on runtime settings within their inner
+ * loops. This allows the compiler to vectorize them. On x86_64 Linux
+ * builds every kernel is additionally compiled for several
+ * instruction set extensions (SSE4.1, AVX, AVX2) and the most
+ * capable variant supported by the host CPU is selected once at
+ * program start. On AArch64 NEON is part of the baseline and used
+ * unconditionally.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+namespace BlockKernels
+{
+	/**
+	 * Resamples a block of a stereo sample.
+	 *
+	 * Renders @a nFrames output frames starting at the (fractional)
+	 * position @a fSamplePos of the input and advancing by @a
+	 * fStep input frames per output frame. The interpolation
+	 * kernel is chosen once according to @a mode. Support points
+	 * outside of the input are treated as silence and positions at
+	 * or beyond the last input frame yield zero.
+	 *
+	 * If @a pIn_L and @a pIn_R are identical, as they are for mono
+	 * samples, the input is interpolated only once and written to
+	 * both outputs.
+	 *
+	 * \param mode Interpolation to use.
+	 * \param pIn_L Left channel of the input.
+	 * \param pIn_R Right channel of the input.
+	 * \param nInFrames Number of frames in the input.
+	 * \param fSamplePos Position in the input of the first frame.
+	 * \param fStep Increment of the input position per output frame.
+	 * \param pOut_L Left channel of the output.
+	 * \param pOut_R Right channel of the output.
+	 * \param nFrames Number of frames to render.
+	 */
+	void resample( Interpolation::InterpolateMode mode,
+				   const float* pIn_L, const float* pIn_R, int nInFrames,
+				   double fSamplePos, double fStep,
+				   float* pOut_L, float* pOut_R, int nFrames );
+	/**
+	 * Resamples a block of a compact sample stored as 16 bit
+	 * integers (see Sample::compact()).
+	 *
+	 * The conversion into floating point values is done within the
+	 * interpolation. Apart from that it behaves like the overload
+	 * for floating point input.
+	 */
+	void resample( Interpolation::InterpolateMode mode,
+				   const int16_t* pIn_L, const int16_t* pIn_R, int nInFrames,
+				   double fSamplePos, double fStep,
+				   float* pOut_L, float* pOut_R, int nFrames );
+
+	/** Converts @a nFrames 16 bit integers of @a pIn into floating
+		point values in [-1, 1) written to @a pOut.*/
+	void convert( const int16_t* pIn, float* pOut, int nFrames );
+
+	/** Multiplies @a nFrames frames of @a pBuffer by @a fGain in place. */
+	void scale( float* pBuffer, float fGain, int nFrames );
+
+	/** Adds @a nFrames frames of @a pIn scaled by @a fGain onto @a pOut. */
+	void mix( const float* pIn, float fGain, float* pOut, int nFrames );
+
+	/**
+	 * \return The maximum of @a fPeak and all @a nFrames values in
+	 * @a pBuffer.
+	 */
+	float peak( const float* pBuffer, int nFrames, float fPeak );
+
+	/**
+	 * \return The maximum of @a fPeak and the absolute values of all
+	 * @a nFrames values in @a pBuffer.
+	 */
+	float absPeak( const float* pBuffer, int nFrames, float fPeak );
+
+	/** \return Sum of the squares of all @a nFrames values in @a
+		pBuffer.*/
+	float energy( const float* pBuffer, int nFrames );
+
+	/** Length of the interpolation filter used by truePeak().*/
+	static constexpr int TRUE_PEAK_TAPS = 12;
+
+	/**
+	 * Estimates the true peak of a block, including the peaks between
+	 * samples, by upsampling it by a factor of four using the filter
+	 * of ITU-R BS.1770-4 Annex 2.
+	 *
+	 * \param pBuffer Block to analyse.
+	 * \param nFrames Number of frames in @a pBuffer.
+	 * \param pHistory The #TRUE_PEAK_TAPS - 1 frames preceding the
+	 *   block, oldest first. They are replaced by the last frames of
+	 *   the block.
+	 * \param fPeak Peak found so far.
+	 *
+	 * \return The maximum of @a fPeak and the absolute values of the
+	 * upsampled block.
+	 */
+	float truePeak( const float* pBuffer, int nFrames, float* pHistory, float fPeak );
+};
+
+};
+
+#endif // BLOCK_KERNELS_H
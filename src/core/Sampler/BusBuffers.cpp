@@ -0,0 +1,55 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/BusBuffers.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace H2Core {
+
+BusBuffers::BusBuffers( int nBusses )
+	: m_nBusses( nBusses )
+{
+	// Aligned operator new is not available on all supported
+	// platforms. The allocation is padded and aligned by hand
+	// instead.
+	const size_t nFloats = 2 * static_cast<size_t>( nBusses ) * STRIDE;
+	m_pAllocation = new float[ nFloats + ALIGNMENT / sizeof( float ) ];
+	const uintptr_t nAddress = reinterpret_cast<uintptr_t>( m_pAllocation );
+	m_pData = reinterpret_cast<float*>(
+		( nAddress + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT );
+	memset( m_pData, 0, nFloats * sizeof( float ) );
+}
+
+BusBuffers::~BusBuffers()
+{
+	delete[] m_pAllocation;
+}
+
+void BusBuffers::clear( int nBus, int nFrames )
+{
+	memset( getBuffer_L( nBus ), 0, nFrames * sizeof( float ) );
+	memset( getBuffer_R( nBus ), 0, nFrames * sizeof( float ) );
+}
+
+};
@@ -0,0 +1,92 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef BUS_BUFFERS_H
+#define BUS_BUFFERS_H
+
+#include <core/config.h>
+#include <core/Object.h>
+
+namespace H2Core
+{
+
+/**
+ * Stereo audio busses stored in a single contiguous block of memory.
+ *
+ * The layout is bus-major: bus n holds its left channel followed by
+ * its right one, each #STRIDE frames long and starting at a cache
+ * line boundary. The BlockKernels can thus work on aligned channels
+ * and all busses - like the ones of the drumkit components of a song
+ * - are adjacent in memory instead of being scattered across the
+ * heap.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class BusBuffers : public H2Core::Object<BusBuffers>
+{
+	H2_OBJECT(BusBuffers)
+public:
+	/** Alignment of each channel in bytes.*/
+	static constexpr int ALIGNMENT = 64;
+	/** Distance between the beginnings of two channels in
+		frames. MAX_BUFFER_SIZE rounded up to a multiple of
+		#ALIGNMENT.*/
+	static constexpr int STRIDE =
+		( MAX_BUFFER_SIZE * sizeof( float ) + ALIGNMENT - 1 ) /
+		ALIGNMENT * ALIGNMENT / sizeof( float );
+
+	/** Allocates @a nBusses silent busses.*/
+	explicit BusBuffers( int nBusses );
+	~BusBuffers();
+
+	int getBusCount() const;
+	/** \return Left channel of bus @a nBus.*/
+	float* getBuffer_L( int nBus );
+	/** \return Right channel of bus @a nBus.*/
+	float* getBuffer_R( int nBus );
+
+	/** Silences the first @a nFrames frames of both channels of
+		bus @a nBus.*/
+	void clear( int nBus, int nFrames );
+
+private:
+	int m_nBusses;
+	/** Memory as returned by new. #m_pData points to its first
+		aligned address.*/
+	float* m_pAllocation;
+	float* m_pData;
+};
+
+inline int BusBuffers::getBusCount() const {
+	return m_nBusses;
+}
+
+inline float* BusBuffers::getBuffer_L( int nBus ) {
+	return m_pData + 2 * nBus * STRIDE;
+}
+
+inline float* BusBuffers::getBuffer_R( int nBus ) {
+	return m_pData + ( 2 * nBus + 1 ) * STRIDE;
+}
+
+};
+
+#endif // BUS_BUFFERS_H
@@ -0,0 +1,315 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/ResampleCache.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Sample.h>
+#include <core/Helpers/Filesystem.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <sndfile.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace H2Core
+{
+
+/** Zeroth order modified Bessel function of the first kind used to
+	compute the Kaiser window.*/
+static double besselI0( double fX )
+{
+	const double fHalf = fX / 2;
+	double fSum = 1;
+	double fTerm = 1;
+	for ( int k = 1; k < 64; ++k ) {
+		fTerm *= ( fHalf / k ) * ( fHalf / k );
+		fSum += fTerm;
+		if ( fTerm < fSum * 1e-12 ) {
+			break;
+		}
+	}
+	return fSum;
+}
+
+ResampleCache::ResampleCache( AudioEngine* pAudioEngine )
+	: m_pAudioEngine( pAudioEngine )
+	, m_nSampleRate( 0 )
+	, m_nGeneration( 0 )
+	, m_bWorking( false )
+	, m_bQuit( false )
+{
+	m_thread = std::thread( &ResampleCache::run, this );
+}
+
+ResampleCache::~ResampleCache()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bQuit = true;
+		m_jobs.clear();
+	}
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+void ResampleCache::update( InstrumentList* pInstrumentList, int nSampleRate )
+{
+	std::vector<Job> jobs;
+	if ( pInstrumentList != nullptr && nSampleRate > 0 ) {
+		for ( int nInstr = 0; nInstr < pInstrumentList->size(); ++nInstr ) {
+			auto pInstr = pInstrumentList->get( nInstr );
+			if ( pInstr == nullptr ) {
+				continue;
+			}
+			for ( const auto& pComponent : *pInstr->get_components() ) {
+				for ( int nLayer = 0; nLayer < InstrumentComponent::getMaxLayers(); ++nLayer ) {
+					auto pLayer = pComponent->get_layer( nLayer );
+					if ( pLayer == nullptr ) {
+						continue;
+					}
+					auto pSample = pLayer->get_sample();
+					auto pConverted = pLayer->get_converted_sample();
+					if ( pSample == nullptr || pSample->is_empty() ||
+						 pSample->is_streamed() ||
+						 pSample->get_sample_rate() == nSampleRate ||
+						 ( pConverted != nullptr &&
+						   pConverted->get_sample_rate() == nSampleRate ) ) {
+						continue;
+					}
+					jobs.push_back( { pLayer, pSample } );
+				}
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_jobs = std::move( jobs );
+		// Process the jobs in the order of the instrument list.
+		std::reverse( m_jobs.begin(), m_jobs.end() );
+		m_nSampleRate = nSampleRate;
+		++m_nGeneration;
+	}
+	m_condition.notify_all();
+}
+
+bool ResampleCache::isBusy()
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_bWorking || ! m_jobs.empty();
+}
+
+void ResampleCache::run()
+{
+	std::unique_lock<std::mutex> lock( m_mutex );
+	while ( true ) {
+		m_condition.wait( lock, [&]() { return m_bQuit || ! m_jobs.empty(); } );
+		if ( m_bQuit ) {
+			return;
+		}
+
+		Job job = m_jobs.back();
+		m_jobs.pop_back();
+		const int nSampleRate = m_nSampleRate;
+		const unsigned nGeneration = m_nGeneration;
+		m_bWorking = true;
+		lock.unlock();
+
+		auto pConverted = process( job.pSample, nSampleRate );
+
+		if ( pConverted != nullptr ) {
+			m_pAudioEngine->lock( RIGHT_HERE );
+			// Neither the sample nor the target rate must have
+			// changed in the meantime.
+			bool bValid;
+			{
+				std::lock_guard<std::mutex> guard( m_mutex );
+				bValid = nGeneration == m_nGeneration;
+			}
+			if ( bValid && job.pLayer->get_sample() == job.pSample ) {
+				job.pLayer->set_converted_sample( pConverted );
+			}
+			m_pAudioEngine->unlock();
+		}
+
+		// Release the references outside of the lock of the
+		// AudioEngine.
+		job = Job();
+		pConverted = nullptr;
+
+		lock.lock();
+		m_bWorking = false;
+	}
+}
+
+std::shared_ptr<Sample> ResampleCache::process( std::shared_ptr<Sample> pSample, int nSampleRate )
+{
+	const QString sPath = getCachePath( pSample, nSampleRate );
+	if ( ! sPath.isEmpty() && Filesystem::file_readable( sPath, true ) ) {
+		auto pCached = Sample::load( sPath );
+		if ( pCached != nullptr && pCached->get_sample_rate() == nSampleRate ) {
+			return pCached;
+		}
+		WARNINGLOG( QString( "Invalid cache file [%1]" ).arg( sPath ) );
+	}
+
+	auto pConverted = convert( pSample, nSampleRate );
+	if ( pConverted == nullptr || sPath.isEmpty() ) {
+		return pConverted;
+	}
+
+	// Write to a temporary file first to never leave a truncated
+	// file behind.
+	QDir().mkpath( QFileInfo( sPath ).absolutePath() );
+	const QString sTmpPath = sPath + ".tmp";
+	if ( pConverted->write( sTmpPath, SF_FORMAT_WAV | SF_FORMAT_FLOAT ) ) {
+		QFile::remove( sPath );
+		if ( ! QFile::rename( sTmpPath, sPath ) ) {
+			WARNINGLOG( QString( "Unable to store [%1]" ).arg( sPath ) );
+			QFile::remove( sTmpPath );
+		}
+	} else {
+		WARNINGLOG( QString( "Unable to write [%1]" ).arg( sTmpPath ) );
+		QFile::remove( sTmpPath );
+	}
+
+	return pConverted;
+}
+
+QString ResampleCache::getCachePath( std::shared_ptr<Sample> pSample, int nSampleRate )
+{
+	// Only samples equal to the content of their file can be
+	// looked up by it.
+	if ( pSample == nullptr || pSample->is_streamed() ||
+		 pSample->get_rubberband().use ||
+		 ! ( pSample->get_loops() == Sample::Loops() ) ||
+		 ! pSample->get_velocity_envelope()->empty() ||
+		 ! pSample->get_pan_envelope()->empty() ) {
+		return "";
+	}
+
+	QFileInfo info( pSample->get_filepath() );
+	if ( ! info.exists() ) {
+		return "";
+	}
+
+	const QString sKey = QString( "%1|%2|%3|%4|%5|%6" )
+		.arg( info.absoluteFilePath() )
+		.arg( info.size() )
+		.arg( info.lastModified().toMSecsSinceEpoch() )
+		.arg( pSample->get_sample_rate() )
+		.arg( nSampleRate )
+		.arg( ZERO_CROSSINGS );
+	const QString sHash = QCryptographicHash::hash( sKey.toUtf8(),
+													QCryptographicHash::Sha1 ).toHex();
+
+	return QDir( Filesystem::cache_dir() ).filePath( QString( "resampled/%1.wav" ).arg( sHash ) );
+}
+
+std::shared_ptr<Sample> ResampleCache::convert( std::shared_ptr<Sample> pSample, int nSampleRate )
+{
+	if ( pSample == nullptr || pSample->is_empty() || pSample->get_frames() <= 0 ||
+		 pSample->get_sample_rate() <= 0 || nSampleRate <= 0 ) {
+		return nullptr;
+	}
+
+	if ( pSample->is_compact() ) {
+		// The sample might be rendered right now and can not be
+		// expanded in place.
+		auto pExpanded = std::make_shared<Sample>( pSample );
+		pExpanded->expand();
+		pSample = pExpanded;
+	}
+
+	const int nFrames = pSample->get_frames();
+	const double fRatio = static_cast<double>( nSampleRate ) / pSample->get_sample_rate();
+	const int nConvertedFrames = std::max( 1, static_cast<int>( std::lround( nFrames * fRatio ) ) );
+
+	// Cutoff relative to the Nyquist frequency of the original
+	// sample. It is placed a little below the lower of both Nyquist
+	// frequencies to leave room for the transition band.
+	const double fCutoff = std::min( 1.0, fRatio ) * 0.95;
+	// Half width of the kernel in frames of the original sample.
+	const double fHalfWidth = ZERO_CROSSINGS / fCutoff;
+	// Stopband attenuation of about 90dB.
+	const double fBeta = 8.6;
+
+	const int nKernelSize = static_cast<int>( std::ceil( fHalfWidth * KERNEL_RESOLUTION ) ) + 2;
+	std::vector<double> kernel( nKernelSize, 0 );
+	const double fNorm = besselI0( fBeta );
+	for ( int ii = 0; ii < nKernelSize; ++ii ) {
+		const double fX = static_cast<double>( ii ) / KERNEL_RESOLUTION;
+		if ( fX >= fHalfWidth ) {
+			break;
+		}
+		const double fArg = M_PI * fCutoff * fX;
+		const double fSinc = ii == 0 ? 1.0 : std::sin( fArg ) / fArg;
+		const double fRel = fX / fHalfWidth;
+		const double fWindow = besselI0( fBeta * std::sqrt( 1 - fRel * fRel ) ) / fNorm;
+		kernel[ ii ] = fCutoff * fSinc * fWindow;
+	}
+
+	const float* pData_L = pSample->get_data_l();
+	const float* pData_R = pSample->get_data_r();
+	float* pConverted_L = new float[ nConvertedFrames ];
+	float* pConverted_R = new float[ nConvertedFrames ];
+
+	for ( int nn = 0; nn < nConvertedFrames; ++nn ) {
+		const double fPos = nn / fRatio;
+		const int nFirst = std::max( 0, static_cast<int>( std::ceil( fPos - fHalfWidth ) ) );
+		const int nLast = std::min( nFrames - 1, static_cast<int>( std::floor( fPos + fHalfWidth ) ) );
+
+		double fVal_L = 0;
+		double fVal_R = 0;
+		for ( int ii = nFirst; ii <= nLast; ++ii ) {
+			const double fIndex = std::abs( fPos - ii ) * KERNEL_RESOLUTION;
+			const int nIndex = static_cast<int>( fIndex );
+			const double fWeight = kernel[ nIndex ] +
+				( fIndex - nIndex ) * ( kernel[ nIndex + 1 ] - kernel[ nIndex ] );
+			fVal_L += fWeight * pData_L[ ii ];
+			fVal_R += fWeight * pData_R[ ii ];
+		}
+		pConverted_L[ nn ] = static_cast<float>( fVal_L );
+		pConverted_R[ nn ] = static_cast<float>( fVal_R );
+	}
+
+	// Mono samples keep sharing a single buffer.
+	if ( pSample->is_mono() ) {
+		delete[] pConverted_R;
+		pConverted_R = pConverted_L;
+	}
+
+	return std::make_shared<Sample>( pSample->get_filepath(), nConvertedFrames,
+									 nSampleRate, pConverted_L, pConverted_R );
+}
+
+};
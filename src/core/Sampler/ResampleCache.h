@@ -0,0 +1,144 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef H2C_RESAMPLE_CACHE_H
+#define H2C_RESAMPLE_CACHE_H
+
+#include <core/Object.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace H2Core
+{
+
+class AudioEngine;
+class InstrumentLayer;
+class InstrumentList;
+class Sample;
+
+/**
+ * Converts the samples of the current drumkit to the sample rate of
+ * the audio driver in a background thread.
+ *
+ * The converted copies are assigned to the corresponding
+ * InstrumentLayer using InstrumentLayer::set_converted_sample(). This
+ * way the Sampler can render all notes neither pitched by the user
+ * nor by the sample rate in Sampler::renderNoteNoResample() instead
+ * of interpolating every single frame.
+ *
+ * Since the conversion uses a windowed sinc filter considerably more
+ * expensive than the interpolation of the Sampler, the results are
+ * stored as floating point WAV files in a subfolder of
+ * Filesystem::cache_dir(). The name of a file is derived from the
+ * path, size, and modification time of the original sample and both
+ * sample rates. Samples altered by loops, Rubber Band, or envelopes
+ * are converted in memory only.
+ *
+ * Streamed samples (see Sample::load_streamed()) are not converted.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class ResampleCache : public H2Core::Object<ResampleCache>
+{
+	H2_OBJECT(ResampleCache)
+public:
+	/** Number of zero crossings of the sinc function on each side
+		of the kernel.*/
+	static constexpr int ZERO_CROSSINGS = 32;
+	/** Number of kernel values tabulated per frame of the original
+		sample. Values in between are interpolated linearly.*/
+	static constexpr int KERNEL_RESOLUTION = 512;
+
+	/** \param pAudioEngine Engine locked while assigning converted
+		samples.*/
+	ResampleCache( AudioEngine* pAudioEngine );
+	/** Stops the conversion thread. Pending jobs are discarded.*/
+	~ResampleCache();
+
+	/**
+	 * Discards all pending jobs and schedules the conversion of all
+	 * samples in @a pInstrumentList to @a nSampleRate.
+	 *
+	 * Layers which already hold a copy at the requested rate are
+	 * skipped.
+	 *
+	 * The converted samples will be assigned while holding the
+	 * lock of the AudioEngine and only if the sample of the layer
+	 * did not change in the meantime.
+	 */
+	void update( InstrumentList* pInstrumentList, int nSampleRate );
+
+	/** \return Whether there are jobs not processed yet.*/
+	bool isBusy();
+
+	/**
+	 * Converts @a pSample to @a nSampleRate using a Kaiser windowed
+	 * sinc filter.
+	 *
+	 * When downsampling the cutoff of the filter is lowered to
+	 * avoid aliasing.
+	 *
+	 * \return New sample or nullptr if @a pSample does not hold any
+	 * data.
+	 */
+	static std::shared_ptr<Sample> convert( std::shared_ptr<Sample> pSample, int nSampleRate );
+
+	/**
+	 * \return Path @a pSample converted to @a nSampleRate is stored
+	 * at or an empty string if the sample can not be cached.
+	 */
+	static QString getCachePath( std::shared_ptr<Sample> pSample, int nSampleRate );
+
+private:
+	struct Job {
+		std::shared_ptr<InstrumentLayer> pLayer;
+		std::shared_ptr<Sample> pSample;
+	};
+
+	void run();
+	/** Loads @a pSample from the cache or converts it.*/
+	std::shared_ptr<Sample> process( std::shared_ptr<Sample> pSample, int nSampleRate );
+
+	AudioEngine* m_pAudioEngine;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	/** Jobs still to do. Guarded by #m_mutex.*/
+	std::vector<Job> m_jobs;
+	/** Target sample rate of #m_jobs. Guarded by #m_mutex.*/
+	int m_nSampleRate;
+	/** Incremented by every call to update(). Guarded by
+		#m_mutex.*/
+	unsigned m_nGeneration;
+	/** Whether a job is processed right now. Guarded by
+		#m_mutex.*/
+	bool m_bWorking;
+	/** Guarded by #m_mutex.*/
+	bool m_bQuit;
+};
+
+};
+
+#endif // H2C_RESAMPLE_CACHE_H
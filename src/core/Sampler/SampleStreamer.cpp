@@ -0,0 +1,317 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/SampleStreamer.h>
+#include <core/Basics/Sample.h>
+#include <core/Globals.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace H2Core {
+
+SampleStreamer::SampleStreamer()
+	: m_nStreams( 0 )
+	, m_pStreams( nullptr )
+	, m_nNextStream( 0 )
+	, m_pReadBuffer( nullptr )
+	, m_bQuit( false )
+	, m_nUnderruns( 0 )
+{
+}
+
+SampleStreamer::~SampleStreamer()
+{
+	if ( m_thread.joinable() ) {
+		m_bQuit.store( true );
+		{
+			// Ensures the I/O thread is either waiting or did not
+			// check #m_bQuit yet.
+			std::lock_guard<std::mutex> lock( m_mutex );
+		}
+		m_condition.notify_all();
+		m_thread.join();
+	}
+
+	for ( int nStream = 0; nStream < m_nStreams; ++nStream ) {
+		closeFile( m_pStreams[ nStream ] );
+		delete[] m_pStreams[ nStream ].pBuffer_L;
+		delete[] m_pStreams[ nStream ].pBuffer_R;
+	}
+	delete[] m_pStreams;
+	delete[] m_pReadBuffer;
+}
+
+void SampleStreamer::start( int nStreams )
+{
+	if ( isRunning() || nStreams <= 0 ) {
+		return;
+	}
+
+	m_pStreams = new Stream[ nStreams ];
+	for ( int nStream = 0; nStream < nStreams; ++nStream ) {
+		Stream& stream = m_pStreams[ nStream ];
+		stream.state.store( Free );
+		stream.nReadFrame.store( 0 );
+		stream.nValidFrame.store( 0 );
+		stream.nWriteFrame.store( 0 );
+		stream.pBuffer_L = new float[ BUFFER_FRAMES ];
+		stream.pBuffer_R = new float[ BUFFER_FRAMES ];
+		stream.pFile = nullptr;
+		stream.nChannels = 0;
+		stream.nEndFrame = 0;
+	}
+	m_pReadBuffer = new float[ CHUNK_FRAMES * SAMPLE_CHANNELS ];
+	m_nStreams = nStreams;
+
+	m_thread = std::thread( &SampleStreamer::run, this );
+	INFOLOG( QString( "Streaming samples using %1 streams" ).arg( m_nStreams ) );
+}
+
+int SampleStreamer::open( std::shared_ptr<Sample> pSample )
+{
+	for ( int ii = 0; ii < m_nStreams; ++ii ) {
+		const int nStream = ( m_nNextStream + ii ) % m_nStreams;
+		Stream& stream = m_pStreams[ nStream ];
+		if ( stream.state.load( std::memory_order_acquire ) != Free ) {
+			continue;
+		}
+
+		const long long nStart = pSample->get_preloaded_frames();
+		stream.pSample = pSample;
+		stream.nReadFrame.store( nStart, std::memory_order_relaxed );
+		stream.nValidFrame.store( nStart, std::memory_order_relaxed );
+		stream.nWriteFrame.store( nStart, std::memory_order_relaxed );
+		stream.state.store( Opening, std::memory_order_release );
+
+		m_nNextStream = ( nStream + 1 ) % m_nStreams;
+		return nStream;
+	}
+	return -1;
+}
+
+void SampleStreamer::release( int nStream )
+{
+	if ( nStream < 0 || nStream >= m_nStreams ) {
+		return;
+	}
+	m_pStreams[ nStream ].state.store( Closing, std::memory_order_release );
+}
+
+void SampleStreamer::read( int nStream, std::shared_ptr<Sample> pSample, int nStart, int nFrames,
+						   float* pOut_L, float* pOut_R )
+{
+	// Part held in memory.
+	const int nPreloaded = pSample->get_preloaded_frames();
+	if ( nStart < nPreloaded ) {
+		const int nCopy = std::min( nFrames, nPreloaded - nStart );
+		memcpy( pOut_L, pSample->get_data_l() + nStart, nCopy * sizeof( float ) );
+		memcpy( pOut_R, pSample->get_data_r() + nStart, nCopy * sizeof( float ) );
+		nStart += nCopy;
+		nFrames -= nCopy;
+		pOut_L += nCopy;
+		pOut_R += nCopy;
+	}
+	if ( nFrames <= 0 ) {
+		return;
+	}
+
+	// Part read from disk.
+	const long long nEnd = static_cast<long long>( nStart ) + nFrames;
+	long long nFrom = nEnd;
+	long long nTo = nEnd;
+	if ( nStream >= 0 && nStream < m_nStreams ) {
+		Stream& stream = m_pStreams[ nStream ];
+		if ( stream.pSample == pSample ) {
+			// Allow the I/O thread to reuse the space of all frames
+			// prior to the requested ones.
+			long long nRead = stream.nReadFrame.load( std::memory_order_relaxed );
+			if ( nStart > nRead ) {
+				nRead = nStart;
+				stream.nReadFrame.store( nRead, std::memory_order_release );
+			}
+			// The acquire of #nWriteFrame makes both the frames and
+			// a #nValidFrame updated alongside it visible.
+			nTo = std::min( nEnd, stream.nWriteFrame.load( std::memory_order_acquire ) );
+			nTo = std::max( nTo, static_cast<long long>( nStart ) );
+			nFrom = std::max( nRead, stream.nValidFrame.load( std::memory_order_acquire ) );
+			nFrom = std::min( nFrom, nTo );
+
+			for ( long long nFrame = nFrom; nFrame < nTo; ) {
+				const int nPos = nFrame % BUFFER_FRAMES;
+				const int nCopy = std::min<long long>( nTo - nFrame, BUFFER_FRAMES - nPos );
+				memcpy( pOut_L + ( nFrame - nStart ), stream.pBuffer_L + nPos, nCopy * sizeof( float ) );
+				memcpy( pOut_R + ( nFrame - nStart ), stream.pBuffer_R + nPos, nCopy * sizeof( float ) );
+				nFrame += nCopy;
+			}
+		}
+	}
+
+	// Silence for frames not read in time.
+	if ( nFrom > nStart ) {
+		memset( pOut_L, 0, ( nFrom - nStart ) * sizeof( float ) );
+		memset( pOut_R, 0, ( nFrom - nStart ) * sizeof( float ) );
+	}
+	if ( nTo < nEnd ) {
+		memset( pOut_L + ( nTo - nStart ), 0, ( nEnd - nTo ) * sizeof( float ) );
+		memset( pOut_R + ( nTo - nStart ), 0, ( nEnd - nTo ) * sizeof( float ) );
+	}
+	const long long nSampleEnd = std::min<long long>( nEnd, pSample->get_frames() );
+	if ( nFrom > nStart || nTo < nSampleEnd ) {
+		m_nUnderruns.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+
+void SampleStreamer::run()
+{
+	while ( ! m_bQuit.load() ) {
+		bool bBusy = false;
+
+		for ( int nStream = 0; nStream < m_nStreams; ++nStream ) {
+			Stream& stream = m_pStreams[ nStream ];
+			switch ( stream.state.load( std::memory_order_acquire ) ) {
+			case Opening: {
+				openFile( stream );
+				// The audio thread might have released the stream in
+				// the meantime.
+				int nExpected = Opening;
+				stream.state.compare_exchange_strong( nExpected, Active,
+													  std::memory_order_acq_rel );
+				bBusy = true;
+				break;
+			}
+			case Active:
+				bBusy = fill( stream ) || bBusy;
+				break;
+			case Closing:
+				closeFile( stream );
+				// The sample is released outside of the audio thread.
+				stream.pSample = nullptr;
+				stream.state.store( Free, std::memory_order_release );
+				break;
+			default:
+				break;
+			}
+		}
+
+		if ( ! bBusy ) {
+			// The audio thread does not notify the I/O thread, as
+			// this might involve a system call. The preloaded part
+			// of the samples covers the polling interval by far.
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_condition.wait_for( lock, std::chrono::milliseconds( 2 ),
+								  [&]{ return m_bQuit.load(); } );
+		}
+	}
+}
+
+void SampleStreamer::openFile( Stream& stream )
+{
+	SF_INFO info = {0};
+	stream.nEndFrame = 0;
+	stream.pFile = sf_open( stream.pSample->get_filepath().toLocal8Bit(), SFM_READ, &info );
+	if ( stream.pFile == nullptr ) {
+		ERRORLOG( QString( "Unable to open %1" ).arg( stream.pSample->get_filepath() ) );
+		return;
+	}
+	if ( info.channels > SAMPLE_CHANNELS ) {
+		ERRORLOG( QString( "Unable to stream %1 channels of %2" )
+				  .arg( info.channels ).arg( stream.pSample->get_filepath() ) );
+		closeFile( stream );
+		return;
+	}
+
+	const long long nStart = stream.nWriteFrame.load( std::memory_order_relaxed );
+	if ( sf_seek( stream.pFile, nStart, SEEK_SET ) != nStart ) {
+		ERRORLOG( QString( "Unable to seek %1" ).arg( stream.pSample->get_filepath() ) );
+		closeFile( stream );
+		return;
+	}
+	stream.nChannels = info.channels;
+	stream.nEndFrame = std::min<long long>( info.frames, stream.pSample->get_frames() );
+}
+
+void SampleStreamer::closeFile( Stream& stream )
+{
+	if ( stream.pFile != nullptr ) {
+		sf_close( stream.pFile );
+		stream.pFile = nullptr;
+	}
+	stream.nEndFrame = 0;
+}
+
+bool SampleStreamer::fill( Stream& stream )
+{
+	if ( stream.pFile == nullptr ) {
+		return false;
+	}
+
+	const long long nRead = stream.nReadFrame.load( std::memory_order_acquire );
+	long long nWrite = stream.nWriteFrame.load( std::memory_order_relaxed );
+	if ( nWrite < nRead ) {
+		// The reader overtook us. There is no use in reading frames
+		// it already skipped.
+		if ( sf_seek( stream.pFile, nRead, SEEK_SET ) != nRead ) {
+			ERRORLOG( QString( "Unable to seek %1" ).arg( stream.pSample->get_filepath() ) );
+			closeFile( stream );
+			return false;
+		}
+		stream.nValidFrame.store( nRead, std::memory_order_relaxed );
+		stream.nWriteFrame.store( nRead, std::memory_order_release );
+		nWrite = nRead;
+	}
+
+	const long long nFrames = std::min<long long>(
+		{ static_cast<long long>( CHUNK_FRAMES ),
+		  nRead + BUFFER_FRAMES - nWrite,
+		  stream.nEndFrame - nWrite } );
+	// Wait for space for a whole chunk unless the end of the file
+	// is reached.
+	if ( nFrames <= 0 ||
+		 ( nFrames < CHUNK_FRAMES && nWrite + nFrames < stream.nEndFrame ) ) {
+		return false;
+	}
+
+	const sf_count_t nCount = sf_readf_float( stream.pFile, m_pReadBuffer, nFrames );
+	if ( nCount <= 0 ) {
+		ERRORLOG( QString( "Unable to read %1" ).arg( stream.pSample->get_filepath() ) );
+		closeFile( stream );
+		return false;
+	}
+
+	for ( sf_count_t ii = 0; ii < nCount; ++ii ) {
+		const int nPos = ( nWrite + ii ) % BUFFER_FRAMES;
+		if ( stream.nChannels == 1 ) {
+			stream.pBuffer_L[ nPos ] = m_pReadBuffer[ ii ];
+			stream.pBuffer_R[ nPos ] = m_pReadBuffer[ ii ];
+		} else {
+			stream.pBuffer_L[ nPos ] = m_pReadBuffer[ ii * SAMPLE_CHANNELS ];
+			stream.pBuffer_R[ nPos ] = m_pReadBuffer[ ii * SAMPLE_CHANNELS + 1 ];
+		}
+	}
+	stream.nWriteFrame.store( nWrite + nCount, std::memory_order_release );
+
+	return true;
+}
+
+};
@@ -0,0 +1,191 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef SAMPLE_STREAMER_H
+#define SAMPLE_STREAMER_H
+
+#include <core/Object.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <sndfile.h>
+
+namespace H2Core
+{
+
+class Sample;
+
+/**
+ * Reads the parts of streamed samples not held in memory from disk
+ * during playback.
+ *
+ * Samples loaded using Sample::load_streamed() only keep their
+ * first few hundred milliseconds in memory. Whenever a voice starts
+ * playing such a sample the Sampler opens a stream for it. A
+ * background thread then fills the ring buffer of the stream with
+ * the frames following the preloaded part well ahead of the
+ * position the voice is rendering.
+ *
+ * The streams are allocated up front and handed between the audio
+ * thread and the I/O thread using atomic states. Neither open(),
+ * read(), nor release() lock, allocate, or touch the disk. Frames
+ * not fetched in time are replaced by silence and counted as an
+ * underrun. If the I/O thread falls behind a voice, it continues
+ * reading at the current position of the voice.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class SampleStreamer : public H2Core::Object<SampleStreamer>
+{
+	H2_OBJECT(SampleStreamer)
+public:
+	/** Number of frames buffered per stream.*/
+	static constexpr int BUFFER_FRAMES = 16384;
+	/** Number of frames read from disk at once.*/
+	static constexpr int CHUNK_FRAMES = 4096;
+
+	/** Creates a streamer without any streams. All samples are
+		played from their preloaded part until start() is
+		called.*/
+	SampleStreamer();
+	/** Stops the I/O thread and closes all files.*/
+	~SampleStreamer();
+
+	/**
+	 * Allocates @a nStreams streams and starts the I/O thread. Does
+	 * nothing if the streamer is already running.
+	 *
+	 * The AudioEngine has to be locked when calling this function.
+	 */
+	void start( int nStreams );
+	bool isRunning() const;
+
+	/**
+	 * Opens a stream delivering the frames of @a pSample following
+	 * its preloaded part. Has to be called by the audio thread.
+	 *
+	 * \return Index of the stream or -1 if no stream is available.
+	 */
+	int open( std::shared_ptr<Sample> pSample );
+	/**
+	 * Hands stream @a nStream back to the I/O thread. Has to be
+	 * called by the audio thread.
+	 */
+	void release( int nStream );
+	/**
+	 * Copies frames [@a nStart, @a nStart + @a nFrames) of @a
+	 * pSample into @a pOut_L and @a pOut_R.
+	 *
+	 * Frames within the preloaded part are taken from the sample
+	 * itself, the remaining ones from stream @a nStream. Frames not
+	 * available yet are set to zero. Since the frames prior to @a
+	 * nStart are discarded, @a nStart must not decrease between
+	 * calls for the same stream.
+	 *
+	 * \param nStream Stream opened for @a pSample using open() or
+	 *   -1.
+	 */
+	void read( int nStream, std::shared_ptr<Sample> pSample, int nStart, int nFrames,
+			   float* pOut_L, float* pOut_R );
+
+	/** \return Number of read() calls which had to fill in silence
+		for frames not read from disk in time.*/
+	long long getUnderrunCount() const;
+	int getStreamCount() const;
+
+private:
+	enum State {
+		/** Available to open().*/
+		Free = 0,
+		/** Opened by the audio thread. The I/O thread has to open
+			the file.*/
+		Opening,
+		/** Filled by the I/O thread.*/
+		Active,
+		/** Released by the audio thread. The I/O thread has to
+			close the file.*/
+		Closing
+	};
+
+	struct Stream {
+		std::atomic<int> state;
+		/** Set by the audio thread before entering #Opening and
+			reset by the I/O thread before entering #Free.*/
+		std::shared_ptr<Sample> pSample;
+		/** Frames before this one were discarded by the reader and
+			might be overwritten.*/
+		std::atomic<long long> nReadFrame;
+		/** Frames [#nValidFrame, #nWriteFrame) are present in the
+			buffers.*/
+		std::atomic<long long> nValidFrame;
+		std::atomic<long long> nWriteFrame;
+		/** Frame index modulo #BUFFER_FRAMES.*/
+		float* pBuffer_L;
+		float* pBuffer_R;
+		/** Only accessed by the I/O thread.*/
+		SNDFILE* pFile;
+		int nChannels;
+		long long nEndFrame;
+	};
+
+	/** Main loop of the I/O thread.*/
+	void run();
+	void openFile( Stream& stream );
+	void closeFile( Stream& stream );
+	/** Reads the next chunk of @a stream from disk if there is
+		enough space in its buffers.
+
+		\return whether frames were read.*/
+	bool fill( Stream& stream );
+
+	int m_nStreams;
+	Stream* m_pStreams;
+	/** Index open() starts searching for a free stream at.*/
+	int m_nNextStream;
+	/** Interleaved frames read from disk by the I/O thread.*/
+	float* m_pReadBuffer;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::atomic<bool> m_bQuit;
+	std::atomic<long long> m_nUnderruns;
+};
+
+inline bool SampleStreamer::isRunning() const {
+	return m_nStreams > 0;
+}
+
+inline long long SampleStreamer::getUnderrunCount() const {
+	return m_nUnderruns.load( std::memory_order_relaxed );
+}
+
+inline int SampleStreamer::getStreamCount() const {
+	return m_nStreams;
+}
+
+};
+
+#endif // SAMPLE_STREAMER_H
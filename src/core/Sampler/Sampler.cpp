@@ -20,6 +20,7 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
@@ -29,6 +30,7 @@
 
 #include <core/Basics/Adsr.h>
 #include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/NotePool.h>
 #include <core/Globals.h>
 #include <core/Hydrogen.h>
 #include <core/Basics/DrumkitComponent.h>
@@ -46,7 +48,10 @@
 #include <core/EventQueue.h>
 
 #include <core/FX/Effects.h>
+#include <core/Sampler/BlockKernels.h>
+#include <core/Sampler/BusBuffers.h>
 #include <core/Sampler/Sampler.h>
+#include <core/Sampler/SampleStreamer.h>
 
 #include <iostream>
 #include <QDebug>
@@ -66,16 +71,48 @@ static std::shared_ptr<Instrument> createInstrument(int id, const QString& filep
 	return pInstrument;
 }
 
-Sampler::Sampler()
+Sampler::Sampler( NotePool* pNotePool )
 		: m_pMainOut_L( nullptr )
 		, m_pMainOut_R( nullptr )
+		, m_nNotesStarted( 0 )
+		, m_nNotesRendered( 0 )
+		, m_nStolenNotes( 0 )
+		, m_pNotePool( pNotePool )
+		, m_nMaxNotesLimit( static_cast<int>( Preferences::get_instance()->m_nMaxNotes ) )
+		, m_pVoiceBuffer_L( nullptr )
+		, m_pVoiceBuffer_R( nullptr )
+		, m_pStreamBuffer_L( nullptr )
+		, m_pStreamBuffer_R( nullptr )
+		, m_pComponentBusses( nullptr )
+		, m_pSampleStreamer( nullptr )
 		, m_pPreviewInstrument( nullptr )
 		, m_interpolateMode( Interpolation::InterpolateMode::Linear )
+		, m_pRenderPool( nullptr )
+		, m_nRenderFrames( 0 )
+		, m_pRenderSong( nullptr )
 {
 	INFOLOG( "INIT" );
 	
 	m_pMainOut_L = new float[ MAX_BUFFER_SIZE ];
 	m_pMainOut_R = new float[ MAX_BUFFER_SIZE ];
+	m_pVoiceBuffer_L = new float[ MAX_BUFFER_SIZE ];
+	m_pVoiceBuffer_R = new float[ MAX_BUFFER_SIZE ];
+	m_pStreamBuffer_L = new float[ MAX_BUFFER_SIZE ];
+	m_pStreamBuffer_R = new float[ MAX_BUFFER_SIZE ];
+	m_pComponentBusses = new BusBuffers( MAX_COMPONENTS );
+
+	m_pSampleStreamer = new SampleStreamer();
+	if ( Preferences::get_instance()->m_bStreamSamples ) {
+		m_pSampleStreamer->start( Preferences::get_instance()->m_nMaxNotes );
+	}
+
+	// Avoid reallocations of the note queues within the audio
+	// thread. The Sampler does never hold more notes than the pool
+	// contains.
+	m_playingNotesQueue.reserve( m_pNotePool->getSize() );
+	m_playingNotesInfo.reserve( m_pNotePool->getSize() );
+	m_queuedNoteOffs.reserve( m_pNotePool->getSize() );
+	m_voices.reserve( MAX_COMPONENTS );
 
 	m_nMaxLayers = InstrumentComponent::getMaxLayers();
 
@@ -88,6 +125,8 @@ Sampler::Sampler()
 	// dummy instrument used for playback track
 	m_pPlaybackTrackInstrument = createInstrument( PLAYBACK_INSTR_ID, sEmptySampleFilename, 0.8 );
 	m_nPlayBackSamplePosition = 0;
+
+	setRenderThreads( Preferences::get_instance()->m_nRenderThreads );
 }
 
 
@@ -97,6 +136,14 @@ Sampler::~Sampler()
 
 	delete[] m_pMainOut_L;
 	delete[] m_pMainOut_R;
+	delete[] m_pVoiceBuffer_L;
+	delete[] m_pVoiceBuffer_R;
+	delete[] m_pStreamBuffer_L;
+	delete[] m_pStreamBuffer_R;
+	delete m_pComponentBusses;
+
+	setRenderThreads( 1 );
+	delete m_pSampleStreamer;
 
 	m_pPreviewInstrument = nullptr;
 	m_pPlaybackTrackInstrument = nullptr;
@@ -119,52 +166,61 @@ void Sampler::process( uint32_t nFrames, std::shared_ptr<Song> pSong )
 	// Track output queues are zeroed by
 	// audioEngine_process_clearAudioBuffers()
 
-	// Max notes limit
-	int m_nMaxNotes = Preferences::get_instance()->m_nMaxNotes;
-	while ( ( int )m_playingNotesQueue.size() > m_nMaxNotes ) {
-		Note * pOldNote = m_playingNotesQueue[ 0 ];
-		m_playingNotesQueue.erase( m_playingNotesQueue.begin() );
-		 pOldNote->get_instrument()->dequeue();
-		delete  pOldNote;	// FIXME: send note-off instead of removing the note from the list?
-	}
+	// Max notes limit. It is already enforced by noteOn() but might
+	// have been lowered in the meantime.
+	stealNotes( getMaxNotes(), nullptr );
 
+	// Each component of the song is rendered into its own bus.
+	int nBus = 0;
 	for ( auto& pComponent : *pSong->getComponents() ) {
-		pComponent->reset_outs(nFrames);
+		if ( nBus < m_pComponentBusses->getBusCount() ) {
+			m_pComponentBusses->clear( nBus, nFrames );
+			pComponent->set_out_buffers( m_pComponentBusses->getBuffer_L( nBus ),
+										 m_pComponentBusses->getBuffer_R( nBus ) );
+		} else {
+			pComponent->set_out_buffers( nullptr, nullptr );
+		}
+		++nBus;
+	}
+
+	InstrumentList* pInstrList = pSong->getInstrumentList();
+	for ( int i = 0; i < pInstrList->size(); ++i ) {
+		pInstrList->get( i )->getMeter()->startCycle( nFrames );
 	}
+	m_pPlaybackTrackInstrument->getMeter()->startCycle( nFrames );
 
-	// eseguo tutte le note nella lista di note in esecuzione
-	unsigned i = 0;
 	Note* pNote;
-	while ( i < m_playingNotesQueue.size() ) {
-		pNote = m_playingNotesQueue[ i ];		// recupero una nuova nota
-		if ( renderNote( pNote, nFrames, pSong ) ) {	// la nota e' finita
-			m_playingNotesQueue.erase( m_playingNotesQueue.begin() + i );
-			pNote->get_instrument()->dequeue();
-			m_queuedNoteOffs.push_back( pNote );
-		} else {
-			++i; // carico la prox nota
+	if ( m_pRenderPool != nullptr ) {
+		renderNotesInParallel( nFrames, pSong );
+	} else {
+		// eseguo tutte le note nella lista di note in esecuzione
+		unsigned i = 0;
+		while ( i < m_playingNotesQueue.size() ) {
+			pNote = m_playingNotesQueue[ i ];		// recupero una nuova nota
+			if ( renderNote( pNote, nFrames, pSong ) ) {	// la nota e' finita
+				// The last note takes its place and is rendered
+				// next.
+				removePlayingNote( i );
+				pNote->get_instrument()->dequeue();
+				m_queuedNoteOffs.push_back( pNote );
+			} else {
+				++i; // carico la prox nota
+			}
 		}
 	}
+	m_nNotesRendered = m_nNotesStarted;
 
 	//Queue midi note off messages for notes that have a length specified for them
-	while ( !m_queuedNoteOffs.empty() ) {
-		pNote =  m_queuedNoteOffs[0];
-		MidiOutput* pMidiOut = Hydrogen::get_instance()->getMidiOutput();
-		
+	MidiOutput* pMidiOut = Hydrogen::get_instance()->getMidiOutput();
+	for ( auto pNote : m_queuedNoteOffs ) {
 		if( pMidiOut != nullptr && !pNote->get_instrument()->is_muted() ){
 			pMidiOut->handleQueueNoteOff(	pNote->get_instrument()->get_midi_out_channel(), 
 											pNote->get_midi_key(),
 											pNote->get_midi_velocity() );
 		}
-		
-		m_queuedNoteOffs.erase( m_queuedNoteOffs.begin() );
-		
-		if( pNote != nullptr ){
-			delete pNote;
-		}
-		
-		pNote = nullptr;
-	}//while
+		releaseNote( pNote );
+	}
+	m_queuedNoteOffs.clear();
 
 	processPlaybackTrack(nFrames);
 }
@@ -202,10 +258,119 @@ void Sampler::noteOn(Note *pNote )
 
 	pInstr->enqueue();
 	if( !pNote->get_note_off() ){
-		m_playingNotesQueue.push_back( pNote );
+		// Make room for the new note.
+		stealNotes( getMaxNotes() - 1, pInstr.get() );
+		addPlayingNote( pNote );
+	}
+}
+
+void Sampler::addPlayingNote( Note* pNote )
+{
+	m_playingNotesQueue.push_back( pNote );
+	m_playingNotesInfo.push_back( { m_nNotesStarted, false } );
+	++m_nNotesStarted;
+}
+
+void Sampler::removePlayingNote( int nIndex )
+{
+	if ( m_playingNotesInfo[ nIndex ].bStolen ) {
+		--m_nStolenNotes;
+	}
+	m_playingNotesQueue[ nIndex ] = m_playingNotesQueue.back();
+	m_playingNotesQueue.pop_back();
+	m_playingNotesInfo[ nIndex ] = m_playingNotesInfo.back();
+	m_playingNotesInfo.pop_back();
+}
+
+void Sampler::stealNotes( int nMaxNotes, const Instrument* pIncoming )
+{
+	const auto policy =
+		static_cast<VoiceStealing>( Preferences::get_instance()->m_nVoiceStealing );
+
+	while ( static_cast<int>( m_playingNotesQueue.size() ) - m_nStolenNotes > nMaxNotes ) {
+		const int nIndex = findNoteToSteal( policy, pIncoming );
+		if ( nIndex == -1 ) {
+			break;
+		}
+
+		// The note is faded out instead of being cut off. It keeps
+		// being rendered and is removed by process() once its
+		// envelope is done.
+		m_playingNotesQueue[ nIndex ]->get_adsr()->fast_release();
+		m_playingNotesInfo[ nIndex ].bStolen = true;
+		++m_nStolenNotes;
 	}
 }
 
+int Sampler::findNoteToSteal( VoiceStealing policy, const Instrument* pIncoming ) const
+{
+	auto isOlder = [&]( int nIndex, int nOther ) {
+		return m_playingNotesInfo[ nIndex ].nStarted <
+			m_playingNotesInfo[ nOther ].nStarted;
+	};
+
+	// All policies are served by a single pass over the playing
+	// notes. Ties are resolved in favour of the oldest note.
+	int nOldest = -1;
+	int nOldestOfInstrument = -1;
+	int nCandidate = -1;
+	float fCandidateLevel = 0;
+	int nCandidatePriority = 0;
+	for ( int i = 0; i < m_playingNotesQueue.size(); ++i ) {
+		if ( m_playingNotesInfo[ i ].bStolen ) {
+			continue;
+		}
+		Note* pNote = m_playingNotesQueue[ i ];
+
+		if ( nOldest == -1 || isOlder( i, nOldest ) ) {
+			nOldest = i;
+		}
+
+		switch ( policy ) {
+		case VoiceStealing::Quietest: {
+			// Notes not rendered yet did not compute their envelope
+			// and are considered to be at full level.
+			float fLevel = pNote->get_velocity();
+			if ( m_playingNotesInfo[ i ].nStarted < m_nNotesRendered ) {
+				fLevel *= pNote->get_adsr()->get_current_value();
+			}
+			if ( nCandidate == -1 || fLevel < fCandidateLevel ||
+				 ( fLevel == fCandidateLevel && isOlder( i, nCandidate ) ) ) {
+				nCandidate = i;
+				fCandidateLevel = fLevel;
+			}
+			break;
+		}
+		case VoiceStealing::SameInstrument:
+			if ( pNote->get_instrument().get() == pIncoming &&
+				 ( nOldestOfInstrument == -1 || isOlder( i, nOldestOfInstrument ) ) ) {
+				nOldestOfInstrument = i;
+			}
+			break;
+		case VoiceStealing::LowestPriority: {
+			const int nPriority = pNote->get_instrument()->getVoicePriority();
+			if ( nCandidate == -1 || nPriority < nCandidatePriority ||
+				 ( nPriority == nCandidatePriority && isOlder( i, nCandidate ) ) ) {
+				nCandidate = i;
+				nCandidatePriority = nPriority;
+			}
+			break;
+		}
+		case VoiceStealing::Oldest:
+		default:
+			break;
+		}
+	}
+
+	if ( nOldestOfInstrument != -1 ) {
+		return nOldestOfInstrument;
+	}
+	if ( nCandidate != -1 ) {
+		return nCandidate;
+	}
+	return nOldest;
+}
+
 void Sampler::midiKeyboardNoteOff( int key )
 {
 	for ( const auto& pNote: m_playingNotesQueue ) {
@@ -216,6 +381,17 @@ void Sampler::midiKeyboardNoteOff( int key )
 }
 
 
+void Sampler::releaseNote( Note* pNote )
+{
+	for ( auto& layer : *pNote->get_layers_selected() ) {
+		if ( layer.second.Stream != -1 ) {
+			m_pSampleStreamer->release( layer.second.Stream );
+			layer.second.Stream = -1;
+		}
+	}
+	m_pNotePool->release( pNote );
+}
+
 /// This old note_off function is only used by right click on mixer channel strip play button
 /// all other note_off stuff will handle in midi_keyboard_note_off() and note_on()
 void Sampler::noteOff(Note* pNote )
@@ -228,7 +404,7 @@ void Sampler::noteOff(Note* pNote )
 		}
 	}
 	
-	delete pNote;
+	m_pNotePool->release( pNote );
 }
 
 
@@ -397,7 +573,7 @@ inline float Sampler::panLaw( float fPan, std::shared_ptr<Song> pSong ) {
 	} else if ( nPanLawType == QUADRATIC_CONST_K_NORM ) {
 		return quadraticConstKNormPanLaw( fPan, pSong->getPanLawKNorm() );
 	} else {
-		WARNINGLOG( "Unknown pan law type. Set default." );
+		RT_WARNINGLOG( "Unknown pan law type. Set default." );
 		pSong->setPanLawType( RATIO_STRAIGHT_POLYGONAL );
 		return ratioStraightPolygonalPanLaw( fPan );
 	}
@@ -405,10 +581,262 @@ inline float Sampler::panLaw( float fPan, std::shared_ptr<Song> pSong ) {
 
 //------------------------------------------------------------------
 
+int Sampler::getMaxNotes() const
+{
+	return std::min( static_cast<int>( Preferences::get_instance()->m_nMaxNotes ),
+					 m_nMaxNotesLimit );
+}
+
+void Sampler::setRenderThreads( int nThreads )
+{
+	delete m_pRenderPool;
+	m_pRenderPool = nullptr;
+	for ( auto pBuffers : m_renderBuffers ) {
+		delete pBuffers;
+	}
+	m_renderBuffers.clear();
+
+	// More threads than cores would only compete with each other.
+	const int nCores = std::thread::hardware_concurrency();
+	if ( nCores > 0 && nThreads > nCores ) {
+		WARNINGLOG( QString( "Only [%1] instead of [%2] render threads will be used" )
+					.arg( nCores ).arg( nThreads ) );
+		nThreads = nCores;
+	}
+	if ( nThreads <= 1 ) {
+		return;
+	}
+
+	// Every playing note contributes at most one voice per
+	// component.
+	const int nMaxVoices = m_pNotePool->getSize() * MAX_COMPONENTS;
+	m_voices.reserve( nMaxVoices );
+	m_preparedNotes.reserve( m_pNotePool->getSize() );
+	m_instrumentWorkers.reserve( m_pNotePool->getSize() );
+	for ( int nWorker = 0; nWorker < nThreads; ++nWorker ) {
+		m_renderBuffers.push_back( new RenderBuffers( nMaxVoices ) );
+	}
+
+	m_pRenderPool = new VoiceRenderPool( nThreads, [this]( int nWorker ) {
+		renderWorker( nWorker );
+	} );
+}
+
+Sampler::RenderBuffers::RenderBuffers( int nMaxVoices )
+	: nFrames( 0 )
+	, nComponents( 0 )
+{
+	pVoice_L = new float[ MAX_BUFFER_SIZE ];
+	pVoice_R = new float[ MAX_BUFFER_SIZE ];
+	pMain_L = new float[ MAX_BUFFER_SIZE ];
+	pMain_R = new float[ MAX_BUFFER_SIZE ];
+	pComponentBusses = new BusBuffers( MAX_COMPONENTS );
+	for ( int nComponent = 0; nComponent < MAX_COMPONENTS; ++nComponent ) {
+		pComponents[ nComponent ] = nullptr;
+		pComponent_L[ nComponent ] = pComponentBusses->getBuffer_L( nComponent );
+		pComponent_R[ nComponent ] = pComponentBusses->getBuffer_R( nComponent );
+	}
+	for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+		bFXUsed[ nFX ] = false;
+		pFX_L[ nFX ] = new float[ MAX_BUFFER_SIZE ];
+		pFX_R[ nFX ] = new float[ MAX_BUFFER_SIZE ];
+	}
+	pStream_L = new float[ MAX_BUFFER_SIZE ];
+	pStream_R = new float[ MAX_BUFFER_SIZE ];
+	voices.reserve( nMaxVoices );
+}
+
+Sampler::RenderBuffers::~RenderBuffers()
+{
+	delete[] pVoice_L;
+	delete[] pVoice_R;
+	delete[] pMain_L;
+	delete[] pMain_R;
+	delete pComponentBusses;
+	for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+		delete[] pFX_L[ nFX ];
+		delete[] pFX_R[ nFX ];
+	}
+	delete[] pStream_L;
+	delete[] pStream_R;
+}
+
+void Sampler::RenderBuffers::reset( int nNewFrames )
+{
+	nFrames = nNewFrames;
+	memset( pMain_L, 0, nFrames * sizeof( float ) );
+	memset( pMain_R, 0, nFrames * sizeof( float ) );
+	nComponents = 0;
+	for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+		bFXUsed[ nFX ] = false;
+	}
+}
+
+int Sampler::RenderBuffers::getComponentSlot( DrumkitComponent* pComponent )
+{
+	for ( int nSlot = 0; nSlot < nComponents; ++nSlot ) {
+		if ( pComponents[ nSlot ] == pComponent ) {
+			return nSlot;
+		}
+	}
+	if ( nComponents >= MAX_COMPONENTS ) {
+		return -1;
+	}
+
+	pComponents[ nComponents ] = pComponent;
+	pComponentBusses->clear( nComponents, nFrames );
+	return nComponents++;
+}
+
+void Sampler::RenderBuffers::useFX( int nFX )
+{
+	if ( ! bFXUsed[ nFX ] ) {
+		memset( pFX_L[ nFX ], 0, nFrames * sizeof( float ) );
+		memset( pFX_R[ nFX ], 0, nFrames * sizeof( float ) );
+		bFXUsed[ nFX ] = true;
+	}
+}
+
+void Sampler::renderNotesInParallel( uint32_t nFrames, std::shared_ptr<Song> pSong )
+{
+	m_voices.clear();
+	m_preparedNotes.clear();
+	m_instrumentWorkers.clear();
+	for ( auto pBuffers : m_renderBuffers ) {
+		pBuffers->voices.clear();
+	}
+
+	// Everything touching state shared between instruments is done
+	// up front in the audio thread.
+	for ( auto pNote : m_playingNotesQueue ) {
+		PreparedNote prepared;
+		prepared.nFirstVoice = m_voices.size();
+		prepared.bEnded = prepareNote( pNote, nFrames, pSong );
+		prepared.nVoices = m_voices.size() - prepared.nFirstVoice;
+		m_preparedNotes.push_back( prepared );
+
+		// All voices of a note share its envelope and filter and have
+		// to be rendered in order by a single worker. Those of an
+		// instrument share its peaks and track outputs.
+		if ( prepared.nVoices > 0 ) {
+			auto& voices = m_renderBuffers[ getWorkerForInstrument( pNote->get_instrument().get() ) ]->voices;
+			for ( int nVoice = prepared.nFirstVoice;
+				  nVoice < prepared.nFirstVoice + prepared.nVoices; ++nVoice ) {
+				voices.push_back( nVoice );
+			}
+		}
+	}
+
+	m_nRenderFrames = nFrames;
+	m_pRenderSong = pSong;
+	m_pRenderPool->run();
+	m_pRenderSong = nullptr;
+
+	// Sum up the private buffers in a fixed order to get the same
+	// result regardless of the timing of the workers.
+	for ( auto pBuffers : m_renderBuffers ) {
+		BlockKernels::mix( pBuffers->pMain_L, 1.0, m_pMainOut_L, nFrames );
+		BlockKernels::mix( pBuffers->pMain_R, 1.0, m_pMainOut_R, nFrames );
+
+		for ( int nSlot = 0; nSlot < pBuffers->nComponents; ++nSlot ) {
+			DrumkitComponent* pComponent = pBuffers->pComponents[ nSlot ];
+			if ( pComponent->get_outs_L() != nullptr ) {
+				BlockKernels::mix( pBuffers->pComponent_L[ nSlot ], 1.0, pComponent->get_outs_L(), nFrames );
+				BlockKernels::mix( pBuffers->pComponent_R[ nSlot ], 1.0, pComponent->get_outs_R(), nFrames );
+			}
+		}
+
+#ifdef H2CORE_HAVE_LADSPA
+		for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+			LadspaFX* pFX = Effects::get_instance()->getLadspaFX( nFX );
+			if ( pFX != nullptr && pBuffers->bFXUsed[ nFX ] ) {
+				BlockKernels::mix( pBuffers->pFX_L[ nFX ], 1.0, pFX->m_pBuffer_L, nFrames );
+				BlockKernels::mix( pBuffers->pFX_R[ nFX ], 1.0, pFX->m_pBuffer_R, nFrames );
+			}
+		}
+#endif
+	}
+
+	// Walking backwards, notes moved into the place of removed ones
+	// were already checked.
+	for ( int i = m_preparedNotes.size() - 1; i >= 0; --i ) {
+		const PreparedNote& prepared = m_preparedNotes[ i ];
+		bool bEnded = prepared.bEnded;
+		for ( int nVoice = prepared.nFirstVoice;
+			  nVoice < prepared.nFirstVoice + prepared.nVoices; ++nVoice ) {
+			bEnded = bEnded && m_voices[ nVoice ].bEnded;
+		}
+
+		if ( bEnded ) {
+			Note* pNote = m_playingNotesQueue[ i ];
+			removePlayingNote( i );
+			pNote->get_instrument()->dequeue();
+			m_queuedNoteOffs.push_back( pNote );
+		}
+	}
+}
+
+void Sampler::renderWorker( int nWorker )
+{
+	RenderBuffers* pBuffers = m_renderBuffers[ nWorker ];
+	pBuffers->reset( m_nRenderFrames );
+
+	for ( int nVoice : pBuffers->voices ) {
+		Voice& voice = m_voices[ nVoice ];
+		voice.bEnded = renderVoice( voice, m_nRenderFrames, m_pRenderSong, pBuffers );
+	}
+}
+
+int Sampler::getWorkerForInstrument( Instrument* pInstrument )
+{
+	for ( const auto& entry : m_instrumentWorkers ) {
+		if ( entry.first == pInstrument ) {
+			return entry.second;
+		}
+	}
+
+	// New instruments are assigned to the worker with the fewest
+	// voices so far.
+	int nWorker = 0;
+	for ( int nOther = 1; nOther < m_renderBuffers.size(); ++nOther ) {
+		if ( m_renderBuffers[ nOther ]->voices.size() <
+			 m_renderBuffers[ nWorker ]->voices.size() ) {
+			nWorker = nOther;
+		}
+	}
+	m_instrumentWorkers.push_back( std::make_pair( pInstrument, nWorker ) );
+
+	return nWorker;
+}
+
 /// Render a note
 /// Return false: the note is not ended
 /// Return true: the note is ended
 bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Song> pSong )
+{
+	m_voices.clear();
+	bool bEnded = prepareNote( pNote, nBufferSize, pSong );
+	for ( auto& voice : m_voices ) {
+		bEnded = renderVoice( voice, nBufferSize, pSong, nullptr ) && bEnded;
+	}
+	return bEnded;
+}
+
+bool Sampler::renderVoice( const Voice& voice, unsigned nBufferSize, std::shared_ptr<Song> pSong, RenderBuffers* pBuffers )
+{
+	if ( voice.bResample ) {
+		return renderNoteResample( voice.pSample, voice.pNote, voice.pSelectedLayer, voice.pCompo,
+								   voice.pDrumCompo, nBufferSize, voice.nInitialSilence,
+								   voice.fCost_L, voice.fCost_R, voice.fCost_track_L,
+								   voice.fCost_track_R, voice.fLayerPitch, pSong, pBuffers );
+	}
+	return renderNoteNoResample( voice.pSample, voice.pNote, voice.pSelectedLayer, voice.pCompo,
+								 voice.pDrumCompo, nBufferSize, voice.nInitialSilence,
+								 voice.fCost_L, voice.fCost_R, voice.fCost_track_L,
+								 voice.fCost_track_R, pSong, pBuffers );
+}
+
+bool Sampler::prepareNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Song> pSong )
 {
 	//infoLog( "[renderNote] instr: " + pNote->getInstrument()->m_sName );
 	assert( pSong );
@@ -426,7 +854,7 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 
 	auto pInstr = pNote->get_instrument();
 	if ( !pInstr ) {
-		ERRORLOG( "NULL instrument" );
+		RT_ERRORLOG( "NULL instrument" );
 		return 1;
 	}
 
@@ -497,8 +925,8 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 		SelectedLayerInfo *pSelectedLayer = pNote->get_layer_selected( pCompo->get_drumkit_componentID() );
 
 		if ( !pSelectedLayer ) {
-			QString dummy = QString( "NULL Layer Information for instrument %1. Component: %2" ).arg( pInstr->get_name() ).arg( pCompo->get_drumkit_componentID() );
-			WARNINGLOG( dummy );
+			RT_WARNINGLOG( "NULL Layer Information for instrument [%1]. Component: %2",
+						   pInstr->get_id(), pCompo->get_drumkit_componentID() );
 			nReturnValues[nReturnValueIndex] = true;
 			continue;
 		}
@@ -532,7 +960,7 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 					}
 
 					if ( !pSample ){
-						WARNINGLOG( "Velocity did fall into a hole between the instrument layers." );
+						RT_WARNINGLOG( "Velocity did fall into a hole between the instrument layers." );
 						// There are a small distance between the
 						// layers of the instruments the velocity of
 						// the pNote has fallen into. This can if the
@@ -601,7 +1029,7 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 						// for the nearest sample and play this
 						// one instead.
 						if ( __foundSamples == 0 ){
-							WARNINGLOG( "Velocity did fall into a hole between the instrument layers." );
+							RT_WARNINGLOG( "Velocity did fall into a hole between the instrument layers." );
 							float shortestDistance = 1.0f;
 							int nearestLayer = -1;
 							for ( unsigned nLayer = 0; nLayer < m_nMaxLayers; ++nLayer ){
@@ -680,7 +1108,7 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 						// for the nearest sample and play this
 						// one instead.
 						if ( __foundSamples == 0 ){
-							WARNINGLOG( "Velocity did fall into a hole between the instrument layers." );
+							RT_WARNINGLOG( "Velocity did fall into a hole between the instrument layers." );
 							float shortestDistance = 1.0f;
 							int nearestLayer = -1;
 							for ( unsigned nLayer = 0; nLayer < m_nMaxLayers; ++nLayer ){
@@ -738,14 +1166,34 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 			}
 		}
 		if ( !pSample ) {
-			QString dummy = QString( "NULL sample for instrument %1. Note velocity: %2" ).arg( pInstr->get_name() ).arg( pNote->get_velocity() );
-			WARNINGLOG( dummy );
+			RT_WARNINGLOG( "NULL sample for instrument [%1]. Note velocity: %2",
+						   pInstr->get_id(), pNote->get_velocity() );
 			nReturnValues[nReturnValueIndex] = true;
 			continue;
 		}
 
+		// Unpitched notes play the copy converted to the sample rate
+		// of the driver by the ResampleCache. The decision is made
+		// at the beginning of the note and kept till its end since
+		// positions in both samples differ.
+		auto pLayer = pCompo->get_layer( pSelectedLayer->SelectedLayer );
+		if ( pSelectedLayer->SamplePosition == 0 ) {
+			auto pConverted = pLayer != nullptr ? pLayer->get_converted_sample() : nullptr;
+			pSelectedLayer->Converted = pConverted != nullptr &&
+				pConverted->get_sample_rate() == pAudioDriver->getSampleRate() &&
+				pNote->get_total_pitch() + fLayerPitch == 0.0;
+		}
+		if ( pSelectedLayer->Converted ) {
+			pSample = pLayer != nullptr ? pLayer->get_converted_sample() : nullptr;
+			if ( pSample == nullptr ) {
+				// The sample of the layer was replaced during note play.
+				nReturnValues[nReturnValueIndex] = true;
+				continue;
+			}
+		}
+
 		if ( pSelectedLayer->SamplePosition >= pSample->get_frames() ) {
-			WARNINGLOG( "sample position out of bounds. The layer has been resized during note play?" );
+			RT_WARNINGLOG( "sample position out of bounds. The layer has been resized during note play?" );
 			nReturnValues[nReturnValueIndex] = true;
 			continue;
 		}
@@ -760,7 +1208,8 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 				int noteStartInFramesNoHumanize = ( int )pNote->get_position() * pAudioEngine->getTickSize();
 				if ( noteStartInFramesNoHumanize > ( int )( nFramepos + nBufferSize ) ) {
 					// this note is not valid. it's in the future...let's skip it....
-					ERRORLOG( QString( "Note pos in the future?? Current frames: %1, note frame pos: %2" ).arg( nFramepos ).arg(noteStartInFramesNoHumanize ) );
+					RT_ERRORLOG( "Note pos in the future?? Current frames: %1, note frame pos: %2",
+								 nFramepos, noteStartInFramesNoHumanize );
 					//pNote->dumpInfo();
 					nReturnValues[nReturnValueIndex] = true;
 					continue;
@@ -855,13 +1304,31 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 			}
 		}
 
-		if ( fTotalPitch == 0.0 && pSample->get_sample_rate() == pAudioDriver->getSampleRate() ) { // NO RESAMPLE
-			nReturnValues[nReturnValueIndex] = renderNoteNoResample( pSample, pNote, pSelectedLayer, pCompo, pMainCompo, nBufferSize, nInitialSilence, cost_L, cost_R, cost_track_L, cost_track_R, pSong );
-		}
-		else { // RESAMPLE
-			nReturnValues[nReturnValueIndex] = renderNoteResample( pSample, pNote, pSelectedLayer, pCompo, pMainCompo, nBufferSize, nInitialSilence, cost_L, cost_R, cost_track_L, cost_track_R, fLayerPitch, pSong );
+		// Streams are only opened for voices actually rendered.
+		if ( pSample->is_streamed() && pSelectedLayer->Stream == -1 ) {
+			pSelectedLayer->Stream = m_pSampleStreamer->open( pSample );
 		}
 
+		Voice voice;
+		voice.pNote = pNote;
+		voice.pSample = pSample;
+		voice.pSelectedLayer = pSelectedLayer;
+		voice.pCompo = pCompo;
+		voice.pDrumCompo = pMainCompo;
+		voice.nInitialSilence = nInitialSilence;
+		voice.fCost_L = cost_L;
+		voice.fCost_R = cost_R;
+		voice.fCost_track_L = cost_track_L;
+		voice.fCost_track_R = cost_track_R;
+		voice.fLayerPitch = fLayerPitch;
+		// NO RESAMPLE if neither pitch nor sample rate differ.
+		voice.bResample = fTotalPitch != 0.0 || pSample->get_sample_rate() != pAudioDriver->getSampleRate();
+		voice.bEnded = false;
+		m_voices.push_back( voice );
+
+		// Whether the voice ended is only known after rendering.
+		nReturnValues[nReturnValueIndex] = true;
+
 		nReturnValueIndex++;
 	}
 	for ( unsigned i = 0 ; i < pInstr->get_components()->size() ; i++ ) {
@@ -897,9 +1364,11 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 
 	auto pSample_data_L = pSample->get_data_l();
 	auto pSample_data_R = pSample->get_data_r();
-	
-	float fInstrPeak_L = m_pPlaybackTrackInstrument->get_peak_l(); // this value will be reset to 0 by the mixer..
-	float fInstrPeak_R = m_pPlaybackTrackInstrument->get_peak_r(); // this value will be reset to 0 by the mixer..
+
+	// The track is rendered into the voice buffers, which are not
+	// used anymore at this point, in order to meter it block-wise.
+	float* pTrack_L = m_pVoiceBuffer_L;
+	float* pTrack_R = m_pVoiceBuffer_R;
 
 	int nAvail_bytes = 0;
 	int	nInitialBufferPos = 0;
@@ -931,18 +1400,8 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 			fVal_L = fVal_L * 1.0f * pSong->getPlaybackTrackVolume(); //costr
 			fVal_R = fVal_R * 1.0f * pSong->getPlaybackTrackVolume(); //cost l
 	
-			//pDrumCompo->set_outs( nBufferPos, fVal_L, fVal_R );
-	
-			// to main mix
-			if ( fVal_L > fInstrPeak_L ) {
-				fInstrPeak_L = fVal_L;
-			}
-			if ( fVal_R > fInstrPeak_R ) {
-				fInstrPeak_R = fVal_R;
-			}
-			
-			m_pMainOut_L[nBufferPos] += fVal_L;
-			m_pMainOut_R[nBufferPos] += fVal_R;
+			pTrack_L[nBufferPos] = fVal_L;
+			pTrack_R[nBufferPos] = fVal_R;
 			
 			++nSamplePos;
 		}
@@ -1013,23 +1472,22 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 					}
 			}
 			
-			if ( fVal_L > fInstrPeak_L ) {
-				fInstrPeak_L = fVal_L;
-			}
-			if ( fVal_R > fInstrPeak_R ) {
-				fInstrPeak_R = fVal_R;
-			}
-
-			m_pMainOut_L[nBufferPos] += fVal_L;
-			m_pMainOut_R[nBufferPos] += fVal_R;
+			pTrack_L[nBufferPos] = fVal_L;
+			pTrack_R[nBufferPos] = fVal_R;
 
 
 			fSamplePos += fStep;
 		} //for
 	}
 	
-	m_pPlaybackTrackInstrument->set_peak_l( fInstrPeak_L );
-	m_pPlaybackTrackInstrument->set_peak_r( fInstrPeak_R );
+	const int nFrames = nAvail_bytes;
+	m_pPlaybackTrackInstrument->getMeter()->process( pTrack_L + nInitialBufferPos,
+													 pTrack_R + nInitialBufferPos,
+													 nFrames );
+
+	// to main mix
+	BlockKernels::mix( pTrack_L + nInitialBufferPos, 1.0, m_pMainOut_L + nInitialBufferPos, nFrames );
+	BlockKernels::mix( pTrack_R + nInitialBufferPos, 1.0, m_pMainOut_R + nInitialBufferPos, nFrames );
 
 	return true;
 }
@@ -1046,11 +1504,12 @@ bool Sampler::renderNoteNoResample(
 	float cost_R,
 	float cost_track_L,
 	float cost_track_R,
-	std::shared_ptr<Song> pSong
+	std::shared_ptr<Song> pSong,
+	RenderBuffers* pBuffers
 )
 {
-	auto pAudioDriver = Hydrogen::get_instance()->getAudioOutput();
 	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	auto pADSR = pNote->get_adsr();
 	bool retValue = true; // the note is ended
 
 	int nNoteLength = -1;
@@ -1068,112 +1527,65 @@ bool Sampler::renderNoteNoResample(
 
 	int nInitialBufferPos = nInitialSilence;
 	int nInitialSamplePos = ( int )pSelectedLayerInfo->SamplePosition;
-	int nSamplePos = nInitialSamplePos;
-	int nTimes = nInitialBufferPos + nAvail_bytes;
-
-	auto pSample_data_L = pSample->get_data_l();
-	auto pSample_data_R = pSample->get_data_r();
-
-	float fInstrPeak_L = pNote->get_instrument()->get_peak_l(); // this value will be reset to 0 by the mixer..
-	float fInstrPeak_R = pNote->get_instrument()->get_peak_r(); // this value will be reset to 0 by the mixer..
-
-	float fADSRValue;
-	float fVal_L;
-	float fVal_R;
 
-
-#ifdef H2CORE_HAVE_JACK
-	float *		pTrackOutL = nullptr;
-	float *		pTrackOutR = nullptr;
-
-	if ( Preferences::get_instance()->m_bJackTrackOuts ) {
-		auto pJackAudioDriver = dynamic_cast<JackAudioDriver*>( pAudioDriver );
-		if( pJackAudioDriver ) {
-			pTrackOutL = pJackAudioDriver->getTrackOut_L( pNote->get_instrument(), pCompo );
-			pTrackOutR = pJackAudioDriver->getTrackOut_R( pNote->get_instrument(), pCompo );
+	const float* pSample_data_L;
+	const float* pSample_data_R;
+	if ( pSample->is_streamed() ) {
+		float* pStream_L = pBuffers != nullptr ? pBuffers->pStream_L : m_pStreamBuffer_L;
+		float* pStream_R = pBuffers != nullptr ? pBuffers->pStream_R : m_pStreamBuffer_R;
+		m_pSampleStreamer->read( pSelectedLayerInfo->Stream, pSample, nInitialSamplePos,
+								 nAvail_bytes, pStream_L, pStream_R );
+		pSample_data_L = pStream_L;
+		pSample_data_R = pStream_R;
+	} else if ( pSample->is_compact() ) {
+		// Converted block by block. The effect sends are fed with
+		// the same frames.
+		float* pStream_L = pBuffers != nullptr ? pBuffers->pStream_L : m_pStreamBuffer_L;
+		float* pStream_R = pBuffers != nullptr ? pBuffers->pStream_R : m_pStreamBuffer_R;
+		BlockKernels::convert( pSample->get_data_16_l() + nInitialSamplePos, pStream_L, nAvail_bytes );
+		pSample_data_L = pStream_L;
+		if ( pSample->is_mono() ) {
+			pSample_data_R = pStream_L;
+		} else {
+			BlockKernels::convert( pSample->get_data_16_r() + nInitialSamplePos, pStream_R, nAvail_bytes );
+			pSample_data_R = pStream_R;
 		}
+	} else {
+		pSample_data_L = pSample->get_data_l() + nInitialSamplePos;
+		pSample_data_R = pSample->get_data_r() + nInitialSamplePos;
 	}
-#endif
-
-	for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
-		if ( ( nNoteLength != -1 ) && ( nNoteLength <= pSelectedLayerInfo->SamplePosition ) ) {
-						if ( pNote->get_adsr()->release() == 0 ) {
-				retValue = true;	// the note is ended
-			}
-		}
-
-		fADSRValue = pNote->get_adsr()->get_value( 1 );
-		fVal_L = pSample_data_L[ nSamplePos ] * fADSRValue;
-		fVal_R = pSample_data_R[ nSamplePos ] * fADSRValue;
-
-		// Low pass resonant filter
-		if ( pNote->get_instrument()->is_filter_active() ) {
-			pNote->compute_lr_values( &fVal_L, &fVal_R );
+	float* pVoice_L = ( pBuffers != nullptr ? pBuffers->pVoice_L : m_pVoiceBuffer_L ) + nInitialBufferPos;
+	float* pVoice_R = ( pBuffers != nullptr ? pBuffers->pVoice_R : m_pVoiceBuffer_R ) + nInitialBufferPos;
+
+	// ADSR envelope and low pass resonant filter. Both carry state
+	// from one frame to the next.
+	const bool bRelease = ( nNoteLength != -1 ) && ( nNoteLength <= pSelectedLayerInfo->SamplePosition );
+	const bool bFilterActive = pNote->get_instrument()->is_filter_active();
+	for ( int i = 0; i < nAvail_bytes; ++i ) {
+		if ( bRelease && pADSR->release() == 0 ) {
+			retValue = true;	// the note is ended
 		}
 
-#ifdef H2CORE_HAVE_JACK
-		if(  pTrackOutL ) {
-			 pTrackOutL[nBufferPos] += fVal_L * cost_track_L;
-		}
-		if( pTrackOutR ) {
-			pTrackOutR[nBufferPos] += fVal_R * cost_track_R;
-		}
-#endif
-
-		fVal_L = fVal_L * cost_L;
-		fVal_R = fVal_R * cost_R;
+		float fADSRValue = pADSR->get_value( 1 );
+		pVoice_L[ i ] = pSample_data_L[ i ] * fADSRValue;
+		pVoice_R[ i ] = pSample_data_R[ i ] * fADSRValue;
 
-		// update instr peak
-		if ( fVal_L > fInstrPeak_L ) {
-			fInstrPeak_L = fVal_L;
+		if ( bFilterActive ) {
+			pNote->compute_lr_values( &pVoice_L[ i ], &pVoice_R[ i ] );
 		}
-		if ( fVal_R > fInstrPeak_R ) {
-			fInstrPeak_R = fVal_R;
-		}
-
-		pDrumCompo->set_outs( nBufferPos, fVal_L, fVal_R );
-
-		// to main mix
-		m_pMainOut_L[nBufferPos] += fVal_L;
-		m_pMainOut_R[nBufferPos] += fVal_R;
-
-		++nSamplePos;
+	}
+	// Notes whose envelope faded out completely, like stolen ones,
+	// are done regardless of the remainder of the sample.
+	if ( pADSR->is_idle() ) {
+		retValue = true;
 	}
 	pSelectedLayerInfo->SamplePosition += nAvail_bytes;
-	pNote->get_instrument()->set_peak_l( fInstrPeak_L );
-	pNote->get_instrument()->set_peak_r( fInstrPeak_R );
-
 
-#ifdef H2CORE_HAVE_LADSPA
-	// LADSPA
-	// change the below return logic if you add code after that ifdef
-	if (pNote->get_instrument()->is_muted() || pSong->getIsMuted() ) return retValue;
-	float masterVol =  pSong->getVolume();
-	for ( unsigned nFX = 0; nFX < MAX_FX; ++nFX ) {
-		LadspaFX *pFX = Effects::get_instance()->getLadspaFX( nFX );
+	mixVoice( pNote, pCompo, pDrumCompo, nInitialBufferPos, nAvail_bytes,
+			  cost_L, cost_R, cost_track_L, cost_track_R, pBuffers );
 
-		float fLevel = pNote->get_instrument()->get_fx_level( nFX );
-
-		if ( ( pFX ) && ( fLevel != 0.0 ) ) {
-			fLevel = fLevel * pFX->getVolume();
-			float *pBuf_L = pFX->m_pBuffer_L;
-			float *pBuf_R = pFX->m_pBuffer_R;
-
-			float fFXCost_L = fLevel * masterVol;
-			float fFXCost_R = fLevel * masterVol;
-
-			int nBufferPos = nInitialBufferPos;
-			int nSamplePos = nInitialSamplePos;
-			for ( int i = 0; i < nAvail_bytes; ++i ) {
-				pBuf_L[ nBufferPos ] += pSample_data_L[ nSamplePos ] * fFXCost_L;
-				pBuf_R[ nBufferPos ] += pSample_data_R[ nSamplePos ] * fFXCost_R;
-				++nSamplePos;
-				++nBufferPos;
-			}
-		}
-	}
-	// ~LADSPA
-#endif
+	// The effect sends are fed with the plain sample.
+	mixFXSends( pNote, pSong, pSample_data_L, pSample_data_R, nInitialBufferPos, nAvail_bytes, pBuffers );
 
 	return retValue;
 }
@@ -1193,11 +1605,13 @@ bool Sampler::renderNoteResample(
 	float cost_track_L,
 	float cost_track_R,
 	float fLayerPitch,
-	std::shared_ptr<Song> pSong
+	std::shared_ptr<Song> pSong,
+	RenderBuffers* pBuffers
 )
 {
 	auto pAudioDriver = Hydrogen::get_instance()->getAudioOutput();
 	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+	auto pADSR = pNote->get_adsr();
 
 	int nNoteLength = -1;
 	if ( pNote->get_length() != -1 ) {
@@ -1225,211 +1639,176 @@ bool Sampler::renderNoteResample(
 	}
 
 	int nInitialBufferPos = nInitialSilence;
-	//float fInitialSamplePos = pNote->get_sample_position( pCompo->get_drumkit_componentID() );
-	double fSamplePos = pSelectedLayerInfo->SamplePosition;
-	int nTimes = nInitialBufferPos + nAvail_bytes;
-
-	auto pSample_data_L = pSample->get_data_l();
-	auto pSample_data_R = pSample->get_data_r();
-
-	float fInstrPeak_L = pNote->get_instrument()->get_peak_l(); // this value will be reset to 0 by the mixer..
-	float fInstrPeak_R = pNote->get_instrument()->get_peak_r(); // this value will be reset to 0 by the mixer..
-
-	float fADSRValue = 1.0;
-	float fVal_L;
-	float fVal_R;
-	int nSampleFrames = pSample->get_frames();
-
-
-#ifdef H2CORE_HAVE_JACK
-	float *		pTrackOutL = nullptr;
-	float *		pTrackOutR = nullptr;
-
-	if ( Preferences::get_instance()->m_bJackTrackOuts ) {
-		auto pJackAudioDriver = dynamic_cast<JackAudioDriver*>( pAudioDriver );
-		if( pJackAudioDriver ) {
-			pTrackOutL = pJackAudioDriver->getTrackOut_L( pNote->get_instrument(), pCompo );
-			pTrackOutR = pJackAudioDriver->getTrackOut_R( pNote->get_instrument(), pCompo );
+	float* pVoice_L = ( pBuffers != nullptr ? pBuffers->pVoice_L : m_pVoiceBuffer_L ) + nInitialBufferPos;
+	float* pVoice_R = ( pBuffers != nullptr ? pBuffers->pVoice_R : m_pVoiceBuffer_R ) + nInitialBufferPos;
+
+	// Interpolate the whole block at once. The kernel matching the
+	// interpolation mode is selected once per voice and buffer.
+	if ( pSample->is_streamed() ) {
+		// The frames are fetched in chunks small enough for the
+		// scratch buffers. Each chunk is padded by the support
+		// points of the interpolation.
+		float* pStream_L = pBuffers != nullptr ? pBuffers->pStream_L : m_pStreamBuffer_L;
+		float* pStream_R = pBuffers != nullptr ? pBuffers->pStream_R : m_pStreamBuffer_R;
+		const int nChunk = std::max( 1, ( int )( ( MAX_BUFFER_SIZE - 8 ) / fStep ) );
+		double fSamplePos = pSelectedLayerInfo->SamplePosition;
+		for ( int nDone = 0; nDone < nAvail_bytes; ) {
+			const int nFrames = std::min( nChunk, nAvail_bytes - nDone );
+			const int nWindowStart = std::max( 0, ( int )fSamplePos - 2 );
+			const int nWindowEnd = std::min( { pSample->get_frames(),
+											   ( int )( fSamplePos + ( nFrames - 1 ) * fStep ) + 4,
+											   nWindowStart + MAX_BUFFER_SIZE } );
+			m_pSampleStreamer->read( pSelectedLayerInfo->Stream, pSample, nWindowStart,
+									 nWindowEnd - nWindowStart, pStream_L, pStream_R );
+			BlockKernels::resample( m_interpolateMode,
+									pStream_L, pStream_R, nWindowEnd - nWindowStart,
+									fSamplePos - nWindowStart, fStep,
+									pVoice_L + nDone, pVoice_R + nDone, nFrames );
+			nDone += nFrames;
+			fSamplePos += nFrames * fStep;
 		}
+	} else if ( pSample->is_compact() ) {
+		BlockKernels::resample( m_interpolateMode,
+								pSample->get_data_16_l(), pSample->get_data_16_r(), pSample->get_frames(),
+								pSelectedLayerInfo->SamplePosition, fStep,
+								pVoice_L, pVoice_R, nAvail_bytes );
+	} else {
+		BlockKernels::resample( m_interpolateMode,
+								pSample->get_data_l(), pSample->get_data_r(), pSample->get_frames(),
+								pSelectedLayerInfo->SamplePosition, fStep,
+								pVoice_L, pVoice_R, nAvail_bytes );
 	}
-#endif
 
-	for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
-		if ( ( nNoteLength != -1 ) && ( nNoteLength <= pSelectedLayerInfo->SamplePosition ) ) {
-						if ( pNote->get_adsr()->release() == 0 ) {
-				retValue = 1;	// the note is ended
-			}
+	// The effect sends are fed with the plain interpolated sample
+	// and have to be served before the envelope is applied in place.
+	mixFXSends( pNote, pSong, pVoice_L, pVoice_R, nInitialBufferPos, nAvail_bytes, pBuffers );
+
+	// ADSR envelope and low pass resonant filter. Both carry state
+	// from one frame to the next.
+	const bool bRelease = ( nNoteLength != -1 ) && ( nNoteLength <= pSelectedLayerInfo->SamplePosition );
+	const bool bFilterActive = pNote->get_instrument()->is_filter_active();
+	for ( int i = 0; i < nAvail_bytes; ++i ) {
+		if ( bRelease && pADSR->release() == 0 ) {
+			retValue = true;	// the note is ended
 		}
 
-		int nSamplePos = ( int )fSamplePos;
-		double fDiff = fSamplePos - nSamplePos;
-		if ( ( nSamplePos + 1 ) >= nSampleFrames ) {
-			//we reach the last audioframe.
-			//set this last frame to zero do nothing wrong.
-						fVal_L = 0.0;
-						fVal_R = 0.0;
-		} else {
-			// some interpolation methods need 4 frames data.
-				float last_l;
-				float last_r;
-				if ( ( nSamplePos + 2 ) >= nSampleFrames ) {
-					last_l = 0.0;
-					last_r = 0.0;
-				} else {
-					last_l =  pSample_data_L[nSamplePos + 2];
-					last_r =  pSample_data_R[nSamplePos + 2];
-				}
-
-				switch( m_interpolateMode ){
+		float fADSRValue = pADSR->get_value( fStep );
+		pVoice_L[ i ] *= fADSRValue;
+		pVoice_R[ i ] *= fADSRValue;
 
-						case Interpolation::InterpolateMode::Linear:
-								fVal_L = pSample_data_L[nSamplePos] * (1 - fDiff ) + pSample_data_L[nSamplePos + 1] * fDiff;
-								fVal_R = pSample_data_R[nSamplePos] * (1 - fDiff ) + pSample_data_R[nSamplePos + 1] * fDiff;
-								//fVal_L = linear_Interpolate( pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], fDiff);
-								//fVal_R = linear_Interpolate( pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], fDiff);
-								break;
-						case Interpolation::InterpolateMode::Cosine:
-								fVal_L = Interpolation::cosine_Interpolate( pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], fDiff);
-								fVal_R = Interpolation::cosine_Interpolate( pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], fDiff);
-								break;
-						case Interpolation::InterpolateMode::Third:
-								fVal_L = Interpolation::third_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
-								fVal_R = Interpolation::third_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
-								break;
-						case Interpolation::InterpolateMode::Cubic:
-								fVal_L = Interpolation::cubic_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
-								fVal_R = Interpolation::cubic_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
-								break;
-						case Interpolation::InterpolateMode::Hermite:
-								fVal_L = Interpolation::hermite_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
-								fVal_R = Interpolation::hermite_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
-								break;
-				}
+		if ( bFilterActive ) {
+			pNote->compute_lr_values( &pVoice_L[ i ], &pVoice_R[ i ] );
 		}
+	}
+	// Notes whose envelope faded out completely, like stolen ones,
+	// are done regardless of the remainder of the sample.
+	if ( pADSR->is_idle() ) {
+		retValue = true;
+	}
+	pSelectedLayerInfo->SamplePosition += nAvail_bytes * fStep;
 
-		// ADSR envelope
-		fADSRValue = pNote->get_adsr()->get_value( fStep );
-		fVal_L = fVal_L * fADSRValue;
-		fVal_R = fVal_R * fADSRValue;
-		// Low pass resonant filter
-		if ( pNote->get_instrument()->is_filter_active() ) {
-			pNote->compute_lr_values( &fVal_L, &fVal_R );
-		}
+	mixVoice( pNote, pCompo, pDrumCompo, nInitialBufferPos, nAvail_bytes,
+			  cost_L, cost_R, cost_track_L, cost_track_R, pBuffers );
 
+	return retValue;
+}
 
+void Sampler::mixVoice( Note* pNote,
+						std::shared_ptr<InstrumentComponent> pCompo,
+						DrumkitComponent* pDrumCompo,
+						int nBufferPos,
+						int nFrames,
+						float cost_L,
+						float cost_R,
+						float cost_track_L,
+						float cost_track_R,
+						RenderBuffers* pBuffers )
+{
+	if ( nFrames <= 0 ) {
+		return;
+	}
+
+	auto pInstr = pNote->get_instrument();
+	float* pVoice_L = ( pBuffers != nullptr ? pBuffers->pVoice_L : m_pVoiceBuffer_L ) + nBufferPos;
+	float* pVoice_R = ( pBuffers != nullptr ? pBuffers->pVoice_R : m_pVoiceBuffer_R ) + nBufferPos;
 
 #ifdef H2CORE_HAVE_JACK
-		if( 		pTrackOutL ) {
-					pTrackOutL[nBufferPos] += fVal_L * cost_track_L;
-		}
-		if( 		pTrackOutR ) {
-					pTrackOutR[nBufferPos] += fVal_R * cost_track_R;
+	if ( Preferences::get_instance()->m_bJackTrackOuts ) {
+		auto pJackAudioDriver = dynamic_cast<JackAudioDriver*>( Hydrogen::get_instance()->getAudioOutput() );
+		if( pJackAudioDriver ) {
+			float* pTrackOutL = pJackAudioDriver->getTrackOut_L( pInstr, pCompo );
+			float* pTrackOutR = pJackAudioDriver->getTrackOut_R( pInstr, pCompo );
+			if ( pTrackOutL ) {
+				BlockKernels::mix( pVoice_L, cost_track_L, pTrackOutL + nBufferPos, nFrames );
+			}
+			if ( pTrackOutR ) {
+				BlockKernels::mix( pVoice_R, cost_track_R, pTrackOutR + nBufferPos, nFrames );
+			}
 		}
+	}
 #endif
 
-		fVal_L = fVal_L * cost_L;
-		fVal_R = fVal_R * cost_R;
+	BlockKernels::scale( pVoice_L, cost_L, nFrames );
+	BlockKernels::scale( pVoice_R, cost_R, nFrames );
 
-		// update instr peak
-		if ( fVal_L > fInstrPeak_L ) {
-			fInstrPeak_L = fVal_L;
-		}
-		if ( fVal_R > fInstrPeak_R ) {
-			fInstrPeak_R = fVal_R;
-		}
-
-		pDrumCompo->set_outs( nBufferPos, fVal_L, fVal_R );
+	// Will be reset by the mixer.
+	pInstr->getMeter()->process( pVoice_L, pVoice_R, nFrames );
 
-		// to main mix
-		m_pMainOut_L[nBufferPos] += fVal_L;
-		m_pMainOut_R[nBufferPos] += fVal_R;
+	if ( pBuffers != nullptr ) {
+		const int nSlot = pBuffers->getComponentSlot( pDrumCompo );
+		if ( nSlot >= 0 ) {
+			BlockKernels::mix( pVoice_L, 1.0, pBuffers->pComponent_L[ nSlot ] + nBufferPos, nFrames );
+			BlockKernels::mix( pVoice_R, 1.0, pBuffers->pComponent_R[ nSlot ] + nBufferPos, nFrames );
+		}
 
-		fSamplePos += fStep;
+		BlockKernels::mix( pVoice_L, 1.0, pBuffers->pMain_L + nBufferPos, nFrames );
+		BlockKernels::mix( pVoice_R, 1.0, pBuffers->pMain_R + nBufferPos, nFrames );
+		return;
 	}
-	pSelectedLayerInfo->SamplePosition += nAvail_bytes * fStep;
-	pNote->get_instrument()->set_peak_l( fInstrPeak_L );
-	pNote->get_instrument()->set_peak_r( fInstrPeak_R );
 
+	if ( pDrumCompo->get_outs_L() != nullptr ) {
+		BlockKernels::mix( pVoice_L, 1.0, pDrumCompo->get_outs_L() + nBufferPos, nFrames );
+		BlockKernels::mix( pVoice_R, 1.0, pDrumCompo->get_outs_R() + nBufferPos, nFrames );
+	}
 
+	// to main mix
+	BlockKernels::mix( pVoice_L, 1.0, m_pMainOut_L + nBufferPos, nFrames );
+	BlockKernels::mix( pVoice_R, 1.0, m_pMainOut_R + nBufferPos, nFrames );
+}
 
+void Sampler::mixFXSends( Note* pNote,
+						  std::shared_ptr<Song> pSong,
+						  const float* pIn_L,
+						  const float* pIn_R,
+						  int nBufferPos,
+						  int nFrames,
+						  RenderBuffers* pBuffers )
+{
 #ifdef H2CORE_HAVE_LADSPA
-	// LADSPA
-	// change the below return logic if you add code after that ifdef
-	if (pNote->get_instrument()->is_muted() || pSong->getIsMuted() ) return retValue;
-	float masterVol = pSong->getVolume();
+	auto pInstr = pNote->get_instrument();
+	if ( nFrames <= 0 || pInstr->is_muted() || pSong->getIsMuted() ) {
+		return;
+	}
+
+	float fMasterVol = pSong->getVolume();
 	for ( unsigned nFX = 0; nFX < MAX_FX; ++nFX ) {
 		LadspaFX *pFX = Effects::get_instance()->getLadspaFX( nFX );
-		float fLevel = pNote->get_instrument()->get_fx_level( nFX );
-		if ( ( pFX ) && ( fLevel != 0.0 ) ) {
-			fLevel = fLevel * pFX->getVolume();
-
-			float *pBuf_L = pFX->m_pBuffer_L;
-			float *pBuf_R = pFX->m_pBuffer_R;
-
-//			float fFXCost_L = cost_L * fLevel;
-//			float fFXCost_R = cost_R * fLevel;
-			float fFXCost_L = fLevel * masterVol;
-			float fFXCost_R = fLevel * masterVol;
-
-			int nBufferPos = nInitialBufferPos;
-			float fSamplePos = pSelectedLayerInfo->SamplePosition;
-			for ( int i = 0; i < nAvail_bytes; ++i ) {
-				int nSamplePos = ( int )fSamplePos;
-				double fDiff = fSamplePos - nSamplePos;
-
-				if ( ( nSamplePos + 1 ) >= nSampleFrames ) {
-					//we reach the last audioframe.
-					//set this last frame to zero do nothing wrong.
-					fVal_L = 0.0;
-					fVal_R = 0.0;
-				} else {
-					// some interpolation methods need 4 frames data.
-					float last_l;
-					float last_r;
-					if ( ( nSamplePos + 2 ) >= nSampleFrames ) {
-						last_l = 0.0;
-						last_r = 0.0;
-					}else
-					{
-						last_l =  pSample_data_L[nSamplePos + 2];
-						last_r =  pSample_data_R[nSamplePos + 2];
-					}
-
-					switch( m_interpolateMode ){
+		float fLevel = pInstr->get_fx_level( nFX );
 
-					case Interpolation::InterpolateMode::Linear:
-						fVal_L = pSample_data_L[nSamplePos] * (1 - fDiff ) + pSample_data_L[nSamplePos + 1] * fDiff;
-						fVal_R = pSample_data_R[nSamplePos] * (1 - fDiff ) + pSample_data_R[nSamplePos + 1] * fDiff;
-						break;
-					case Interpolation::InterpolateMode::Cosine:
-						fVal_L = Interpolation::cosine_Interpolate( pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], fDiff);
-						fVal_R = Interpolation::cosine_Interpolate( pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], fDiff);
-						break;
-					case Interpolation::InterpolateMode::Third:
-						fVal_L = Interpolation::third_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
-						fVal_R = Interpolation::third_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
-						break;
-					case Interpolation::InterpolateMode::Cubic:
-						fVal_L = Interpolation::cubic_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
-						fVal_R = Interpolation::cubic_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
-						break;
-					case Interpolation::InterpolateMode::Hermite:
-						fVal_L = Interpolation::hermite_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
-						fVal_R = Interpolation::hermite_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
-						break;
-					}
-				}
-
-				pBuf_L[ nBufferPos ] += fVal_L * fFXCost_L;
-								pBuf_R[ nBufferPos ] += fVal_R * fFXCost_R;
-				fSamplePos += fStep;
-				++nBufferPos;
+		if ( ( pFX ) && ( fLevel != 0.0 ) ) {
+			float fFXCost = fLevel * pFX->getVolume() * fMasterVol;
+			float* pOut_L = pFX->m_pBuffer_L;
+			float* pOut_R = pFX->m_pBuffer_R;
+			if ( pBuffers != nullptr ) {
+				pBuffers->useFX( nFX );
+				pOut_L = pBuffers->pFX_L[ nFX ];
+				pOut_R = pBuffers->pFX_R[ nFX ];
 			}
+			BlockKernels::mix( pIn_L, fFXCost, pOut_L + nBufferPos, nFrames );
+			BlockKernels::mix( pIn_R, fFXCost, pOut_R + nBufferPos, nFrames );
 		}
 	}
 #endif
-
-	return retValue;
 }
 
 
@@ -1440,20 +1819,23 @@ void Sampler::stopPlayingNotes( std::shared_ptr<Instrument> pInstr )
 			Note *pNote = m_playingNotesQueue[ i ];
 			assert( pNote );
 			if ( pNote->get_instrument() == pInstr ) {
-				delete pNote;
+				releaseNote( pNote );
 				pInstr->dequeue();
-				m_playingNotesQueue.erase( m_playingNotesQueue.begin() + i );
+				removePlayingNote( i );
+			} else {
+				++i;
 			}
-			++i;
 		}
 	} else { // stop all notes
 		// delete all copied notes in the playing notes queue
 		for ( unsigned i = 0; i < m_playingNotesQueue.size(); ++i ) {
 			Note *pNote = m_playingNotesQueue[i];
 			pNote->get_instrument()->dequeue();
-			delete pNote;
+			releaseNote( pNote );
 		}
 		m_playingNotesQueue.clear();
+		m_playingNotesInfo.clear();
+		m_nStolenNotes = 0;
 	}
 }
 
@@ -1469,7 +1851,10 @@ void Sampler::preview_sample(std::shared_ptr<Sample> pSample, int length )
 
 		pLayer->set_sample( pSample );
 
-		Note *pPreviewNote = new Note( m_pPreviewInstrument, 0, 1.0, 0.f, length, 0 );
+		Note *pPreviewNote = m_pNotePool->acquire( m_pPreviewInstrument, 0, 1.0, 0.f, length, 0 );
+		if ( pPreviewNote == nullptr ) {
+			pPreviewNote = new Note( m_pPreviewInstrument, 0, 1.0, 0.f, length, 0 );
+		}
 
 		stopPlayingNotes( m_pPreviewInstrument );
 		noteOn( pPreviewNote );
@@ -1492,7 +1877,10 @@ void Sampler::preview_instrument( std::shared_ptr<Instrument> pInstr )
 	m_pPreviewInstrument = pInstr;
 	pInstr->set_is_preview_instrument(true);
 
-	Note *pPreviewNote = new Note( m_pPreviewInstrument, 0, 1.0, 0.f, MAX_NOTES, 0 );
+	Note *pPreviewNote = m_pNotePool->acquire( m_pPreviewInstrument, 0, 1.0, 0.f, MAX_NOTES, 0 );
+	if ( pPreviewNote == nullptr ) {
+		pPreviewNote = new Note( m_pPreviewInstrument, 0, 1.0, 0.f, MAX_NOTES, 0 );
+	}
 
 	noteOn( pPreviewNote );	// exclusive note
 	Hydrogen::get_instance()->getAudioEngine()->unlock();
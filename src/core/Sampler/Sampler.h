@@ -24,9 +24,11 @@
 #ifndef SAMPLER_H
 #define SAMPLER_H
 
+#include <core/config.h>
 #include <core/Object.h>
 #include <core/Globals.h>
 #include <core/Sampler/Interpolation.h>
+#include <core/Sampler/VoiceRenderPool.h>
 
 #include <inttypes.h>
 #include <vector>
@@ -43,6 +45,9 @@ class Instrument;
 struct SelectedLayerInfo;
 class InstrumentComponent;
 class AudioOutput;
+class BusBuffers;
+class NotePool;
+class SampleStreamer;
 
 ///
 /// Waveform based sampler.
@@ -161,6 +166,28 @@ public:
 	static float getRatioPan( float fPan_L, float fPan_R );
 	
 
+	/**
+	 * Decides which of the playing notes is stopped once more than
+	 * Preferences::m_nMaxNotes notes are playing. Stolen notes are
+	 * faded out within ADSR::FAST_RELEASE frames to avoid clicks.
+	 *
+	 * Set using Preferences::m_nVoiceStealing.
+	 */
+	enum class VoiceStealing {
+		/** The note started first.*/
+		Oldest = 0,
+		/** The note with the lowest product of current envelope
+			value and velocity.*/
+		Quietest = 1,
+		/** The oldest note of the instrument of the incoming
+			note. Falls back to #Oldest in case the instrument does
+			not play any note.*/
+		SameInstrument = 2,
+		/** The oldest note of the instrument with the lowest
+			Instrument::getVoicePriority().*/
+		LowestPriority = 3
+	};
+
 	float* m_pMainOut_L;	///< sampler main out (left channel)
 	float* m_pMainOut_R;	///< sampler main out (right channel)
 
@@ -169,8 +196,11 @@ public:
 	 *
 	 * It is called by AudioEngine::AudioEngine() and stored in
 	 * AudioEngine::m_pSampler.
+	 *
+	 * \param pNotePool Pool all notes are returned to once they are
+	 * done playing. Owned by the AudioEngine.
 	 */
-	Sampler();
+	Sampler( NotePool* pNotePool );
 	~Sampler();
 
 	void process( uint32_t nFrames, std::shared_ptr<Song> pSong );
@@ -187,6 +217,17 @@ public:
 	int getPlayingNotesNumber() {
 		return m_playingNotesQueue.size();
 	}
+	/**
+	 * The NotePool and the note queues of the AudioEngine are sized
+	 * according to Preferences::m_nMaxNotes on startup. Larger
+	 * values set afterwards only take effect after a restart.
+	 *
+	 * \return Preferences::m_nMaxNotes clamped to
+	 * #m_nMaxNotesLimit.
+	 */
+	int getMaxNotes() const;
+	/** \return #m_nMaxNotesLimit */
+	int getMaxNotesLimit() const;
 
 	void preview_sample( std::shared_ptr<Sample> pSample, int length );
 	void preview_instrument( std::shared_ptr<Instrument> pInstr );
@@ -217,10 +258,166 @@ public:
 	 * loaded with a nullptr instead.
 	 */
 	void reinitializePlaybackTrack();
+
+	/**
+	 * Sets the number of threads rendering the playing notes.
+	 *
+	 * For values larger than one a VoiceRenderPool is created and
+	 * the notes are distributed among its workers by instrument. For
+	 * all other values they are rendered by the audio thread alone.
+	 * The AudioEngine has to be locked when calling this function.
+	 *
+	 * \param nThreads Number of threads including the audio
+	 *   thread. Initialized using Preferences::m_nRenderThreads.
+	 */
+	void setRenderThreads( int nThreads );
+	int getRenderThreads() const;
+
+	/** Reads the parts of streamed samples not held in memory. It
+		is started on creation of the Sampler if
+		Preferences::m_bStreamSamples is set.*/
+	SampleStreamer* getSampleStreamer() const {
+		return m_pSampleStreamer;
+	}
 	
 private:
+	/** Block of a single component of a note. It is created by
+		prepareNote() and rendered by renderVoice().*/
+	struct Voice {
+		Note* pNote;
+		std::shared_ptr<Sample> pSample;
+		SelectedLayerInfo* pSelectedLayer;
+		std::shared_ptr<InstrumentComponent> pCompo;
+		DrumkitComponent* pDrumCompo;
+		int nInitialSilence;
+		float fCost_L;
+		float fCost_R;
+		float fCost_track_L;
+		float fCost_track_R;
+		float fLayerPitch;
+		bool bResample;
+		/** Whether the voice finished playing. Set after rendering.*/
+		bool bEnded;
+	};
+
+	/** Book keeping of a note rendered in parallel.*/
+	struct PreparedNote {
+		/** Index of its first voice in #m_voices.*/
+		int nFirstVoice;
+		int nVoices;
+		/** Whether the note is done for all components without a
+			voice.*/
+		bool bEnded;
+	};
+
+	/**
+	 * Private outputs of a single worker of #m_pRenderPool.
+	 *
+	 * The buffers of all workers are summed up by the audio thread in
+	 * the order of the workers once rendering is done. Component and
+	 * effect buffers are only cleared and summed up if used.
+	 */
+	struct RenderBuffers {
+		RenderBuffers( int nMaxVoices );
+		~RenderBuffers();
+
+		/** Clears the main out and marks all other buffers
+			unused.*/
+		void reset( int nFrames );
+		/** \return Slot of @a pComponent in #pComponent_L and
+			#pComponent_R or -1 if there is no free slot left.*/
+		int getComponentSlot( DrumkitComponent* pComponent );
+		/** Clears the buffers of effect @a nFX on first use.*/
+		void useFX( int nFX );
+
+		int nFrames;
+		float* pVoice_L;
+		float* pVoice_R;
+		float* pMain_L;
+		float* pMain_R;
+		int nComponents;
+		DrumkitComponent* pComponents[ MAX_COMPONENTS ];
+		/** Storage of #pComponent_L and #pComponent_R.*/
+		BusBuffers* pComponentBusses;
+		float* pComponent_L[ MAX_COMPONENTS ];
+		float* pComponent_R[ MAX_COMPONENTS ];
+		bool bFXUsed[ MAX_FX ];
+		float* pFX_L[ MAX_FX ];
+		float* pFX_R[ MAX_FX ];
+		/** Frames of streamed and compact samples passed to the
+			renderers.*/
+		float* pStream_L;
+		float* pStream_R;
+		/** Indices of the voices in #m_voices to be rendered.*/
+		std::vector<int> voices;
+	};
+
+
+	/** Book keeping of the note at the same index in
+		#m_playingNotesQueue. Kept separately so that finding a note
+		to steal does not have to touch all notes.*/
+	struct PlayingNote {
+		/** Value of #m_nNotesStarted when the note was started.*/
+		uint64_t nStarted;
+		/** Whether the note was stolen and is fading out.*/
+		bool bStolen;
+	};
+
+	/** Adds @a pNote to #m_playingNotesQueue.*/
+	void addPlayingNote( Note* pNote );
+	/** Removes the note at @a nIndex of #m_playingNotesQueue in
+		constant time by moving the last note in its place. The
+		order of the notes is thus not preserved.*/
+	void removePlayingNote( int nIndex );
+	/**
+	 * Steals notes till no more than @a nMaxNotes are playing. Notes
+	 * already fading out are not counted.
+	 *
+	 * \param nMaxNotes Number of notes allowed to keep playing.
+	 * \param pIncoming Instrument of the note about to be started
+	 *   or nullptr.
+	 */
+	void stealNotes( int nMaxNotes, const Instrument* pIncoming );
+	/** \return Index of the note in #m_playingNotesQueue to be
+		stolen according to @a policy or -1 if there is none.*/
+	int findNoteToSteal( VoiceStealing policy, const Instrument* pIncoming ) const;
+
+	/** Notes currently played. Their order is not
+		preserved. Use #m_playingNotesInfo to determine their age.*/
 	std::vector<Note*> m_playingNotesQueue;
+	std::vector<PlayingNote> m_playingNotesInfo;
+	/** Number of notes started since the creation of the
+		Sampler.*/
+	uint64_t m_nNotesStarted;
+	/** Value of #m_nNotesStarted at the end of the last call to
+		process(). Notes started afterwards were not rendered
+		yet.*/
+	uint64_t m_nNotesRendered;
+	/** Number of notes in #m_playingNotesQueue fading out after
+		being stolen.*/
+	int m_nStolenNotes;
 	std::vector<Note*> m_queuedNoteOffs;
+
+	/** Pool finished notes are handed back to instead of deleting
+		them within the audio thread.*/
+	NotePool* m_pNotePool;
+	/** Value of Preferences::m_nMaxNotes the #m_pNotePool was
+		sized with.*/
+	int m_nMaxNotesLimit;
+
+	/** Scratch buffers holding the block of the voice currently
+		rendered before it is distributed to the outputs.*/
+	float* m_pVoiceBuffer_L;
+	float* m_pVoiceBuffer_R;
+	/** Scratch buffers holding the frames of a streamed or compact
+		sample rendered by the audio thread.*/
+	float* m_pStreamBuffer_L;
+	float* m_pStreamBuffer_R;
+	/** Output busses of the drumkit components. Bus n is assigned
+		to the n-th component of the current song in process().*/
+	BusBuffers* m_pComponentBusses;
+
+	SampleStreamer* m_pSampleStreamer;
 	
 	/// Instrument used for the playback track feature.
 	std::shared_ptr<Instrument> m_pPlaybackTrackInstrument;
@@ -246,8 +443,46 @@ private:
 	bool processPlaybackTrack(int nBufferSize);
 	
 	bool isAnyInstrumentSoloed() const;
+
+	/** Releases the streams of all layers of @a pNote and hands it
+		back to #m_pNotePool.*/
+	void releaseNote( Note* pNote );
 	
+	/** Prepares and renders all voices of @a pNote in the audio
+		thread.
+
+		\return whether the note is done playing.*/
 	bool renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Song> pSong );
+	/**
+	 * Selects the layers of all components of @a pNote and appends
+	 * the ones to be rendered in the current cycle to #m_voices.
+	 *
+	 * All work which is either not thread-safe or not specific to a
+	 * single note - like the layer selection, sending MIDI, and
+	 * logging - is done in here and thus in the audio thread.
+	 *
+	 * \return whether the note is done playing for all components
+	 * not appended.
+	 */
+	bool prepareNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Song> pSong );
+	/**
+	 * Renders @a voice into @a pBuffers or - if nullptr - directly
+	 * into the outputs of the Sampler, the drumkit components, and
+	 * the effects.
+	 *
+	 * \return whether the voice is done playing.
+	 */
+	bool renderVoice( const Voice& voice, unsigned nBufferSize, std::shared_ptr<Song> pSong, RenderBuffers* pBuffers );
+	/** Distributes the playing notes by instrument among the
+		workers of #m_pRenderPool, renders them, and sums up the
+		results.*/
+	void renderNotesInParallel( uint32_t nFrames, std::shared_ptr<Song> pSong );
+	/** Renders all voices assigned to worker @a nWorker. Called by
+		#m_pRenderPool.*/
+	void renderWorker( int nWorker );
+	/** \return the worker rendering all notes of @a pInstrument
+		in the current cycle.*/
+	int getWorkerForInstrument( Instrument* pInstrument );
 
 	Interpolation::InterpolateMode m_interpolateMode;
 
@@ -263,7 +498,8 @@ private:
 		float cost_R,
 		float cost_track_L,
 		float cost_track_R,
-		std::shared_ptr<Song> pSong
+		std::shared_ptr<Song> pSong,
+		RenderBuffers* pBuffers
 	);
 
 	bool renderNoteResample(
@@ -279,10 +515,73 @@ private:
 		float cost_track_L,
 		float cost_track_R,
 		float fLayerPitch,
-		std::shared_ptr<Song> pSong
+		std::shared_ptr<Song> pSong,
+		RenderBuffers* pBuffers
 	);
+
+	/**
+	 * Distributes a rendered block of a single voice.
+	 *
+	 * Takes @a nFrames frames of #m_pVoiceBuffer_L and
+	 * #m_pVoiceBuffer_R starting at @a nBufferPos and adds them to
+	 * the JACK track outputs, the drumkit component and the main
+	 * output. Feeds the Meter of the instrument. The voice buffers
+	 * are scaled in place.
+	 *
+	 * If @a pBuffers is not nullptr, its voice buffers are used
+	 * instead and the drumkit component and main output are replaced
+	 * by its private ones.
+	 */
+	void mixVoice( Note* pNote,
+				   std::shared_ptr<InstrumentComponent> pCompo,
+				   DrumkitComponent* pDrumCompo,
+				   int nBufferPos,
+				   int nFrames,
+				   float cost_L,
+				   float cost_R,
+				   float cost_track_L,
+				   float cost_track_R,
+				   RenderBuffers* pBuffers );
+
+	/**
+	 * Adds @a nFrames frames of @a pIn_L and @a pIn_R to the
+	 * buffers of all LADSPA effects the instrument of @a pNote is
+	 * sending to, starting at @a nBufferPos. If @a pBuffers is not
+	 * nullptr, its private effect buffers are used instead.
+	 */
+	void mixFXSends( Note* pNote,
+					 std::shared_ptr<Song> pSong,
+					 const float* pIn_L,
+					 const float* pIn_R,
+					 int nBufferPos,
+					 int nFrames,
+					 RenderBuffers* pBuffers );
+
+	/** Optional workers rendering the playing notes in parallel.
+		nullptr if all notes are rendered by the audio thread.*/
+	VoiceRenderPool* m_pRenderPool;
+	/** Private outputs of the workers of #m_pRenderPool.*/
+	std::vector<RenderBuffers*> m_renderBuffers;
+	/** Voices of all notes rendered in the current cycle.*/
+	std::vector<Voice> m_voices;
+	/** One entry for each element in #m_playingNotesQueue. Only
+		used when rendering in parallel.*/
+	std::vector<PreparedNote> m_preparedNotes;
+	/** Workers assigned to the instruments in the current cycle.*/
+	std::vector<std::pair<Instrument*, int>> m_instrumentWorkers;
+	/** Arguments of the current cycle passed to the workers.*/
+	uint32_t m_nRenderFrames;
+	std::shared_ptr<Song> m_pRenderSong;
 };
 
+inline int Sampler::getMaxNotesLimit() const {
+	return m_nMaxNotesLimit;
+}
+
+inline int Sampler::getRenderThreads() const {
+	return m_pRenderPool != nullptr ? m_pRenderPool->getWorkerCount() : 1;
+}
+
 
 } // namespace
 
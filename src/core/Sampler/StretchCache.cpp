@@ -0,0 +1,382 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/StretchCache.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/Hydrogen.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace H2Core
+{
+
+StretchCache::StretchCache( AudioEngine* pAudioEngine )
+	: m_pAudioEngine( pAudioEngine )
+	, m_fBpm( 0 )
+	, m_nGeneration( 0 )
+	, m_nUseCounter( 0 )
+	, m_bResampleRequired( false )
+	, m_bQuit( false )
+{
+	// Leave one core to the audio and GUI threads.
+	const int nThreads = std::max( 1, std::min( MAX_THREADS,
+												static_cast<int>( std::thread::hardware_concurrency() ) - 1 ) );
+	m_working.resize( nThreads, -1 );
+	for ( int nThread = 0; nThread < nThreads; ++nThread ) {
+		m_threads.push_back( std::thread( &StretchCache::run, this, nThread ) );
+	}
+}
+
+StretchCache::~StretchCache()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bQuit = true;
+		m_jobs.clear();
+	}
+	m_condition.notify_all();
+	m_doneCondition.notify_all();
+	for ( auto& thread : m_threads ) {
+		thread.join();
+	}
+}
+
+int StretchCache::getTempoKey( float fBpm )
+{
+	return static_cast<int>( std::lround( fBpm * 1000 ) );
+}
+
+std::vector<int> StretchCache::getDistances( InstrumentList* pInstrumentList,
+											 const std::vector<PatternList*>& columns,
+											 int nColumn, bool bLoop )
+{
+	std::vector<int> distances;
+	if ( pInstrumentList == nullptr ) {
+		return distances;
+	}
+	distances.resize( pInstrumentList->size(), UNUSED );
+
+	std::map<Instrument*, int> indices;
+	for ( int nInstr = 0; nInstr < pInstrumentList->size(); ++nInstr ) {
+		indices[ pInstrumentList->get( nInstr ).get() ] = nInstr;
+	}
+
+	const int nColumns = columns.size();
+	if ( nColumn < 0 || nColumn >= nColumns ) {
+		nColumn = 0;
+	}
+
+	for ( int nn = 0; nn < nColumns; ++nn ) {
+		int nDistance = nn - nColumn;
+		if ( nDistance < 0 ) {
+			if ( ! bLoop ) {
+				continue;
+			}
+			nDistance += nColumns;
+		}
+
+		PatternList* pColumn = columns[ nn ];
+		if ( pColumn == nullptr ) {
+			continue;
+		}
+		for ( int nPattern = 0; nPattern < pColumn->size(); ++nPattern ) {
+			Pattern* pPattern = pColumn->get( nPattern );
+			std::vector<Pattern*> patterns( pPattern->get_flattened_virtual_patterns()->begin(),
+											pPattern->get_flattened_virtual_patterns()->end() );
+			patterns.push_back( pPattern );
+
+			for ( const auto& ppPattern : patterns ) {
+				for ( const auto& [ nPosition, pNote ] : *ppPattern->get_notes() ) {
+					auto it = indices.find( pNote->get_instrument().get() );
+					if ( it != indices.end() ) {
+						distances[ it->second ] = std::min( distances[ it->second ], nDistance );
+					}
+				}
+			}
+		}
+	}
+
+	return distances;
+}
+
+void StretchCache::update( std::shared_ptr<Song> pSong, float fBpm, int nColumn,
+						   PatternList* pPlayingPatterns )
+{
+	const int nTempoKey = getTempoKey( fBpm );
+	std::vector<Job> jobs;
+	std::vector<std::shared_ptr<InstrumentLayer>> layers;
+
+	if ( pSong != nullptr && fBpm > 0 ) {
+		InstrumentList* pInstrumentList = pSong->getInstrumentList();
+		std::vector<int> distances;
+		if ( nColumn >= 0 && pSong->getPatternGroupVector() != nullptr ) {
+			distances = getDistances( pInstrumentList, *pSong->getPatternGroupVector(),
+									  nColumn, pSong->getIsLoopEnabled() );
+		} else {
+			std::vector<PatternList*> columns;
+			if ( pPlayingPatterns != nullptr ) {
+				columns.push_back( pPlayingPatterns );
+			}
+			distances = getDistances( pInstrumentList, columns, 0, false );
+		}
+
+		for ( int nInstr = 0; nInstr < pInstrumentList->size(); ++nInstr ) {
+			auto pInstr = pInstrumentList->get( nInstr );
+			if ( pInstr == nullptr ) {
+				continue;
+			}
+			for ( const auto& pComponent : *pInstr->get_components() ) {
+				for ( int nLayer = 0; nLayer < InstrumentComponent::getMaxLayers(); ++nLayer ) {
+					auto pLayer = pComponent->get_layer( nLayer );
+					if ( pLayer == nullptr || pLayer->get_sample() == nullptr ||
+						 ! pLayer->get_sample()->get_rubberband().use ||
+						 pLayer->get_sample()->is_streamed() ) {
+						continue;
+					}
+					layers.push_back( pLayer );
+					jobs.push_back( { pLayer, pLayer->get_sample(), distances[ nInstr ] } );
+				}
+			}
+		}
+	}
+
+	// Most urgent job last. Within the same distance the order of
+	// the instrument list is kept.
+	std::reverse( jobs.begin(), jobs.end() );
+	std::stable_sort( jobs.begin(), jobs.end(), []( const Job& a, const Job& b ) {
+		return a.nDistance > b.nDistance;
+	} );
+
+	// Entries are released outside of the lock.
+	std::map<std::shared_ptr<InstrumentLayer>, Entry> entries;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		for ( const auto& pLayer : layers ) {
+			auto it = m_entries.find( pLayer );
+			if ( it != m_entries.end() ) {
+				entries.insert( *it );
+			}
+		}
+		std::swap( m_entries, entries );
+
+		jobs.erase( std::remove_if( jobs.begin(), jobs.end(), [&]( const Job& job ) {
+			auto it = m_entries.find( job.pLayer );
+			return it != m_entries.end() &&
+				it->second.pAssigned == job.pSample &&
+				it->second.nAssignedTempoKey == nTempoKey;
+		} ), jobs.end() );
+
+		m_jobs = std::move( jobs );
+		m_fBpm = fBpm;
+		++m_nGeneration;
+		// Jobs of previous generations do not count anymore.
+		std::fill( m_working.begin(), m_working.end(), -1 );
+	}
+	m_condition.notify_all();
+	m_doneCondition.notify_all();
+}
+
+void StretchCache::wait( int nMaxDistance )
+{
+	std::unique_lock<std::mutex> lock( m_mutex );
+	m_doneCondition.wait( lock, [&]() {
+		if ( m_bQuit ) {
+			return true;
+		}
+		if ( ! m_jobs.empty() && m_jobs.back().nDistance <= nMaxDistance ) {
+			return false;
+		}
+		for ( int nDistance : m_working ) {
+			if ( nDistance >= 0 && nDistance <= nMaxDistance ) {
+				return false;
+			}
+		}
+		return true;
+	} );
+}
+
+bool StretchCache::isBusy()
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if ( ! m_jobs.empty() ) {
+		return true;
+	}
+	for ( int nDistance : m_working ) {
+		if ( nDistance >= 0 ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void StretchCache::clear()
+{
+	std::map<std::shared_ptr<InstrumentLayer>, Entry> entries;
+	std::vector<Job> jobs;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		std::swap( m_entries, entries );
+		std::swap( m_jobs, jobs );
+		++m_nGeneration;
+		std::fill( m_working.begin(), m_working.end(), -1 );
+		m_bResampleRequired = false;
+	}
+	m_doneCondition.notify_all();
+}
+
+std::shared_ptr<Sample> StretchCache::findVariant( Entry& entry, int nTempoKey )
+{
+	for ( auto& variant : entry.variants ) {
+		if ( variant.nTempoKey == nTempoKey ) {
+			variant.nLastUse = ++m_nUseCounter;
+			return variant.pSample;
+		}
+	}
+	return nullptr;
+}
+
+void StretchCache::addVariant( Entry& entry, int nTempoKey, std::shared_ptr<Sample> pSample )
+{
+	if ( findVariant( entry, nTempoKey ) != nullptr ) {
+		return;
+	}
+	entry.variants.push_back( { nTempoKey, pSample, ++m_nUseCounter } );
+	if ( entry.variants.size() > MAX_VARIANTS ) {
+		entry.variants.erase( std::min_element( entry.variants.begin(), entry.variants.end(),
+												[]( const Variant& a, const Variant& b ) {
+													return a.nLastUse < b.nLastUse;
+												} ) );
+	}
+}
+
+void StretchCache::run( int nThread )
+{
+	std::unique_lock<std::mutex> lock( m_mutex );
+	while ( true ) {
+		m_condition.wait( lock, [&]() { return m_bQuit || ! m_jobs.empty(); } );
+		if ( m_bQuit ) {
+			return;
+		}
+
+		Job job = m_jobs.back();
+		m_jobs.pop_back();
+		const float fBpm = m_fBpm;
+		const int nTempoKey = getTempoKey( fBpm );
+		const unsigned nGeneration = m_nGeneration;
+		m_working[ nThread ] = job.nDistance;
+
+		std::shared_ptr<Sample> pSource;
+		std::shared_ptr<Sample> pVariant;
+		auto it = m_entries.find( job.pLayer );
+		if ( it != m_entries.end() && it->second.pAssigned == job.pSample ) {
+			pSource = it->second.pSource;
+			pVariant = findVariant( it->second, nTempoKey );
+		}
+		lock.unlock();
+
+		if ( pSource == nullptr ) {
+			// The sample of the layer was loaded along with the song
+			// or replaced by the user. Its unstretched version has
+			// to be loaded first.
+			pSource = Sample::load( job.pSample->get_filepath(),
+									job.pSample->get_loops(),
+									Sample::Rubberband(),
+									*job.pSample->get_velocity_envelope(),
+									*job.pSample->get_pan_envelope() );
+		}
+		if ( pVariant == nullptr && pSource != nullptr ) {
+			pVariant = Sample::stretch( pSource, job.pSample->get_rubberband(), fBpm );
+			if ( pVariant == nullptr ) {
+				ERRORLOG( QString( "Unable to stretch [%1] to %2 bpm" )
+						  .arg( job.pSample->get_filepath() ).arg( fBpm ) );
+			}
+		}
+
+		if ( pVariant != nullptr ) {
+			m_pAudioEngine->lock( RIGHT_HERE );
+			{
+				std::lock_guard<std::mutex> guard( m_mutex );
+				auto it = m_entries.find( job.pLayer );
+				// Neither the sample nor the tempo must have changed
+				// in the meantime.
+				if ( nGeneration == m_nGeneration &&
+					 job.pLayer->get_sample() == job.pSample ) {
+					job.pLayer->set_sample( pVariant );
+
+					if ( it == m_entries.end() ) {
+						it = m_entries.insert( std::make_pair( job.pLayer, Entry() ) ).first;
+					}
+					Entry& entry = it->second;
+					if ( entry.pAssigned != job.pSample ) {
+						entry = Entry();
+					}
+					entry.pSource = pSource;
+					entry.pAssigned = pVariant;
+					entry.nAssignedTempoKey = nTempoKey;
+					addVariant( entry, nTempoKey, pVariant );
+					m_bResampleRequired = true;
+				} else if ( it != m_entries.end() && it->second.pSource == pSource ) {
+					// Outdated but still useful once the song
+					// returns to this tempo.
+					addVariant( it->second, nTempoKey, pVariant );
+				}
+			}
+			m_pAudioEngine->unlock();
+		}
+
+		// Release the references - possibly the last ones to the
+		// previous variant - outside of the lock of the AudioEngine.
+		job = Job();
+		pSource = nullptr;
+		pVariant = nullptr;
+
+		lock.lock();
+		if ( nGeneration == m_nGeneration ) {
+			m_working[ nThread ] = -1;
+		}
+		m_doneCondition.notify_all();
+
+		if ( m_bResampleRequired && m_jobs.empty() &&
+			 std::count( m_working.begin(), m_working.end(), -1 ) ==
+			 static_cast<long>( m_working.size() ) ) {
+			// The new samples have the sample rate of their files and
+			// are converted to the one of the audio driver once all
+			// of them are assigned.
+			m_bResampleRequired = false;
+			lock.unlock();
+			Hydrogen::get_instance()->updateResampleCache();
+			lock.lock();
+		}
+	}
+}
+
+};
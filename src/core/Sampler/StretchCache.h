@@ -0,0 +1,208 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef H2C_STRETCH_CACHE_H
+#define H2C_STRETCH_CACHE_H
+
+#include <core/Object.h>
+#include <core/Basics/Sample.h>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace H2Core
+{
+
+class AudioEngine;
+class InstrumentLayer;
+class InstrumentList;
+class PatternList;
+class Song;
+
+/**
+ * Stretches the samples of all layers with Rubber Band enabled to
+ * the current tempo in background threads.
+ *
+ * For each layer the unstretched source sample is kept along with up
+ * to #MAX_VARIANTS stretched variants keyed by the tempo they were
+ * computed for. Going back to a tempo already encountered - like in
+ * a ramp played repeatedly or in a song alternating between a few
+ * tempi - does not require Rubber Band at all. Variants are
+ * additionally stored in the SampleCache and survive a restart.
+ *
+ * Missing variants are computed by up to #MAX_THREADS worker
+ * threads. Layers of instruments used in the upcoming columns of the
+ * song are processed first. Whenever a variant is ready it is
+ * assigned to its layer while holding the lock of the AudioEngine.
+ * Until then the layer keeps playing its previous variant. Neither
+ * the GUI nor the audio thread waits for Rubber Band.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class StretchCache : public H2Core::Object<StretchCache>
+{
+	H2_OBJECT(StretchCache)
+public:
+	/** Maximum number of stretched variants kept per layer. The
+		least recently used one is dropped first.*/
+	static constexpr int MAX_VARIANTS = 16;
+	/** Maximum number of worker threads.*/
+	static constexpr int MAX_THREADS = 4;
+	/** Distance of instruments not used in the song at all.*/
+	static constexpr int UNUSED = 1 << 20;
+
+	/** \param pAudioEngine Engine locked while assigning stretched
+		samples.*/
+	StretchCache( AudioEngine* pAudioEngine );
+	/** Stops the worker threads. Pending jobs are discarded.*/
+	~StretchCache();
+
+	/**
+	 * Discards all pending jobs and schedules stretching all layers
+	 * of @a pSong using Rubber Band to @a fBpm.
+	 *
+	 * Layers already holding a variant for @a fBpm are skipped.
+	 * Entries of layers not part of @a pSong anymore are dropped.
+	 *
+	 * Has to be called while holding the lock of the AudioEngine
+	 * since @a pPlayingPatterns is altered by the audio thread.
+	 *
+	 * \param pSong Current song.
+	 * \param fBpm New tempo.
+	 * \param nColumn Column currently played. In pattern mode -1
+	 *   and the playing patterns are considered instead.
+	 * \param pPlayingPatterns Patterns played in pattern mode.
+	 */
+	void update( std::shared_ptr<Song> pSong, float fBpm, int nColumn,
+				 PatternList* pPlayingPatterns );
+
+	/**
+	 * Blocks until all layers of instruments used within the next
+	 * @a nMaxDistance columns got their variant for the tempo passed
+	 * to the last call of update().
+	 *
+	 * Used by the DiskWriterDriver, which can not render a column
+	 * before its samples are stretched.
+	 */
+	void wait( int nMaxDistance );
+
+	/** \return Whether there are jobs not processed yet.*/
+	bool isBusy();
+
+	/** Discards all pending jobs and drops all cached
+		variants. Variants already assigned to their layers are kept
+		by them.*/
+	void clear();
+
+	/**
+	 * Computes for each instrument in @a pInstrumentList the number
+	 * of columns till it is used next.
+	 *
+	 * \param pInstrumentList Instruments of the song.
+	 * \param columns Pattern groups of the song.
+	 * \param nColumn Current column. 0 for an instrument used in
+	 *   this very column.
+	 * \param bLoop Whether columns prior to @a nColumn will be
+	 *   played again after the end of the song.
+	 *
+	 * \return Distances in the order of @a pInstrumentList. Unused
+	 * instruments are assigned #UNUSED.
+	 */
+	static std::vector<int> getDistances( InstrumentList* pInstrumentList,
+										  const std::vector<PatternList*>& columns,
+										  int nColumn, bool bLoop );
+
+	/** \return Key of the variants stretched to @a fBpm. Tempi
+		differing by less than a thousandth of a beat per minute
+		share their variants.*/
+	static int getTempoKey( float fBpm );
+
+private:
+	struct Variant {
+		int nTempoKey;
+		std::shared_ptr<Sample> pSample;
+		/** Value of #m_nUseCounter when the variant was used
+			last.*/
+		unsigned long long nLastUse;
+	};
+	struct Entry {
+		/** Layer's sample with loops and envelopes applied but not
+			stretched.*/
+		std::shared_ptr<Sample> pSource;
+		/** Sample last assigned to the layer by the cache. If the
+			sample of the layer differs, it was replaced by the user
+			and the entry is outdated.*/
+		std::shared_ptr<Sample> pAssigned;
+		int nAssignedTempoKey = -1;
+		std::vector<Variant> variants;
+	};
+	struct Job {
+		std::shared_ptr<InstrumentLayer> pLayer;
+		/** Sample of #pLayer at the time the job was created.*/
+		std::shared_ptr<Sample> pSample;
+		int nDistance;
+	};
+
+	void run( int nThread );
+	/** \return Variant of @a entry for @a nTempoKey or nullptr. Has
+		to be called while holding #m_mutex.*/
+	std::shared_ptr<Sample> findVariant( Entry& entry, int nTempoKey );
+	/** Adds @a pSample to @a entry and drops the least recently used
+		variant if there are too many. Has to be called while holding
+		#m_mutex.*/
+	void addVariant( Entry& entry, int nTempoKey, std::shared_ptr<Sample> pSample );
+
+	AudioEngine* m_pAudioEngine;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	/** Notifies the workers about new jobs.*/
+	std::condition_variable m_condition;
+	/** Notifies wait() about finished jobs.*/
+	std::condition_variable m_doneCondition;
+	/** Cached samples of all layers. Guarded by #m_mutex.*/
+	std::map<std::shared_ptr<InstrumentLayer>, Entry> m_entries;
+	/** Jobs still to do, the most urgent one last. Guarded by
+		#m_mutex.*/
+	std::vector<Job> m_jobs;
+	/** Distance of the job each worker is processing right now or
+		-1. Guarded by #m_mutex.*/
+	std::vector<int> m_working;
+	/** Tempo of #m_jobs. Guarded by #m_mutex.*/
+	float m_fBpm;
+	/** Incremented by every call to update(). Guarded by
+		#m_mutex.*/
+	unsigned m_nGeneration;
+	/** Guarded by #m_mutex.*/
+	unsigned long long m_nUseCounter;
+	/** Whether variants were assigned since the last update of the
+		ResampleCache. Guarded by #m_mutex.*/
+	bool m_bResampleRequired;
+	/** Guarded by #m_mutex.*/
+	bool m_bQuit;
+};
+
+};
+
+#endif // H2C_STRETCH_CACHE_H
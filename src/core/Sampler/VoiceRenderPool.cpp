@@ -0,0 +1,213 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/VoiceRenderPool.h>
+
+#include <algorithm>
+#include <climits>
+
+#ifdef WIN32
+#include <windows.h>
+#elif defined( Q_OS_MACX )
+#include <dispatch/dispatch.h>
+#include <sched.h>
+#else
+#include <errno.h>
+#include <sched.h>
+#include <semaphore.h>
+#endif
+
+namespace H2Core {
+
+class VoiceRenderPool::Semaphore {
+public:
+	Semaphore() {
+#ifdef WIN32
+		m_handle = CreateSemaphore( nullptr, 0, LONG_MAX, nullptr );
+#elif defined( Q_OS_MACX )
+		// Unnamed POSIX semaphores are not supported on macOS.
+		m_semaphore = dispatch_semaphore_create( 0 );
+#else
+		sem_init( &m_semaphore, 0, 0 );
+#endif
+	}
+	~Semaphore() {
+#ifdef WIN32
+		CloseHandle( m_handle );
+#elif defined( Q_OS_MACX )
+		dispatch_release( m_semaphore );
+#else
+		sem_destroy( &m_semaphore );
+#endif
+	}
+
+	void post() {
+#ifdef WIN32
+		ReleaseSemaphore( m_handle, 1, nullptr );
+#elif defined( Q_OS_MACX )
+		dispatch_semaphore_signal( m_semaphore );
+#else
+		sem_post( &m_semaphore );
+#endif
+	}
+
+	void wait() {
+#ifdef WIN32
+		WaitForSingleObject( m_handle, INFINITE );
+#elif defined( Q_OS_MACX )
+		dispatch_semaphore_wait( m_semaphore, DISPATCH_TIME_FOREVER );
+#else
+		while ( sem_wait( &m_semaphore ) != 0 && errno == EINTR ) {
+		}
+#endif
+	}
+
+private:
+#ifdef WIN32
+	HANDLE m_handle;
+#elif defined( Q_OS_MACX )
+	dispatch_semaphore_t m_semaphore;
+#else
+	sem_t m_semaphore;
+#endif
+};
+
+VoiceRenderPool::VoiceRenderPool( int nWorkers, std::function<void(int)> render )
+	: m_nWorkers( std::max( nWorkers, 1 ) )
+	, m_render( render )
+	, m_pDoneSemaphore( new Semaphore() )
+	, m_bQuit( false )
+	, m_nPending( 0 )
+#ifndef WIN32
+	, m_bCallingThreadKnown( false )
+#endif
+	, m_nPolicy( 0 )
+	, m_nPriority( 0 )
+	, m_nSchedulingVersion( 0 )
+{
+	for ( int nWorker = 1; nWorker < m_nWorkers; ++nWorker ) {
+		m_wakeSemaphores.push_back( std::unique_ptr<Semaphore>( new Semaphore() ) );
+	}
+	for ( int nWorker = 1; nWorker < m_nWorkers; ++nWorker ) {
+		m_threads.push_back( std::thread( &VoiceRenderPool::work, this, nWorker ) );
+	}
+	INFOLOG( QString( "Rendering voices using %1 threads" ).arg( m_nWorkers ) );
+}
+
+VoiceRenderPool::~VoiceRenderPool()
+{
+	m_bQuit.store( true );
+	for ( auto& pSemaphore : m_wakeSemaphores ) {
+		pSemaphore->post();
+	}
+
+	for ( auto& thread : m_threads ) {
+		thread.join();
+	}
+}
+
+void VoiceRenderPool::run()
+{
+	if ( m_nWorkers > 1 ) {
+		updateScheduling();
+		m_nPending.store( m_nWorkers - 1, std::memory_order_relaxed );
+		// Posting a semaphore synchronizes memory. The workers thus
+		// see everything prepared by the calling thread.
+		for ( auto& pSemaphore : m_wakeSemaphores ) {
+			pSemaphore->post();
+		}
+	}
+
+	m_render( 0 );
+
+	if ( m_nWorkers > 1 ) {
+		// The last worker posts once all others decremented
+		// #m_nPending. Their buffers are visible afterwards.
+		m_pDoneSemaphore->wait();
+	}
+}
+
+void VoiceRenderPool::work( int nWorker )
+{
+	Semaphore* pWakeSemaphore = m_wakeSemaphores[ nWorker - 1 ].get();
+	int nSchedulingVersion = 0;
+	while ( true ) {
+		pWakeSemaphore->wait();
+		if ( m_bQuit.load() ) {
+			return;
+		}
+
+		m_render( nWorker );
+
+		if ( m_nPending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+			m_pDoneSemaphore->post();
+		}
+
+		// Done after the cycle in order to not delay the calling
+		// thread.
+		applyScheduling( nWorker, nSchedulingVersion );
+	}
+}
+
+void VoiceRenderPool::updateScheduling()
+{
+#ifndef WIN32
+	// Drivers might be restarted or exchanged. Checking the thread
+	// does not involve a system call.
+	const pthread_t thread = pthread_self();
+	if ( m_bCallingThreadKnown && pthread_equal( thread, m_callingThread ) ) {
+		return;
+	}
+	m_callingThread = thread;
+	m_bCallingThreadKnown = true;
+
+	int nPolicy;
+	struct sched_param sched;
+	if ( pthread_getschedparam( thread, &nPolicy, &sched ) != 0 ) {
+		return;
+	}
+	m_nPolicy.store( nPolicy, std::memory_order_relaxed );
+	m_nPriority.store( sched.sched_priority, std::memory_order_relaxed );
+	m_nSchedulingVersion.fetch_add( 1, std::memory_order_release );
+#endif
+}
+
+void VoiceRenderPool::applyScheduling( int nWorker, int& nVersion )
+{
+#ifndef WIN32
+	const int nCurrentVersion = m_nSchedulingVersion.load( std::memory_order_acquire );
+	if ( nCurrentVersion == nVersion ) {
+		return;
+	}
+	nVersion = nCurrentVersion;
+
+	struct sched_param sched;
+	sched.sched_priority = m_nPriority.load( std::memory_order_relaxed );
+	const int nPolicy = m_nPolicy.load( std::memory_order_relaxed );
+	if ( pthread_setschedparam( pthread_self(), nPolicy, &sched ) != 0 ) {
+		WARNINGLOG( QString( "Can't set scheduling policy %1 with priority %2 for render thread %3" )
+					.arg( nPolicy ).arg( sched.sched_priority ).arg( nWorker ) );
+	}
+#endif
+}
+
+};
@@ -0,0 +1,128 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef VOICE_RENDER_POOL_H
+#define VOICE_RENDER_POOL_H
+
+#include <core/Object.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+namespace H2Core
+{
+
+/**
+ * Set of worker threads the Sampler distributes the rendering of
+ * its voices to.
+ *
+ * A pool of @a nWorkers consists of the thread calling run() - the
+ * audio thread - and @a nWorkers - 1 additional threads started in
+ * the constructor. Each call of run() executes the render function
+ * once for every worker index in [0, @a nWorkers) and returns as
+ * soon as all of them are done. Index 0 is always processed by the
+ * calling thread itself.
+ *
+ * Each worker waits on a semaphore of its own, which run() posts
+ * once per cycle. Posting never blocks, so the audio thread neither
+ * locks a mutex nor waits for a worker to be scheduled in order to
+ * wake it. The last worker finishing a cycle posts another
+ * semaphore the calling thread waits on afterwards.
+ *
+ * The workers adopt the scheduling policy and priority of the
+ * thread calling run(), which is the one of the audio driver.
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class VoiceRenderPool : public H2Core::Object<VoiceRenderPool>
+{
+	H2_OBJECT(VoiceRenderPool)
+public:
+	/**
+	 * \param nWorkers Number of threads rendering in parallel,
+	 *   including the one calling run().
+	 * \param render Function called with the index of the worker.
+	 */
+	VoiceRenderPool( int nWorkers, std::function<void(int)> render );
+	/** Stops and joins all additional threads.*/
+	~VoiceRenderPool();
+
+	/** Runs the render function for all workers and waits for them
+		to finish.*/
+	void run();
+
+	int getWorkerCount() const;
+
+private:
+	/** Counting semaphore whose post() never blocks.*/
+	class Semaphore;
+
+	void work( int nWorker );
+	/** Stores the scheduling parameters of the calling thread in
+		case it differs from the one of the previous run().*/
+	void updateScheduling();
+	/** Applies the parameters stored by updateScheduling() to the
+		calling worker in case they changed since @a nVersion.*/
+	void applyScheduling( int nWorker, int& nVersion );
+
+	int m_nWorkers;
+	std::function<void(int)> m_render;
+	std::vector<std::thread> m_threads;
+
+	/** One per additional worker. Posted by run() to start a cycle
+		and by the destructor to stop the worker.*/
+	std::vector<std::unique_ptr<Semaphore>> m_wakeSemaphores;
+	/** Posted by the last worker finishing a cycle.*/
+	std::unique_ptr<Semaphore> m_pDoneSemaphore;
+	std::atomic<bool> m_bQuit;
+	/** Number of additional workers which did not finish the current
+		cycle yet.*/
+	std::atomic<int> m_nPending;
+
+	/** @name Scheduling of the workers
+	 * Policy and priority of the thread calling run(). Published to
+	 * the workers by incrementing #m_nSchedulingVersion.
+	 * @{ */
+#ifndef WIN32
+	/** Thread which called run() last. Only accessed by it.*/
+	pthread_t m_callingThread;
+	bool m_bCallingThreadKnown;
+#endif
+	std::atomic<int> m_nPolicy;
+	std::atomic<int> m_nPriority;
+	std::atomic<int> m_nSchedulingVersion;
+	/** @} */
+};
+
+inline int VoiceRenderPool::getWorkerCount() const {
+	return m_nWorkers;
+}
+
+};
+
+#endif // VOICE_RENDER_POOL_H
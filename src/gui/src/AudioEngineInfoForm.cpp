@@ -43,6 +43,15 @@ AudioEngineInfoForm::AudioEngineInfoForm(QWidget* parent)
  , Object()
 {
 	setupUi( this );
+
+	QFont profileFont( "Monospace" );
+	profileFont.setStyleHint( QFont::TypeWriter );
+	m_pProfileLbl->setFont( profileFont );
+	// Reserve enough space to show all stages at once.
+	m_pProfileLbl->setMinimumSize( m_pProfileLbl->fontMetrics().averageCharWidth() * 56,
+								   m_pProfileLbl->fontMetrics().lineSpacing() * ( ProcessProfiler::STAGES + 2 ) );
+	connect( m_pResetProfileBtn, SIGNAL( clicked() ), this, SLOT( resetProfile() ) );
+
 	adjustSize();
 	setFixedSize( width(), height() );	// not resizable
 
@@ -195,11 +204,19 @@ void AudioEngineInfoForm::updateInfo()
 
 	// SAMPLER
 	Sampler *pSampler = pAudioEngine->getSampler();
-	sampler_playingNotesLbl->setText(QString( "%1 / %2" ).arg(pSampler->getPlayingNotesNumber()).arg(Preferences::get_instance()->m_nMaxNotes));
+	sampler_playingNotesLbl->setText(QString( "%1 / %2" ).arg(pSampler->getPlayingNotesNumber()).arg(pSampler->getMaxNotes()));
 
 	// Synth
 	Synth *pSynth = pAudioEngine->getSynth();
 	synth_playingNotesLbl->setText( QString( "%1" ).arg( pSynth->getPlayingNotesNumber() ) );
+
+	// Time spent in the individual stages of the processing
+	m_pProfileLbl->setText( pAudioEngine->getProfiler()->getSummary() );
+}
+
+void AudioEngineInfoForm::resetProfile()
+{
+	Hydrogen::get_instance()->getAudioEngine()->getProfiler()->reset();
 }
 
 
@@ -58,6 +58,8 @@ class AudioEngineInfoForm :  public QWidget, public Ui_AudioEngineInfoForm_UI, p
 
 	public slots:
 		void updateInfo();
+		/** Clears all measurements of the ProcessProfiler. */
+		void resetProfile();
 
 	private:
 		void updateAudioEngineState();
@@ -115,7 +115,7 @@ AudioFileBrowser::AudioFileBrowser ( QWidget* pParent, bool bAllowMultiSelect, b
 
 AudioFileBrowser::~AudioFileBrowser()
 {
-	auto pNewSample = Sample::load( m_sEmptySampleFilename );
+	auto pNewSample = Sample::load( m_sEmptySampleFilename, false );
 	H2Core::Hydrogen::get_instance()->getAudioEngine()->getSampler()->preview_sample( pNewSample, 100 );
 	INFOLOG ( "DESTROY" );
 }
@@ -263,7 +263,7 @@ void AudioFileBrowser::browseTree( const QModelIndex& index )
 	{
 
 		filelineedit->setText( fleTxt );
-		auto pNewSample = Sample::load( path2 );
+		auto pNewSample = Sample::load( path2, false );
 
 		if ( pNewSample != nullptr ) {
 			m_pNBytesLable->setText( tr( "Size: %1 bytes" ).arg( pNewSample->get_size() / 2 ) );
@@ -320,7 +320,7 @@ void AudioFileBrowser::on_m_pPlayBtn_clicked()
 	
 	m_pStopBtn->setEnabled( true );
 	
-	auto pNewSample = Sample::load( m_pSampleFilename );
+	auto pNewSample = Sample::load( m_pSampleFilename, false );
 	if ( pNewSample ) {
 		assert(pNewSample->get_sample_rate() != 0);
 		
@@ -333,7 +333,7 @@ void AudioFileBrowser::on_m_pPlayBtn_clicked()
 
 void AudioFileBrowser::on_m_pStopBtn_clicked()
 {
-	auto pNewSample = Sample::load( m_sEmptySampleFilename );
+	auto pNewSample = Sample::load( m_sEmptySampleFilename, false );
 	H2Core::Hydrogen::get_instance()->getAudioEngine()->getSampler()->preview_sample( pNewSample, 100 );
 	m_pStopBtn->setEnabled( false );
 }
@@ -85,7 +85,7 @@ void SampleWaveDisplay::paintEvent(QPaintEvent *ev)
 void SampleWaveDisplay::updateDisplay( QString filename )
 {
 
-	auto pNewSample = Sample::load( filename );
+	auto pNewSample = Sample::load( filename, false );
 
 	if ( pNewSample != nullptr ) {
 		// Extract the filename from the complete path
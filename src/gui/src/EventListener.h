@@ -57,6 +57,7 @@ class EventListener
 		virtual void updatePreferencesEvent( int nValue ){ UNUSED( nValue ); }
 		virtual void actionModeChangeEvent( int nValue ){ UNUSED( nValue ); }
     	virtual void updateSongEditorEvent( int nValue ){ UNUSED( nValue ); }
+		virtual void loadProgressEvent( int nValue ){ UNUSED( nValue ); }
 
 		virtual ~EventListener() {}
 };
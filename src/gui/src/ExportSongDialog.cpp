@@ -43,9 +43,11 @@
 #include <core/IO/AudioOutput.h>
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/Sampler/Sampler.h>
+#include <core/Sampler/StretchCache.h>
 #include <core/EventQueue.h>
 
 #include <memory>
+#include <set>
 
 #ifdef WIN32
 #include <time.h>
@@ -719,66 +721,25 @@ void ExportSongDialog::calculateRubberbandTime()
 	auto tempoMarkerVector = pTimeline->getAllTempoMarkers();
 
 	float oldBPM = m_pHydrogen->getSong()->getBpm();
-	float lowBPM = oldBPM;
 
-	if ( tempoMarkerVector.size() >= 1 ){
-		for ( int t = 0; t < tempoMarkerVector.size(); t++){
-			if(tempoMarkerVector[t]->fBpm < lowBPM){
-				lowBPM =  tempoMarkerVector[t]->fBpm;
-			}
-
-		}
+	// Stretch the samples to all tempi of the song in advance. The
+	// results are kept by the StretchCache and the export itself
+	// hardly has to wait for Rubber Band.
+	std::set<float> tempi = { oldBPM };
+	for ( const auto& pTempoMarker : tempoMarkerVector ) {
+		tempi.insert( pTempoMarker->fBpm );
 	}
 
-	m_pHydrogen->setBPM(lowBPM);
 	time_t sTime = time(nullptr);
 
-	std::shared_ptr<Song> pSong = m_pHydrogen->getSong();
-	assert(pSong);
-	
-	if(pSong){
-		InstrumentList *songInstrList = pSong->getInstrumentList();
-		assert(songInstrList);
-		for ( unsigned nInstr = 0; nInstr < songInstrList->size(); ++nInstr ) {
-			auto pInstr = songInstrList->get( nInstr );
-			assert( pInstr );
-			if ( pInstr ){
-				for ( auto& pCompo : *pInstr->get_components() ) {
-					for ( int nLayer = 0; nLayer < InstrumentComponent::getMaxLayers(); nLayer++ ) {
-						auto pLayer = pCompo->get_layer( nLayer );
-						if ( pLayer ) {
-							auto pSample = pLayer->get_sample();
-							if ( pSample != nullptr ) {
-								if( pSample->get_rubberband().use ) {
-									auto pNewSample = Sample::load(
-												pSample->get_filepath(),
-												pSample->get_loops(),
-												pSample->get_rubberband(),
-												*pSample->get_velocity_envelope(),
-												*pSample->get_pan_envelope()
-												);
-									if( pNewSample == nullptr ){
-										continue;
-									}
-	
-									// insert new sample from newInstrument
-									m_pHydrogen->getAudioEngine()->lock( RIGHT_HERE );
-									pLayer->set_sample( pNewSample );
-									m_pHydrogen->getAudioEngine()->unlock();
-									
-								}
-							}
-						}
-					}
-				}
-			}
-		}
+	for ( float fBpm : tempi ) {
+		m_pHydrogen->recalculateRubberband( fBpm );
+		m_pHydrogen->getStretchCache()->wait( StretchCache::UNUSED );
 	}
-	
+	m_pHydrogen->recalculateRubberband( oldBPM );
+
 	Preferences::get_instance()->setRubberBandCalcTime(time(nullptr) - sTime);
 	
-	m_pHydrogen->setBPM(oldBPM);
-	
 	closeBtn->setEnabled(true);
 	resampleComboBox->setEnabled(true);
 	okBtn->setEnabled(true);
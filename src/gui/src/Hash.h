@@ -0,0 +1,35 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+#ifndef H2_HASH_H
+#define H2_HASH_H
+
+#include <cstddef>
+
+/** Mixes @a nValue into @a nSeed the way boost::hash_combine()
+	does. Used to compute the signatures of the rows and columns
+	cached by the editors. \ingroup docGUI*/
+inline void hashCombine( size_t& nSeed, size_t nValue )
+{
+	nSeed ^= nValue + 0x9e3779b9 + ( nSeed << 6 ) + ( nSeed >> 2 );
+}
+
+#endif
@@ -503,8 +503,12 @@ void HydrogenApp::onEventQueueTimer()
 	// use the timer to do schedule instrument slaughter;
 	EventQueue *pQueue = EventQueue::get_instance();
 
-	Event event;
-	while ( ( event = pQueue->pop_event() ).type != EVENT_NONE ) {
+	// Drain the whole queue at once. Events pushed while the
+	// listeners are notified will be handled during the next timeout.
+	Event events[ MAX_EVENTS ];
+	const int nEvents = pQueue->pop_events( events, MAX_EVENTS );
+	for ( int nEvent = 0; nEvent < nEvents; ++nEvent ) {
+		const Event& event = events[ nEvent ];
 		
 		// Provide the event to all EventListeners registered to
 		// HydrogenApp. By registering itself as EventListener and
@@ -629,6 +633,10 @@ void HydrogenApp::onEventQueueTimer()
 			case EVENT_UPDATE_SONG_EDITOR:
 				pListener->updateSongEditorEvent( event.value );
 				break;
+
+			case EVENT_LOAD_PROGRESS:
+				pListener->loadProgressEvent( event.value );
+				break;
 				
 			default:
 				ERRORLOG( QString("[onEventQueueTimer] Unhandled event: %1").arg( event.type ) );
@@ -862,6 +870,14 @@ void HydrogenApp::quitEvent( int nValue ) {
 	
 }
 
+void HydrogenApp::loadProgressEvent( int nValue ) {
+	if ( nValue < 100 ) {
+		setStatusBarMessage( tr( "Loading samples: %1%" ).arg( nValue ), 2000 );
+	} else {
+		setStatusBarMessage( tr( "Samples loaded" ), 2000 );
+	}
+}
+
 void HydrogenApp::changePreferences( H2Core::Preferences::Changes changes ) {
 	if ( m_pPreferencesUpdateTimer->isActive() ) {
 		m_pPreferencesUpdateTimer->stop();
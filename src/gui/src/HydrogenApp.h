@@ -192,6 +192,8 @@ signals:
 		     EventListener::updatePreferencesEvent()
 		 * - H2Core::EVENT_UPDATE_SONG -> 
 		     EventListener::updateSongEvent()
+		 * - H2Core::EVENT_LOAD_PROGRESS -> 
+		     EventListener::loadProgressEvent()
 		 * - H2Core::EVENT_NONE -> nothing
 		 *
 		 * In addition, all MIDI notes in
@@ -283,6 +285,13 @@ private slots:
 		 * \param nValue unused
 		 */
 		virtual void quitEvent( int nValue ) override;
+		/**
+		 * Displays the progress of decoding samples in the status
+		 * bar.
+		 *
+		 * \param nValue Progress in percent.
+		 */
+		virtual void loadProgressEvent( int nValue ) override;
 	
 };
 
@@ -132,12 +132,26 @@ void WaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer> pLayer
 
 		//INFOLOG( "[updateDisplay] sample: " + m_sSampleName  );
 
-		int nSampleLength = pLayer->get_sample()->get_frames();
+		auto pSample = pLayer->get_sample();
+		if ( pSample->is_streamed() ) {
+			// Only the beginning of streamed samples is held in memory.
+			auto pFullSample = Sample::load( pSample->get_filepath() );
+			if ( pFullSample != nullptr ) {
+				pSample = pFullSample;
+			}
+		} else if ( pSample->is_compact() ) {
+			// The data of compact samples has to be converted first.
+			auto pExpanded = std::make_shared<Sample>( pSample );
+			pExpanded->expand();
+			pSample = pExpanded;
+		}
+
+		int nSampleLength = pSample->get_preloaded_frames();
 		int nScaleFactor = nSampleLength / m_nCurrentWidth;
 
 		float fGain = height() / 2.0 * pLayer->get_gain();
 
-		auto pSampleData = pLayer->get_sample()->get_data_l();
+		auto pSampleData = pSample->get_data_l();
 
 		int nSamplePos =0;
 		int nVal;
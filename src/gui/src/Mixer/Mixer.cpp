@@ -403,11 +403,11 @@ void Mixer::updateMixer()
 			auto pInstr = pInstrList->get( nInstr );
 			assert( pInstr );
 
-			float fNewPeak_L = pInstr->get_peak_l();
-			pInstr->set_peak_l( 0.0f );	// reset instrument peak
+			const Meter::Snapshot levels = pInstr->getMeter()->getSnapshot();
+			pInstr->getMeter()->reset();	// reset instrument levels
 
-			float fNewPeak_R = pInstr->get_peak_r();
-			pInstr->set_peak_r( 0.0f );	// reset instrument peak
+			float fNewPeak_L = levels.fPeak_L;
+			float fNewPeak_R = levels.fPeak_R;
 
 			QString sName = pInstr->get_name();
 
@@ -433,6 +433,12 @@ void Mixer::updateMixer()
 				pLine->setPeak_R( fOldPeak_R / fallOff );
 			}
 
+			if ( bShowPeaks ) {
+				pLine->setRms( levels.fRms_L, levels.fRms_R );
+			} else {
+				pLine->setRms( 0.0f, 0.0f );
+			}
+
 			// fader position
 			float fNewVolume = pInstr->get_volume();
 			float fOldVolume = pLine->getVolume();
@@ -487,11 +493,12 @@ void Mixer::updateMixer()
 
 		ComponentMixerLine *pLine = m_pComponentMixerLine[ pDrumkitComponent->get_id() ];
 
-		float fNewPeak_L = pDrumkitComponent->get_peak_l();
-		pDrumkitComponent->set_peak_l( 0.0f );	// reset instrument peak
+		const Meter::Snapshot levels = pDrumkitComponent->getMeter()->getSnapshot();
+		pDrumkitComponent->getMeter()->reset();	// reset component levels
 
-		float fNewPeak_R = pDrumkitComponent->get_peak_r();
-		pDrumkitComponent->set_peak_r( 0.0f );	// reset instrument peak
+		// Components are metered including the peaks between samples.
+		float fNewPeak_L = levels.fTruePeak_L;
+		float fNewPeak_R = levels.fTruePeak_R;
 
 		bool bMuted = pDrumkitComponent->is_muted();
 
@@ -518,6 +525,12 @@ void Mixer::updateMixer()
 			pLine->setPeak_R( fOldPeak_R / fallOff );
 		}
 
+		if ( bShowPeaks ) {
+			pLine->setRms( levels.fRms_L, levels.fRms_R );
+		} else {
+			pLine->setRms( 0.0f, 0.0f );
+		}
+
 		// fader position
 		float fNewVolume = pDrumkitComponent->get_volume();
 		float fOldVolume = pLine->getVolume();
@@ -564,12 +577,12 @@ void Mixer::updateMixer()
 
 
 	// update MasterPeak
+	const Meter::Snapshot masterLevels = pAudioEngine->getMasterMeter()->getSnapshot();
+	pAudioEngine->getMasterMeter()->reset();
 	float fOldPeak_L = m_pMasterLine->getPeak_L();
-	float fNewPeak_L = pAudioEngine->getMasterPeak_L();
-	pAudioEngine->setMasterPeak_L(0.0);
+	float fNewPeak_L = masterLevels.fTruePeak_L;
 	float fOldPeak_R = m_pMasterLine->getPeak_R();
-	float fNewPeak_R = pAudioEngine->getMasterPeak_R();
-	pAudioEngine->setMasterPeak_R(0.0);
+	float fNewPeak_R = masterLevels.fTruePeak_R;
 
 	if (!bShowPeaks) {
 		fNewPeak_L = 0.0;
@@ -589,6 +602,12 @@ void Mixer::updateMixer()
 		m_pMasterLine->setPeak_R( fOldPeak_R / fallOff );
 	}
 
+	if ( bShowPeaks ) {
+		m_pMasterLine->setRms( masterLevels.fRms_L, masterLevels.fRms_R );
+	} else {
+		m_pMasterLine->setRms( 0.0f, 0.0f );
+	}
+
 
 	// set master fader position
 	float fNewVolume = pSong->getVolume();
@@ -299,6 +299,10 @@ float MixerLine::getPeak_R() {
 	return m_pFader->getPeak_R();
 }
 
+void MixerLine::setRms( float fRms_L, float fRms_R ) {
+	m_pFader->setRms( fRms_L, fRms_R );
+}
+
 void MixerLine::nameClicked() {
 	emit instrumentNameClicked(this);
 }
@@ -573,6 +577,10 @@ float ComponentMixerLine::getPeak_R() {
 	return m_pFader->getPeak_R();
 }
 
+void ComponentMixerLine::setRms( float fRms_L, float fRms_R ) {
+	m_pFader->setRms( fRms_L, fRms_R );
+}
+
 
 // ::::::::::::::::::::::::::::
 
@@ -730,6 +738,10 @@ float MasterMixerLine::getPeak_R() {
 	return m_pMasterFader->getPeak_R();
 }
 
+void MasterMixerLine::setRms( float fRms_L, float fRms_R ) {
+	m_pMasterFader->setRms( fRms_L, fRms_R );
+}
+
 void MasterMixerLine::updateMixerLine()
 {
 
@@ -106,6 +106,9 @@ public:
 	void	setPeak_R( float peak );
 	float	getPeak_R();
 
+	/** Sets the RMS levels shown by the fader.*/
+	void	setRms( float fRms_L, float fRms_R );
+
 	void	setName(QString name) {     m_pNameWidget->setText( name );        }
 	QString getName() {      return m_pNameWidget->text();        }
 
@@ -193,6 +196,9 @@ public:
 	void	setPeak_R( float peak );
 	float	getPeak_R();
 
+	/** Sets the RMS levels shown by the fader.*/
+	void	setRms( float fRms_L, float fRms_R );
+
 	void	setName(QString name) {     m_pNameWidget->setText( name );        }
 	QString getName() {      return m_pNameWidget->text();        }
 
@@ -249,6 +255,9 @@ public:
 	void	setPeak_R(float peak);
 	float	getPeak_R();
 
+	/** Sets the RMS levels shown by the fader.*/
+	void	setRms( float fRms_L, float fRms_R );
+
 
 signals:
 	void	volumeChanged(MasterMixerLine *ref);
@@ -41,17 +41,23 @@
 
 #include "UndoActions.h"
 #include "../HydrogenApp.h"
+#include "../Hash.h"
 #include "../Mixer/Mixer.h"
 
 #include <math.h>
 #include <cassert>
 #include <algorithm>
 #include <stack>
+#include <functional>
 
 using namespace H2Core;
 
 DrumPatternEditor::DrumPatternEditor(QWidget* parent, PatternEditorPanel *panel)
  : PatternEditor( parent, panel )
+ , m_nBackgroundSignature( 0 )
+ , m_bNeedsUpdate( true )
+ , m_bNeedsBackgroundUpdate( true )
+ , m_bMovingNotesDrawn( false )
 {
 	auto pPref = H2Core::Preferences::get_instance();
 
@@ -59,11 +65,19 @@ DrumPatternEditor::DrumPatternEditor(QWidget* parent, PatternEditorPanel *panel)
 	m_nEditorHeight = m_nGridHeight * MAX_INSTRUMENTS;
 	resize( m_nEditorWidth, m_nEditorHeight );
 
+	qreal pixelRatio = devicePixelRatio();
+	m_pBackgroundPixmap = new QPixmap( m_nEditorWidth * pixelRatio, m_nEditorHeight * pixelRatio );
+	m_pBackgroundPixmap->setDevicePixelRatio( pixelRatio );
+	m_pPatternPixmap = new QPixmap( m_nEditorWidth * pixelRatio, m_nEditorHeight * pixelRatio );
+	m_pPatternPixmap->setDevicePixelRatio( pixelRatio );
+
 	Hydrogen::get_instance()->setSelectedInstrumentNumber( 0 );
 }
 
 DrumPatternEditor::~DrumPatternEditor()
 {
+	delete m_pBackgroundPixmap;
+	delete m_pPatternPixmap;
 }
 
 
@@ -87,8 +101,155 @@ void DrumPatternEditor::updateEditor( bool bPatternOnly )
 	}
 	resize( m_nEditorWidth, height() );
 
-	// redraw all
-	update( 0, 0, width(), height() );
+	// As long as the background stays the same only the rows
+	// containing modified notes have to be redrawn.
+	if ( m_bNeedsUpdate || m_bNeedsBackgroundUpdate || m_bMovingNotesDrawn ||
+		 m_selection.isMoving() ||
+		 computeBackgroundSignature() != m_nBackgroundSignature ) {
+		m_bNeedsUpdate = true;
+		update();
+	} else {
+		updateModifiedRows();
+	}
+}
+
+void DrumPatternEditor::updateWidget()
+{
+	updateEditor( true );
+	update();
+}
+
+void DrumPatternEditor::finishUpdateEditor()
+{
+	auto pPref = H2Core::Preferences::get_instance();
+	const QColor selectedRowColor( pPref->getColorTheme()->m_patternEditor_selectedRowColor );
+
+	const size_t nBackgroundSignature = computeBackgroundSignature();
+	if ( m_bNeedsBackgroundUpdate || nBackgroundSignature != m_nBackgroundSignature ) {
+		int nNotes = MAX_NOTES;
+		if ( m_pPattern ) {
+			nNotes = m_pPattern->get_length();
+		}
+		int nInstruments = Hydrogen::get_instance()->getSong()->getInstrumentList()->size();
+		int nSelectedInstrument = Hydrogen::get_instance()->getSelectedInstrumentNumber();
+
+		// The length of the pattern or the number of instruments
+		// might have changed.
+		m_nEditorWidth = m_nMargin + m_fGridWidth * nNotes;
+		m_nEditorHeight = m_nGridHeight * nInstruments;
+		resize( m_nEditorWidth, m_nEditorHeight );
+
+		qreal pixelRatio = devicePixelRatio();
+		int nPixmapWidth = std::max( width(), 1 ) * pixelRatio;
+		int nPixmapHeight = std::max( height(), 1 ) * pixelRatio;
+		if ( m_pBackgroundPixmap->width() != nPixmapWidth ||
+			 m_pBackgroundPixmap->height() != nPixmapHeight ||
+			 m_pBackgroundPixmap->devicePixelRatio() != pixelRatio ) {
+			delete m_pBackgroundPixmap;
+			delete m_pPatternPixmap;
+			m_pBackgroundPixmap = new QPixmap( nPixmapWidth, nPixmapHeight );
+			m_pBackgroundPixmap->setDevicePixelRatio( pixelRatio );
+			m_pPatternPixmap = new QPixmap( nPixmapWidth, nPixmapHeight );
+			m_pPatternPixmap->setDevicePixelRatio( pixelRatio );
+		}
+
+		QPainter p( m_pBackgroundPixmap );
+		__create_background( p );
+		if ( nSelectedInstrument >= 0 && nSelectedInstrument < nInstruments ) {
+			p.fillRect( 0, m_nGridHeight * nSelectedInstrument + 1,
+						( m_nMargin + nNotes * m_fGridWidth ), m_nGridHeight - 1,
+						selectedRowColor );
+		}
+		__draw_grid( p );
+
+		m_nBackgroundSignature = nBackgroundSignature;
+		m_bNeedsBackgroundUpdate = false;
+	}
+
+	m_rowSignatures = computeRowSignatures();
+
+	QPainter p( m_pPatternPixmap );
+	p.drawPixmap( 0, 0, *m_pBackgroundPixmap );
+	__draw_pattern( p );
+
+	m_bMovingNotesDrawn = m_selection.isMoving();
+	m_bNeedsUpdate = false;
+}
+
+void DrumPatternEditor::updateModifiedRows()
+{
+	std::vector<size_t> rowSignatures = computeRowSignatures();
+
+	QPainter p( m_pPatternPixmap );
+	qreal pixelRatio = m_pPatternPixmap->devicePixelRatio();
+	for ( int nRow = 0; nRow < rowSignatures.size(); ++nRow ) {
+		if ( nRow < m_rowSignatures.size() &&
+			 rowSignatures[ nRow ] == m_rowSignatures[ nRow ] ) {
+			continue;
+		}
+
+		QRect rowRect( 0, nRow * m_nGridHeight, width(), m_nGridHeight );
+		QRectF srcRect(
+				pixelRatio * rowRect.x(),
+				pixelRatio * rowRect.y(),
+				pixelRatio * rowRect.width(),
+				pixelRatio * rowRect.height()
+		);
+		p.drawPixmap( rowRect, *m_pBackgroundPixmap, srcRect );
+		__draw_pattern( p, nRow );
+		update( rowRect );
+	}
+
+	m_rowSignatures = rowSignatures;
+}
+
+std::vector<size_t> DrumPatternEditor::computeRowSignatures()
+{
+	updatePatternInfo();
+
+	InstrumentList *pInstrList = Hydrogen::get_instance()->getSong()->getInstrumentList();
+	std::vector<size_t> rowSignatures( pInstrList->size(), 0 );
+	if ( m_pPattern == nullptr ) {
+		return rowSignatures;
+	}
+
+	validateSelection();
+
+	for ( const auto& it : *m_pPattern->get_notes() ) {
+		Note *pNote = it.second;
+		int nRow = pInstrList->index( pNote->get_instrument() );
+		if ( nRow < 0 ) {
+			continue;
+		}
+
+		size_t& nSignature = rowSignatures[ nRow ];
+		hashCombine( nSignature, pNote->get_position() );
+		hashCombine( nSignature, std::hash<float>()( pNote->get_velocity() ) );
+		hashCombine( nSignature, pNote->get_length() );
+		hashCombine( nSignature, pNote->get_note_off() );
+		hashCombine( nSignature, pNote->get_key() );
+		hashCombine( nSignature, pNote->get_octave() );
+		hashCombine( nSignature, m_selection.isSelected( pNote ) );
+	}
+
+	return rowSignatures;
+}
+
+size_t DrumPatternEditor::computeBackgroundSignature()
+{
+	// Ensure that m_pPattern is up to date.
+	updatePatternInfo();
+
+	size_t nSignature = 0;
+	hashCombine( nSignature, m_pPattern != nullptr ? m_pPattern->get_length() : MAX_NOTES );
+	hashCombine( nSignature, Hydrogen::get_instance()->getSong()->getInstrumentList()->size() );
+	hashCombine( nSignature, Hydrogen::get_instance()->getSelectedInstrumentNumber() );
+	hashCombine( nSignature, std::hash<float>()( m_fGridWidth ) );
+	hashCombine( nSignature, m_nGridHeight );
+	hashCombine( nSignature, m_nResolution );
+	hashCombine( nSignature, m_bUseTriplets );
+
+	return nSignature;
 }
 
 
@@ -985,56 +1146,18 @@ void DrumPatternEditor::paste()
 ///
 /// Draws a pattern
 ///
-void DrumPatternEditor::__draw_pattern(QPainter& painter)
+void DrumPatternEditor::__draw_pattern( QPainter& painter, int nRow )
 {
 	auto pPref = H2Core::Preferences::get_instance();
-	
-	const QColor selectedRowColor( pPref->getColorTheme()->m_patternEditor_selectedRowColor );
-
-	__create_background( painter );
 
 	if (m_pPattern == nullptr) {
 		return;
 	}
 
-	int nNotes = m_pPattern->get_length();
-	int nSelectedInstrument = Hydrogen::get_instance()->getSelectedInstrumentNumber();
 	std::shared_ptr<Song> pSong = Hydrogen::get_instance()->getSong();
 
 	InstrumentList * pInstrList = pSong->getInstrumentList();
 
-
-	if ( m_nEditorHeight != (int)( m_nGridHeight * pInstrList->size() ) ) {
-		// the number of instruments is changed...recreate all
-		m_nEditorHeight = m_nGridHeight * pInstrList->size();
-		resize( width(), m_nEditorHeight );
-	}
-
-	for ( uint nInstr = 0; nInstr < pInstrList->size(); ++nInstr ) {
-		uint y = m_nGridHeight * nInstr;
-		if ( nInstr == (uint)nSelectedInstrument ) {	// selected instrument
-			painter.fillRect( 0, y + 1, ( m_nMargin + nNotes * m_fGridWidth ), m_nGridHeight - 1, selectedRowColor );
-		}
-	}
-
-
-	// draw the grid
-	__draw_grid( painter );
-
-
-	// Draw cursor
-	if ( hasFocus() && !HydrogenApp::get_instance()->hideKeyboardCursor() ) {
-		uint x = m_nMargin + m_pPatternEditorPanel->getCursorPosition() * m_fGridWidth;
-		int nSelectedInstrument = Hydrogen::get_instance()->getSelectedInstrumentNumber();
-		uint y = nSelectedInstrument * m_nGridHeight;
-		QPen p( Qt::black );
-		p.setWidth( 2 );
-		painter.setPen( p );
-		painter.setRenderHint( QPainter::Antialiasing );
-		painter.drawRoundedRect( QRect( x-m_fGridWidth*3, y+2, m_fGridWidth*6, m_nGridHeight-3 ), 4, 4 );
-	}
-
-
 	/*
 		BUGFIX
 
@@ -1050,7 +1173,10 @@ void DrumPatternEditor::__draw_pattern(QPainter& painter)
 			return;
 		}
 
-		validateSelection();
+		if ( nRow != -1 ) {
+			painter.save();
+			painter.setClipRect( 0, nRow * m_nGridHeight, width(), m_nGridHeight );
+		}
 
 		std::vector< int > noteCount; // instrument_id -> count
 		std::stack<std::shared_ptr<Instrument>> instruments;
@@ -1065,6 +1191,11 @@ void DrumPatternEditor::__draw_pattern(QPainter& painter)
 			auto noteIt = posIt;
 			while ( noteIt != pNotes->end() && noteIt->second->get_position() == nPosition ) {
 				Note *pNote = noteIt->second;
+				if ( nRow != -1 &&
+					 pInstrList->index( pNote->get_instrument() ) != nRow ) {
+					++noteIt;
+					continue;
+				}
 
 				int nInstrumentID = pNote->get_instrument_id();
 				if ( nInstrumentID >= noteCount.size() ) {
@@ -1105,6 +1236,10 @@ void DrumPatternEditor::__draw_pattern(QPainter& painter)
 
 			posIt = noteIt;
 		}
+
+		if ( nRow != -1 ) {
+			painter.restore();
+		}
 	}
 }
 
@@ -1180,12 +1315,6 @@ void DrumPatternEditor::__create_background( QPainter& p)
 	std::shared_ptr<Song> pSong = Hydrogen::get_instance()->getSong();
 	int nInstruments = pSong->getInstrumentList()->size();
 
-	if ( m_nEditorHeight != (int)( m_nGridHeight * nInstruments ) ) {
-		// the number of instruments is changed...recreate all
-		m_nEditorHeight = m_nGridHeight * nInstruments;
-		resize( width(), m_nEditorHeight );
-	}
-
 	p.fillRect(0, 0, m_nMargin + nNotes * m_fGridWidth, height(), backgroundColor);
 	for ( uint i = 0; i < (uint)nInstruments; i++ ) {
 		uint y = m_nGridHeight * i;
@@ -1206,16 +1335,50 @@ void DrumPatternEditor::__create_background( QPainter& p)
 
 
 
-void DrumPatternEditor::paintEvent( QPaintEvent* /*ev*/ )
+void DrumPatternEditor::paintEvent( QPaintEvent* ev )
 {
 	QPainter painter( this );
-	__draw_pattern( painter );
+	if ( m_pPatternPixmap->devicePixelRatio() != devicePixelRatio() ) {
+		// The widget was moved to a screen of different scaling.
+		m_bNeedsBackgroundUpdate = true;
+		m_bNeedsUpdate = true;
+	}
+	if ( m_bNeedsUpdate || computeBackgroundSignature() != m_nBackgroundSignature ) {
+		finishUpdateEditor();
+	}
+	qreal pixelRatio = m_pPatternPixmap->devicePixelRatio();
+	QRectF srcRect(
+			pixelRatio * ev->rect().x(),
+			pixelRatio * ev->rect().y(),
+			pixelRatio * ev->rect().width(),
+			pixelRatio * ev->rect().height()
+	);
+	painter.drawPixmap( ev->rect(), *m_pPatternPixmap, srcRect );
+
+	drawCursor( painter );
 
 	drawFocus( painter );
 	
 	m_selection.paintSelection( &painter );
 }
 
+void DrumPatternEditor::drawCursor( QPainter& painter ) {
+
+	if ( m_pPattern == nullptr || ! hasFocus() ||
+		 HydrogenApp::get_instance()->hideKeyboardCursor() ) {
+		return;
+	}
+
+	uint x = m_nMargin + m_pPatternEditorPanel->getCursorPosition() * m_fGridWidth;
+	int nSelectedInstrument = Hydrogen::get_instance()->getSelectedInstrumentNumber();
+	uint y = nSelectedInstrument * m_nGridHeight;
+	QPen p( Qt::black );
+	p.setWidth( 2 );
+	painter.setPen( p );
+	painter.setRenderHint( QPainter::Antialiasing );
+	painter.drawRoundedRect( QRect( x-m_fGridWidth*3, y+2, m_fGridWidth*6, m_nGridHeight-3 ), 4, 4 );
+}
+
 void DrumPatternEditor::drawFocus( QPainter& painter ) {
 
 	if ( ! m_bEntered && ! hasFocus() ) {
@@ -1275,14 +1438,14 @@ void DrumPatternEditor::focusInEvent ( QFocusEvent *ev )
 
 void DrumPatternEditor::selectedInstrumentChangedEvent()
 {
-	update( 0, 0, width(), height() );
+	updateEditor();
 }
 
 
 /// This method is called from another thread (audio engine)
 void DrumPatternEditor::patternModifiedEvent()
 {
-	update( 0, 0, width(), height() );
+	updateEditor( true );
 }
 
 
@@ -1358,6 +1521,7 @@ void DrumPatternEditor::onPreferencesChanged( H2Core::Preferences::Changes chang
 	
 	if ( changes & ( H2Core::Preferences::Changes::Colors |
 					 H2Core::Preferences::Changes::Font ) ) {
+		m_bNeedsBackgroundUpdate = true;
 		updateEditor();
 	}
 }
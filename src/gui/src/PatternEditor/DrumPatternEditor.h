@@ -36,6 +36,8 @@
 #include <QtGui>
 #include <QtWidgets>
 
+#include <vector>
+
 class PatternEditorInstrumentList;
 
 ///
@@ -113,6 +115,10 @@ class DrumPatternEditor : public PatternEditor, protected WidgetWithScalableFont
 		void functionPasteNotesRedoAction(std::list<H2Core::Pattern*> & changeList, std::list<H2Core::Pattern*> & appliedList);
 		void functionPasteNotesUndoAction(std::list<H2Core::Pattern*> & appliedList);
 
+		//! Redraws the rows with changed selection and repaints the
+		//! overlay holding the lasso.
+		virtual void updateWidget() override;
+
 		// Synthetic UI events from selection manager
 		virtual void mouseClickEvent( QMouseEvent *ev ) override;
 		virtual void mouseDragStartEvent( QMouseEvent *ev ) override;
@@ -137,11 +143,46 @@ class DrumPatternEditor : public PatternEditor, protected WidgetWithScalableFont
 
 	private:
 		void __draw_note( H2Core::Note* note, QPainter& painter );
-		void __draw_pattern( QPainter& painter );
+		/** Draws the notes of #m_pPattern. In case @a nRow is not -1
+			only those of the corresponding instrument are drawn.*/
+		void __draw_pattern( QPainter& painter, int nRow = -1 );
 		void __draw_grid( QPainter& painter );
 		void __create_background( QPainter& pointer );
+		void drawCursor( QPainter& painter );
 		void drawFocus( QPainter& painter );
 
+		/** Recreates #m_pBackgroundPixmap if required and redraws all
+			notes into #m_pPatternPixmap.*/
+		void finishUpdateEditor();
+		/** Redraws only those rows of #m_pPatternPixmap whose notes
+			changed since they were drawn the last time and schedules
+			a repaint of them.*/
+		void updateModifiedRows();
+		/** \return Hash of all properties affecting the appearance of
+			the notes for each instrument row.*/
+		std::vector<size_t> computeRowSignatures();
+		/** \return Hash of all properties #m_pBackgroundPixmap
+			depends on.*/
+		size_t computeBackgroundSignature();
+
+		/** Background, grid, and highlighting of the selected
+			instrument. Only recreated if
+			computeBackgroundSignature() changes.*/
+		QPixmap *m_pBackgroundPixmap;
+		/** #m_pBackgroundPixmap with the notes of #m_pPattern drawn
+			on top. Cursor, focus, and lasso are painted as an overlay
+			in paintEvent().*/
+		QPixmap *m_pPatternPixmap;
+		size_t m_nBackgroundSignature;
+		/** Signatures of the rows of #m_pPatternPixmap as returned by
+			computeRowSignatures() at the time they were drawn.*/
+		std::vector<size_t> m_rowSignatures;
+		bool m_bNeedsUpdate;
+		bool m_bNeedsBackgroundUpdate;
+		/** Whether the outlines of notes being moved, which are not
+			bound to a single row, are part of #m_pPatternPixmap.*/
+		bool m_bMovingNotesDrawn;
+
 		virtual void keyPressEvent (QKeyEvent *ev) override;
 		virtual void keyReleaseEvent (QKeyEvent *ev) override;
 		virtual void showEvent ( QShowEvent *ev ) override;
@@ -1007,6 +1007,7 @@ void PatternEditorPanel::patternSizeChanged( double fValue ){
 	// set length and denominator				
 	m_pPattern->set_length( nLength );
 	m_pPattern->set_denominator( static_cast<int>( fDenominator ) );
+	Hydrogen::get_instance()->getSong()->updateColumnIndex();
 	patternLengthChanged();
 }
 
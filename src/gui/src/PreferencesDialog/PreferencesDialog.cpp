@@ -41,6 +41,7 @@
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/Helpers/Translations.h>
 #include <core/Sampler/Sampler.h>
+#include <core/Sampler/SampleStreamer.h>
 #include "../SongEditor/SongEditor.h"
 #include "../SongEditor/SongEditorPanel.h"
 
@@ -243,6 +244,17 @@ PreferencesDialog::PreferencesDialog(QWidget* parent)
 
 	// max voices
 	maxVoicesTxt->setValue( pPref->m_nMaxNotes );
+	voiceStealingComboBox->setCurrentIndex( pPref->m_nVoiceStealing );
+
+	// render threads
+	renderThreadsSpinBox->setValue( pPref->m_nRenderThreads );
+
+	// sample streaming
+	streamSamplesCheckBox->setChecked( pPref->m_bStreamSamples );
+	streamPreloadSpinBox->setValue( pPref->m_nStreamPreloadMs );
+	compactSamplesCheckBox->setChecked( pPref->m_bCompactSamples );
+	sampleCacheCheckBox->setChecked( pPref->m_bUseSampleCache );
+	sampleCacheSizeSpinBox->setValue( pPref->m_nSampleCacheSize );
 
 	// JACK
 	trackOutsCheckBox->setChecked( pPref->m_bJackTrackOuts );
@@ -675,8 +687,38 @@ void PreferencesDialog::on_okBtn_clicked()
 	// metronome
 	pPref->m_fMetronomeVolume = (metronomeVolumeSpinBox->value()) / 100.0;
 
-	// maxVoices
+	// maxVoices. The note pool of the AudioEngine can not be
+	// enlarged while running.
 	pPref->m_nMaxNotes = maxVoicesTxt->value();
+	const bool bMaxNotesNeedRestart = static_cast<int>( pPref->m_nMaxNotes ) >
+		Hydrogen::get_instance()->getAudioEngine()->getSampler()->getMaxNotesLimit();
+	pPref->m_nVoiceStealing = voiceStealingComboBox->currentIndex();
+
+	// render threads
+	if ( pPref->m_nRenderThreads != renderThreadsSpinBox->value() ) {
+		pPref->m_nRenderThreads = renderThreadsSpinBox->value();
+		auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+		pAudioEngine->lock( RIGHT_HERE );
+		pAudioEngine->getSampler()->setRenderThreads( pPref->m_nRenderThreads );
+		pAudioEngine->unlock();
+	}
+
+	// sample streaming and storage. Only drumkits loaded afterwards
+	// are affected.
+	pPref->m_bStreamSamples = streamSamplesCheckBox->isChecked();
+	pPref->m_nStreamPreloadMs = streamPreloadSpinBox->value();
+	pPref->m_bCompactSamples = compactSamplesCheckBox->isChecked();
+	pPref->m_bUseSampleCache = sampleCacheCheckBox->isChecked();
+	pPref->m_nSampleCacheSize = sampleCacheSizeSpinBox->value();
+	if ( pPref->m_bStreamSamples ) {
+		auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+		SampleStreamer* pStreamer = pAudioEngine->getSampler()->getSampleStreamer();
+		if ( ! pStreamer->isRunning() ) {
+			pAudioEngine->lock( RIGHT_HERE );
+			pStreamer->start( pPref->m_nMaxNotes );
+			pAudioEngine->unlock();
+		}
+	}
 
 	if ( m_pMidiDriverComboBox->currentText() == "ALSA" ) {
 		pPref->m_sMidiDriver = "ALSA";
@@ -768,6 +810,10 @@ void PreferencesDialog::on_okBtn_clicked()
 	SongEditor * pSongEditor = pSongEditorPanel->getSongEditor();
 	pSongEditor->updateEditorandSetTrue();
 
+	if ( bMaxNotesNeedRestart ) {
+		QMessageBox::information( this, "Hydrogen", tr( "Hydrogen must be restarted for the increased number of voices to take effect" ));
+	}
+
 	QString sPreferredLanguage = languageComboBox->currentData().toString();
 	if ( sPreferredLanguage != m_sInitialLanguage ) {
 		QMessageBox::information( this, "Hydrogen", tr( "Hydrogen must be restarted for language change to take effect" ));
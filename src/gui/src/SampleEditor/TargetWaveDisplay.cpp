@@ -203,13 +203,27 @@ void TargetWaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer>
 {
 	if ( pLayer && pLayer->get_sample() ) {
 
-		int nSampleLength = pLayer->get_sample()->get_frames();
+		auto pSample = pLayer->get_sample();
+		if ( pSample->is_streamed() ) {
+			// Only the beginning of streamed samples is held in memory.
+			auto pFullSample = Sample::load( pSample->get_filepath() );
+			if ( pFullSample != nullptr ) {
+				pSample = pFullSample;
+			}
+		} else if ( pSample->is_compact() ) {
+			// The data of compact samples has to be converted first.
+			auto pExpanded = std::make_shared<Sample>( pSample );
+			pExpanded->expand();
+			pSample = pExpanded;
+		}
+
+		int nSampleLength = pSample->get_preloaded_frames();
 		float nScaleFactor = nSampleLength / width();
 
 		float fGain = (height() - 8) / 2.0 * pLayer->get_gain();
 
-		auto pSampleDatal = pLayer->get_sample()->get_data_l();
-		auto pSampleDatar = pLayer->get_sample()->get_data_r();
+		auto pSampleDatal = pSample->get_data_l();
+		auto pSampleDatar = pSample->get_data_r();
 		int nSamplePos = 0;
 		int nVall;
 		int nValr;
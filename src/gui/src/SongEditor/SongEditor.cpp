@@ -22,6 +22,8 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
 
 #include <core/Basics/Song.h>
@@ -50,6 +52,7 @@ using namespace H2Core;
 #include "SoundLibrary/SoundLibraryDatastructures.h"
 #include "../PatternEditor/PatternEditorPanel.h"
 #include "../HydrogenApp.h"
+#include "../Hash.h"
 #include "../InstrumentRack.h"
 #include "../PatternPropertiesDialog.h"
 #include "../SongPropertiesDialog.h"
@@ -78,6 +81,9 @@ SongEditor::SongEditor( QWidget *parent, QScrollArea *pScrollView, SongEditorPan
  , m_selection( this )
  , m_pHydrogen( nullptr )
  , m_pAudioEngine( nullptr )
+ , m_nTileGridWidth( 0 )
+ , m_nTileGridHeight( 0 )
+ , m_nTilePatterns( -1 )
  , m_bEntered( false )
 {
 	m_pHydrogen = Hydrogen::get_instance();
@@ -142,6 +148,7 @@ void SongEditor::setGridWidth( uint width )
 	if ( ( SONG_EDITOR_MIN_GRID_WIDTH <= width ) && ( SONG_EDITOR_MAX_GRID_WIDTH >= width ) ) {
 		m_nGridWidth = width;
 		this->resize ( m_nMargin + m_nMaxPatternSequence * m_nGridWidth, height() );
+		createBackground();
 	}
 }
 
@@ -722,18 +729,37 @@ void SongEditor::paintEvent( QPaintEvent *ev )
 	// ridisegno tutto solo se sono cambiate le note
 	if (m_bSequenceChanged) {
 		m_bSequenceChanged = false;
-		drawSequence();
+		updateGridCells();
 	}
 
 	QPainter painter(this);
-	painter.drawPixmap( ev->rect(), *m_pSequencePixmap, ev->rect() );
+
+	// Only tiles intersecting the exposed area are rendered.
+	const QRect exposedRect = ev->rect();
+	for ( int nTileY = exposedRect.top() / TILE_SIZE; nTileY <= exposedRect.bottom() / TILE_SIZE; ++nTileY ) {
+		for ( int nTileX = exposedRect.left() / TILE_SIZE; nTileX <= exposedRect.right() / TILE_SIZE; ++nTileX ) {
+			QPoint tile( nTileX, nTileY );
+			auto it = m_tiles.find( tile );
+			if ( it == m_tiles.end() ) {
+				it = m_tiles.insert( std::make_pair( tile, createTile( tile ) ) ).first;
+			}
+
+			QRect tileRect( nTileX * TILE_SIZE, nTileY * TILE_SIZE, TILE_SIZE, TILE_SIZE );
+			QRect rect = tileRect.intersected( exposedRect );
+			painter.drawPixmap( rect, it->second, rect.translated( -tileRect.topLeft() ) );
+		}
+	}
+	evictTiles();
 
 	// Draw moving selected cells
 	QColor patternColor( 0, 0, 0 );
 	if ( m_selection.isMoving() ) {
 		QPoint offset = movingGridOffset();
 		for ( QPoint point : m_selection ) {
-			int nWidth = m_gridCells[ point ].m_fWidth * m_nGridWidth;
+			// Looked up without inserting to not add empty cells to
+			// the cached ones.
+			auto cell = m_gridCells.find( point );
+			int nWidth = cell != m_gridCells.end() ? cell->second.m_fWidth * m_nGridWidth : 0;
 			QRect r = QRect( columnRowToXy( point + offset ),
 							 QSize( nWidth, m_nGridHeight ) )
 				.marginsRemoved( QMargins( 2, 4, 1 , 3 ) );
@@ -809,32 +835,55 @@ void SongEditor::leaveEvent( QEvent *ev ) {
 
 void SongEditor::createBackground()
 {
-	auto pPref = H2Core::Preferences::get_instance();
 	std::shared_ptr<Song> pSong = m_pHydrogen->getSong();
 
-	uint nPatterns = pSong->getPatternList()->size();
+	int nPatterns = pSong->getPatternList()->size();
 
-	static int nOldHeight = -1;
 	int nNewHeight = m_nGridHeight * nPatterns;
+	if ( nNewHeight == 0 ) {
+		nNewHeight = 1;	// the widget should not be empty
+	}
+	if ( nNewHeight != height() ) {
+		this->resize( QSize( width(), nNewHeight ) );
+	}
 
-	if (nOldHeight != nNewHeight) {
+	if ( m_nTileGridWidth != m_nGridWidth || m_nTileGridHeight != m_nGridHeight ||
+		 m_nTilePatterns != nPatterns ) {
 		// cambiamento di dimensioni...
-		if (nNewHeight == 0) {
-			nNewHeight = 1;	// the pixmap should not be empty
-		}
-
-		m_pBackgroundPixmap = new QPixmap( width(), nNewHeight );	// initialize the pixmap
-		m_pSequencePixmap = new QPixmap( width(), nNewHeight );	// initialize the pixmap
-		this->resize( QSize( width(), nNewHeight ) );
+		m_tiles.clear();
+		m_nTileGridWidth = m_nGridWidth;
+		m_nTileGridHeight = m_nGridHeight;
+		m_nTilePatterns = nPatterns;
 	}
 
-	m_pBackgroundPixmap->fill( pPref->getColorTheme()->m_songEditor_alternateRowColor );
+	//~ celle
+	m_bSequenceChanged = true;
+}
 
-	QPainter p( m_pBackgroundPixmap );
+QPixmap SongEditor::createTile( const QPoint& tile )
+{
+	auto pPref = H2Core::Preferences::get_instance();
+	std::shared_ptr<Song> pSong = m_pHydrogen->getSong();
+
+	int nPatterns = pSong->getPatternList()->size();
+	const QRect tileRect( tile.x() * TILE_SIZE, tile.y() * TILE_SIZE, TILE_SIZE, TILE_SIZE );
+
+	// Columns and rows intersecting the tile.
+	int nFirstColumn = std::max( 0, ( tileRect.left() - m_nMargin ) / (int)m_nGridWidth - 1 );
+	int nLastColumn = std::min( (int)m_nMaxPatternSequence,
+								( tileRect.right() - m_nMargin ) / (int)m_nGridWidth + 1 );
+	int nFirstRow = std::max( 0, tileRect.top() / (int)m_nGridHeight - 1 );
+	int nLastRow = std::min( nPatterns, tileRect.bottom() / (int)m_nGridHeight + 1 );
+
+	QPixmap pixmap( TILE_SIZE, TILE_SIZE );
+	pixmap.fill( pPref->getColorTheme()->m_songEditor_alternateRowColor );
+
+	QPainter p( &pixmap );
+	p.translate( -tileRect.topLeft() );
 	p.setPen( pPref->getColorTheme()->m_songEditor_lineColor );
 
 	// vertical lines
-	for (uint i = 0; i < m_nMaxPatternSequence + 1; i++) {
+	for ( int i = nFirstColumn; i <= nLastColumn; i++ ) {
 		uint x = m_nMargin + i * m_nGridWidth;
 		int x1 = x;
 		int x2 = x + m_nGridWidth;
@@ -845,7 +894,7 @@ void SongEditor::createBackground()
 
 	p.setPen( pPref->getColorTheme()->m_songEditor_lineColor );
 	// horizontal lines
-	for (uint i = 0; i < nPatterns; i++) {
+	for ( int i = nFirstRow; i < nLastRow; i++ ) {
 		uint y = m_nGridHeight * i;
 
 		int y1 = y + 2;
@@ -858,33 +907,98 @@ void SongEditor::createBackground()
 
 	p.setPen( pPref->getColorTheme()->m_songEditor_backgroundColor );
 	// horizontal lines (erase..)
-	for (uint i = 0; i < nPatterns + 1; i++) {
+	for ( int i = nFirstRow; i <= nLastRow; i++ ) {
 		uint y = m_nGridHeight * i;
 
 		p.fillRect( 0, y, m_nMaxPatternSequence * m_nGridWidth, 2, pPref->getColorTheme()->m_songEditor_backgroundColor );
 		p.drawLine( 0, y + m_nGridHeight - 1, m_nMaxPatternSequence * m_nGridWidth, y + m_nGridHeight - 1 );
 	}
 
-	//~ celle
-	m_bSequenceChanged = true;
+	// Cells are ordered by column first.
+	for ( auto it = m_gridCells.lower_bound( QPoint( nFirstColumn, std::numeric_limits<int>::min() ) );
+		  it != m_gridCells.end() && it->first.x() <= nLastColumn; ++it ) {
+		if ( it->first.y() >= nFirstRow && it->first.y() <= nLastRow ) {
+			drawPattern( p, it->first.x(), it->first.y(), it->second.m_bDrawnVirtual,
+						 it->second.m_fWidth, it->second.m_bSelected );
+		}
+	}
+
+	return pixmap;
 }
 
-void SongEditor::cleanUp(){
+void SongEditor::invalidateTiles( const QRect& rect )
+{
+	for ( int nTileY = rect.top() / TILE_SIZE; nTileY <= rect.bottom() / TILE_SIZE; ++nTileY ) {
+		for ( int nTileX = rect.left() / TILE_SIZE; nTileX <= rect.right() / TILE_SIZE; ++nTileX ) {
+			m_tiles.erase( QPoint( nTileX, nTileY ) );
+		}
+	}
+}
 
-	delete m_pBackgroundPixmap;
-	delete m_pSequencePixmap;
+void SongEditor::invalidateCell( const QPoint& cell )
+{
+	if ( cell.x() < 0 || cell.y() < 0 ) {
+		return;
+	}
+	invalidateTiles( QRect( columnRowToXy( cell ), QSize( m_nGridWidth + 1, m_nGridHeight ) ) );
+}
+
+void SongEditor::evictTiles()
+{
+	if ( m_tiles.size() <= MAX_TILES ) {
+		return;
+	}
+
+	const QRect keptRect = visibleRegion().boundingRect()
+		.adjusted( -TILE_SIZE, -TILE_SIZE, TILE_SIZE, TILE_SIZE );
+	for ( auto it = m_tiles.begin(); it != m_tiles.end(); ) {
+		QRect tileRect( it->first.x() * TILE_SIZE, it->first.y() * TILE_SIZE, TILE_SIZE, TILE_SIZE );
+		if ( ! tileRect.intersects( keptRect ) ) {
+			it = m_tiles.erase( it );
+		} else {
+			++it;
+		}
+	}
 }
 
 // Update the GridCell representation.
 void SongEditor::updateGridCells() {
 
-	m_gridCells.clear();
 	std::shared_ptr<Song> pSong = Hydrogen::get_instance()->getSong();
 	PatternList *pPatternList = pSong->getPatternList();
 	std::vector< PatternList* > *pColumns = pSong->getPatternGroupVector();
 
+	int nOldColumns = m_columnSignatures.size();
+	for ( int nColumn = pColumns->size(); nColumn < nOldColumns; nColumn++ ) {
+		eraseGridColumn( nColumn );
+	}
+	m_columnSignatures.resize( pColumns->size(), 0 );
+
 	for ( int nColumn = 0; nColumn < pColumns->size(); nColumn++ ) {
 		PatternList *pColumn = (*pColumns)[nColumn];
+
+		size_t nSignature = 0;
+		auto hashPattern = [&]( Pattern* pPattern ) {
+			hashCombine( nSignature, pPatternList->index( pPattern ) );
+			hashCombine( nSignature, pPattern->get_length() );
+		};
+		for ( uint nPat = 0; nPat < pColumn->size(); nPat++ ) {
+			Pattern *pPattern = (*pColumn)[ nPat ];
+			hashPattern( pPattern );
+			for ( Pattern *pVPattern : *( pPattern->get_flattened_virtual_patterns() ) ) {
+				hashPattern( pVPattern );
+			}
+			// Separates the virtual patterns of subsequent patterns.
+			hashCombine( nSignature, std::numeric_limits<size_t>::max() );
+		}
+
+		if ( nColumn < nOldColumns && m_columnSignatures[ nColumn ] == nSignature ) {
+			continue;
+		}
+		m_columnSignatures[ nColumn ] = nSignature;
+
+		eraseGridColumn( nColumn );
+
 		int nMaxLength = pColumn->longest_pattern_length();
 
 		for ( uint nPat = 0; nPat < pColumn->size(); nPat++ ) {
@@ -894,14 +1008,34 @@ void SongEditor::updateGridCells() {
 			GridCell *pCell = &( m_gridCells[ QPoint( nColumn, y ) ] );
 			pCell->m_bActive = true;
 			pCell->m_fWidth = (float) pPattern->get_length() / nMaxLength;
+			invalidateCell( QPoint( nColumn, y ) );
 
 			for ( Pattern *pVPattern : *( pPattern->get_flattened_virtual_patterns() ) ) {
-				GridCell *pVCell = &( m_gridCells[ QPoint( nColumn, pPatternList->index( pVPattern ) ) ] );
+				QPoint vCell( nColumn, pPatternList->index( pVPattern ) );
+				GridCell *pVCell = &( m_gridCells[ vCell ] );
 				pVCell->m_bDrawnVirtual = true;
 				pVCell->m_fWidth = (float) pVPattern->get_length() / nMaxLength;
+				invalidateCell( vCell );
 			}
 		}
 	}
+
+	// The selection is part of the rendered cells.
+	for ( auto& it : m_gridCells ) {
+		bool bSelected = m_selection.isSelected( it.first );
+		if ( bSelected != it.second.m_bSelected ) {
+			it.second.m_bSelected = bSelected;
+			invalidateCell( it.first );
+		}
+	}
+}
+
+void SongEditor::eraseGridColumn( int nColumn ) {
+	auto it = m_gridCells.lower_bound( QPoint( nColumn, std::numeric_limits<int>::min() ) );
+	while ( it != m_gridCells.end() && it->first.x() == nColumn ) {
+		invalidateCell( it->first );
+		it = m_gridCells.erase( it );
+	}
 }
 
 // Return grid offset (in cell coordinate space) of moving selection
@@ -921,31 +1055,8 @@ QPoint SongEditor::movingGridOffset( ) const {
 }
 
 
-void SongEditor::drawSequence()
+void SongEditor::drawPattern( QPainter& p, int nPos, int nNumber, bool bInvertColour, double fWidth, bool bIsSelected )
 {
-	QPainter p;
-	p.begin( m_pSequencePixmap );
-	p.drawPixmap( rect(), *m_pBackgroundPixmap, rect() );
-	p.end();
-
-	std::shared_ptr<Song> song = Hydrogen::get_instance()->getSong();
-	PatternList *patList = song->getPatternList();
-	std::vector<PatternList*>* pColumns = song->getPatternGroupVector();
-	uint listLength = patList->size();
-
-	updateGridCells();
-
-	// Draw using GridCells representation
-	for ( auto it : m_gridCells ) {
-		drawPattern( it.first.x(), it.first.y(), it.second.m_bDrawnVirtual, it.second.m_fWidth );
-	}
-}
-
-
-
-void SongEditor::drawPattern( int nPos, int nNumber, bool bInvertColour, double fWidth )
-{
-	QPainter p( m_pSequencePixmap );
 	/*
 	 * The default color of the cubes in rgb is 97,167,251.
 	 */
@@ -984,8 +1095,6 @@ void SongEditor::drawPattern( int nPos, int nNumber, bool bInvertColour, double
 		patternColor = patternColor.darker(200);
 	}
 
-	bool bIsSelected = m_selection.isSelected( QPoint( nPos, nNumber ) );
-
 	if ( bIsSelected ) {
 		patternColor = patternColor.darker( 130 );
 	}
@@ -1033,6 +1142,7 @@ void SongEditor::clearThePatternSequenceVector( QString filename )
 		delete pPatternList;
 	}
 	pPatternGroupsVect->clear();
+	song->updateColumnIndex();
 
 	song->setIsModified( true );
 	m_pAudioEngine->unlock();
@@ -1052,6 +1162,7 @@ void SongEditor::onPreferencesChanged( H2Core::Preferences::Changes changes ) {
 
 	if ( changes & ( H2Core::Preferences::Changes::Colors |
 					 H2Core::Preferences::Changes::AppearanceTab ) ) {
+		m_tiles.clear();
 		createBackground();
 		update();
 	}
@@ -1614,6 +1725,7 @@ void SongEditorPatternList::deletePatternFromList( QString patternFilename, QStr
 		i++;
 
 	}
+	song->updateColumnIndex();
 
 	//Lock because PatternList will be modified
 	m_pAudioEngine->lock( RIGHT_HERE );
@@ -1779,6 +1891,7 @@ void SongEditorPatternList::fillRangeWithPattern( FillRange* pRange, int nPatter
 				break;
 			}
 		}
+	pSong->updateColumnIndex();
 	m_pAudioEngine->unlock();
 
 
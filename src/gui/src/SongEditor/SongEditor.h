@@ -23,6 +23,7 @@
 #ifndef SONG_EDITOR_H
 #define SONG_EDITOR_H
 
+#include <map>
 #include <vector>
 
 #include <unistd.h>
@@ -71,15 +72,18 @@ class SongEditor :  public QWidget,  public H2Core::Object<SongEditor>, public S
 			bool m_bActive;
 			bool m_bDrawnVirtual;
 			float m_fWidth;
+			/** Whether the cell was selected when it was drawn.*/
+			bool m_bSelected;
 		};
 	
 	public:
 		SongEditor( QWidget *parent, QScrollArea *pScrollView, SongEditorPanel *pSongEditorPanel );
 		~SongEditor();
 
+		/** Adapts the size of the widget to the number of patterns
+			and invalidates all tiles in case the layout of the grid
+			changed.*/
 		void createBackground();
-		
-		void cleanUp();
 
 		int getGridWidth ();
 		void setGridWidth( uint width);
@@ -129,22 +133,38 @@ class SongEditor :  public QWidget,  public H2Core::Object<SongEditor>, public S
 		//! set at the start of the draw gesture.
 		bool 					m_bDrawingActiveCell;
 
-		//! Pattern sequence or selection has changed, so must be redrawn.
+		//! Pattern sequence or selection has changed, so #m_gridCells must be synchronized.
 		bool 					m_bSequenceChanged;
 
 		QMenu *					m_pPopupMenu;
 
 
-		//! @name Background pixmap caching
+		//! @name Tile caching
 		//!
 		//! To make painting the song editor sequence grid more efficient, the drawing uses multiple levels of lazy painting.
-		//!   * The grid background pixmap is only updated when the size of the pattern grid changes.
-		//!   * The sequence pixmap are only updated when cells are added/removed or selections change
-		//!       * the cached grid background pixmap is used when repainting the pattern
-		//!   * selections and moving cells are painted on top of the cached sequence pixmap
+		//!   * The grid background and the cells are rendered into tiles of #TILE_SIZE pixels. Tiles are only
+		//!     created when they intersect the area to be painted.
+		//!   * All tiles are dropped when the layout of the grid changes. Adding, removing, or (de)selecting
+		//!     cells only drops the tiles touched by them.
+		//!   * selections and moving cells are painted on top of the cached tiles
+		//! @{
+		static constexpr int	TILE_SIZE = 256;
+		//! Tiles kept in #m_tiles before those far from the visible area are dropped.
+		static constexpr int	MAX_TILES = 128;
+		std::map< QPoint, QPixmap > m_tiles;
+		//! Layout of the grid #m_tiles were rendered with.
 		//! @{
-		QPixmap *				m_pBackgroundPixmap;
-		QPixmap *				m_pSequencePixmap;
+		unsigned				m_nTileGridWidth;
+		unsigned				m_nTileGridHeight;
+		int						m_nTilePatterns;
+		//! @}
+
+		QPixmap createTile( const QPoint& tile );
+		//! Drops all tiles intersecting @a rect (in widget coordinates).
+		void invalidateTiles( const QRect& rect );
+		void invalidateCell( const QPoint& cell );
+		//! Drops tiles far from the visible area in case #MAX_TILES is exceeded.
+		void evictTiles();
 		//! @}
 
 		const int m_nMargin = 10;
@@ -195,13 +215,18 @@ class SongEditor :  public QWidget,  public H2Core::Object<SongEditor>, public S
     	void togglePatternActive( int nColumn, int nRow );
 		void setPatternActive( int nColumn, int nRow, bool bActivate );
 
-		void drawSequence();
-  
-		void drawPattern( int pos, int number, bool invertColour, double width );
+		void drawPattern( QPainter& p, int pos, int number, bool invertColour, double width, bool bIsSelected );
 		void drawFocus( QPainter& painter );
 
 		std::map< QPoint, GridCell > m_gridCells;
+		//! Synchronizes #m_gridCells with the pattern sequence of the song. Only columns whose content
+		//! changed since the last call are recomputed and only tiles of modified cells are invalidated.
 		void updateGridCells();
+		//! Removes all cells of column @a nColumn from #m_gridCells.
+		void eraseGridColumn( int nColumn );
+		//! Hash of the patterns (and their virtual patterns) in each column of the sequence used to
+		//! detect modified columns in updateGridCells().
+		std::vector<size_t> m_columnSignatures;
 		bool m_bEntered;
 public:
 
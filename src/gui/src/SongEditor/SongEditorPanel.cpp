@@ -399,15 +399,19 @@ void SongEditorPanel::updatePlaybackFaderPeaks()
 	float fOldPeak_L = m_pPlaybackTrackFader->getPeak_L();
 	float fOldPeak_R = m_pPlaybackTrackFader->getPeak_R();
 	
-	float fNewPeak_L = pInstrument->get_peak_l();
-	pInstrument->set_peak_l( 0.0f );	// reset instrument peak
+	const Meter::Snapshot levels = pInstrument->getMeter()->getSnapshot();
+	pInstrument->getMeter()->reset();	// reset instrument levels
 
-	float fNewPeak_R = pInstrument->get_peak_r();
-	pInstrument->set_peak_r( 0.0f );	// reset instrument peak
+	float fNewPeak_L = levels.fPeak_L;
+	float fNewPeak_R = levels.fPeak_R;
+	float fNewRms_L = levels.fRms_L;
+	float fNewRms_R = levels.fRms_R;
 
 	if (!bShowPeaks) {
 		fNewPeak_L = 0.0f;
 		fNewPeak_R = 0.0f;
+		fNewRms_L = 0.0f;
+		fNewRms_R = 0.0f;
 	}
 
 	if ( fNewPeak_L >= fOldPeak_L) {	// LEFT peak
@@ -422,6 +426,7 @@ void SongEditorPanel::updatePlaybackFaderPeaks()
 	else {
 		m_pPlaybackTrackFader->setPeak_R( fOldPeak_R / fallOff );
 	}
+	m_pPlaybackTrackFader->setRms( fNewRms_L, fNewRms_R );
 }
 
 void SongEditorPanel::vScrollTo( int value )
@@ -463,8 +468,6 @@ void SongEditorPanel::updateAll()
 	m_pPatternList->createBackground();
 	m_pPatternList->update();
 
-	m_pSongEditor->cleanUp();
-
 	m_pSongEditor->createBackground();
 	m_pSongEditor->update();
 
@@ -230,7 +230,7 @@ void FileBrowser::on_fileList_ItemActivated( QListWidgetItem* item )
 			if ( !fileInfo.isDir() ) {
 
 				// FIXME: evitare di caricare il sample, visualizzare solo le info del file
-				auto pNewSample = Sample::load( fileInfo.absoluteFilePath() );
+				auto pNewSample = Sample::load( fileInfo.absoluteFilePath(), false );
 				if ( pNewSample != nullptr ) {
 					updateFileInfo( fileInfo.absoluteFilePath(), pNewSample->get_sample_rate(), pNewSample->get_size() );
 					Hydrogen::get_instance()->getAudioEngine()->getSampler()->preview_sample(pNewSample, 192);
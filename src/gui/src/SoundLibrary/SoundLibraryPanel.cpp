@@ -346,7 +346,9 @@ void SoundLibraryPanel::on_DrumkitList_itemActivated( QTreeWidgetItem * item, in
 		QString sDrumkitName = item->parent()->text(0);
 		INFOLOG( QString(sDrumkitName) + ", instr:" + sInstrName );
 
-		auto pInstrument = Instrument::load_instrument( sDrumkitName, sInstrName );
+		// Previews are not worth storing in the SampleCache.
+		auto pInstrument = Instrument::load_instrument( sDrumkitName, sInstrName,
+														Filesystem::Lookup::stacked, false );
 		pInstrument->set_muted( false );
 
 		Hydrogen::get_instance()->getAudioEngine()->getSampler()->preview_instrument( pInstrument );
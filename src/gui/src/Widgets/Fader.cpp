@@ -30,6 +30,8 @@
 #include <QtGui>
 #include <QtWidgets>
 
+#include <algorithm>
+
 #include <core/Globals.h>
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
@@ -46,6 +48,8 @@ Fader::Fader( QWidget *pParent, Type type, QString sBaseTooltip, bool bUseIntSte
 	, m_bWithoutKnob( bWithoutKnob )
 	, m_fPeakValue_L( 0.01f )
 	, m_fPeakValue_R( 0.01f )
+	, m_fRmsValue_L( 0.01f )
+	, m_fRmsValue_R( 0.01f )
 	, m_fMinPeak( 0.01f )
 	, m_fMaxPeak( 1.0 )
 {
@@ -194,6 +198,7 @@ void Fader::paintEvent( QPaintEvent *ev)
 	QColor colorGradientNormal( Qt::green );
 	QColor colorGradientWarning( Qt::yellow );
 	QColor colorGradientDanger( Qt::red );
+	QColor colorRms( Qt::white );
 
 	// If the mouse is placed on the widget but the user hasn't
 	// clicked it yet, the highlight will be done more transparent to
@@ -224,7 +229,8 @@ void Fader::paintEvent( QPaintEvent *ev)
 
 	if ( m_bIsActive ) {
 		float fFaderTopLeftX_L, fFaderTopLeftY_L, fFaderTopLeftX_R,
-			fFaderTopLeftY_R, fFaderWidth, fFaderHeight, fPeak_L, fPeak_R;
+			fFaderTopLeftY_R, fFaderWidth, fFaderHeight, fPeak_L, fPeak_R,
+			fRms_L, fRms_R;
 
 		if ( m_type == Type::Master ) {
 			fFaderTopLeftX_L = 1;
@@ -235,6 +241,8 @@ void Fader::paintEvent( QPaintEvent *ev)
 			fFaderHeight = 186;
 			fPeak_L = ( m_fPeakValue_L - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
 			fPeak_R = ( m_fPeakValue_R - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
+			fRms_L = ( m_fRmsValue_L - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
+			fRms_R = ( m_fRmsValue_R - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
 		} else if ( m_type == Type::Vertical ) {
 			fFaderTopLeftX_L = 1.5;
 			fFaderTopLeftY_L = 2;
@@ -244,6 +252,8 @@ void Fader::paintEvent( QPaintEvent *ev)
 			fFaderHeight = 6.5;
 			fPeak_L = ( m_fPeakValue_L - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderWidth;
 			fPeak_R = ( m_fPeakValue_R - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderWidth;
+			fRms_L = ( m_fRmsValue_L - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderWidth;
+			fRms_R = ( m_fRmsValue_R - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderWidth;
 		} else {
 			fFaderTopLeftX_L = 1.5;
 			fFaderTopLeftY_L = 1.7;
@@ -253,6 +263,8 @@ void Fader::paintEvent( QPaintEvent *ev)
 			fFaderHeight = 114;
 			fPeak_L = ( m_fPeakValue_L - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
 			fPeak_R = ( m_fPeakValue_R - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
+			fRms_L = ( m_fRmsValue_L - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
+			fRms_R = ( m_fRmsValue_R - m_fMinPeak ) / ( m_fMaxPeak - m_fMinPeak ) * fFaderHeight;
 		}
 
 		QLinearGradient gradient;
@@ -281,6 +293,17 @@ void Fader::paintEvent( QPaintEvent *ev)
 			painter.fillRect( QRectF( fFaderTopLeftX_L, fFaderTopLeftY_L + fFaderHeight - fPeak_L, fFaderWidth, fPeak_L ), QBrush( gradient ) );
 			painter.fillRect( QRectF( fFaderTopLeftX_R, fFaderTopLeftY_R + fFaderHeight - fPeak_R, fFaderWidth, fPeak_R ), QBrush( gradient ) );
 		}
+
+		// RMS markers
+		if ( m_fRmsValue_L > m_fMinPeak || m_fRmsValue_R > m_fMinPeak ) {
+			if ( m_type == Type::Vertical ) {
+				painter.fillRect( QRectF( fFaderTopLeftX_L + fRms_L - 1, fFaderTopLeftY_L, 1, fFaderHeight ), colorRms );
+				painter.fillRect( QRectF( fFaderTopLeftX_R + fRms_R - 1, fFaderTopLeftY_R, 1, fFaderHeight ), colorRms );
+			} else {
+				painter.fillRect( QRectF( fFaderTopLeftX_L, fFaderTopLeftY_L + fFaderHeight - fRms_L, fFaderWidth, 1 ), colorRms );
+				painter.fillRect( QRectF( fFaderTopLeftX_R, fFaderTopLeftY_R + fFaderHeight - fRms_R, fFaderWidth, 1 ), colorRms );
+			}
+		}
 	}
 	
 	// Draws the outline of the fader on top of the colors indicating
@@ -369,6 +392,18 @@ void Fader::setPeak_R( float fPeak )
 	}
 }
 
+void Fader::setRms( float fRms_L, float fRms_R )
+{
+	fRms_L = std::clamp( fRms_L, m_fMinPeak, m_fMaxPeak );
+	fRms_R = std::clamp( fRms_R, m_fMinPeak, m_fMaxPeak );
+
+	if ( m_fRmsValue_L != fRms_L || m_fRmsValue_R != fRms_R ) {
+		m_fRmsValue_L = fRms_L;
+		m_fRmsValue_R = fRms_R;
+		update();
+	}
+}
+
 void Fader::setMaxPeak( float fMax )
 {
 	if ( m_fMaxPeak == fMax ) {
@@ -64,6 +64,10 @@ public:
 	void setPeak_R( float peak );
 	float getPeak_R() const {	return m_fPeakValue_R;	}
 
+	/** Sets the RMS levels drawn as markers on top of the peak
+		bars.*/
+	void setRms( float fRms_L, float fRms_R );
+
 public slots:
 	void onPreferencesChanged( H2Core::Preferences::Changes changes );
 
@@ -75,6 +79,8 @@ private:
 
 	float m_fPeakValue_L;
 	float m_fPeakValue_R;
+	float m_fRmsValue_L;
+	float m_fRmsValue_R;
 	float m_fMinPeak;
 	float m_fMaxPeak;
 	
@@ -73,3 +73,26 @@ void ADSRTest::testRelease()
 	/* Idle */
 	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, m_adsr->get_value( 2.0 ), delta );
 }
+
+void ADSRTest::testFastRelease()
+{
+	auto pADSR = std::make_shared<ADSR>( 0, 0, 0.8, 10000 );
+	pADSR->get_value( 1.0 );
+	pADSR->get_value( 1.0 );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.8, pADSR->get_current_value(), delta );
+
+	/* Regular release started but cut short */
+	pADSR->release();
+	pADSR->get_value( 1000.0 );
+	const float fValue = pADSR->get_value( 1.0 );
+	CPPUNIT_ASSERT( fValue < 0.8 );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( fValue, pADSR->fast_release(), delta );
+
+	/* Faded out within the shortest release */
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( fValue, pADSR->get_value( ADSR::FAST_RELEASE / 2 ), delta );
+	CPPUNIT_ASSERT( ! pADSR->is_idle() );
+	pADSR->get_value( ADSR::FAST_RELEASE / 2 + 1 );
+	CPPUNIT_ASSERT( pADSR->is_idle() );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, pADSR->get_value( 1.0 ), delta );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, pADSR->fast_release(), delta );
+}
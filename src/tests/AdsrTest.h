@@ -33,6 +33,7 @@ class ADSRTest : public CppUnit::TestCase {
 	CPPUNIT_TEST_SUITE( ADSRTest );
 	CPPUNIT_TEST( testAttack );
 	CPPUNIT_TEST( testRelease );
+	CPPUNIT_TEST( testFastRelease );
 	CPPUNIT_TEST_SUITE_END();
 
 	private:
@@ -43,6 +44,7 @@ class ADSRTest : public CppUnit::TestCase {
 	
 	void testAttack();
 	void testRelease();
+	void testFastRelease();
 };
 
 #endif
@@ -0,0 +1,168 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Sampler/BlockKernels.h>
+
+#include <vector>
+
+using namespace H2Core;
+
+class BlockKernelsTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( BlockKernelsTest );
+	CPPUNIT_TEST( testResample );
+	CPPUNIT_TEST( testCompactAndMono );
+	CPPUNIT_TEST( testMixAndPeak );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Straight forward per-frame interpolation the kernels are
+		checked against.*/
+	float interpolate( Interpolation::InterpolateMode mode, const std::vector<float>& data, double fPos )
+	{
+		int nFrames = data.size();
+		int nPos = static_cast<int>( fPos );
+		double fMu = fPos - nPos;
+		if ( nPos + 1 >= nFrames ) {
+			return 0.0;
+		}
+		float y0 = nPos > 0 ? data[ nPos - 1 ] : 0.0;
+		float y3 = nPos + 2 < nFrames ? data[ nPos + 2 ] : 0.0;
+		switch ( mode ) {
+		case Interpolation::InterpolateMode::Linear:
+			return Interpolation::linear_Interpolate( data[ nPos ], data[ nPos + 1 ], fMu );
+		case Interpolation::InterpolateMode::Cosine:
+			return Interpolation::cosine_Interpolate( data[ nPos ], data[ nPos + 1 ], fMu );
+		case Interpolation::InterpolateMode::Third:
+			return Interpolation::third_Interpolate( y0, data[ nPos ], data[ nPos + 1 ], y3, fMu );
+		case Interpolation::InterpolateMode::Cubic:
+			return Interpolation::cubic_Interpolate( y0, data[ nPos ], data[ nPos + 1 ], y3, fMu );
+		case Interpolation::InterpolateMode::Hermite:
+			return Interpolation::hermite_Interpolate( y0, data[ nPos ], data[ nPos + 1 ], y3, fMu );
+		}
+		return 0.0;
+	}
+
+	void testResample()
+	{
+		const int nInFrames = 97;
+		std::vector<float> data_L( nInFrames ), data_R( nInFrames );
+		for ( int i = 0; i < nInFrames; ++i ) {
+			data_L[ i ] = ( i % 7 ) * 0.1 - 0.3;
+			data_R[ i ] = ( i % 5 ) * -0.2 + 0.4;
+		}
+
+		const Interpolation::InterpolateMode modes[] = {
+			Interpolation::InterpolateMode::Linear,
+			Interpolation::InterpolateMode::Cosine,
+			Interpolation::InterpolateMode::Third,
+			Interpolation::InterpolateMode::Cubic,
+			Interpolation::InterpolateMode::Hermite };
+
+		// Covers the start and the end of the input as well as
+		// steps both below and above unity.
+		const double positions[] = { 0.0, 0.5, 1.25, 40.7, 90.3 };
+		const double steps[] = { 0.37, 1.0, 1.5946, 3.1 };
+		const int nFrames = 64;
+
+		for ( auto mode : modes ) {
+			for ( double fPos : positions ) {
+				for ( double fStep : steps ) {
+					std::vector<float> out_L( nFrames ), out_R( nFrames );
+					BlockKernels::resample( mode, data_L.data(), data_R.data(), nInFrames,
+											fPos, fStep, out_L.data(), out_R.data(), nFrames );
+					for ( int i = 0; i < nFrames; ++i ) {
+						CPPUNIT_ASSERT_DOUBLES_EQUAL( interpolate( mode, data_L, fPos + i * fStep ),
+													  out_L[ i ], 1e-6 );
+						CPPUNIT_ASSERT_DOUBLES_EQUAL( interpolate( mode, data_R, fPos + i * fStep ),
+													  out_R[ i ], 1e-6 );
+					}
+				}
+			}
+		}
+	}
+
+	void testCompactAndMono()
+	{
+		const int nInFrames = 53;
+		std::vector<int16_t> data16_L( nInFrames ), data16_R( nInFrames );
+		std::vector<float> data_L( nInFrames ), data_R( nInFrames );
+		for ( int i = 0; i < nInFrames; ++i ) {
+			data16_L[ i ] = ( i % 7 ) * 4000 - 12000;
+			data16_R[ i ] = ( i % 5 ) * -8000 + 16000;
+			data_L[ i ] = data16_L[ i ] / 32768.0;
+			data_R[ i ] = data16_R[ i ] / 32768.0;
+		}
+
+		std::vector<float> converted( nInFrames );
+		BlockKernels::convert( data16_L.data(), converted.data(), nInFrames );
+		for ( int i = 0; i < nInFrames; ++i ) {
+			CPPUNIT_ASSERT_EQUAL( data_L[ i ], converted[ i ] );
+		}
+
+		const int nFrames = 40;
+		std::vector<float> out_L( nFrames ), out_R( nFrames );
+		std::vector<float> ref_L( nFrames ), ref_R( nFrames );
+		BlockKernels::resample( Interpolation::InterpolateMode::Hermite,
+								data16_L.data(), data16_R.data(), nInFrames,
+								0.5, 1.3, out_L.data(), out_R.data(), nFrames );
+		BlockKernels::resample( Interpolation::InterpolateMode::Hermite,
+								data_L.data(), data_R.data(), nInFrames,
+								0.5, 1.3, ref_L.data(), ref_R.data(), nFrames );
+		for ( int i = 0; i < nFrames; ++i ) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( ref_L[ i ], out_L[ i ], 1e-6 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( ref_R[ i ], out_R[ i ], 1e-6 );
+		}
+
+		// Identical channels are interpolated once.
+		BlockKernels::resample( Interpolation::InterpolateMode::Cubic,
+								data_L.data(), data_L.data(), nInFrames,
+								3.2, 0.7, out_L.data(), out_R.data(), nFrames );
+		BlockKernels::resample( Interpolation::InterpolateMode::Cubic,
+								data_L.data(), data_R.data(), nInFrames,
+								3.2, 0.7, ref_L.data(), ref_R.data(), nFrames );
+		for ( int i = 0; i < nFrames; ++i ) {
+			CPPUNIT_ASSERT_EQUAL( ref_L[ i ], out_L[ i ] );
+			CPPUNIT_ASSERT_EQUAL( ref_L[ i ], out_R[ i ] );
+		}
+	}
+
+	void testMixAndPeak()
+	{
+		const int nFrames = 21;
+		std::vector<float> in( nFrames ), out( nFrames, 1.0 );
+		for ( int i = 0; i < nFrames; ++i ) {
+			in[ i ] = i - 10;
+		}
+
+		BlockKernels::mix( in.data(), 0.5, out.data(), nFrames );
+		for ( int i = 0; i < nFrames; ++i ) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0 + ( i - 10 ) * 0.5, out[ i ], 1e-6 );
+		}
+
+		BlockKernels::scale( in.data(), 2.0, nFrames );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 20.0, BlockKernels::peak( in.data(), nFrames, 0.0 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 25.0, BlockKernels::peak( in.data(), nFrames, 25.0 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( -20.0, BlockKernels::peak( in.data(), 1, -30.0 ), 1e-6 );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BlockKernelsTest );
@@ -0,0 +1,69 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Sampler/BusBuffers.h>
+
+#include <cstdint>
+
+using namespace H2Core;
+
+class BusBuffersTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( BusBuffersTest );
+	CPPUNIT_TEST( testLayout );
+	CPPUNIT_TEST( testClear );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testLayout()
+	{
+		BusBuffers busses( 4 );
+		CPPUNIT_ASSERT_EQUAL( 4, busses.getBusCount() );
+		CPPUNIT_ASSERT( BusBuffers::STRIDE >= MAX_BUFFER_SIZE );
+
+		for ( int nBus = 0; nBus < busses.getBusCount(); ++nBus ) {
+			CPPUNIT_ASSERT_EQUAL( (uintptr_t) 0, reinterpret_cast<uintptr_t>( busses.getBuffer_L( nBus ) ) % BusBuffers::ALIGNMENT );
+			CPPUNIT_ASSERT_EQUAL( (uintptr_t) 0, reinterpret_cast<uintptr_t>( busses.getBuffer_R( nBus ) ) % BusBuffers::ALIGNMENT );
+			// All channels are adjacent.
+			CPPUNIT_ASSERT( busses.getBuffer_R( nBus ) == busses.getBuffer_L( nBus ) + BusBuffers::STRIDE );
+			CPPUNIT_ASSERT( busses.getBuffer_L( nBus ) == busses.getBuffer_L( 0 ) + 2 * nBus * BusBuffers::STRIDE );
+			CPPUNIT_ASSERT_EQUAL( 0.0f, busses.getBuffer_R( nBus )[ MAX_BUFFER_SIZE - 1 ] );
+		}
+	}
+
+	void testClear()
+	{
+		BusBuffers busses( 2 );
+		for ( int i = 0; i < 10; ++i ) {
+			busses.getBuffer_L( 1 )[ i ] = 1.0;
+			busses.getBuffer_R( 1 )[ i ] = 1.0;
+			busses.getBuffer_L( 0 )[ i ] = 1.0;
+		}
+
+		busses.clear( 1, 8 );
+		CPPUNIT_ASSERT_EQUAL( 0.0f, busses.getBuffer_L( 1 )[ 7 ] );
+		CPPUNIT_ASSERT_EQUAL( 0.0f, busses.getBuffer_R( 1 )[ 0 ] );
+		CPPUNIT_ASSERT_EQUAL( 1.0f, busses.getBuffer_R( 1 )[ 8 ] );
+		CPPUNIT_ASSERT_EQUAL( 1.0f, busses.getBuffer_L( 0 )[ 0 ] );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BusBuffersTest );
@@ -0,0 +1,116 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/EventQueue.h>
+
+#include <vector>
+
+using namespace H2Core;
+
+class EventQueueTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( EventQueueTest );
+	CPPUNIT_TEST( testPopEvents );
+	CPPUNIT_TEST( testOverflow );
+	CPPUNIT_TEST( testCriticalEvents );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Drains the queue and returns the values of all events of
+		type EVENT_UPDATE_SONG_EDITOR. Other events might be pushed
+		by the audio engine in the meantime.*/
+	std::vector<int> drain()
+	{
+		std::vector<int> values;
+		Event events[ MAX_EVENTS ];
+		int nEvents;
+		while ( ( nEvents = EventQueue::get_instance()->pop_events( events, MAX_EVENTS ) ) > 0 ) {
+			for ( int i = 0; i < nEvents; ++i ) {
+				if ( events[ i ].type == EVENT_UPDATE_SONG_EDITOR ) {
+					values.push_back( events[ i ].value );
+				}
+			}
+		}
+		return values;
+	}
+
+	void testPopEvents()
+	{
+		EventQueue* pQueue = EventQueue::get_instance();
+		drain();
+
+		for ( int i = 0; i < 10; ++i ) {
+			pQueue->push_event( EVENT_UPDATE_SONG_EDITOR, i );
+		}
+		std::vector<int> values = drain();
+		CPPUNIT_ASSERT_EQUAL( 10, (int) values.size() );
+		for ( int i = 0; i < 10; ++i ) {
+			CPPUNIT_ASSERT_EQUAL( i, values[ i ] );
+		}
+		CPPUNIT_ASSERT_EQUAL( EVENT_NONE, pQueue->pop_event().type );
+	}
+
+	void testOverflow()
+	{
+		EventQueue* pQueue = EventQueue::get_instance();
+		drain();
+
+		const unsigned int nDropped = pQueue->get_dropped_event_count();
+		for ( int i = 0; i < MAX_EVENTS + 10; ++i ) {
+			pQueue->push_event( EVENT_UPDATE_SONG_EDITOR, i );
+		}
+		CPPUNIT_ASSERT( pQueue->get_dropped_event_count() >= nDropped + 10 );
+
+		// Unread events are kept and the most recent ones dropped.
+		std::vector<int> values = drain();
+		CPPUNIT_ASSERT( ! values.empty() );
+		for ( int i = 0; i < values.size(); ++i ) {
+			CPPUNIT_ASSERT_EQUAL( i, values[ i ] );
+		}
+	}
+
+	void testCriticalEvents()
+	{
+		EventQueue* pQueue = EventQueue::get_instance();
+		drain();
+
+		for ( int i = 0; i < MAX_EVENTS; ++i ) {
+			pQueue->push_event( EVENT_UPDATE_SONG_EDITOR, i );
+		}
+		// The reserved slots must still be available.
+		pQueue->push_event( EVENT_PROGRESS, 100 );
+
+		bool bFound = false;
+		Event events[ MAX_EVENTS ];
+		int nEvents;
+		while ( ( nEvents = pQueue->pop_events( events, MAX_EVENTS ) ) > 0 ) {
+			for ( int i = 0; i < nEvents; ++i ) {
+				if ( events[ i ].type == EVENT_PROGRESS &&
+					 events[ i ].value == 100 ) {
+					bFound = true;
+				}
+			}
+		}
+		CPPUNIT_ASSERT( bFound );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( EventQueueTest );
@@ -41,6 +41,8 @@
 #include <core/Basics/Song.h>
 #include <core/Basics/Playlist.h>
 #include <core/Smf/SMF.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Timeline.h>
 #include "TestHelper.h"
 #include "assertions/File.h"
 #include "assertions/AudioFile.h"
@@ -52,23 +54,16 @@ using namespace H2Core;
 
 /**
  * \brief Export Hydrogon song to audio file
- * \param songFile Path to Hydrogen file
+ * \param pSong Song to export
  * \param fileName Output file name
  **/
-void exportSong( const QString &songFile, const QString &fileName )
+void exportSong( std::shared_ptr<Song> pSong, const QString &fileName )
 {
 	auto t0 = std::chrono::high_resolution_clock::now();
 
 	Hydrogen *pHydrogen = Hydrogen::get_instance();
 	EventQueue *pQueue = EventQueue::get_instance();
 
-	std::shared_ptr<Song> pSong = Song::load( songFile );
-	CPPUNIT_ASSERT( pSong != nullptr );
-	
-	if( !pSong ) {
-		return;
-	}
-	
 	pHydrogen->setSong( pSong );
 
 	InstrumentList *pInstrumentList = pSong->getInstrumentList();
@@ -80,13 +75,15 @@ void exportSong( const QString &songFile, const QString &fileName )
 	pHydrogen->startExportSong( fileName );
 
 	bool done = false;
+	Event events[ MAX_EVENTS ];
 	while ( ! done ) {
-		Event event = pQueue->pop_event();
-
-		if (event.type == EVENT_PROGRESS && event.value == 100) {
-			done = true;
+		const int nEvents = pQueue->pop_events( events, MAX_EVENTS );
+		for ( int i = 0; i < nEvents; ++i ) {
+			if ( events[ i ].type == EVENT_PROGRESS && events[ i ].value == 100 ) {
+				done = true;
+			}
 		}
-		else {
+		if ( nEvents == 0 ) {
 			usleep(100 * 1000);
 		}
 	}
@@ -97,6 +94,77 @@ void exportSong( const QString &songFile, const QString &fileName )
 	___INFOLOG( QString("Audio export took %1 seconds").arg(t) );
 }
 
+/**
+ * \brief Export Hydrogon song to audio file
+ * \param songFile Path to Hydrogen file
+ * \param fileName Output file name
+ **/
+void exportSong( const QString &songFile, const QString &fileName )
+{
+	std::shared_ptr<Song> pSong = Song::load( songFile );
+	CPPUNIT_ASSERT( pSong != nullptr );
+	
+	if( !pSong ) {
+		return;
+	}
+
+	exportSong( pSong, fileName );
+}
+
+/**
+ * \brief Create a song playing a single note of a Rubber Band
+ * instrument
+ * \param bLeadingEmptyColumn Whether the note is played in the
+ *   second column instead of the first one
+ **/
+std::shared_ptr<Song> createRubberbandSong( bool bLeadingEmptyColumn )
+{
+	std::shared_ptr<Song> pSong = Song::load( H2TEST_FILE("functional/test.h2song") );
+	CPPUNIT_ASSERT( pSong != nullptr );
+
+	Sample::Rubberband rubberband;
+	rubberband.use = true;
+	auto pInstrument = pSong->getInstrumentList()->get( 0 );
+	for ( auto pComponent : *pInstrument->get_components() ) {
+		for ( int i = 0; i < InstrumentComponent::getMaxLayers(); ++i ) {
+			auto pLayer = pComponent->get_layer( i );
+			if ( pLayer == nullptr || pLayer->get_sample() == nullptr ) {
+				continue;
+			}
+			auto pSample = pLayer->get_sample();
+			pLayer->set_sample( Sample::load( pSample->get_filepath(), pSample->get_loops(),
+											  rubberband, *pSample->get_velocity_envelope(),
+											  *pSample->get_pan_envelope() ) );
+		}
+	}
+
+	Pattern* pEmptyPattern = new Pattern( "Empty" );
+	Pattern* pNotePattern = new Pattern( "Note" );
+	pNotePattern->insert_note( new Note( pInstrument, 0, 1.0, 0.0, -1, 0 ) );
+	pSong->getPatternList()->add( pEmptyPattern );
+	pSong->getPatternList()->add( pNotePattern );
+
+	std::vector<PatternList*>* pColumns = pSong->getPatternGroupVector();
+	for ( auto pColumn : *pColumns ) {
+		pColumn->clear();
+		delete pColumn;
+	}
+	pColumns->clear();
+	if ( bLeadingEmptyColumn ) {
+		pColumns->push_back( new PatternList() );
+		pColumns->back()->add( pEmptyPattern );
+	}
+	pColumns->push_back( new PatternList() );
+	pColumns->back()->add( pNotePattern );
+	pSong->updateColumnIndex();
+
+	// The export has to stretch all samples to the tempo of the
+	// timeline.
+	Hydrogen::get_instance()->getTimeline()->addTempoMarker( 0, 90 );
+
+	return pSong;
+}
+
 /**
  * \brief Export Hydrogon song to MIDI file
  * \param songFile Path to Hydrogen file
@@ -127,6 +195,7 @@ class FunctionalTest : public CppUnit::TestCase {
 	CPPUNIT_TEST( testExportVelocityAutomationAudio );
 	CPPUNIT_TEST( testExportVelocityAutomationMIDISMF0 );
 	CPPUNIT_TEST( testExportVelocityAutomationMIDISMF1 );
+	CPPUNIT_TEST( testExportRubberbandAudio );
 	// CPPUNIT_TEST( testPrintMessages ); // MANUAL
 	CPPUNIT_TEST_SUITE_END();
 
@@ -311,5 +380,31 @@ class FunctionalTest : public CppUnit::TestCase {
 		Filesystem::rm( outFile );
 	}
 
+	void testExportRubberbandAudio()
+	{
+#ifdef H2CORE_HAVE_RUBBERBAND
+		Preferences* pPref = Preferences::get_instance();
+		const bool bOldUseTimelineBpm = pPref->getUseTimelineBpm();
+		const int nOldRubberBandBatchMode = pPref->getRubberBandBatchMode();
+		pPref->setUseTimelineBpm( true );
+		pPref->setRubberBandBatchMode( 1 );
+
+		// The Rubber Band instrument is used for the first time in
+		// the second column. It has to sound the same way as in a
+		// song starting with it.
+		auto refFile = Filesystem::tmp_file_path("rubberband.ref.wav");
+		auto outFile = Filesystem::tmp_file_path("rubberband.wav");
+		exportSong( createRubberbandSong( false ), refFile );
+		exportSong( createRubberbandSong( true ), outFile );
+		H2TEST_ASSERT_AUDIO_FILE_TAIL_EQUAL( refFile, outFile );
+		Filesystem::rm( refFile );
+		Filesystem::rm( outFile );
+
+		Hydrogen::get_instance()->getTimeline()->deleteAllTempoMarkers();
+		pPref->setUseTimelineBpm( bOldUseTimelineBpm );
+		pPref->setRubberBandBatchMode( nOldRubberBandBatchMode );
+#endif
+	}
+
 };
 CPPUNIT_TEST_SUITE_REGISTRATION( FunctionalTest );
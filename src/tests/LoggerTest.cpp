@@ -0,0 +1,71 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Logger.h>
+
+#include <QString>
+
+#include <chrono>
+#include <thread>
+
+using namespace H2Core;
+
+class LoggerTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( LoggerTest );
+	CPPUNIT_TEST( testLogRt );
+	CPPUNIT_TEST( testFormatRt );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testLogRt()
+	{
+		Logger* pLogger = Logger::get_instance();
+
+		// Records of level None are consumed by the logger thread
+		// without printing them.
+		const unsigned nDropped = pLogger->get_rt_dropped_count();
+		for ( unsigned i = 0; i < 4 * Logger::RT_QUEUE_SIZE; ++i ) {
+			pLogger->log_rt( Logger::None, "LoggerTest", "testLogRt", "%1 %2", i, 0.5 );
+		}
+		CPPUNIT_ASSERT( pLogger->get_rt_dropped_count() > nDropped );
+
+		// Wait for the logger thread to empty the ring.
+		std::this_thread::sleep_for( std::chrono::milliseconds( 10 * Logger::RT_POLL_INTERVAL ) );
+		const unsigned nDroppedAfter = pLogger->get_rt_dropped_count();
+		for ( int i = 0; i < 10; ++i ) {
+			pLogger->log_rt( Logger::None, "LoggerTest", "testLogRt", "no arguments" );
+		}
+		CPPUNIT_ASSERT_EQUAL( nDroppedAfter, pLogger->get_rt_dropped_count() );
+	}
+
+	void testFormatRt()
+	{
+		// Frame positions have to be printed exactly.
+		const Logger::RtArg args[] = { 12345678, -7654321LL, 0.5, 2u };
+		CPPUNIT_ASSERT_EQUAL( QString( "12345678 -7654321 0.5 2" ),
+							  Logger::format_rt( "%1 %2 %3 %4", 4, args ) );
+		CPPUNIT_ASSERT_EQUAL( QString( "no arguments" ),
+							  Logger::format_rt( "no arguments", 0, nullptr ) );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( LoggerTest );
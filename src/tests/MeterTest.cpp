@@ -0,0 +1,139 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/Meter.h>
+#include <core/Sampler/BlockKernels.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace H2Core;
+
+class MeterTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( MeterTest );
+	CPPUNIT_TEST( testKernels );
+	CPPUNIT_TEST( testTruePeak );
+	CPPUNIT_TEST( testSnapshot );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Sine at a quarter of the sample rate whose samples are all
+		placed at +-sqrt(2)/2 while its peaks of 1.0 lie in between
+		them.*/
+	std::vector<float> quarterSine( int nFrames )
+	{
+		std::vector<float> data( nFrames );
+		for ( int i = 0; i < nFrames; ++i ) {
+			data[ i ] = std::sin( M_PI / 4 + i * M_PI / 2 );
+		}
+		return data;
+	}
+
+	void testKernels()
+	{
+		const int nFrames = 21;
+		std::vector<float> data( nFrames );
+		for ( int i = 0; i < nFrames; ++i ) {
+			data[ i ] = ( i - 15 ) * 0.1;
+		}
+
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.5, BlockKernels::absPeak( data.data(), nFrames, 0.0 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.0, BlockKernels::absPeak( data.data(), nFrames, 2.0 ), 1e-6 );
+
+		double fEnergy = 0;
+		for ( const auto& fValue : data ) {
+			fEnergy += fValue * fValue;
+		}
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( fEnergy, BlockKernels::energy( data.data(), nFrames ), 1e-5 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, BlockKernels::energy( data.data(), 0 ), 1e-6 );
+	}
+
+	void testTruePeak()
+	{
+		const int nFrames = 64;
+		const int nHistory = BlockKernels::TRUE_PEAK_TAPS - 1;
+		std::vector<float> data = quarterSine( nFrames );
+
+		std::vector<float> history( nHistory, 0.0 );
+		const float fTruePeak = BlockKernels::truePeak( data.data(), nFrames, history.data(), 0.0 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, fTruePeak, 0.02 );
+		CPPUNIT_ASSERT( std::equal( history.begin(), history.end(), data.end() - nHistory ) );
+
+		// Splitting the signal into blocks - also ones smaller than
+		// the history - must not alter the result.
+		for ( int nBlockSize : { 1, 5, 20 } ) {
+			std::vector<float> blockHistory( nHistory, 0.0 );
+			float fPeak = 0.0;
+			for ( int i = 0; i < nFrames; i += nBlockSize ) {
+				fPeak = BlockKernels::truePeak( data.data() + i, std::min( nBlockSize, nFrames - i ),
+												blockHistory.data(), fPeak );
+			}
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( fTruePeak, fPeak, 1e-6 );
+			CPPUNIT_ASSERT( blockHistory == history );
+		}
+	}
+
+	void testSnapshot()
+	{
+		const int nFrames = 64;
+		std::vector<float> data_L = quarterSine( nFrames );
+		std::vector<float> data_R( nFrames, -0.5 );
+
+		Meter meter( true );
+		meter.startCycle( nFrames );
+		meter.process( data_L.data(), data_R.data(), nFrames );
+
+		Meter::Snapshot levels = meter.getSnapshot();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( std::sqrt( 0.5 ), levels.fPeak_L, 1e-5 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, levels.fPeak_R, 1e-5 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( std::sqrt( 0.5 ), levels.fRms_L, 1e-5 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, levels.fRms_R, 1e-5 );
+		CPPUNIT_ASSERT( levels.fTruePeak_L > 0.98 );
+		CPPUNIT_ASSERT( levels.fTruePeak_R >= levels.fPeak_R );
+
+		// A silent cycle halves the energy per frame.
+		std::vector<float> silence( nFrames, 0.0 );
+		meter.startCycle( nFrames );
+		meter.process( silence.data(), silence.data(), nFrames );
+		levels = meter.getSnapshot();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, levels.fRms_L, 1e-5 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, levels.fPeak_R, 1e-5 );
+
+		// The levels are cleared by the audio thread at the
+		// beginning of the next cycle.
+		meter.reset();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, meter.getSnapshot().fPeak_R, 1e-5 );
+		meter.startCycle( nFrames );
+		levels = meter.getSnapshot();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, levels.fPeak_L, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, levels.fRms_R, 1e-6 );
+
+		// Meters without true peak detection leave it untouched.
+		Meter voiceMeter;
+		voiceMeter.startCycle( nFrames );
+		voiceMeter.process( data_L.data(), data_R.data(), nFrames );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, voiceMeter.getSnapshot().fTruePeak_L, 1e-6 );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MeterTest );
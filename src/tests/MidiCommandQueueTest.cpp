@@ -0,0 +1,101 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/IO/MidiCommandQueue.h>
+
+using namespace H2Core;
+
+class MidiCommandQueueTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( MidiCommandQueueTest );
+	CPPUNIT_TEST( testPushPop );
+	CPPUNIT_TEST( testOverflow );
+	CPPUNIT_TEST( testSysex );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testPushPop()
+	{
+		MidiCommandQueue queue;
+		CPPUNIT_ASSERT( queue.isEmpty() );
+
+		MidiMessage msg;
+		msg.m_type = MidiMessage::NOTE_ON;
+		msg.m_nChannel = 9;
+		msg.m_nFrameOffset = 17;
+		for ( int i = 0; i < 10; ++i ) {
+			msg.m_nData1 = 36 + i;
+			msg.m_nData2 = 100;
+			CPPUNIT_ASSERT( queue.push( MidiCommand::fromMessage( msg ) ) );
+		}
+
+		MidiCommand command;
+		for ( int i = 0; i < 10; ++i ) {
+			CPPUNIT_ASSERT( queue.pop( command ) );
+			CPPUNIT_ASSERT_EQUAL( MidiMessage::NOTE_ON, command.type );
+			CPPUNIT_ASSERT_EQUAL( 9, command.nChannel );
+			CPPUNIT_ASSERT_EQUAL( 36 + i, command.nData1 );
+			CPPUNIT_ASSERT_EQUAL( 100, command.nData2 );
+			CPPUNIT_ASSERT_EQUAL( 17, command.nFrameOffset );
+		}
+		CPPUNIT_ASSERT( ! queue.pop( command ) );
+		CPPUNIT_ASSERT( queue.isEmpty() );
+	}
+
+	void testOverflow()
+	{
+		MidiCommandQueue queue;
+		MidiMessage msg;
+		for ( unsigned i = 0; i < MidiCommandQueue::SIZE + 10; ++i ) {
+			msg.m_nData1 = i;
+			queue.push( MidiCommand::fromMessage( msg ) );
+		}
+		CPPUNIT_ASSERT_EQUAL( 10, queue.getDroppedCount() );
+
+		// Unread commands are kept and the most recent ones dropped.
+		MidiCommand command;
+		for ( unsigned i = 0; i < MidiCommandQueue::SIZE; ++i ) {
+			CPPUNIT_ASSERT( queue.pop( command ) );
+			CPPUNIT_ASSERT_EQUAL( static_cast<int>( i ), command.nData1 );
+		}
+		CPPUNIT_ASSERT( queue.isEmpty() );
+	}
+
+	void testSysex()
+	{
+		MidiMessage msg;
+		msg.m_type = MidiMessage::SYSEX;
+		msg.m_sysexData = { 240, 127, 0, 6, 2, 247 };
+
+		MidiMessage converted = MidiCommand::fromMessage( msg ).toMessage();
+		CPPUNIT_ASSERT_EQUAL( MidiMessage::SYSEX, converted.m_type );
+		CPPUNIT_ASSERT( converted.m_sysexData == msg.m_sysexData );
+
+		// Long messages are truncated but keep their size.
+		msg.m_sysexData.assign( 40, 1 );
+		MidiCommand command = MidiCommand::fromMessage( msg );
+		CPPUNIT_ASSERT_EQUAL( 40, command.nSysexSize );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( MidiCommand::MAX_SYSEX ),
+							  command.toMessage().m_sysexData.size() );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MidiCommandQueueTest );
@@ -0,0 +1,88 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/MidiAction.h>
+#include <core/MidiMap.h>
+
+#include <memory>
+
+class MidiMapTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( MidiMapTest );
+	CPPUNIT_TEST( testActionId );
+	CPPUNIT_TEST( testDispatchTable );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testActionId()
+	{
+		CPPUNIT_ASSERT_EQUAL( -1, MidiActionManager::getActionId( "NOTHING" ) );
+		CPPUNIT_ASSERT_EQUAL( -1, Action( "UNKNOWN_ACTION" ).getId() );
+
+		Action action( "STRIP_VOLUME_ABSOLUTE" );
+		CPPUNIT_ASSERT_EQUAL( MidiActionManager::getActionId( "STRIP_VOLUME_ABSOLUTE" ),
+							  action.getId() );
+		CPPUNIT_ASSERT( action.getId() >= 0 );
+		CPPUNIT_ASSERT_EQUAL( 1, MidiActionManager::get_instance()->
+							  getParameterNumber( "STRIP_VOLUME_ABSOLUTE" ) );
+
+		action.setParameter1( "3" );
+		action.setValue( QString( "100" ) );
+		CPPUNIT_ASSERT_EQUAL( 3, action.getParameter1AsInt() );
+		CPPUNIT_ASSERT_EQUAL( 0, action.getParameter2AsInt() );
+		CPPUNIT_ASSERT_EQUAL( 100, action.getValue() );
+		action.setValue( 27 );
+		CPPUNIT_ASSERT_EQUAL( 27, action.getValue() );
+	}
+
+	void testDispatchTable()
+	{
+		MidiMap::reset_instance();
+		MidiMap* pMidiMap = MidiMap::get_instance();
+
+		CPPUNIT_ASSERT( pMidiMap->findCCAction( 4 ) == nullptr );
+		CPPUNIT_ASSERT( pMidiMap->findPCAction() == nullptr );
+		CPPUNIT_ASSERT( ! pMidiMap->isNoteMapped( 36 ) );
+
+		auto pCCAction = std::make_shared<Action>( "MASTER_VOLUME_ABSOLUTE" );
+		auto pNoteAction = std::make_shared<Action>( "PLAY" );
+		pMidiMap->registerCCEvent( 4, pCCAction );
+		pMidiMap->registerCCEvent( 5, std::make_shared<Action>( "NOTHING" ) );
+		pMidiMap->registerNoteEvent( 36, pNoteAction );
+		pMidiMap->registerNoteEvent( 128, pNoteAction );
+
+		CPPUNIT_ASSERT( pMidiMap->findCCAction( 4 ) == pCCAction );
+		CPPUNIT_ASSERT( pMidiMap->findCCAction( 5 ) == nullptr );
+		CPPUNIT_ASSERT( pMidiMap->findCCAction( 128 ) == nullptr );
+		CPPUNIT_ASSERT( pMidiMap->findNoteAction( 36 ) == pNoteAction );
+		CPPUNIT_ASSERT( pMidiMap->isNoteMapped( 36 ) );
+		CPPUNIT_ASSERT( ! pMidiMap->isNoteMapped( 37 ) );
+
+		// The authoring interface still reports unsupported actions.
+		CPPUNIT_ASSERT_EQUAL( QString( "NOTHING" ), pMidiMap->getCCAction( 5 )->getType() );
+
+		MidiMap::reset_instance();
+		CPPUNIT_ASSERT( pMidiMap->findCCAction( 4 ) == nullptr );
+		CPPUNIT_ASSERT( ! pMidiMap->isNoteMapped( 36 ) );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MidiMapTest );
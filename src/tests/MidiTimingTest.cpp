@@ -0,0 +1,54 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/IO/MidiCommon.h>
+
+using namespace H2Core;
+
+class MidiTimingTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( MidiTimingTest );
+	CPPUNIT_TEST( testFrameOffset );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testFrameOffset()
+	{
+		CPPUNIT_ASSERT_EQUAL( -1, MidiMessage().m_nFrameOffset );
+
+		// Cycle of 256 frames at 48 kHz starting at one second.
+		const long long nStart = 1000000000LL;
+		CPPUNIT_ASSERT_EQUAL( 0, AudioEngine::computeFrameOffset( nStart, nStart, 256, 48000 ) );
+		// One millisecond corresponds to 48 frames.
+		CPPUNIT_ASSERT_EQUAL( 48, AudioEngine::computeFrameOffset( nStart + 1000000, nStart, 256, 48000 ) );
+		CPPUNIT_ASSERT_EQUAL( 96, AudioEngine::computeFrameOffset( nStart + 2000000, nStart, 256, 48000 ) );
+
+		// Events outside of the cycle are clamped.
+		CPPUNIT_ASSERT_EQUAL( 0, AudioEngine::computeFrameOffset( nStart - 5000000, nStart, 256, 48000 ) );
+		CPPUNIT_ASSERT_EQUAL( 255, AudioEngine::computeFrameOffset( nStart + 10000000, nStart, 256, 48000 ) );
+
+		// No cycle processed yet.
+		CPPUNIT_ASSERT_EQUAL( -1, AudioEngine::computeFrameOffset( nStart, 0, 0, 0 ) );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MidiTimingTest );
@@ -0,0 +1,111 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/NotePool.h>
+#include <core/Basics/Adsr.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentComponent.h>
+
+#include <vector>
+
+using namespace H2Core;
+
+class NotePoolTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( NotePoolTest );
+	CPPUNIT_TEST( testAcquireRelease );
+	CPPUNIT_TEST( testCopy );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testAcquireRelease()
+	{
+		const int nSize = 4;
+		NotePool pool( nSize );
+		auto pInstr = std::make_shared<Instrument>( 1, "Snare", nullptr );
+
+		std::vector<Note*> notes;
+		for ( int ii = 0; ii < nSize; ++ii ) {
+			Note* pNote = pool.acquire( pInstr, ii, 0.5f, 0.f, -1, 0.f );
+			CPPUNIT_ASSERT( pNote != nullptr );
+			CPPUNIT_ASSERT( pool.contains( pNote ) );
+			CPPUNIT_ASSERT_EQUAL( ii, pNote->get_position() );
+			notes.push_back( pNote );
+		}
+
+		// The pool is exhausted.
+		CPPUNIT_ASSERT( pool.acquire( pInstr, 0, 0.5f, 0.f, -1, 0.f ) == nullptr );
+		CPPUNIT_ASSERT_EQUAL( 1, pool.getExhaustedCount() );
+
+		pool.release( notes.back() );
+		notes.pop_back();
+		Note* pNote = pool.acquire( pInstr, 7, 0.5f, 0.f, -1, 0.f );
+		CPPUNIT_ASSERT( pNote != nullptr );
+		CPPUNIT_ASSERT_EQUAL( 7, pNote->get_position() );
+		notes.push_back( pNote );
+
+		// Released notes must not keep the instrument alive.
+		for ( auto& ppNote : notes ) {
+			pool.release( ppNote );
+		}
+		CPPUNIT_ASSERT_EQUAL( 1l, pInstr.use_count() );
+
+		// Notes not created by the pool are deleted.
+		Note* pHeapNote = new Note( pInstr, 0, 0.5f, 0.f, -1, 0.f );
+		CPPUNIT_ASSERT( ! pool.contains( pHeapNote ) );
+		pool.release( pHeapNote );
+	}
+
+	void testCopy()
+	{
+		NotePool pool( 2 );
+		auto pInstr = std::make_shared<Instrument>( 1, "Kick", nullptr );
+		pInstr->get_components()->push_back( std::make_shared<InstrumentComponent>( 0 ) );
+		pInstr->get_components()->push_back( std::make_shared<InstrumentComponent>( 2 ) );
+		pInstr->get_adsr()->set_release( 1234 );
+
+		Note note( pInstr, 24, 0.7f, -0.5f, 10, 1.5f );
+		note.set_probability( 0.25f );
+		note.get_layer_selected( 2 )->SelectedLayer = 3;
+
+		Note* pCopy = pool.acquire( &note );
+		CPPUNIT_ASSERT( pCopy != nullptr );
+		CPPUNIT_ASSERT( pCopy->get_instrument() == pInstr );
+		CPPUNIT_ASSERT_EQUAL( 1, pCopy->get_instrument_id() );
+		CPPUNIT_ASSERT_EQUAL( 24, pCopy->get_position() );
+		CPPUNIT_ASSERT_EQUAL( 0.7f, pCopy->get_velocity() );
+		CPPUNIT_ASSERT_EQUAL( -0.5f, pCopy->getPan() );
+		CPPUNIT_ASSERT_EQUAL( 10, pCopy->get_length() );
+		CPPUNIT_ASSERT_EQUAL( 1.5f, pCopy->get_pitch() );
+		CPPUNIT_ASSERT_EQUAL( 0.25f, pCopy->get_probability() );
+		CPPUNIT_ASSERT_EQUAL( 1234u, pCopy->get_adsr()->get_release() );
+
+		// Layer selection is reset for every component.
+		CPPUNIT_ASSERT( pCopy->get_layer_selected( 0 ) != nullptr );
+		CPPUNIT_ASSERT_EQUAL( -1, pCopy->get_layer_selected( 2 )->SelectedLayer );
+		CPPUNIT_ASSERT( pCopy->get_layer_selected( 1 ) == nullptr );
+
+		pool.release( pCopy );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( NotePoolTest );
@@ -0,0 +1,126 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/NoteQueue.h>
+#include <core/Basics/Note.h>
+
+#include <vector>
+
+using namespace H2Core;
+
+class NoteQueueTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( NoteQueueTest );
+	CPPUNIT_TEST( testPopDue );
+	CPPUNIT_TEST( testOverflow );
+	CPPUNIT_TEST_SUITE_END();
+
+	Note* createNote( int nPosition, int nDelay )
+	{
+		Note* pNote = new Note( nullptr, nPosition, 0.8f, 0.f, -1, 0.f );
+		pNote->set_humanize_delay( nDelay );
+		return pNote;
+	}
+
+	void testPopDue()
+	{
+		const float fTickSize = 100;
+		NoteQueue queue( 8 );
+		std::vector<Note*> due;
+		due.reserve( queue.getCapacity() );
+
+		Note* pLate = createNote( 12, 50 );
+		Note* pEarly = createNote( 12, -150 );
+		Note* pFirst = createNote( 10, 0 );
+		Note* pNext = createNote( 20, 0 );
+		CPPUNIT_ASSERT( queue.push( pLate ) );
+		CPPUNIT_ASSERT( queue.push( pEarly ) );
+		CPPUNIT_ASSERT( queue.push( pFirst ) );
+		CPPUNIT_ASSERT( queue.push( pNext ) );
+		CPPUNIT_ASSERT_EQUAL( 4, queue.size() );
+
+		// Nothing due yet.
+		queue.popDue( 1000, fTickSize, due );
+		CPPUNIT_ASSERT( due.empty() );
+
+		// The negative humanize delay moves the second note into
+		// this buffer while the positive one is ignored.
+		queue.popDue( 1100, fTickSize, due );
+		CPPUNIT_ASSERT_EQUAL( 2, static_cast<int>( due.size() ) );
+		CPPUNIT_ASSERT( due[ 0 ] == pFirst );
+		CPPUNIT_ASSERT( due[ 1 ] == pEarly );
+
+		// Notes of previous buffers are due as well and ordered by
+		// their onset including the positive delay.
+		due.clear();
+		Note* pOld = createNote( 5, 0 );
+		CPPUNIT_ASSERT( queue.push( pOld ) );
+		queue.popDue( 1300, fTickSize, due );
+		CPPUNIT_ASSERT_EQUAL( 2, static_cast<int>( due.size() ) );
+		CPPUNIT_ASSERT( due[ 0 ] == pOld );
+		CPPUNIT_ASSERT( due[ 1 ] == pLate );
+		CPPUNIT_ASSERT_EQUAL( 1, queue.size() );
+
+		due.clear();
+		queue.popAll( due );
+		CPPUNIT_ASSERT_EQUAL( 1, static_cast<int>( due.size() ) );
+		CPPUNIT_ASSERT( due[ 0 ] == pNext );
+		CPPUNIT_ASSERT( queue.empty() );
+
+		for ( auto pNote : { pLate, pEarly, pFirst, pNext, pOld } ) {
+			delete pNote;
+		}
+	}
+
+	void testOverflow()
+	{
+		NoteQueue queue( 2 );
+		std::vector<Note*> due;
+		due.reserve( queue.getCapacity() );
+
+		// Beyond the range covered by the wheel.
+		Note* pNear = createNote( 0, 0 );
+		Note* pFar = createNote( 3 * NoteQueue::BUCKETS + 7, 0 );
+		Note* pFull = createNote( 1, 0 );
+		CPPUNIT_ASSERT( queue.push( pNear ) );
+		CPPUNIT_ASSERT( queue.push( pFar ) );
+		CPPUNIT_ASSERT( ! queue.push( pFull ) );
+
+		queue.popDue( 1, 1.0, due );
+		CPPUNIT_ASSERT_EQUAL( 1, static_cast<int>( due.size() ) );
+		CPPUNIT_ASSERT( due[ 0 ] == pNear );
+
+		due.clear();
+		queue.popDue( 3 * NoteQueue::BUCKETS + 7, 1.0, due );
+		CPPUNIT_ASSERT( due.empty() );
+		queue.popDue( 3 * NoteQueue::BUCKETS + 8, 1.0, due );
+		CPPUNIT_ASSERT_EQUAL( 1, static_cast<int>( due.size() ) );
+		CPPUNIT_ASSERT( due[ 0 ] == pFar );
+		CPPUNIT_ASSERT( queue.empty() );
+
+		delete pNear;
+		delete pFar;
+		delete pFull;
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( NoteQueueTest );
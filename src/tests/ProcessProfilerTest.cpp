@@ -0,0 +1,99 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/ProcessProfiler.h>
+
+using namespace H2Core;
+
+class ProcessProfilerTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( ProcessProfilerTest );
+	CPPUNIT_TEST( testRecord );
+	CPPUNIT_TEST( testReset );
+	CPPUNIT_TEST( testScopedStage );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testRecord()
+	{
+		ProcessProfiler profiler;
+		// Budget of one millisecond.
+		profiler.startCycle( 1000000 );
+
+		for ( int i = 0; i < 99; ++i ) {
+			profiler.record( ProcessProfiler::Sampler, 3000 );
+		}
+		profiler.record( ProcessProfiler::Sampler, 500000 );
+		profiler.record( ProcessProfiler::Total, 400 );
+		profiler.record( ProcessProfiler::Total, 2000000 );
+
+		CPPUNIT_ASSERT_EQUAL( 100LL, profiler.getCount( ProcessProfiler::Sampler ) );
+		CPPUNIT_ASSERT_EQUAL( 0LL, profiler.getCount( ProcessProfiler::Synth ) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.00797, profiler.getMean( ProcessProfiler::Sampler ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, profiler.getMax( ProcessProfiler::Sampler ), 1e-6 );
+
+		// 3 microseconds are stored in the bin [2, 4).
+		CPPUNIT_ASSERT_EQUAL( 99LL, profiler.getBinCount( ProcessProfiler::Sampler, 2 ) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.004, profiler.getPercentile( ProcessProfiler::Sampler, 99 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, profiler.getPercentile( ProcessProfiler::Sampler, 100 ), 1e-6 );
+		CPPUNIT_ASSERT_EQUAL( 1LL, profiler.getBinCount( ProcessProfiler::Total, 0 ) );
+
+		CPPUNIT_ASSERT_EQUAL( 1LL, profiler.getOverrunCount() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, profiler.getBudget(), 1e-6 );
+	}
+
+	void testReset()
+	{
+		ProcessProfiler profiler;
+		profiler.startCycle( 1000 );
+		profiler.record( ProcessProfiler::Total, 5000 );
+		profiler.reset();
+
+		// The measurements are cleared by the audio thread at the
+		// beginning of the next cycle.
+		CPPUNIT_ASSERT_EQUAL( 1LL, profiler.getCount( ProcessProfiler::Total ) );
+		profiler.startCycle( 1000 );
+		CPPUNIT_ASSERT_EQUAL( 0LL, profiler.getCount( ProcessProfiler::Total ) );
+		CPPUNIT_ASSERT_EQUAL( 0LL, profiler.getOverrunCount() );
+	}
+
+	void testScopedStage()
+	{
+		ProcessProfiler profiler;
+		profiler.startCycle( 1000000 );
+
+		auto earlyReturn = [&]( bool bReturn ) {
+			ProcessProfiler::ScopedStage stage( &profiler, ProcessProfiler::Total,
+												ProcessProfiler::now() );
+			if ( bReturn ) {
+				return;
+			}
+			profiler.record( ProcessProfiler::Sampler, 1000 );
+		};
+		earlyReturn( true );
+		earlyReturn( false );
+
+		CPPUNIT_ASSERT_EQUAL( 2LL, profiler.getCount( ProcessProfiler::Total ) );
+		CPPUNIT_ASSERT_EQUAL( 1LL, profiler.getCount( ProcessProfiler::Sampler ) );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ProcessProfilerTest );
@@ -0,0 +1,95 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Sample.h>
+#include <core/Sampler/ResampleCache.h>
+#include "TestHelper.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace H2Core;
+
+class ResampleCacheTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( ResampleCacheTest );
+	CPPUNIT_TEST( testConvert );
+	CPPUNIT_TEST( testCachePath );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** \return Largest deviation of @a pSample from a sine of 1kHz
+		ignoring the edges.*/
+	float sineError( std::shared_ptr<Sample> pSample )
+	{
+		float fError = 0;
+		for ( int nn = 200; nn < pSample->get_frames() - 200; ++nn ) {
+			const float fSine = 0.5 * std::sin( 2 * M_PI * 1000.0 * nn / pSample->get_sample_rate() );
+			fError = std::max( fError, std::fabs( pSample->get_data_l()[ nn ] - fSine ) );
+			fError = std::max( fError, std::fabs( pSample->get_data_r()[ nn ] - fSine ) );
+		}
+		return fError;
+	}
+
+	void testConvert()
+	{
+		const int nFrames = 4410;
+		float* pData_L = new float[ nFrames ];
+		float* pData_R = new float[ nFrames ];
+		for ( int nn = 0; nn < nFrames; ++nn ) {
+			pData_L[ nn ] = 0.5 * std::sin( 2 * M_PI * 1000.0 * nn / 44100 );
+			pData_R[ nn ] = pData_L[ nn ];
+		}
+		auto pSample = std::make_shared<Sample>( "/tmp/sine.wav", nFrames, 44100,
+												 pData_L, pData_R );
+
+		auto pUp = ResampleCache::convert( pSample, 48000 );
+		CPPUNIT_ASSERT( pUp != nullptr );
+		CPPUNIT_ASSERT_EQUAL( 48000, pUp->get_sample_rate() );
+		CPPUNIT_ASSERT_EQUAL( 4800, pUp->get_frames() );
+		CPPUNIT_ASSERT( sineError( pUp ) < 1e-4 );
+
+		auto pDown = ResampleCache::convert( pUp, 22050 );
+		CPPUNIT_ASSERT( pDown != nullptr );
+		CPPUNIT_ASSERT_EQUAL( 2205, pDown->get_frames() );
+		CPPUNIT_ASSERT( sineError( pDown ) < 1e-4 );
+
+		CPPUNIT_ASSERT( ResampleCache::convert( std::make_shared<Sample>( "/tmp/empty.wav" ), 48000 ) == nullptr );
+	}
+
+	void testCachePath()
+	{
+		auto pSample = Sample::load( H2TEST_FILE( "drumkits/baseKit/kick.wav" ) );
+		CPPUNIT_ASSERT( pSample != nullptr );
+
+		const QString sPath = ResampleCache::getCachePath( pSample, 48000 );
+		CPPUNIT_ASSERT( ! sPath.isEmpty() );
+		CPPUNIT_ASSERT( sPath.endsWith( ".wav" ) );
+		CPPUNIT_ASSERT( sPath == ResampleCache::getCachePath( pSample, 48000 ) );
+		CPPUNIT_ASSERT( sPath != ResampleCache::getCachePath( pSample, 96000 ) );
+
+		// Altered samples do not correspond to their file anymore.
+		pSample->get_pan_envelope()->push_back( EnvelopePoint( 0, 0 ) );
+		CPPUNIT_ASSERT( ResampleCache::getCachePath( pSample, 48000 ).isEmpty() );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ResampleCacheTest );
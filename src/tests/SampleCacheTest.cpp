@@ -0,0 +1,186 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Sample.h>
+#include <core/Basics/SampleCache.h>
+#include <core/Preferences/Preferences.h>
+#include "TestHelper.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstring>
+#include <limits>
+
+using namespace H2Core;
+
+class SampleCacheTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SampleCacheTest );
+	CPPUNIT_TEST( testMap );
+	CPPUNIT_TEST( testCopyOnWrite );
+	CPPUNIT_TEST( testCachePath );
+	CPPUNIT_TEST( testPrune );
+	CPPUNIT_TEST_SUITE_END();
+
+	bool equalData( std::shared_ptr<Sample> pA, std::shared_ptr<Sample> pB )
+	{
+		const size_t nBytes = pA->get_frames() * sizeof( float );
+		return pA->get_frames() == pB->get_frames() &&
+			memcmp( pA->get_data_l(), pB->get_data_l(), nBytes ) == 0 &&
+			memcmp( pA->get_data_r(), pB->get_data_r(), nBytes ) == 0;
+	}
+
+	void testMap()
+	{
+		const QString sFilepath = H2TEST_FILE( "drumkits/baseKit/kick.wav" );
+		const QString sCachePath = SampleCache::getCachePath( sFilepath );
+		CPPUNIT_ASSERT( ! sCachePath.isEmpty() );
+		QFile::remove( sCachePath );
+
+		// The first load decodes the file and stores the result.
+		auto pDecoded = Sample::load( sFilepath );
+		CPPUNIT_ASSERT( pDecoded != nullptr );
+		CPPUNIT_ASSERT( ! pDecoded->is_mapped() );
+		CPPUNIT_ASSERT( QFile::exists( sCachePath ) );
+
+		auto pMapped = Sample::load( sFilepath );
+		CPPUNIT_ASSERT( pMapped != nullptr );
+		CPPUNIT_ASSERT( pMapped->is_mapped() );
+		CPPUNIT_ASSERT_EQUAL( 17477, pMapped->get_frames() );
+		CPPUNIT_ASSERT_EQUAL( pDecoded->get_sample_rate(), pMapped->get_sample_rate() );
+		CPPUNIT_ASSERT( equalData( pDecoded, pMapped ) );
+
+		pMapped->unload();
+		CPPUNIT_ASSERT( pMapped->is_empty() );
+		CPPUNIT_ASSERT( ! pMapped->is_mapped() );
+
+		// Invalid files are ignored.
+		QFile file( sCachePath );
+		CPPUNIT_ASSERT( file.open( QIODevice::WriteOnly ) );
+		file.write( "invalid" );
+		file.close();
+		auto pInvalid = std::make_shared<Sample>( sFilepath );
+		CPPUNIT_ASSERT( ! SampleCache::map( pInvalid.get(), sCachePath ) );
+		CPPUNIT_ASSERT( pInvalid->is_empty() );
+		QFile::remove( sCachePath );
+	}
+
+	void testCopyOnWrite()
+	{
+		const QString sFilepath = H2TEST_FILE( "drumkits/baseKit/snare.wav" );
+		auto pDecoded = Sample::load( sFilepath );
+		auto pMapped = Sample::load( sFilepath );
+		CPPUNIT_ASSERT( pMapped != nullptr );
+		CPPUNIT_ASSERT( pMapped->is_mapped() );
+
+		// Copies share the mapping.
+		auto pCopy = std::make_shared<Sample>( pMapped );
+		CPPUNIT_ASSERT( pCopy->is_mapped() );
+		CPPUNIT_ASSERT( pCopy->get_data_l() == pMapped->get_data_l() );
+
+		Sample::VelocityEnvelope velocity;
+		velocity.push_back( EnvelopePoint( 0, 0 ) );
+		velocity.push_back( EnvelopePoint( 841, 91 ) );
+		pCopy->apply_velocity( velocity );
+		CPPUNIT_ASSERT( ! pCopy->is_mapped() );
+		CPPUNIT_ASSERT( pMapped->is_mapped() );
+		CPPUNIT_ASSERT( equalData( pDecoded, pMapped ) );
+		CPPUNIT_ASSERT( ! equalData( pDecoded, pCopy ) );
+
+		// The processed sample is cached as well.
+		auto pProcessed = Sample::load( sFilepath, Sample::Loops(), Sample::Rubberband(),
+										velocity, Sample::PanEnvelope() );
+		CPPUNIT_ASSERT( pProcessed != nullptr );
+		auto pProcessedMapped = Sample::load( sFilepath, Sample::Loops(), Sample::Rubberband(),
+											  velocity, Sample::PanEnvelope() );
+		CPPUNIT_ASSERT( pProcessedMapped->is_mapped() );
+		CPPUNIT_ASSERT( pProcessedMapped->get_is_modified() );
+		CPPUNIT_ASSERT_EQUAL( 2, (int) pProcessedMapped->get_velocity_envelope()->size() );
+		CPPUNIT_ASSERT( equalData( pCopy, pProcessedMapped ) );
+	}
+
+	void testCachePath()
+	{
+		const QString sFilepath = H2TEST_FILE( "drumkits/baseKit/kick.wav" );
+		Sample::Loops loops;
+		Sample::VelocityEnvelope velocity;
+		Sample::PanEnvelope pan;
+
+		CPPUNIT_ASSERT( SampleCache::getProcessingKey( loops, Sample::Rubberband(),
+													   velocity, pan, 120 ).isEmpty() );
+		// Rubber Band settings are ignored as long as it is disabled.
+		Sample::Rubberband rubber;
+		rubber.pitch = 2;
+		CPPUNIT_ASSERT( SampleCache::getProcessingKey( loops, rubber,
+													   velocity, pan, 120 ).isEmpty() );
+
+		loops.end_frame = 1000;
+		const QString sProcessing = SampleCache::getProcessingKey( loops, rubber, velocity, pan, 120 );
+		CPPUNIT_ASSERT( ! sProcessing.isEmpty() );
+		CPPUNIT_ASSERT( SampleCache::getCachePath( sFilepath ) !=
+						SampleCache::getCachePath( sFilepath, sProcessing ) );
+		CPPUNIT_ASSERT( SampleCache::getCachePath( sFilepath, sProcessing ) ==
+						SampleCache::getCachePath( sFilepath, sProcessing ) );
+		// The tempo only matters for stretched samples.
+		CPPUNIT_ASSERT( sProcessing == SampleCache::getProcessingKey( loops, rubber, velocity, pan, 140 ) );
+		rubber.use = true;
+		CPPUNIT_ASSERT( SampleCache::getProcessingKey( loops, rubber, velocity, pan, 120 ) !=
+						SampleCache::getProcessingKey( loops, rubber, velocity, pan, 140 ) );
+
+		CPPUNIT_ASSERT( SampleCache::getCachePath( H2TEST_FILE( "drumkits/baseKit/missing.wav" ) ).isEmpty() );
+
+		auto pPref = Preferences::get_instance();
+		pPref->m_bUseSampleCache = false;
+		CPPUNIT_ASSERT( SampleCache::getCachePath( sFilepath ).isEmpty() );
+		pPref->m_bUseSampleCache = true;
+	}
+
+	void testPrune()
+	{
+		const QString sKick = H2TEST_FILE( "drumkits/baseKit/kick.wav" );
+		const QString sSnare = H2TEST_FILE( "drumkits/baseKit/snare.wav" );
+		const QString sKickCache = SampleCache::getCachePath( sKick );
+		const QString sSnareCache = SampleCache::getCachePath( sSnare );
+
+		// Previews are not cached.
+		QFile::remove( sKickCache );
+		CPPUNIT_ASSERT( Sample::load( sKick, false ) != nullptr );
+		CPPUNIT_ASSERT( ! QFile::exists( sKickCache ) );
+
+		CPPUNIT_ASSERT( Sample::load( sKick ) != nullptr );
+		CPPUNIT_ASSERT( Sample::load( sSnare ) != nullptr );
+		CPPUNIT_ASSERT( QFile::exists( sKickCache ) );
+		CPPUNIT_ASSERT( QFile::exists( sSnareCache ) );
+
+		// Nothing is removed as long as the limit is not exceeded.
+		const qint64 nSize = SampleCache::prune( std::numeric_limits<qint64>::max() );
+		CPPUNIT_ASSERT( nSize >= QFileInfo( sKickCache ).size() + QFileInfo( sSnareCache ).size() );
+		CPPUNIT_ASSERT( QFile::exists( sKickCache ) );
+
+		CPPUNIT_ASSERT_EQUAL( (qint64) 0, SampleCache::prune( 1 ) );
+		CPPUNIT_ASSERT( ! QFile::exists( sKickCache ) );
+		CPPUNIT_ASSERT( ! QFile::exists( sSnareCache ) );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SampleCacheTest );
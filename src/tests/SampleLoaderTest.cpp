@@ -0,0 +1,76 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/InstrumentComponent.h>
+#include <core/Basics/InstrumentLayer.h>
+#include <core/Basics/Sample.h>
+#include <core/Basics/SampleLoader.h>
+#include "TestHelper.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace H2Core;
+
+class SampleLoaderTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SampleLoaderTest );
+	CPPUNIT_TEST( testRun );
+	CPPUNIT_TEST( testLoadComponents );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testRun()
+	{
+		const int nJobs = 1000;
+		std::vector<std::atomic<int>> calls( nJobs );
+		for ( auto& nCalls : calls ) {
+			nCalls = 0;
+		}
+		SampleLoader::run( nJobs, [&]( int nJob ) {
+			calls[ nJob ]++;
+		} );
+		for ( const auto& nCalls : calls ) {
+			CPPUNIT_ASSERT_EQUAL( 1, nCalls.load() );
+		}
+	}
+
+	void testLoadComponents()
+	{
+		auto pComponent = std::make_shared<InstrumentComponent>( 0 );
+		pComponent->set_layer( std::make_shared<InstrumentLayer>(
+			std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/kick.wav" ) ) ), 0 );
+		pComponent->set_layer( std::make_shared<InstrumentLayer>(
+			std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/crash.wav" ) ) ), 1 );
+		std::vector<std::shared_ptr<InstrumentComponent>> components{ pComponent };
+
+		CPPUNIT_ASSERT( SampleLoader::loadComponents( components ) );
+		CPPUNIT_ASSERT_EQUAL( 17477, pComponent->get_layer( 0 )->get_sample()->get_frames() );
+		CPPUNIT_ASSERT( ! pComponent->get_layer( 1 )->get_sample()->is_empty() );
+
+		pComponent->set_layer( std::make_shared<InstrumentLayer>(
+			std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/missing.wav" ) ) ), 2 );
+		CPPUNIT_ASSERT( ! SampleLoader::loadComponents( components ) );
+		CPPUNIT_ASSERT( pComponent->get_layer( 2 )->get_sample()->is_empty() );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SampleLoaderTest );
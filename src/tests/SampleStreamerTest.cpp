@@ -0,0 +1,127 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Sample.h>
+#include <core/Sampler/SampleStreamer.h>
+#include "TestHelper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace H2Core;
+
+class SampleStreamerTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SampleStreamerTest );
+	CPPUNIT_TEST( testLoadStreamed );
+	CPPUNIT_TEST( testRead );
+	CPPUNIT_TEST( testOpen );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testLoadStreamed()
+	{
+		auto pSample = std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/crash.wav" ) );
+		CPPUNIT_ASSERT( pSample->load_streamed( 250 ) );
+		CPPUNIT_ASSERT( pSample->is_streamed() );
+		CPPUNIT_ASSERT_EQUAL( 134144, pSample->get_frames() );
+		CPPUNIT_ASSERT_EQUAL( 11025, pSample->get_preloaded_frames() );
+
+		// Short samples are loaded completely.
+		auto pShortSample = std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/kick.wav" ) );
+		CPPUNIT_ASSERT( pShortSample->load_streamed( 250 ) );
+		CPPUNIT_ASSERT( ! pShortSample->is_streamed() );
+		CPPUNIT_ASSERT_EQUAL( pShortSample->get_frames(), pShortSample->get_preloaded_frames() );
+	}
+
+	void testRead()
+	{
+		auto pFullSample = Sample::load( H2TEST_FILE( "drumkits/baseKit/crash.wav" ) );
+		auto pSample = std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/crash.wav" ) );
+		CPPUNIT_ASSERT( pSample->load_streamed( 250 ) );
+
+		SampleStreamer streamer;
+		streamer.start( 1 );
+		int nStream = streamer.open( pSample );
+		CPPUNIT_ASSERT( nStream >= 0 );
+
+		const int nBlock = 1024;
+		float pOut_L[ nBlock ];
+		float pOut_R[ nBlock ];
+		for ( int nStart = 0; nStart < pSample->get_frames(); nStart += nBlock ) {
+			const int nFrames = std::min( nBlock, pSample->get_frames() - nStart );
+
+			// Wait for the I/O thread instead of accepting silence.
+			for ( int nTry = 0; nTry < 1000; ++nTry ) {
+				const long long nUnderruns = streamer.getUnderrunCount();
+				streamer.read( nStream, pSample, nStart, nFrames, pOut_L, pOut_R );
+				if ( streamer.getUnderrunCount() == nUnderruns ) {
+					break;
+				}
+				std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+			}
+
+			for ( int ii = 0; ii < nFrames; ++ii ) {
+				CPPUNIT_ASSERT_EQUAL( pFullSample->get_data_l()[ nStart + ii ], pOut_L[ ii ] );
+				CPPUNIT_ASSERT_EQUAL( pFullSample->get_data_r()[ nStart + ii ], pOut_R[ ii ] );
+			}
+		}
+		streamer.release( nStream );
+	}
+
+	void testOpen()
+	{
+		auto pSample = std::make_shared<Sample>( H2TEST_FILE( "drumkits/baseKit/crash.wav" ) );
+		CPPUNIT_ASSERT( pSample->load_streamed( 250 ) );
+
+		SampleStreamer streamer;
+		CPPUNIT_ASSERT_EQUAL( -1, streamer.open( pSample ) );
+
+		streamer.start( 1 );
+		const int nStream = streamer.open( pSample );
+		CPPUNIT_ASSERT( nStream >= 0 );
+		CPPUNIT_ASSERT_EQUAL( -1, streamer.open( pSample ) );
+
+		// Without a stream only the preloaded part is played.
+		float pOut_L[ 10 ];
+		float pOut_R[ 10 ];
+		const long long nUnderruns = streamer.getUnderrunCount();
+		streamer.read( -1, pSample, pSample->get_preloaded_frames() - 5, 10, pOut_L, pOut_R );
+		CPPUNIT_ASSERT_EQUAL( pSample->get_data_l()[ pSample->get_preloaded_frames() - 1 ], pOut_L[ 4 ] );
+		CPPUNIT_ASSERT_EQUAL( 0.0f, pOut_L[ 5 ] );
+		CPPUNIT_ASSERT_EQUAL( 0.0f, pOut_R[ 9 ] );
+		CPPUNIT_ASSERT_EQUAL( nUnderruns + 1, streamer.getUnderrunCount() );
+
+		// Released streams are reused once the I/O thread closed
+		// them.
+		streamer.release( nStream );
+		int nNewStream = -1;
+		for ( int nTry = 0; nTry < 1000 && nNewStream == -1; ++nTry ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+			nNewStream = streamer.open( pSample );
+		}
+		CPPUNIT_ASSERT_EQUAL( nStream, nNewStream );
+		streamer.release( nNewStream );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SampleStreamerTest );
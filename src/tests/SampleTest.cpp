@@ -25,9 +25,13 @@
 
 #include <core/Basics/Sample.h>
 
+#include <cstring>
+
 class SampleTest : public CppUnit::TestCase {
 	CPPUNIT_TEST_SUITE( SampleTest );
 	CPPUNIT_TEST( testLoadInvalidSample );
+	CPPUNIT_TEST( testMono );
+	CPPUNIT_TEST( testCompact );
 
 	CPPUNIT_TEST_SUITE_END();
 
@@ -45,6 +49,68 @@ class SampleTest : public CppUnit::TestCase {
 		pSample = H2Core::Sample::load( H2TEST_FILE("drumkits/baseKit/drumkit.xml") );
 		CPPUNIT_ASSERT(pSample == nullptr);
 	}
+
+	void testMono()
+	{
+		auto pSample = H2Core::Sample::load( H2TEST_FILE( "drumkits/baseKit/kick.wav" ) );
+		CPPUNIT_ASSERT( pSample != nullptr );
+		CPPUNIT_ASSERT( pSample->is_mono() );
+		CPPUNIT_ASSERT( pSample->get_data_l() == pSample->get_data_r() );
+
+		// Panning splits both channels.
+		H2Core::Sample::PanEnvelope pan;
+		pan.push_back( H2Core::EnvelopePoint( 0, 0 ) );
+		pan.push_back( H2Core::EnvelopePoint( 841, 45 ) );
+		pSample->apply_pan( pan );
+		CPPUNIT_ASSERT( ! pSample->is_mono() );
+		CPPUNIT_ASSERT( pSample->get_data_l() != pSample->get_data_r() );
+
+		auto pStereo = H2Core::Sample::load( H2TEST_FILE( "drumkits/baseKit/snare.wav" ) );
+		CPPUNIT_ASSERT( pStereo != nullptr );
+		CPPUNIT_ASSERT( ! pStereo->is_mono() );
+	}
+
+	void testCompact()
+	{
+		auto pSample = H2Core::Sample::load( H2TEST_FILE( "drumkits/baseKit/snare.wav" ) );
+		CPPUNIT_ASSERT( pSample != nullptr );
+		auto pReference = std::make_shared<H2Core::Sample>( pSample );
+
+		// The sample is read from a 16 bit file.
+		CPPUNIT_ASSERT( pSample->compact() );
+		CPPUNIT_ASSERT( pSample->is_compact() );
+		CPPUNIT_ASSERT( ! pSample->is_empty() );
+		CPPUNIT_ASSERT( pSample->get_data_l() == nullptr );
+		for ( int i = 0; i < pSample->get_frames(); ++i ) {
+			CPPUNIT_ASSERT_EQUAL( pReference->get_data_l()[ i ],
+								  pSample->get_data_16_l()[ i ] * H2Core::Sample::INT16_SCALE );
+			CPPUNIT_ASSERT_EQUAL( pReference->get_data_r()[ i ],
+								  pSample->get_data_16_r()[ i ] * H2Core::Sample::INT16_SCALE );
+		}
+
+		auto pCopy = std::make_shared<H2Core::Sample>( pSample );
+		CPPUNIT_ASSERT( pCopy->is_compact() );
+		pCopy->expand();
+		CPPUNIT_ASSERT( ! pCopy->is_compact() );
+		CPPUNIT_ASSERT( memcmp( pReference->get_data_l(), pCopy->get_data_l(),
+								pCopy->get_frames() * sizeof( float ) ) == 0 );
+
+		pSample->unload();
+		CPPUNIT_ASSERT( pSample->is_empty() );
+
+		// Mono samples stay mono.
+		auto pMono = H2Core::Sample::load( H2TEST_FILE( "drumkits/baseKit/kick.wav" ) );
+		CPPUNIT_ASSERT( pMono->compact() );
+		CPPUNIT_ASSERT( pMono->is_mono() );
+
+		// Values not representable by 16 bit integers are kept.
+		float* pData_L = new float[ 2 ]{ 0.5f, 0.3f };
+		float* pData_R = new float[ 2 ]{ 0.5f, 0.5f };
+		auto pFloat = std::make_shared<H2Core::Sample>( "/tmp/float.wav", 2, 44100, pData_L, pData_R );
+		CPPUNIT_ASSERT( ! pFloat->compact() );
+		CPPUNIT_ASSERT( ! pFloat->is_compact() );
+		CPPUNIT_ASSERT_EQUAL( 0.3f, pFloat->get_data_l()[ 1 ] );
+	}
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( SampleTest );
@@ -0,0 +1,102 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/Hydrogen.h>
+
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+class SongTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SongTest );
+	CPPUNIT_TEST( testColumnIndex );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testColumnIndex()
+	{
+		auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+		pAudioEngine->lock( RIGHT_HERE );
+
+		auto pSong = std::make_shared<Song>( "test", "", 120, 0.5 );
+		Pattern* pLong = new Pattern( "long", "", "", MAX_NOTES );
+		Pattern* pShort = new Pattern( "short", "", "", MAX_NOTES / 2 );
+		PatternList* pPatternList = new PatternList();
+		pPatternList->add( pLong );
+		pPatternList->add( pShort );
+		pSong->setPatternList( pPatternList );
+
+		// Columns of 96, 192 (empty), and 192 ticks.
+		std::vector<PatternList*>* pColumns = new std::vector<PatternList*>;
+		pColumns->push_back( new PatternList() );
+		( *pColumns )[ 0 ]->add( pShort );
+		pColumns->push_back( new PatternList() );
+		pColumns->push_back( new PatternList() );
+		( *pColumns )[ 2 ]->add( pShort );
+		( *pColumns )[ 2 ]->add( pLong );
+		pSong->setPatternGroupVector( pColumns );
+
+		int nStart = -1;
+		CPPUNIT_ASSERT_EQUAL( 480, pSong->lengthInTicks() );
+		CPPUNIT_ASSERT_EQUAL( 0, pSong->getColumnForTick( 0, false, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( 0, nStart );
+		CPPUNIT_ASSERT_EQUAL( 0, pSong->getColumnForTick( 95, false, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( 1, pSong->getColumnForTick( 96, false, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( 96, nStart );
+		CPPUNIT_ASSERT_EQUAL( 2, pSong->getColumnForTick( 479, false, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( 288, nStart );
+		CPPUNIT_ASSERT_EQUAL( -1, pSong->getColumnForTick( 480, false, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( -1, pSong->getColumnForTick( -1, true, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( 1, pSong->getColumnForTick( 480 * 3 + 100, true, &nStart ) );
+		CPPUNIT_ASSERT_EQUAL( 96, nStart );
+
+		CPPUNIT_ASSERT_EQUAL( 288L, pSong->getTickForColumn( 2 ) );
+		CPPUNIT_ASSERT_EQUAL( 480L, pSong->getTickForColumn( 3 ) );
+		CPPUNIT_ASSERT_EQUAL( -1L, pSong->getTickForColumn( 4 ) );
+		CPPUNIT_ASSERT_EQUAL( MAX_NOTES, pSong->getColumnLength( 1 ) );
+		CPPUNIT_ASSERT_EQUAL( -1, pSong->getColumnLength( 3 ) );
+
+		// Modifications of the columns only take effect after the
+		// index was rebuilt.
+		( *pColumns )[ 0 ]->del( pShort );
+		( *pColumns )[ 0 ]->add( pLong );
+		CPPUNIT_ASSERT_EQUAL( 480, pSong->lengthInTicks() );
+		pSong->updateColumnIndex();
+		CPPUNIT_ASSERT_EQUAL( 576, pSong->lengthInTicks() );
+		CPPUNIT_ASSERT_EQUAL( 0, pSong->getColumnForTick( 100, false, &nStart ) );
+
+		pShort->set_length( MAX_NOTES * 2 );
+		pSong->updateColumnIndex();
+		CPPUNIT_ASSERT_EQUAL( 2 * MAX_NOTES, pSong->getColumnLength( 2 ) );
+		CPPUNIT_ASSERT_EQUAL( 768L, pSong->getTickForColumn( 3 ) );
+
+		pSong = nullptr;
+		pAudioEngine->unlock();
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SongTest );
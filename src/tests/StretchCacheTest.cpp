@@ -0,0 +1,100 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Sampler/StretchCache.h>
+
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+class StretchCacheTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( StretchCacheTest );
+	CPPUNIT_TEST( testDistances );
+	CPPUNIT_TEST( testTempoKey );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testDistances()
+	{
+		InstrumentList instruments;
+		auto pKick = std::make_shared<Instrument>( 0, "Kick" );
+		auto pSnare = std::make_shared<Instrument>( 1, "Snare" );
+		auto pHihat = std::make_shared<Instrument>( 2, "HiHat" );
+		instruments.add( pKick );
+		instruments.add( pSnare );
+		instruments.add( pHihat );
+
+		Pattern kickPattern;
+		kickPattern.insert_note( new Note( pKick, 0, 1.0, 0.0, -1, 0 ) );
+		Pattern snarePattern;
+		snarePattern.insert_note( new Note( pSnare, 48, 1.0, 0.0, -1, 0 ) );
+
+		// Columns: kick, empty, snare, kick + snare.
+		PatternList columns[ 4 ];
+		columns[ 0 ].add( &kickPattern );
+		columns[ 2 ].add( &snarePattern );
+		columns[ 3 ].add( &kickPattern );
+		columns[ 3 ].add( &snarePattern );
+		std::vector<PatternList*> song = { &columns[ 0 ], &columns[ 1 ],
+										   &columns[ 2 ], &columns[ 3 ] };
+
+		std::vector<int> distances = StretchCache::getDistances( &instruments, song, 1, false );
+		CPPUNIT_ASSERT_EQUAL( 3, static_cast<int>( distances.size() ) );
+		CPPUNIT_ASSERT_EQUAL( 2, distances[ 0 ] );
+		CPPUNIT_ASSERT_EQUAL( 1, distances[ 1 ] );
+		CPPUNIT_ASSERT_EQUAL( StretchCache::UNUSED, distances[ 2 ] );
+
+		// Columns prior to the current one are played after the
+		// last one in loop mode only.
+		distances = StretchCache::getDistances( &instruments, song, 3, false );
+		CPPUNIT_ASSERT_EQUAL( 0, distances[ 0 ] );
+		distances = StretchCache::getDistances( &instruments, song, 3, true );
+		CPPUNIT_ASSERT_EQUAL( 0, distances[ 0 ] );
+		CPPUNIT_ASSERT_EQUAL( 0, distances[ 1 ] );
+		distances = StretchCache::getDistances( &instruments, { &columns[ 0 ], &columns[ 1 ], &columns[ 2 ] }, 1, true );
+		CPPUNIT_ASSERT_EQUAL( 2, distances[ 0 ] );
+		CPPUNIT_ASSERT_EQUAL( 1, distances[ 1 ] );
+
+		// The patterns are owned by this test.
+		for ( auto& column : columns ) {
+			while ( column.size() > 0 ) {
+				column.del( 0 );
+			}
+		}
+	}
+
+	void testTempoKey()
+	{
+		CPPUNIT_ASSERT_EQUAL( StretchCache::getTempoKey( 120 ),
+							  StretchCache::getTempoKey( 120.0001 ) );
+		CPPUNIT_ASSERT( StretchCache::getTempoKey( 120 ) !=
+						StretchCache::getTempoKey( 120.01 ) );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( StretchCacheTest );
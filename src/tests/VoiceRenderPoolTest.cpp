@@ -0,0 +1,74 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2002-2008 by Alex >Comix< Cominu [comix@users.sourceforge.net]
+ * Copyright(c) 2008-2021 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Sampler/VoiceRenderPool.h>
+
+#include <atomic>
+#include <vector>
+
+using namespace H2Core;
+
+class VoiceRenderPoolTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( VoiceRenderPoolTest );
+	CPPUNIT_TEST( testRun );
+	CPPUNIT_TEST( testSingleWorker );
+	CPPUNIT_TEST_SUITE_END();
+
+	void testRun()
+	{
+		const int nWorkers = 4;
+		std::vector<int> calls( nWorkers, 0 );
+		std::atomic<int> nCalls( 0 );
+		{
+			VoiceRenderPool pool( nWorkers, [&]( int nWorker ) {
+				++calls[ nWorker ];
+				++nCalls;
+			} );
+			CPPUNIT_ASSERT_EQUAL( nWorkers, pool.getWorkerCount() );
+
+			// Each run has to wait for all workers to finish.
+			for ( int nRun = 1; nRun <= 100; ++nRun ) {
+				pool.run();
+				CPPUNIT_ASSERT_EQUAL( nRun * nWorkers, nCalls.load() );
+			}
+		}
+
+		for ( int nWorker = 0; nWorker < nWorkers; ++nWorker ) {
+			CPPUNIT_ASSERT_EQUAL( 100, calls[ nWorker ] );
+		}
+	}
+
+	void testSingleWorker()
+	{
+		int nCalls = 0;
+		VoiceRenderPool pool( 0, [&]( int nWorker ) {
+			CPPUNIT_ASSERT_EQUAL( 0, nWorker );
+			++nCalls;
+		} );
+		CPPUNIT_ASSERT_EQUAL( 1, pool.getWorkerCount() );
+		pool.run();
+		CPPUNIT_ASSERT_EQUAL( 1, nCalls );
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( VoiceRenderPoolTest );
@@ -27,6 +27,42 @@
 
 static constexpr qint64 BUFFER_SIZE = 4096;
 
+static void compareAudioData( SNDFILE* f1, SNDFILE* f2, sf_count_t remainingSamples,
+							  const QString &expected, const QString &actual,
+							  CppUnit::SourceLine sourceLine )
+{
+	auto offset = 0LL;
+	while ( remainingSamples > 0 ) {
+		short buf1[ BUFFER_SIZE ];
+		short buf2[ BUFFER_SIZE ];
+		auto toRead = qMin( remainingSamples, (sf_count_t)BUFFER_SIZE );
+
+		auto read1 = sf_read_short( f1, buf1, toRead);
+		if ( read1 != toRead ) throw CppUnit::Exception( CppUnit::Message( "Short read or read error" ), sourceLine );
+
+		auto read2= sf_read_short( f2, buf2, toRead);
+		if ( read2 != toRead ) throw CppUnit::Exception( CppUnit::Message( "Short read or read error" ), sourceLine );
+
+		for ( sf_count_t i = 0; i < toRead; ++i ) {
+			// Bit-precise floating point on all platforms is unneeded, and arbitrarily small differences can
+			// create rounding differences. Allow results to differ by 1 either way to account for this.
+			int delta = (int)buf1[i] - (int)buf2[i];
+			if ( delta < -1 || delta > 1 ) {
+				auto diffLocation = offset + i + 1;
+				CppUnit::Message msg(
+					std::string("Files differ at sample ") + std::to_string(diffLocation),
+					std::string("Expected: ") + expected.toStdString(),
+					std::string("Actual  : ") + actual.toStdString() );
+				throw CppUnit::Exception(msg, sourceLine);
+
+			}
+		}
+
+		offset += read1;
+		remainingSamples -= read1;
+	}
+}
+
 void H2Test::checkAudioFilesEqual(const QString &expected, const QString &actual, CppUnit::SourceLine sourceLine)
 {
 	SF_INFO info1 = {0};
@@ -59,35 +95,46 @@ void H2Test::checkAudioFilesEqual(const QString &expected, const QString &actual
 		throw CppUnit::Exception(msg, sourceLine);
 	}
 
-	auto remainingSamples = info1.frames * info1.channels;
-	auto offset = 0LL;
-	while ( remainingSamples > 0 ) {
-		short buf1[ BUFFER_SIZE ];
-		short buf2[ BUFFER_SIZE ];
-		auto toRead = qMin( remainingSamples, (sf_count_t)BUFFER_SIZE );
-
-		auto read1 = sf_read_short( f1.get(), buf1, toRead);
-		if ( read1 != toRead ) throw CppUnit::Exception( CppUnit::Message( "Short read or read error" ), sourceLine );
+	compareAudioData( f1.get(), f2.get(), info1.frames * info1.channels,
+					  expected, actual, sourceLine );
+}
 
-		auto read2= sf_read_short( f2.get(), buf2, toRead);
-		if ( read2 != toRead ) throw CppUnit::Exception( CppUnit::Message( "Short read or read error" ), sourceLine );
+void H2Test::checkAudioFileTailEqual(const QString &expected, const QString &actual, CppUnit::SourceLine sourceLine)
+{
+	SF_INFO info1 = {0};
+	std::unique_ptr<SNDFILE, decltype(&sf_close)>
+		f1{ sf_open( expected.toLocal8Bit().data(), SFM_READ, &info1), sf_close };
+	if ( f1 == nullptr ) {
+		CppUnit::Message msg(
+			"Can't open reference file",
+			sf_strerror( nullptr )
+		);
+		throw CppUnit::Exception(msg, sourceLine);
+	}
 
-		for ( sf_count_t i = 0; i < toRead; ++i ) {
-			// Bit-precise floating point on all platforms is unneeded, and arbitrarily small differences can
-			// create rounding differences. Allow results to differ by 1 either way to account for this.
-			int delta = (int)buf1[i] - (int)buf2[i];
-			if ( delta < -1 || delta > 1 ) {
-				auto diffLocation = offset + i + 1;
-				CppUnit::Message msg(
-					std::string("Files differ at sample ") + std::to_string(diffLocation),
-					std::string("Expected: ") + expected.toStdString(),
-					std::string("Actual  : ") + actual.toStdString() );
-				throw CppUnit::Exception(msg, sourceLine);
+	SF_INFO info2 = {0};
+	std::unique_ptr<SNDFILE, decltype(&sf_close)>
+		f2{ sf_open( actual.toLocal8Bit().data(), SFM_READ, &info2), sf_close };
+	if ( f2 == nullptr ) {
+		CppUnit::Message msg(
+			"Can't open results file",
+			sf_strerror( nullptr )
+		);
+		throw CppUnit::Exception(msg, sourceLine);
+	}
 
-			}
-		}
+	if ( info1.frames > info2.frames || info1.channels != info2.channels ) {
+		CppUnit::Message msg(
+			"Results file shorter than reference or channel count different",
+			std::string("Expected: ") + expected.toStdString(),
+			std::string("Actual  : ") + actual.toStdString() );
+		throw CppUnit::Exception(msg, sourceLine);
+	}
 
-		offset += read1;
-		remainingSamples -= read1;
+	if ( sf_seek( f2.get(), info2.frames - info1.frames, SEEK_SET ) < 0 ) {
+		throw CppUnit::Exception( CppUnit::Message( "Seek error" ), sourceLine );
 	}
+
+	compareAudioData( f1.get(), f2.get(), info1.frames * info1.channels,
+					  expected, actual, sourceLine );
 }
@@ -29,6 +29,7 @@
 namespace H2Test {
 	
 	void checkAudioFilesEqual(const QString &expected, const QString &actual, CppUnit::SourceLine sourceLine);
+	void checkAudioFileTailEqual(const QString &expected, const QString &actual, CppUnit::SourceLine sourceLine);
 
 }
 
@@ -38,5 +39,12 @@ namespace H2Test {
 #define H2TEST_ASSERT_AUDIO_FILES_EQUAL(expected, actual) \
 	H2Test::checkAudioFilesEqual(expected, actual, CPPUNIT_SOURCELINE())
 
+/**
+ * \brief Assert that the contents of the first file equal the last
+ * frames of the second one
+ **/
+#define H2TEST_ASSERT_AUDIO_FILE_TAIL_EQUAL(expected, actual) \
+	H2Test::checkAudioFileTailEqual(expected, actual, CPPUNIT_SOURCELINE())
+
 #endif
 